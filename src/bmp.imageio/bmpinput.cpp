@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
-#include <cstdio>
+#include <memory>
 
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imageio.h>
@@ -19,6 +19,10 @@ public:
     BmpInput() { init(); }
     virtual ~BmpInput() { close(); }
     virtual const char* format_name(void) const override { return "bmp"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool valid_file(const std::string& filename) const override;
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
     virtual bool open(const std::string& name, ImageSpec& newspec,
@@ -26,11 +30,17 @@ public:
     virtual bool close(void) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     int64_t m_padded_scanline_size;
     int m_pad_size;
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     bmp_pvt::BmpFileHeader m_bmp_header;
     bmp_pvt::DibInformationHeader m_dib_header;
     std::string m_filename;
@@ -43,7 +53,8 @@ private:
     {
         m_padded_scanline_size = 0;
         m_pad_size             = 0;
-        m_fd                   = NULL;
+        m_io                   = nullptr;
+        m_io_local.reset();
         m_filename.clear();
         m_colortable.clear();
         m_allgray = false;
@@ -83,13 +94,11 @@ OIIO_PLUGIN_EXPORTS_END
 bool
 BmpInput::valid_file(const std::string& filename) const
 {
-    FILE* fd = Filesystem::fopen(filename, "rb");
-    if (!fd)
+    Filesystem::IOFile file(filename, Filesystem::IOProxy::Mode::Read);
+    if (file.mode() != Filesystem::IOProxy::Mode::Read)
         return false;
     bmp_pvt::BmpFileHeader bmp_header;
-    bool ok = bmp_header.read_header(fd) && bmp_header.isBmp();
-    fclose(fd);
-    return ok;
+    return bmp_header.read_header(&file) && bmp_header.isBmp();
 }
 
 
@@ -117,14 +126,22 @@ BmpInput::open(const std::string& name, ImageSpec& newspec,
     // this behavior off.
     bool monodetect = config["bmp:monochrome_detect"].get<int>(1);
 
-    m_fd = Filesystem::fopen(m_filename, "rb");
-    if (!m_fd) {
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorf("Could not open file \"%s\"", name);
         return false;
     }
+    m_io->seek(0);
 
     // we read header of the file that we think is BMP file
-    if (!m_bmp_header.read_header(m_fd)) {
+    if (!m_bmp_header.read_header(m_io)) {
         errorf("\"%s\": wrong bmp header size", m_filename);
         close();
         return false;
@@ -135,7 +152,7 @@ BmpInput::open(const std::string& name, ImageSpec& newspec,
         close();
         return false;
     }
-    if (!m_dib_header.read_header(m_fd)) {
+    if (!m_dib_header.read_header(m_io)) {
         errorf("\"%s\": wrong bitmap header size", m_filename);
         close();
         return false;
@@ -228,9 +245,9 @@ BmpInput::read_rle_image()
     // Note: the clear+resize zeroes out the buffer
     bool err = false;
     int y = 0, x = 0;
-    while (!err && !feof(m_fd)) {
+    while (!err && m_io->tell() < int64_t(m_io->size())) {
         unsigned char rle_pair[2];
-        if (fread(rle_pair, 1, 2, m_fd) != 2) {
+        if (m_io->read(rle_pair, 2) != 2) {
             err = true;
             break;
         }
@@ -247,7 +264,7 @@ BmpInput::read_rle_image()
             // [0,2] is a "delta" -- two more bytes reposition the
             // current pixel position that we're reading.
             unsigned char offset[2];
-            err |= (fread(offset, 1, 2, m_fd) != 2);
+            err |= (m_io->read(offset, 2) != 2);
             x += offset[0];
             y += offset[1];
         } else if (npixels == 0) {
@@ -259,7 +276,7 @@ BmpInput::read_rle_image()
                               ? round_to_multiple((npixels + 1) / 2, 2)
                               : round_to_multiple(npixels, 2);
             unsigned char absolute[256];
-            err |= (fread(absolute, 1, nbytes, m_fd) != size_t(nbytes));
+            err |= (m_io->read(absolute, nbytes) != size_t(nbytes));
             for (int i = 0; i < npixels; ++i, ++x) {
                 if (rletype == 4)
                     value = (i & 1) ? (absolute[i / 2] & 0x0f)
@@ -317,10 +334,11 @@ BmpInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
     const int64_t scanline_off = y * m_padded_scanline_size;
 
     fscanline.resize(m_padded_scanline_size);
-    Filesystem::fseek(m_fd, m_bmp_header.offset + scanline_off, SEEK_SET);
-    size_t n = fread(fscanline.data(), 1, m_padded_scanline_size, m_fd);
+    size_t n = m_io->pread(fscanline.data(), m_padded_scanline_size,
+                           m_bmp_header.offset + scanline_off);
     if (n != (size_t)m_padded_scanline_size) {
-        if (feof(m_fd))
+        if (m_bmp_header.offset + scanline_off + int64_t(n)
+            >= int64_t(m_io->size()))
             errorf("Hit end of file unexpectedly");
         else
             errorf("read error");
@@ -399,10 +417,8 @@ BmpInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
 
 bool inline BmpInput::close(void)
 {
-    if (m_fd) {
-        fclose(m_fd);
-        m_fd = NULL;
-    }
+    // N.B. init() releases m_io_local if we allocated our own proxy, but
+    // never closes one that was supplied by the caller.
     init();
     return true;
 }
@@ -429,9 +445,9 @@ BmpInput::read_color_table(void)
         entry_size = 3;
     m_colortable.resize(colors);
     for (int i = 0; i < colors; i++) {
-        size_t n = fread(&m_colortable[i], 1, entry_size, m_fd);
+        size_t n = m_io->read(&m_colortable[i], entry_size);
         if (n != entry_size) {
-            if (feof(m_fd))
+            if (m_io->tell() >= int64_t(m_io->size()))
                 errorfmt(
                     "Hit end of file unexpectedly while reading color table on color {}/{} (read {}, expected {})",
                     i, colors, n, entry_size);
@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
-#include <cstdio>
+#include <memory>
 
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imageio.h>
@@ -29,10 +29,16 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     int64_t m_padded_scanline_size;
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
     bmp_pvt::BmpFileHeader m_bmp_header;
     bmp_pvt::DibInformationHeader m_dib_header;
@@ -45,7 +51,8 @@ private:
     void init(void)
     {
         m_padded_scanline_size = 0;
-        m_fd                   = NULL;
+        m_io                   = nullptr;
+        m_io_local.reset();
         m_filename.clear();
     }
 
@@ -74,7 +81,7 @@ OIIO_PLUGIN_EXPORTS_END
 int
 BmpOutput::supports(string_view feature) const
 {
-    return (feature == "alpha");
+    return (feature == "alpha" || feature == "ioproxy");
 }
 
 
@@ -108,8 +115,15 @@ BmpOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
         return false;
     }
 
-    m_fd = Filesystem::fopen(m_filename, "wb");
-    if (!m_fd) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", m_filename);
         return false;
     }
@@ -120,7 +134,7 @@ BmpOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
     create_and_write_file_header();
     create_and_write_bitmap_header();
 
-    m_image_start = Filesystem::ftell(m_fd);
+    m_image_start = m_io->tell();
 
     // If user asked for tiles -- which this format doesn't support, emulate
     // it by buffering the whole image.
@@ -145,7 +159,7 @@ BmpOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
     if (m_spec.width >= 0)
         y = (m_spec.height - y - 1);
     int64_t scanline_off = y * m_padded_scanline_size;
-    Filesystem::fseek(m_fd, m_image_start + scanline_off, SEEK_SET);
+    m_io->seek(m_image_start + scanline_off);
 
     m_scratch.clear();
     data = to_native_scanline(format, data, xstride, m_scratch, m_dither, y, z);
@@ -159,7 +173,7 @@ BmpOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
              i += m_spec.nchannels)
             std::swap(m_buf[i], m_buf[i + 2]);
 
-    size_t byte_count = fwrite(&m_buf[0], 1, m_buf.size(), m_fd);
+    size_t byte_count = m_io->write(&m_buf[0], m_buf.size());
     return byte_count == m_buf.size();  // true if wrote all bytes (no error)
 }
 
@@ -179,7 +193,7 @@ BmpOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
 bool
 BmpOutput::close(void)
 {
-    if (!m_fd) {  // already closed
+    if (!m_io) {  // already closed
         init();
         return true;
     }
@@ -193,8 +207,7 @@ BmpOutput::close(void)
         std::vector<unsigned char>().swap(m_tilebuffer);
     }
 
-    fclose(m_fd);
-    m_fd = NULL;
+    init();
     return ok;
 }
 
@@ -211,7 +224,7 @@ BmpOutput::create_and_write_file_header(void)
     m_bmp_header.res2  = 0;
     m_bmp_header.offset = BMP_HEADER_SIZE + WINDOWS_V3 + palettesize;
 
-    m_bmp_header.write_header(m_fd);
+    m_bmp_header.write_header(m_io);
 }
 
 
@@ -255,13 +268,13 @@ BmpOutput::create_and_write_bitmap_header(void)
         }
     }
 
-    m_dib_header.write_header(m_fd);
+    m_dib_header.write_header(m_io);
 
     // Write palette, if there is one. This is only used for grayscale
     // images, and the palette is just the 256 possible gray values.
     for (int i = 0; i < m_dib_header.cpalete; ++i) {
         unsigned char val[4] = { uint8_t(i), uint8_t(i), uint8_t(i), 255 };
-        fwrite(&val, 1, 4, m_fd);
+        m_io->write(&val, 4);
     }
 }
 
@@ -21,26 +21,41 @@ public:
     CineonInput() { init(); }
     virtual ~CineonInput() { close(); }
     virtual const char* format_name(void) const override { return "cineon"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
+    virtual bool open(const std::string& name, ImageSpec& newspec,
+                      const ImageSpec& config) override;
     virtual bool close() override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     InStream* m_stream = nullptr;
     cineon::Reader m_cin;
     std::vector<unsigned char> m_userBuf;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     /// Reset everything to initial state
     ///
     void init()
     {
         if (m_stream) {
-            m_stream->Close();
             delete m_stream;
             m_stream = nullptr;
+            m_cin.SetInStream(nullptr);
         }
         m_userBuf.clear();
+        m_io_local.reset();
+        m_io = nullptr;
     }
 
     /// Helper function - retrieve string for libcineon descriptor
@@ -77,15 +92,22 @@ bool
 CineonInput::open(const std::string& name, ImageSpec& newspec)
 {
     // open the image
-    m_stream = new InStream();
-    if (!m_stream->Open(name.c_str())) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorfmt("Could not open file \"{}\"", name);
+        close();
         return false;
     }
+    m_stream = new InStream(m_io);
 
     m_cin.SetInStream(m_stream);
     if (!m_cin.ReadHeader()) {
         error("Could not read header");
+        close();
         return false;
     }
 
@@ -356,6 +378,18 @@ CineonInput::open(const std::string& name, ImageSpec& newspec)
 
 
 
+bool
+CineonInput::open(const std::string& name, ImageSpec& newspec,
+                  const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, newspec);
+}
+
+
+
 bool
 CineonInput::close()
 {
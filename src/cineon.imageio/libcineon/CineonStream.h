@@ -41,6 +41,8 @@
 
 #include <cstdio>
 
+#include <OpenImageIO/filesystem.h>
+
 namespace cineon {
 
 /*!
@@ -67,24 +69,12 @@ class InStream
 	/*!
 	 * \brief Constructor
 	 */
-	InStream();
+	InStream(OIIO::Filesystem::IOProxy* io) : m_io(io) { }
 
 	/*!
 	 * \brief Destructor
 	 */
-	virtual ~InStream();
-
-	/*!
-	 * \brief Open file
-	 * \param fn File name
-	 * \return success true/false
-	 */
-	virtual bool Open(const char * fn);
-
-	/*!
-	 * \brief Close file
-	 */
-	virtual void Close();
+	virtual ~InStream() = default;
 
 	/*!
 	 * \brief Rewind file pointer to beginning of file
@@ -122,8 +112,17 @@ class InStream
 	 */
 	virtual bool Seek(long offset, Origin origin);
 
+	/*!
+	 * \brief Query if the stream is usable
+	 * \return True if the stream exists and is opened, or false otherwise
+	 */
+	virtual bool IsValid() const { return m_io && m_io->opened(); }
+
   protected:
-	FILE *fp;
+	/*!
+	 * This is a weak pointer, so opening and closing is done by the caller.
+	 */
+	OIIO::Filesystem::IOProxy* m_io;
 };
 
 
@@ -131,6 +130,9 @@ class InStream
 /*!
  * \class OutStream
  * \brief Output Stream for writing files
+ *
+ * Only libcineon's Writer uses this, and OIIO has no Cineon output, so
+ * it still writes through a FILE* rather than an IOProxy.
  */
 class OutStream
 {
@@ -41,41 +41,10 @@
 
 namespace cineon {
 
-InStream::InStream() : fp(0)
-{
-}
-
-
-InStream::~InStream()
-{
-}
-
-
-bool InStream::Open(const char *f)
-{
-	if (this->fp)
-		this->Close();
-	if ((this->fp = OIIO::Filesystem::fopen(f, "rb")) == 0)
-		return false;
-
-	return true;
-}
-
-
-void InStream::Close()
-{
-	if (this->fp)
-	{
-		::fclose(this->fp);
-		this->fp = 0;
-	}
-}
-
-
 void InStream::Rewind()
 {
-	if (this->fp)
-		::rewind(fp);
+	if (IsValid())
+		m_io->seek(0);
 }
 
 
@@ -95,18 +64,18 @@ bool InStream::Seek(long offset, Origin origin)
 		break;
 	}
 
-	if (this->fp == 0)
+	if (!IsValid())
 		return false;
-	return (::fseek(this->fp, offset, o) == 0);
+	return m_io->seek(offset, o);
 }
 
 
 
 size_t InStream::Read(void *buf, const size_t size)
 {
-	if (this->fp == 0)
+	if (!IsValid())
 		return 0;
-	return ::fread(buf, 1, size, this->fp);
+	return m_io->read(buf, size);
 }
 
 
@@ -118,9 +87,9 @@ size_t InStream::ReadDirect(void *buf, const size_t size)
 
 bool InStream::EndOfFile() const
 {
-	if (this->fp == 0)
+	if (!IsValid())
 		return true;
-	return ::feof(this->fp);
+	return size_t(m_io->tell()) >= m_io->size();
 }
 
 }
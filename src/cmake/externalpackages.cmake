@@ -213,6 +213,12 @@ endif ()
 
 checked_find_package (WebP)
 
+# Linux io_uring, for batched asynchronous reads (Filesystem::IOUringFile)
+if (CMAKE_SYSTEM_NAME STREQUAL "Linux")
+    checked_find_package (Liburing
+                          DEFINITIONS  -DUSE_LIBURING=1)
+endif ()
+
 option (USE_R3DSDK "Enable R3DSDK (RED camera) support" OFF)
 checked_find_package (R3DSDK)  # RED camera
 
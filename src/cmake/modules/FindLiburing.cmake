@@ -0,0 +1,40 @@
+# Module to find liburing (Linux io_uring helper library)
+#
+# This module will first look into the directories defined by the variables:
+#   - Liburing_ROOT, LIBURING_INCLUDE_PATH, LIBURING_LIBRARY_PATH
+#
+# This module defines the following variables:
+#
+# Liburing_FOUND            True if liburing was found.
+# LIBURING_INCLUDES         Where to find liburing headers
+# LIBURING_LIBRARIES        List of libraries to link against when using liburing
+
+include (FindPackageHandleStandardArgs)
+
+find_path (LIBURING_INCLUDE_DIR liburing.h
+           HINTS
+               ${LIBURING_INCLUDE_PATH}
+               ENV LIBURING_INCLUDE_PATH
+           DOC "The directory where liburing headers reside")
+
+find_library (LIBURING_LIBRARY uring
+              HINTS
+                  ${LIBURING_LIBRARY_PATH}
+                  ENV LIBURING_LIBRARY_PATH
+              DOC "The liburing libraries")
+
+find_package_handle_standard_args (Liburing
+    REQUIRED_VARS
+        LIBURING_INCLUDE_DIR
+        LIBURING_LIBRARY
+    )
+
+if (Liburing_FOUND)
+    set (LIBURING_INCLUDES ${LIBURING_INCLUDE_DIR})
+    set (LIBURING_LIBRARIES ${LIBURING_LIBRARY})
+endif ()
+
+mark_as_advanced (
+    LIBURING_INCLUDE_DIR
+    LIBURING_LIBRARY
+    )
@@ -170,8 +170,11 @@ macro (oiio_add_all_tests)
     oiio_add_tests (
                     cmake-consumer
                     nonwhole-tiles
+                    oiiotool-asyncout
                     oiiotool-composite
                     oiiotool-fixnan
+                    oiiotool-jpegscale
+                    oiiotool-parallel-subimages
                     oiiotool-pattern
                     oiiotool-readerror
                     oiiotool-subimage oiiotool-text
@@ -180,6 +183,7 @@ macro (oiio_add_all_tests)
                     jpeg-corrupt
                     missingcolor
                     null
+                    openexr-core
                     rational
                     texture-derivs texture-fill
                     texture-flipt texture-gettexels texture-gray
@@ -192,6 +196,7 @@ macro (oiio_add_all_tests)
                     texture-mip-trilinear
                     texture-missing
                     texture-pointsample
+                    texture-trace
                     texture-udim texture-udim2
                     texture-uint8
                     texture-width0blur
@@ -231,6 +236,8 @@ macro (oiio_add_all_tests)
                     ENABLEVAR ENABLE_BMP
                     IMAGEDIR bmpsuite
                     URL http://entropymine.com/jason/bmpsuite/bmpsuite.zip)
+    oiio_add_tests (dds-write
+                    ENABLEVAR ENABLE_DDS)
     oiio_add_tests (dpx
                     ENABLEVAR ENABLE_DPX
                     IMAGEDIR oiio-images URL "Recent checkout of oiio-images")
@@ -271,6 +278,8 @@ macro (oiio_add_all_tests)
     oiio_add_tests (png
                     ENABLEVAR ENABLE_PNG
                     IMAGEDIR oiio-images URL "Recent checkout of oiio-images")
+    oiio_add_tests (png-parallel
+                    ENABLEVAR ENABLE_PNG)
     oiio_add_tests (pnm
                     ENABLEVAR ENABLE_PNM
                     IMAGEDIR oiio-images URL "Recent checkout of oiio-images")
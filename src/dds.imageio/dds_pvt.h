@@ -4,6 +4,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+
 
 OIIO_PLUGIN_NAMESPACE_BEGIN
 
@@ -18,6 +21,10 @@ namespace DDS_pvt {
 #define DDS_4CC_DXT3 DDS_MAKE4CC('D', 'X', 'T', '3')
 #define DDS_4CC_DXT4 DDS_MAKE4CC('D', 'X', 'T', '4')
 #define DDS_4CC_DXT5 DDS_MAKE4CC('D', 'X', 'T', '5')
+#define DDS_4CC_ATI1 DDS_MAKE4CC('A', 'T', 'I', '1')
+#define DDS_4CC_ATI2 DDS_MAKE4CC('A', 'T', 'I', '2')
+#define DDS_4CC_BC4U DDS_MAKE4CC('B', 'C', '4', 'U')
+#define DDS_4CC_BC5U DDS_MAKE4CC('B', 'C', '5', 'U')
 
 /// DDS pixel format flags. Channel flags are only applicable for uncompressed
 /// images.
@@ -101,6 +108,92 @@ typedef struct {
 } dds_header;
 
 
+
+/// Is the four-character code one of the single channel BC4 variants?
+inline bool
+dds_is_bc4(uint32_t fourCC)
+{
+    return fourCC == DDS_4CC_ATI1 || fourCC == DDS_4CC_BC4U;
+}
+
+/// Is the four-character code one of the two channel BC5 variants?
+inline bool
+dds_is_bc5(uint32_t fourCC)
+{
+    return fourCC == DDS_4CC_ATI2 || fourCC == DDS_4CC_BC5U;
+}
+
+/// Number of bytes in one compressed 4x4 block.
+inline int
+dds_block_bytes(uint32_t fourCC)
+{
+    return (fourCC == DDS_4CC_DXT1 || dds_is_bc4(fourCC)) ? 8 : 16;
+}
+
+/// Number of bytes in a compressed w x h image.
+inline size_t
+dds_compressed_size(uint32_t fourCC, int w, int h)
+{
+    return size_t((w + 3) / 4) * size_t((h + 3) / 4) * dds_block_bytes(fourCC);
+}
+
+
+
+/// Decode one BC4 block (which has the same layout as the alpha half of a
+/// DXT5 block): two 8-bit endpoints followed by sixteen 3-bit indices.
+/// The 16 values are written to dst[0], dst[stride], dst[2*stride], ...
+inline void
+bc4_decode_block(const uint8_t* block, uint8_t* dst, int stride)
+{
+    int e0 = block[0], e1 = block[1];
+    uint8_t palette[8];
+    palette[0] = uint8_t(e0);
+    palette[1] = uint8_t(e1);
+    if (e0 > e1) {
+        for (int i = 1; i < 7; ++i)
+            palette[i + 1] = uint8_t(((7 - i) * e0 + i * e1) / 7);
+    } else {
+        for (int i = 1; i < 5; ++i)
+            palette[i + 1] = uint8_t(((5 - i) * e0 + i * e1) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t bits = 0;
+    for (int i = 0; i < 6; ++i)
+        bits |= uint64_t(block[2 + i]) << (8 * i);
+    for (int i = 0; i < 16; ++i, bits >>= 3)
+        dst[i * stride] = palette[bits & 7];
+}
+
+/// Encode 16 values, taken from src[0], src[stride], src[2*stride], ...,
+/// as a BC4 block, always using the 8-value interpolation mode spanning
+/// the range of the values.
+inline void
+bc4_encode_block(const uint8_t* src, int stride, uint8_t* block)
+{
+    int lo = 255, hi = 0;
+    for (int i = 0; i < 16; ++i) {
+        lo = std::min(lo, int(src[i * stride]));
+        hi = std::max(hi, int(src[i * stride]));
+    }
+    block[0]      = uint8_t(hi);
+    block[1]      = uint8_t(lo);
+    uint64_t bits = 0;
+    if (hi > lo) {
+        int range = hi - lo;
+        for (int i = 0; i < 16; ++i) {
+            // Nearest of the 8 evenly spaced steps from lo (0) to hi (7),
+            // then map the step to its palette index.
+            int step = ((src[i * stride] - lo) * 14 + range) / (2 * range);
+            int idx  = step == 7 ? 0 : step == 0 ? 1 : 8 - step;
+            bits |= uint64_t(idx) << (3 * i);
+        }
+    }
+    for (int i = 0; i < 6; ++i)
+        block[2 + i] = uint8_t(bits >> (8 * i));
+}
+
+
 }  // namespace DDS_pvt
 
 
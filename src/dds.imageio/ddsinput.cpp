@@ -5,11 +5,13 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include <OpenImageIO/dassert.h>
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/fmath.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/parallel.h>
 #include <OpenImageIO/typedesc.h>
 
 #include "dds_pvt.h"
@@ -244,8 +246,8 @@ DDSInput::open(const std::string& name, ImageSpec& newspec)
     // TODO: support DXGI and the "wackier" uncompressed formats
     if (m_dds.fmt.flags & DDS_PF_FOURCC && m_dds.fmt.fourCC != DDS_4CC_DXT1
         && m_dds.fmt.fourCC != DDS_4CC_DXT2 && m_dds.fmt.fourCC != DDS_4CC_DXT3
-        && m_dds.fmt.fourCC != DDS_4CC_DXT4
-        && m_dds.fmt.fourCC != DDS_4CC_DXT5) {
+        && m_dds.fmt.fourCC != DDS_4CC_DXT4 && m_dds.fmt.fourCC != DDS_4CC_DXT5
+        && !dds_is_bc4(m_dds.fmt.fourCC) && !dds_is_bc5(m_dds.fmt.fourCC)) {
         errorf("Unsupported compression type");
         return false;
     }
@@ -256,7 +258,12 @@ DDSInput::open(const std::string& name, ImageSpec& newspec)
         /*if (m_dds.fmt.fourCC == DDS_4CC_DXT1)
             m_nchans = 3; // no alpha in DXT1
         else*/
-        m_nchans = 4;
+        if (dds_is_bc4(m_dds.fmt.fourCC))
+            m_nchans = 1;
+        else if (dds_is_bc5(m_dds.fmt.fourCC))
+            m_nchans = 2;
+        else
+            m_nchans = 4;
     } else {
         m_nchans = ((m_dds.fmt.flags & DDS_PF_LUMINANCE) ? 1 : 3)
                    + ((m_dds.fmt.flags & DDS_PF_ALPHA) ? 1 : 0);
@@ -348,13 +355,7 @@ DDSInput::internal_seek_subimage(int cubeface, int miplevel, unsigned int& w,
         if (m_dds.mipmaps < 2) {
             if (j > 0) {
                 if (m_dds.fmt.flags & DDS_PF_FOURCC)
-                    // only check for DXT1 - all other formats have same block
-                    // size
-                    len = squish::GetStorageRequirements(w, h,
-                                                         m_dds.fmt.fourCC
-                                                                 == DDS_4CC_DXT1
-                                                             ? squish::kDxt1
-                                                             : squish::kDxt5);
+                    len = dds_compressed_size(m_dds.fmt.fourCC, w, h);
                 else
                     len = w * h * d * m_Bpp;
                 ofs += len;
@@ -363,12 +364,7 @@ DDSInput::internal_seek_subimage(int cubeface, int miplevel, unsigned int& w,
         }
         for (int i = 0; i < miplevel; i++) {
             if (m_dds.fmt.flags & DDS_PF_FOURCC)
-                // only check for DXT1 - all other formats have same block size
-                len = squish::GetStorageRequirements(w, h,
-                                                     m_dds.fmt.fourCC
-                                                             == DDS_4CC_DXT1
-                                                         ? squish::kDxt1
-                                                         : squish::kDxt5);
+                len = dds_compressed_size(m_dds.fmt.fourCC, w, h);
             else
                 len = w * h * d * m_Bpp;
             ofs += len;
@@ -523,29 +519,49 @@ DDSInput::internal_readimg(unsigned char* dst, int w, int h, int d)
         }
         // create source buffer
         std::vector<squish::u8> tmp(
-            squish::GetStorageRequirements(w, h, flags));
+            dds_compressed_size(m_dds.fmt.fourCC, w, h));
         // load image into buffer
         if (!fread(&tmp[0], tmp.size(), 1))
             return false;
-        // decompress image
-        squish::DecompressImage(dst, w, h, &tmp[0], flags);
-        tmp.clear();
-        // correct pre-multiplied alpha, if necessary
-        if (m_dds.fmt.fourCC == DDS_4CC_DXT2
-            || m_dds.fmt.fourCC == DDS_4CC_DXT4) {
-            int k;
-            for (int y = 0; y < h; y++) {
-                for (int x = 0; x < w; x++) {
-                    k          = (y * w + x) * 4;
-                    dst[k + 0] = (unsigned char)((int)dst[k + 0] * 255
-                                                 / (int)dst[k + 3]);
-                    dst[k + 1] = (unsigned char)((int)dst[k + 1] * 255
-                                                 / (int)dst[k + 3]);
-                    dst[k + 2] = (unsigned char)((int)dst[k + 2] * 255
-                                                 / (int)dst[k + 3]);
+        // Decompress in parallel, a row of blocks (four scanlines) at a
+        // time. Each row of blocks decodes into its own scanlines.
+        const int blockbytes = dds_block_bytes(m_dds.fmt.fourCC);
+        const int bw = (w + 3) / 4, bh = (h + 3) / 4;
+        const bool premult = (m_dds.fmt.fourCC == DDS_4CC_DXT2
+                              || m_dds.fmt.fourCC == DDS_4CC_DXT4);
+        parallel_for(0, bh, [&](int64_t by) {
+            const squish::u8* src = &tmp[by * bw * blockbytes];
+            unsigned char* row    = dst + by * 4 * w * m_nchans;
+            int rows              = std::min(4, h - int(by) * 4);
+            if (m_nchans <= 2) {
+                // BC4 / BC5: one or two independent single channel blocks
+                for (int bx = 0; bx < bw; ++bx, src += blockbytes) {
+                    unsigned char pixels[16 * 2];
+                    for (int c = 0; c < m_nchans; ++c)
+                        bc4_decode_block(src + 8 * c, pixels + c, m_nchans);
+                    int cols = std::min(4, w - bx * 4);
+                    for (int y = 0; y < rows; ++y)
+                        memcpy(row + (y * w + bx * 4) * m_nchans,
+                               pixels + y * 4 * m_nchans, cols * m_nchans);
                 }
+            } else {
+                squish::DecompressImage(row, w, rows, src, flags);
             }
-        }
+            // correct pre-multiplied alpha, if necessary
+            if (premult) {
+                for (int k = 0, e = rows * w * 4; k < e; k += 4) {
+                    int a = row[k + 3];
+                    if (!a)
+                        continue;
+                    row[k + 0] = (unsigned char)std::min(255,
+                                                         row[k + 0] * 255 / a);
+                    row[k + 1] = (unsigned char)std::min(255,
+                                                         row[k + 1] * 255 / a);
+                    row[k + 2] = (unsigned char)std::min(255,
+                                                         row[k + 2] * 255 / a);
+                }
+            }
+        });
     } else {
         // uncompressed image
 
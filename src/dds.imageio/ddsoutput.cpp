@@ -0,0 +1,407 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+#include <cstring>
+#include <memory>
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/fmath.h>
+#include <OpenImageIO/imageio.h>
+#include <OpenImageIO/parallel.h>
+#include <OpenImageIO/strutil.h>
+
+#include "dds_pvt.h"
+#include "squish.h"
+
+OIIO_PLUGIN_NAMESPACE_BEGIN
+
+using namespace DDS_pvt;
+
+
+class DDSOutput final : public ImageOutput {
+public:
+    DDSOutput() { init(); }
+    virtual ~DDSOutput() { close(); }
+    virtual const char* format_name(void) const override { return "dds"; }
+    virtual int supports(string_view feature) const override
+    {
+        return (feature == "tiles" || feature == "mipmap" || feature == "alpha"
+                || feature == "ioproxy");
+    }
+    virtual bool open(const std::string& name, const ImageSpec& spec,
+                      OpenMode mode = Create) override;
+    virtual bool close() override;
+    virtual bool write_scanline(int y, int z, TypeDesc format, const void* data,
+                                stride_t xstride) override;
+    virtual bool write_tile(int x, int y, int z, TypeDesc format,
+                            const void* data, stride_t xstride,
+                            stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
+
+private:
+    std::string m_filename;            ///< Stash the filename
+    std::vector<unsigned char> m_buf;  ///< Pixels of the current MIP level
+    std::vector<unsigned char> m_scratch;
+    uint32_t m_fourCC;    ///< Compression, or 0 for uncompressed
+    int m_squishflags;    ///< Compression and quality flags for squish
+    int m_miplevels;      ///< Number of MIP levels written so far
+    int m_width;          ///< Size of the highest resolution level
+    int m_height;
+    int m_nchannels;
+    unsigned int m_dither;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
+
+    void init()
+    {
+        m_filename.clear();
+        m_buf.clear();
+        m_fourCC      = 0;
+        m_squishflags = 0;
+        m_miplevels   = 0;
+        m_io_local.reset();
+        m_io = nullptr;
+    }
+
+    /// Compress (if needed) and write the buffered MIP level.
+    bool write_level();
+
+    /// Write the file header, which can only be done once we know how many
+    /// MIP levels there are.
+    bool write_header();
+
+    bool write(const void* buf, size_t size)
+    {
+        if (m_io->write(buf, size) != size) {
+            errorf("Write error");
+            return false;
+        }
+        return true;
+    }
+};
+
+
+
+// Obligatory material to make this a recognizeable imageio plugin:
+OIIO_PLUGIN_EXPORTS_BEGIN
+
+OIIO_EXPORT ImageOutput*
+dds_output_imageio_create()
+{
+    return new DDSOutput;
+}
+
+// OIIO_EXPORT int dds_imageio_version = OIIO_PLUGIN_VERSION;   // it's in ddsinput.cpp
+
+OIIO_EXPORT const char* dds_output_extensions[] = { "dds", nullptr };
+
+OIIO_PLUGIN_EXPORTS_END
+
+
+
+bool
+DDSOutput::open(const std::string& name, const ImageSpec& userspec,
+                OpenMode mode)
+{
+    if (mode == AppendSubimage) {
+        errorf("%s does not support subimages", format_name());
+        return false;
+    }
+
+    if (mode == AppendMIPLevel) {
+        if (m_filename.empty()) {
+            errorf("Cannot append a MIP level to a file that is not open");
+            return false;
+        }
+        // Each level must be half the size of the previous one, all the
+        // way down to 1x1.
+        int w = std::max(1, m_spec.width / 2);
+        int h = std::max(1, m_spec.height / 2);
+        if (userspec.width != w || userspec.height != h
+            || userspec.nchannels != m_nchannels) {
+            errorf("DDS MIP level %d must be %dx%d with %d channels",
+                   m_miplevels, w, h, m_nchannels);
+            return false;
+        }
+        if (!write_level())
+            return false;
+        m_spec.width       = w;
+        m_spec.height      = h;
+        m_spec.tile_width  = userspec.tile_width;
+        m_spec.tile_height = userspec.tile_height;
+        m_spec.set_roi_full(m_spec.roi());
+        m_buf.assign(m_spec.image_bytes(), 0);
+        return true;
+    }
+
+    // Keep any proxy handed to us by set_ioproxy() before this open
+    Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+    close();
+    m_io = ioproxy;
+
+    m_spec = userspec;
+    if (m_spec.nchannels < 1 || m_spec.nchannels > 4) {
+        errorf("%s does not support %d-channel images", format_name(),
+               m_spec.nchannels);
+        return false;
+    }
+    if (m_spec.depth > 1) {
+        errorf("%s does not support volume images", format_name());
+        return false;
+    }
+    m_spec.set_format(TypeDesc::UINT8);
+    m_spec.set_roi_full(m_spec.roi());
+    m_width     = m_spec.width;
+    m_height    = m_spec.height;
+    m_nchannels = m_spec.nchannels;
+    m_dither    = m_spec.get_int_attribute("oiio:dither", 0);
+
+    // Compression: DXT1/3/5 (a.k.a. BC1/2/3) for color, BC4 for a single
+    // channel, BC5 for two channels.
+    std::string comp = m_spec.get_string_attribute("compression", "none");
+    if (Strutil::iequals(comp, "DXT1") || Strutil::iequals(comp, "BC1"))
+        m_fourCC = DDS_4CC_DXT1;
+    else if (Strutil::iequals(comp, "DXT3") || Strutil::iequals(comp, "BC2"))
+        m_fourCC = DDS_4CC_DXT3;
+    else if (Strutil::iequals(comp, "DXT5") || Strutil::iequals(comp, "BC3"))
+        m_fourCC = DDS_4CC_DXT5;
+    else if (Strutil::iequals(comp, "ATI1") || Strutil::iequals(comp, "BC4"))
+        m_fourCC = DDS_4CC_ATI1;
+    else if (Strutil::iequals(comp, "ATI2") || Strutil::iequals(comp, "BC5"))
+        m_fourCC = DDS_4CC_ATI2;
+    else
+        m_fourCC = 0;
+
+    // Each block format holds a fixed set of channels. Refuse rather than
+    // quietly drop (or invent) the ones that don't fit.
+    if (m_fourCC) {
+        int want_lo = 3, want_hi = 4;
+        if (dds_is_bc4(m_fourCC))
+            want_lo = want_hi = 1;
+        else if (dds_is_bc5(m_fourCC))
+            want_lo = want_hi = 2;
+        if (m_nchannels < want_lo || m_nchannels > want_hi) {
+            errorf("%s compression requires %s channels, not %d", comp,
+                   want_lo == want_hi ? Strutil::sprintf("%d", want_lo)
+                                      : std::string("3 or 4"),
+                   m_nchannels);
+            return false;
+        }
+    }
+
+    if (m_fourCC == DDS_4CC_DXT1)
+        m_squishflags = squish::kDxt1;
+    else if (m_fourCC == DDS_4CC_DXT3)
+        m_squishflags = squish::kDxt3;
+    else if (m_fourCC == DDS_4CC_DXT5)
+        m_squishflags = squish::kDxt5;
+
+    // Speed/quality trade-off of the DXT color compressor
+    std::string quality = m_spec.get_string_attribute("dds:quality", "normal");
+    if (Strutil::iequals(quality, "fast"))
+        m_squishflags |= squish::kColourRangeFit;
+    else if (Strutil::iequals(quality, "best"))
+        m_squishflags |= squish::kColourIterativeClusterFit;
+    else
+        m_squishflags |= squish::kColourClusterFit;
+
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
+        errorf("Could not open \"%s\"", name);
+        return false;
+    }
+    m_filename = name;
+
+    // Leave room for the header, which is written last
+    unsigned char zeros[128] = { 0 };
+    if (!write(zeros, sizeof(zeros)))
+        return false;
+
+    m_buf.assign(m_spec.image_bytes(), 0);
+    return true;
+}
+
+
+
+bool
+DDSOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
+                          stride_t xstride)
+{
+    y -= m_spec.y;
+    if (y < 0 || y >= m_spec.height) {
+        errorf("Attempt to write scanline %d out of range", y + m_spec.y);
+        return false;
+    }
+    m_spec.auto_stride(xstride, format, m_spec.nchannels);
+    data = to_native_scanline(format, data, xstride, m_scratch, m_dither, y, z);
+    memcpy(&m_buf[y * m_spec.scanline_bytes()], data, m_spec.scanline_bytes());
+    return true;
+}
+
+
+
+bool
+DDSOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
+                      stride_t xstride, stride_t ystride, stride_t zstride)
+{
+    // Emulate tiles by buffering the whole level
+    return copy_tile_to_image_buffer(x, y, z, format, data, xstride, ystride,
+                                     zstride, &m_buf[0]);
+}
+
+
+
+bool
+DDSOutput::write_level()
+{
+    const int w = m_spec.width, h = m_spec.height, nc = m_nchannels;
+    const unsigned char* pixels = m_buf.data();
+    std::vector<unsigned char> out;
+
+    if (m_fourCC) {
+        // Compress in parallel, a row of blocks (four scanlines) at a time.
+        // Blocks that hang off the edge of the image repeat the edge pixels.
+        const int blockbytes = dds_block_bytes(m_fourCC);
+        const int bw = (w + 3) / 4, bh = (h + 3) / 4;
+        out.resize(dds_compressed_size(m_fourCC, w, h));
+        parallel_for(0, bh, [&](int64_t by) {
+            unsigned char* block = &out[by * bw * blockbytes];
+            for (int bx = 0; bx < bw; ++bx, block += blockbytes) {
+                squish::u8 rgba[16 * 4];
+                int mask = 0;
+                for (int i = 0; i < 16; ++i) {
+                    int x = bx * 4 + (i & 3), y = int(by) * 4 + (i >> 2);
+                    if (x < w && y < h)
+                        mask |= 1 << i;
+                    const unsigned char* p
+                        = pixels + (std::min(y, h - 1) * w + std::min(x, w - 1))
+                                       * nc;
+                    squish::u8* q = rgba + 4 * i;
+                    if (nc >= 3) {
+                        q[0] = p[0];
+                        q[1] = p[1];
+                        q[2] = p[2];
+                        q[3] = nc == 4 ? p[3] : 255;
+                    } else {
+                        // BC4 takes its channel from R, BC5 its second
+                        // channel from G.
+                        q[0] = q[2] = p[0];
+                        q[1]        = nc == 2 ? p[1] : p[0];
+                        q[3]        = 255;
+                    }
+                }
+                if (dds_is_bc4(m_fourCC)) {
+                    bc4_encode_block(rgba, 4, block);
+                } else if (dds_is_bc5(m_fourCC)) {
+                    bc4_encode_block(rgba, 4, block);
+                    bc4_encode_block(rgba + 1, 4, block + 8);
+                } else {
+                    squish::CompressMasked(rgba, mask, block, m_squishflags);
+                }
+            }
+        });
+    } else {
+        // Uncompressed: luminance (+alpha) is stored as is, color as BGR(A).
+        out.assign(pixels, pixels + m_buf.size());
+        if (nc >= 3)
+            for (size_t i = 0, e = out.size(); i < e; i += nc)
+                std::swap(out[i], out[i + 2]);
+    }
+
+    if (!write(out.data(), out.size()))
+        return false;
+    ++m_miplevels;
+    return true;
+}
+
+
+
+bool
+DDSOutput::write_header()
+{
+    dds_header dds;
+    memset(&dds, 0, sizeof(dds));
+    dds.fourCC   = DDS_MAKE4CC('D', 'D', 'S', ' ');
+    dds.size     = 124;
+    dds.flags    = DDS_CAPS | DDS_HEIGHT | DDS_WIDTH | DDS_PIXELFORMAT;
+    dds.height   = m_height;
+    dds.width    = m_width;
+    dds.mipmaps  = m_miplevels;
+    dds.fmt.size = 32;
+    dds.caps.flags1 = DDS_CAPS1_TEXTURE;
+    if (m_miplevels > 1) {
+        dds.flags |= DDS_MIPMAPCOUNT;
+        dds.caps.flags1 |= DDS_CAPS1_COMPLEX | DDS_CAPS1_MIPMAP;
+    }
+    if (m_fourCC) {
+        dds.flags |= DDS_LINEARSIZE;
+        dds.pitch      = uint32_t(dds_compressed_size(m_fourCC, m_width,
+                                                      m_height));
+        dds.fmt.flags  = DDS_PF_FOURCC;
+        dds.fmt.fourCC = m_fourCC;
+    } else {
+        dds.flags |= DDS_PITCH;
+        dds.pitch   = m_width * m_nchannels;
+        dds.fmt.bpp = 8 * m_nchannels;
+        if (m_nchannels <= 2) {
+            dds.fmt.flags = DDS_PF_LUMINANCE;
+            dds.fmt.rmask = 0x000000ff;
+        } else {
+            dds.fmt.flags = DDS_PF_RGB;
+            dds.fmt.rmask = 0x00ff0000;
+            dds.fmt.gmask = 0x0000ff00;
+            dds.fmt.bmask = 0x000000ff;
+        }
+        if (m_nchannels == 2 || m_nchannels == 4) {
+            dds.fmt.flags |= DDS_PF_ALPHA;
+            dds.fmt.amask = m_nchannels == 2 ? 0x0000ff00 : 0xff000000;
+        }
+    }
+
+    // Write it out member by member, in little endian order, filling in
+    // the reserved fields (see DDSInput::open).
+    uint32_t words[32] = { 0 };
+    uint32_t* w        = words;
+    for (uint32_t v : { dds.fourCC, dds.size, dds.flags, dds.height, dds.width,
+                        dds.pitch, dds.depth, dds.mipmaps })
+        *w++ = v;
+    w += 11;
+    for (uint32_t v : { dds.fmt.size, dds.fmt.flags, dds.fmt.fourCC,
+                        dds.fmt.bpp, dds.fmt.rmask, dds.fmt.gmask,
+                        dds.fmt.bmask, dds.fmt.amask, dds.caps.flags1,
+                        dds.caps.flags2 })
+        *w++ = v;
+    if (bigendian())
+        swap_endian(words, 32);
+    return m_io->seek(0) && write(words, sizeof(words));
+}
+
+
+
+bool
+DDSOutput::close()
+{
+    if (!m_io || m_filename.empty()) {  // already closed
+        init();
+        return true;
+    }
+
+    bool ok = write_level();
+    ok &= write_header();
+    init();
+    return ok;
+}
+
+OIIO_PLUGIN_NAMESPACE_END
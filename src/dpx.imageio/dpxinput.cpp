@@ -27,7 +27,7 @@ public:
     virtual const char* format_name(void) const override { return "dpx"; }
     virtual int supports(string_view feature) const override
     {
-        return (feature == "ioproxy");
+        return (feature == "ioproxy" || feature == "mmap");
     }
     virtual bool valid_file(const std::string& filename) const override;
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
@@ -52,6 +52,7 @@ private:
     dpx::Reader m_dpx;
     std::vector<unsigned char> m_userBuf;
     bool m_rawcolor;
+    bool m_mmap = false;  // Memory-map the file if we open it ourselves
     std::vector<unsigned char> m_decodebuf;  // temporary decode buffer
     std::unique_ptr<Filesystem::IOProxy> m_io_local;
     Filesystem::IOProxy* m_io = nullptr;
@@ -69,9 +70,16 @@ private:
         }
         m_userBuf.clear();
         m_rawcolor = false;
+        m_mmap     = false;
         m_io       = nullptr;
     }
 
+    /// If the pixels of the block are stored in the file exactly as we
+    /// return them, and the proxy is memory-backed, return a pointer to
+    /// them in place, otherwise nullptr.
+    const unsigned char* mapped_block(int element, const dpx::Block& block,
+                                      size_t& bytes) const;
+
     /// Helper function - retrieve string for libdpx characteristic
     ///
     std::string get_characteristic_string(dpx::Characteristic c);
@@ -139,7 +147,11 @@ DPXInput::open(const std::string& name, ImageSpec& newspec)
 {
     if (!m_io) {
         // If no proxy was supplied, create a file reader
-        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        if (m_mmap)
+            m_io = new Filesystem::IOMMap(name);
+        else
+            m_io = new Filesystem::IOFile(name,
+                                          Filesystem::IOProxy::Mode::Read);
         m_io_local.reset(m_io);
     }
     if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
@@ -179,6 +191,7 @@ DPXInput::open(const std::string& name, ImageSpec& newspec,
     m_rawcolor = config.get_int_attribute("dpx:RawColor")
                  || config.get_int_attribute("dpx:RawData")  // deprecated
                  || config.get_int_attribute("oiio:RawColor");
+    m_mmap       = config.get_int_attribute("oiio:mmap");
     auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
     if (ioparam)
         m_io = ioparam->get<Filesystem::IOProxy*>();
@@ -614,6 +627,19 @@ DPXInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
     dpx::Block block(0, ybegin - m_spec.y, m_dpx.header.Width() - 1,
                      yend - 1 - m_spec.y);
 
+    size_t bytes;
+    if (const unsigned char* src = mapped_block(subimage, block, bytes)) {
+        // The pixels are right there in memory: convert straight from
+        // them when the conversion needs a separate buffer anyway,
+        // otherwise just copy them (no read calls or stdio buffering).
+        if (!m_rawcolor
+            && dpx::QueryRGBBufferSize(m_dpx.header, subimage, block) > 0)
+            return dpx::ConvertToRGB(m_dpx.header, subimage, src, data, block);
+        memcpy(data, src, bytes);
+        return m_rawcolor
+               || dpx::ConvertToRGB(m_dpx.header, subimage, data, data, block);
+    }
+
     if (m_rawcolor) {
         // fast path - just read the scanline in
         if (!m_dpx.ReadBlock(subimage, (unsigned char*)data, block))
@@ -638,6 +664,32 @@ DPXInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 
 
 
+const unsigned char*
+DPXInput::mapped_block(int element, const dpx::Block& block,
+                       size_t& bytes) const
+{
+    // Same conditions as the single-read fast path of dpx::ReadBlock, but
+    // the data must also already be in our byte order.
+    const dpx::Header& header(m_dpx.header);
+    int bits           = header.BitDepth(element);
+    dpx::DataSize size = header.ComponentDataSize(element);
+    if (header.ImageEncoding(element) == dpx::kRLE
+        || header.EndOfLinePadding(element) != 0 || header.RequiresByteSwap()
+        || !((bits == 8 && size == dpx::kByte)
+             || (bits == 16 && size == dpx::kWord)
+             || (bits == 32 && size == dpx::kFloat)
+             || (bits == 64 && size == dpx::kDouble))
+        || block.x1 != 0 || block.x2 != int(header.Width() - 1))
+        return nullptr;
+    size_t rowbytes = size_t(header.Width())
+                      * header.ImageElementComponentCount(element) * bits / 8;
+    bytes = rowbytes * (block.y2 - block.y1 + 1);
+    return (const unsigned char*)m_io->mapped(
+        header.DataOffset(element) + block.y1 * rowbytes, bytes);
+}
+
+
+
 std::string
 DPXInput::get_characteristic_string(dpx::Characteristic c)
 {
@@ -39,6 +39,7 @@
 
 #include <cstdio>
 #include <limits>
+#include <vector>
 
 #include "DPXHeader.h"
 #include "DPXStream.h"
@@ -252,6 +253,7 @@ namespace dpx
 		
 		Codec *codex[MAX_ELEMENTS];
 		ElementReadStream *rio;
+		std::vector<unsigned char> filledBuf;		// packed 10-bit lines for ReadBlock
 	};
 	
 	
@@ -420,6 +422,7 @@ namespace dpx
 		OutStream *fd;
 		
 		bool WriteThrough(void *, const U32, const U32, const int, const int, const U32, const U32, char *);
+		bool WriteFilled10bit(const U16 *, const U32, const U32, const int, const Packing, const bool, const U32);
 		
 	};
 	
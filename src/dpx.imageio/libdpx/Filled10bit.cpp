@@ -0,0 +1,133 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+#include <algorithm>
+#include <cstring>
+
+#include <OpenImageIO/fmath.h>
+#include <OpenImageIO/parallel.h>
+
+#include "Filled10bit.h"
+
+
+
+namespace dpx
+{
+
+	// Work on whole 32-bit words, three datums at a time, with no per-datum
+	// divisions or branches so that the compiler can vectorize the loops.
+	// Words are loaded and stored with memcpy because mapped or user buffers
+	// need not be aligned.
+
+	template <bool REVERSE, bool SWAP>
+	static void Unfill10bitRow(const unsigned char *src, U16 *dst, const int datums, const int pad)
+	{
+		const int s0 = REVERSE ? 20 + pad : pad;
+		const int s2 = REVERSE ? pad : 20 + pad;
+		const int words = datums / 3;
+		for (int w = 0; w < words; w++)
+		{
+			U32 word;
+			memcpy(&word, src + w * sizeof(U32), sizeof(U32));
+			if (SWAP)
+				OIIO::swap_endian(&word);
+			const U32 d0 = (word >> s0) & 0x3ff;
+			const U32 d1 = (word >> (10 + pad)) & 0x3ff;
+			const U32 d2 = (word >> s2) & 0x3ff;
+			dst[3 * w]     = U16((d0 << 6) | (d0 >> 4));
+			dst[3 * w + 1] = U16((d1 << 6) | (d1 >> 4));
+			dst[3 * w + 2] = U16((d2 << 6) | (d2 >> 4));
+		}
+
+		// partial last word
+		const int rem = datums - 3 * words;
+		if (rem)
+		{
+			U32 word;
+			memcpy(&word, src + words * sizeof(U32), sizeof(U32));
+			if (SWAP)
+				OIIO::swap_endian(&word);
+			for (int i = 0; i < rem; i++)
+			{
+				const U32 d = (word >> ((REVERSE ? 2 - i : i) * 10 + pad)) & 0x3ff;
+				dst[3 * words + i] = U16((d << 6) | (d >> 4));
+			}
+		}
+	}
+
+
+	template <bool REVERSE, bool SWAP>
+	static void Fill10bitRow(const U16 *src, unsigned char *dst, const int datums, const int pad)
+	{
+		const int s0 = REVERSE ? 20 + pad : pad;
+		const int s2 = REVERSE ? pad : 20 + pad;
+		const int words = datums / 3;
+		for (int w = 0; w < words; w++)
+		{
+			U32 word = (U32(src[3 * w] >> 6) << s0)
+					 | (U32(src[3 * w + 1] >> 6) << (10 + pad))
+					 | (U32(src[3 * w + 2] >> 6) << s2);
+			if (SWAP)
+				OIIO::swap_endian(&word);
+			memcpy(dst + w * sizeof(U32), &word, sizeof(U32));
+		}
+
+		const int rem = datums - 3 * words;
+		if (rem)
+		{
+			U32 word = 0;
+			for (int i = 0; i < rem; i++)
+				word |= U32(src[3 * words + i] >> 6) << ((REVERSE ? 2 - i : i) * 10 + pad);
+			if (SWAP)
+				OIIO::swap_endian(&word);
+			memcpy(dst + words * sizeof(U32), &word, sizeof(U32));
+		}
+	}
+
+
+	// Rows are independent, so hand out ranges of them to the thread pool,
+	// but at least 64k datums' worth at a time so that reading a scanline or
+	// two doesn't pay for a trip through the queue.
+	static OIIO::parallel_options RowOptions(const int datums)
+	{
+		OIIO::parallel_options opt;
+		opt.minitems = size_t(std::max(1, 65536 / std::max(datums, 1)));
+		return opt;
+	}
+
+}
+
+
+
+void dpx::Unfill10bitRows(const void *src, const size_t srcStride, U16 *dst, const int datums,
+						  const int height, const Packing packing, const bool reverse, const bool swapEndian)
+{
+	typedef void (*RowFunc)(const unsigned char *, U16 *, int, int);
+	static const RowFunc funcs[4] = { Unfill10bitRow<false, false>, Unfill10bitRow<false, true>,
+									  Unfill10bitRow<true, false>, Unfill10bitRow<true, true> };
+	const RowFunc func = funcs[(reverse ? 2 : 0) + (swapEndian ? 1 : 0)];
+	const int pad = (packing == kFilledMethodA ? 2 : 0);
+
+	OIIO::parallel_for_chunked(0, height, 0, [&](int64_t ybegin, int64_t yend) {
+		for (int64_t y = ybegin; y < yend; y++)
+			func(reinterpret_cast<const unsigned char *>(src) + y * srcStride, dst + y * datums, datums, pad);
+	}, RowOptions(datums));
+}
+
+
+
+void dpx::Fill10bitRows(const U16 *src, void *dst, const size_t dstStride, const int datums,
+						const int height, const Packing packing, const bool reverse, const bool swapEndian)
+{
+	typedef void (*RowFunc)(const U16 *, unsigned char *, int, int);
+	static const RowFunc funcs[4] = { Fill10bitRow<false, false>, Fill10bitRow<false, true>,
+									  Fill10bitRow<true, false>, Fill10bitRow<true, true> };
+	const RowFunc func = funcs[(reverse ? 2 : 0) + (swapEndian ? 1 : 0)];
+	const int pad = (packing == kFilledMethodA ? 2 : 0);
+
+	OIIO::parallel_for_chunked(0, height, 0, [&](int64_t ybegin, int64_t yend) {
+		for (int64_t y = ybegin; y < yend; y++)
+			func(src + y * datums, reinterpret_cast<unsigned char *>(dst) + y * dstStride, datums, pad);
+	}, RowOptions(datums));
+}
@@ -0,0 +1,71 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+// Whole-image conversion between 16-bit components and 10-bit data
+// "filled" into 32-bit words (three components per word, method A or B).
+// These are used by dpx::Reader::ReadBlock and dpx::Writer::WriteElement
+// for the common uncompressed case instead of the per-component code in
+// ReaderInternal.h / WriterInternal.h, and split the rows across the
+// OIIO thread pool.
+
+
+#ifndef _DPX_FILLED10BIT_H
+#define _DPX_FILLED10BIT_H 1
+
+
+#include "DPX.h"
+
+
+namespace dpx
+{
+
+	/*!
+	 * \brief Number of bytes in one line of 10-bit filled data
+	 * \param datums number of components in the line
+	 */
+	inline size_t Filled10bitLineBytes(const size_t datums)
+	{
+		return (datums + 2) / 3 * sizeof(U32);
+	}
+
+	/*!
+	 * \brief Unpack rows of 10-bit filled data into 16-bit components
+	 *
+	 * 10-bit values are expanded to the full 16-bit range the same way as
+	 * BaseTypeConvertU10ToU16().
+	 *
+	 * \param src first source line
+	 * \param srcStride distance in bytes between the starts of source lines
+	 * \param dst destination, datums*height contiguous components
+	 * \param datums number of components in one line
+	 * \param height number of lines
+	 * \param packing kFilledMethodA or kFilledMethodB
+	 * \param reverse the first datum of each word is in the most significant bits
+	 * \param swapEndian source words are in the other byte order
+	 */
+	void Unfill10bitRows(const void *src, const size_t srcStride, U16 *dst, const int datums,
+						 const int height, const Packing packing, const bool reverse, const bool swapEndian);
+
+	/*!
+	 * \brief Pack rows of 16-bit components into 10-bit filled data
+	 *
+	 * The inverse of Unfill10bitRows().  Values are truncated to their top 10
+	 * bits, and unused bits of the last word of each line are zero.
+	 *
+	 * \param src source, datums*height contiguous components
+	 * \param dst first destination line
+	 * \param dstStride distance in bytes between the starts of destination lines
+	 * \param datums number of components in one line
+	 * \param height number of lines
+	 * \param packing kFilledMethodA or kFilledMethodB
+	 * \param reverse put the first datum of each word in the most significant bits
+	 * \param swapEndian write words in the other byte order
+	 */
+	void Fill10bitRows(const U16 *src, void *dst, const size_t dstStride, const int datums,
+					   const int height, const Packing packing, const bool reverse, const bool swapEndian);
+
+}
+
+
+#endif
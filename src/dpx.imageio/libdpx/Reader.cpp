@@ -41,6 +41,7 @@
 #include "ReaderInternal.h"
 #include "ElementReadStream.h"
 #include "Codec.h"
+#include "Filled10bit.h"
 #include "RunLengthEncoding.h"
 
 
@@ -160,6 +161,31 @@ bool dpx::Reader::ReadBlock(const int element, unsigned char *data, Block &block
         return true;
     }
 
+    // 10-bit filled into 16-bit words: read all the lines at once and
+    // unpack them in parallel
+    const Packing packing = this->header.ImagePacking(element);
+    if (!rle && bitDepth == 10 && size == dpx::kWord &&
+        (packing == kFilledMethodA || packing == kFilledMethodB) &&
+        block.x1 == 0 && block.x2 == (int)(this->header.Width()-1))
+    {
+        const int datums = this->header.Width() * numberOfComponents;
+        const int height = block.y2 - block.y1 + 1;
+        const size_t lineLength = Filled10bitLineBytes(datums) + this->header.EndOfLinePadding(element);
+        const size_t readSize = lineLength * height;
+
+        if (this->fd->Seek(this->header.DataOffset(element) + block.y1 * lineLength, InStream::kStart) == false)
+            return false;
+        this->filledBuf.resize(readSize);
+        if (this->fd->ReadDirect(&this->filledBuf[0], readSize) != readSize)
+            return false;
+
+        // 1-channel images have always been read with the datums of each
+        // word in the opposite order
+        Unfill10bitRows(&this->filledBuf[0], lineLength, reinterpret_cast<U16 *>(data), datums, height,
+                        packing, numberOfComponents != 1, this->header.RequiresByteSwap());
+        return true;
+    }
+
     // determine if the encoding system is loaded
     if (this->codex[element] == 0)
     {
@@ -32,8 +32,10 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */ 
 
+#include <algorithm>
 #include <cstring>
 #include <ctime>
+#include <vector>
 
 #if defined(__GNUC__)
 #    pragma GCC diagnostic ignored "-Wunused-parameter"
@@ -42,6 +44,7 @@
 #include "DPX.h"
 #include "DPXStream.h"
 #include "EndianSwap.h"
+#include "Filled10bit.h"
 #include "WriterInternal.h"
 
 
@@ -316,7 +319,11 @@ bool dpx::Writer::WriteElement(const int element, void *data, const DataSize siz
 			if (this->header.ImageDescriptor(element) == kRGB && this->header.DatumSwap(element) && bitDepth == 10)
 				reverse = true;
 
-			if (size == dpx::kWord)
+			if (size == dpx::kWord && !rle && (packing == kFilledMethodA || packing == kFilledMethodB))
+				// same datum order as WriteBuffer uses for 4-channel images
+				status = this->WriteFilled10bit(reinterpret_cast<U16 *>(data), width, height, noc, packing,
+												noc == 4 ? !reverse : reverse, eolnPad);
+			else if (size == dpx::kWord)
 				this->fileLoc += WriteBuffer<U16, 10, true>(this->fd, size, data, width, height, noc, packing, rle, reverse, eolnPad, blank, status, this->header.RequiresByteSwap());
 			else
 				this->fileLoc += WriteBuffer<U16, 10, false>(this->fd, size, data, width, height, noc, packing, rle, reverse, eolnPad, blank, status, this->header.RequiresByteSwap());
@@ -368,6 +375,31 @@ bool dpx::Writer::WriteElement(const int element, void *data, const DataSize siz
 }
 
 
+// 10-bit filled data from 16-bit words, packed in parallel a band of lines
+// at a time (bounding the extra memory) and written a band at a time
+
+bool dpx::Writer::WriteFilled10bit(const U16 *data, const U32 width, const U32 height, const int noc,
+								   const Packing packing, const bool reverse, const U32 eolnPad)
+{
+	const int datums = width * noc;
+	const size_t lineLength = Filled10bitLineBytes(datums) + eolnPad;
+	const U32 band = std::max(U32(1), std::min(height, U32((16 << 20) / lineLength)));
+
+	// zero-filled so the end of line padding is blank
+	std::vector<unsigned char> buf(lineLength * band, 0);
+	for (U32 y = 0; y < height; y += band)
+	{
+		const U32 n = std::min(band, height - y);
+		Fill10bitRows(data + size_t(y) * datums, &buf[0], lineLength, datums, n, packing, reverse,
+					  this->header.RequiresByteSwap());
+		if (!this->fd->WriteCheck(&buf[0], lineLength * n))
+			return false;
+		this->fileLoc += lineLength * n;
+	}
+	return true;
+}
+
+
 // the passed in image buffer is written to the file untouched
 
 bool dpx::Writer::WriteThrough(void *data, const U32 width, const U32 height, const int noc, const int bytes, const U32 eolnPad, const U32 eoimPad, char *blank)
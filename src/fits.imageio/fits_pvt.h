@@ -45,24 +45,33 @@ public:
     {
         return (feature == "arbitrary_metadata"
                 || feature == "exif"    // Because of arbitrary_metadata
-                || feature == "iptc");  // Because of arbitrary_metadata
+                || feature == "iptc"    // Because of arbitrary_metadata
+                || feature == "ioproxy");
     }
     virtual bool valid_file(const std::string& filename) const override;
     virtual bool open(const std::string& name, ImageSpec& spec) override;
+    virtual bool open(const std::string& name, ImageSpec& spec,
+                      const ImageSpec& config) override;
     virtual bool close(void) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
     virtual bool seek_subimage(int subimage, int miplevel) override;
     virtual int current_subimage() const override { return m_cur_subimage; }
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
     int m_cur_subimage;
     int m_bitpix;              // number of bits that represents data value;
     int m_naxes;               // number of axes of the image (e.g dimensions)
     std::vector<int> m_naxis;  // axis sizes of each dimension
-    fpos_t m_filepos;          // current position in the file
+    int64_t m_filepos;         // start of the current image data
     // here we store informations how many times COMMENT, HISTORY, HIERARCH
     // keywords have occurred
     std::map<std::string, int> keys;
@@ -76,7 +85,8 @@ private:
 
     void init(void)
     {
-        m_fd = NULL;
+        m_io = nullptr;
+        m_io_local.reset();
         m_filename.clear();
         m_cur_subimage = 0;
         m_bitpix       = 0;
@@ -88,6 +98,10 @@ private:
         m_sep = '\n';
     }
 
+    // Read exactly size bytes at the current position, with an error
+    // message if we can't.
+    bool fread(void* buf, size_t size);
+
     // read keywords from FITS header and add them to the ImageSpec
     // sets some ImageSpec fields: width, height, depth.
     // Return true if all is ok, false if there was a read error.
@@ -127,12 +141,18 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
-    int m_bitpix;      // number of bits that represents data value;
-    fpos_t m_filepos;  // current position in the file
+    int m_bitpix;       // number of bits that represents data value;
+    int64_t m_filepos;  // start of the current image data
     bool m_simple;     // does the header with SIMPLE key was written?
     std::vector<unsigned char> m_scratch;
     std::string m_sep;
@@ -140,7 +160,8 @@ private:
 
     void init(void)
     {
-        m_fd = NULL;
+        m_io = nullptr;
+        m_io_local.reset();
         m_filename.clear();
         m_bitpix = 0;
         m_simple = true;
@@ -148,9 +169,12 @@ private:
         m_sep = '\n';
     }
 
+    // Write the pixels we've been holding for tile emulation.
+    bool flush_tilebuffer();
+
     // save to FITS file all attributes from ImageSpace and after writing last
     // attribute writes END keyword
-    void create_fits_header(void);
+    bool create_fits_header(void);
 
     // save to FITS file some mandatory keywords: SIMPLE, BITPIX, NAXIS, NAXIS1
     // and NAXIS2 with their values.
@@ -40,15 +40,28 @@ OIIO_PLUGIN_EXPORTS_END
 bool
 FitsInput::valid_file(const std::string& filename) const
 {
-    FILE* fd = Filesystem::fopen(filename, "rb");
-    if (!fd)
+    Filesystem::IOFile io(filename, Filesystem::IOProxy::Mode::Read);
+    if (!io.opened())
         return false;
 
     char magic[6] = { 0 };
-    bool ok = (fread(magic, 1, 6, fd) == 6) && !strncmp(magic, "SIMPLE", 6);
+    return io.pread(magic, 6, 0) == 6 && !strncmp(magic, "SIMPLE", 6);
+}
+
 
-    fclose(fd);
-    return ok;
+
+bool
+FitsInput::fread(void* buf, size_t size)
+{
+    size_t n = m_io->read(buf, size);
+    if (n != size) {
+        if (m_io->tell() >= int64_t(m_io->size()))
+            errorf("Hit end of file unexpectedly (offset=%d)", m_io->tell());
+        else
+            errorf("read error");
+        return false;
+    }
+    return true;
 }
 
 
@@ -60,26 +73,26 @@ FitsInput::open(const std::string& name, ImageSpec& spec)
     m_filename = name;
 
     // checking if the file exists and can be opened in READ mode
-    m_fd = Filesystem::fopen(m_filename, "rb");
-    if (!m_fd) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorf("Could not open file \"%s\"", m_filename);
+        close();
         return false;
     }
 
     // checking if the file is FITS file
     char magic[6] = { 0 };
-    if (fread(magic, 1, 6, m_fd) != 6) {
-        errorf("%s isn't a FITS file", m_filename);
-        return false;  // Read failed
-    }
-
-    if (strncmp(magic, "SIMPLE", 6)) {
+    if (m_io->pread(magic, 6, 0) != 6 || strncmp(magic, "SIMPLE", 6)) {
         errorf("%s isn't a FITS file", m_filename);
         close();
         return false;
     }
     // moving back to the start of the file
-    fseek(m_fd, 0, SEEK_SET);
+    m_io->seek(0);
 
     subimage_search();
 
@@ -92,6 +105,18 @@ FitsInput::open(const std::string& name, ImageSpec& spec)
 
 
 
+bool
+FitsInput::open(const std::string& name, ImageSpec& spec,
+                const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, spec);
+}
+
+
+
 bool
 FitsInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
                                 void* data)
@@ -105,13 +130,14 @@ FitsInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
         return true;
 
     std::vector<unsigned char> data_tmp(m_spec.scanline_bytes());
-    long scanline_off = (m_spec.height - y) * m_spec.scanline_bytes();
-    fseek(m_fd, scanline_off, SEEK_CUR);
-    size_t n = fread(&data_tmp[0], 1, m_spec.scanline_bytes(), m_fd);
-    if (n != m_spec.scanline_bytes()) {
-        if (feof(m_fd))
+    int64_t scanline_off = m_filepos
+                           + int64_t(m_spec.height - y)
+                                 * m_spec.scanline_bytes();
+    size_t n = m_io->pread(&data_tmp[0], data_tmp.size(), scanline_off);
+    if (n != data_tmp.size()) {
+        if (scanline_off + n >= m_io->size())
             errorf("Hit end of file unexpectedly (offset=%d, scanline %d)",
-                   ftell(m_fd), y);
+                   scanline_off + n, y);
         else
             errorf("read error");
         return false;  // Read failed
@@ -136,9 +162,6 @@ FitsInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
     }
 
     memcpy(data, &data_tmp[0], data_tmp.size());
-
-    // after reading scanline we set file pointer to the start of image data
-    fsetpos(m_fd, &m_filepos);
     return true;
 };
 
@@ -158,7 +181,7 @@ FitsInput::seek_subimage(int subimage, int miplevel)
 
     // setting file pointer to the beginning of IMAGE extension
     m_cur_subimage = subimage;
-    fseek(m_fd, m_subimages[m_cur_subimage].offset, SEEK_SET);
+    m_io->seek(m_subimages[m_cur_subimage].offset);
 
     if (!set_spec_info())
         return false;
@@ -184,7 +207,7 @@ FitsInput::set_spec_info()
     // now we can get the current position in the file
     // this is the start of the image data
     // we will need it in the read_native_scanline method
-    fgetpos(m_fd, &m_filepos);
+    m_filepos = m_io->tell();
 
     if (m_bitpix == 8)
         m_spec.set_format(TypeDesc::UCHAR);
@@ -204,8 +227,6 @@ FitsInput::set_spec_info()
 bool
 FitsInput::close(void)
 {
-    if (m_fd)
-        fclose(m_fd);
     init();
     return true;
 }
@@ -218,13 +239,8 @@ FitsInput::read_fits_header(void)
     std::string fits_header(HEADER_SIZE, 0);
 
     // we read whole header at once
-    if (fread(&fits_header[0], 1, HEADER_SIZE, m_fd) != HEADER_SIZE) {
-        if (feof(m_fd))
-            errorf("Hit end of file unexpectedly (offset=%d)", ftell(m_fd));
-        else
-            errorf("read error");
+    if (!fread(&fits_header[0], HEADER_SIZE))
         return false;  // Read failed
-    }
 
     bool found_end = false;
     for (int i = 0; i < CARDS_PER_HEADER; ++i) {
@@ -386,18 +402,17 @@ void
 FitsInput::subimage_search()
 {
     // saving position of the file, just for safe)
-    fpos_t fpos;
-    fgetpos(m_fd, &fpos);
+    int64_t fpos = m_io->tell();
 
     // starting reading headers from the beginning of the file
-    fseek(m_fd, 0, SEEK_SET);
+    m_io->seek(0);
 
     // we search for subimages by reading whole header and checking if it
     // starts by "SIMPLE" keyword (primary header is always image header)
     // or by "XTENSION= 'IMAGE   '" (it is image extensions)
     std::string hdu(HEADER_SIZE, 0);
     size_t offset = 0;
-    while (fread(&hdu[0], 1, HEADER_SIZE, m_fd) == HEADER_SIZE) {
+    while (m_io->read(&hdu[0], HEADER_SIZE) == HEADER_SIZE) {
         if (!strncmp(&hdu[0], "SIMPLE", 6)
             || !strncmp(&hdu[0], "XTENSION= 'IMAGE   '", 20)) {
             fits_pvt::Subimage newSub;
@@ -407,7 +422,7 @@ FitsInput::subimage_search()
         }
         offset += HEADER_SIZE;
     }
-    fsetpos(m_fd, &fpos);
+    m_io->seek(fpos);
 }
 
 
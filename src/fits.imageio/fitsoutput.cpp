@@ -33,7 +33,8 @@ FitsOutput::supports(string_view feature) const
             || feature == "nchannels" || feature == "random_access"
             || feature == "arbitrary_metadata"
             || feature == "exif"    // Because of arbitrary_metadata
-            || feature == "iptc");  // Because of arbitrary_metadata
+            || feature == "iptc"    // Because of arbitrary_metadata
+            || feature == "ioproxy");
 }
 
 
@@ -46,6 +47,22 @@ FitsOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
         return false;
     }
 
+    if (mode == AppendSubimage) {
+        // Subimages go at the end of the file we already have open
+        if (!m_io || m_filename.empty()) {
+            errorf("%s not opened, can't append a subimage", name);
+            return false;
+        }
+        if (!flush_tilebuffer())
+            return false;
+    } else {
+        // Close any already-opened file, but hold on to a proxy that was
+        // supplied with set_ioproxy() for the new one.
+        Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+        close();
+        m_io = ioproxy;
+    }
+
     // saving 'name' and 'spec' for later use
     m_filename = name;
     m_spec     = spec;
@@ -57,23 +74,44 @@ FitsOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
     else if (m_spec.format == TypeDesc::UINT)
         m_spec.format = TypeDesc::INT;
 
-    // checking if the file exists and can be opened in WRITE mode
-    m_fd = Filesystem::fopen(m_filename, mode == AppendSubimage ? "r+b" : "wb");
-    if (!m_fd) {
-        errorf("Could not open \"%s\"", m_filename);
-        return false;
-    }
-
     if (m_spec.depth != 1) {
         errorf("Volume FITS files not supported");
         return false;
     }
 
-    create_fits_header();
+    if (mode == AppendSubimage) {
+        // Each HDU starts on a HEADER_SIZE boundary, so zero-pad the
+        // data of the previous subimage out to the next one.
+        int64_t end = m_io->size();
+        int64_t pad = (HEADER_SIZE - end % HEADER_SIZE) % HEADER_SIZE;
+        std::vector<char> zeros(pad, 0);
+        m_io->seek(end);
+        if (pad && m_io->write(zeros.data(), pad) != size_t(pad)) {
+            errorf("Write error: %s", m_io->error());
+            return false;
+        }
+    } else {
+        auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+        if (ioparam)
+            m_io = ioparam->get<Filesystem::IOProxy*>();
+        if (!m_io) {
+            // If no proxy was supplied, create a file writer
+            m_io = new Filesystem::IOFile(name,
+                                          Filesystem::IOProxy::Mode::Write);
+            m_io_local.reset(m_io);
+        }
+        if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
+            errorf("Could not open \"%s\"", name);
+            return false;
+        }
+    }
+
+    if (!create_fits_header())
+        return false;
 
     // now we can get the current position in the file
     // we will need it int the write_native_scanline method
-    fgetpos(m_fd, &m_filepos);
+    m_filepos = m_io->tell();
 
     // If user asked for tiles -- which this format doesn't support, emulate
     // it by buffering the whole image.
@@ -103,8 +141,9 @@ FitsOutput::write_scanline(int y, int /*z*/, TypeDesc format, const void* data,
     memcpy(&data_tmp[0], data, m_spec.scanline_bytes());
 
     // computing scanline offset
-    long scanline_off = (m_spec.height - y) * m_spec.scanline_bytes();
-    fseek(m_fd, scanline_off, SEEK_CUR);
+    int64_t scanline_off = m_filepos
+                           + int64_t(m_spec.height - y)
+                                 * m_spec.scanline_bytes();
 
     // in FITS image data is stored in big-endian so we have to switch to
     // big-endian on little-endian machines
@@ -122,12 +161,16 @@ FitsOutput::write_scanline(int y, int /*z*/, TypeDesc format, const void* data,
                         data_tmp.size() / sizeof(double));
     }
 
-    size_t byte_count = fwrite(&data_tmp[0], 1, data_tmp.size(), m_fd);
-
-    fsetpos(m_fd, &m_filepos);
+    m_io->seek(scanline_off);
+    size_t byte_count = m_io->write(&data_tmp[0], data_tmp.size());
+    m_io->seek(m_filepos);
 
     //byte_count == data.size --> all written
-    return byte_count == data_tmp.size();
+    if (byte_count != data_tmp.size()) {
+        errorf("Write error: %s", m_io->error());
+        return false;
+    }
+    return true;
 }
 
 
@@ -144,30 +187,36 @@ FitsOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
 
 
 bool
-FitsOutput::close(void)
+FitsOutput::flush_tilebuffer()
 {
-    if (!m_fd) {  // already closed
-        init();
-        return true;
-    }
-
     bool ok = true;
-    if (m_spec.tile_width) {
+    if (m_spec.tile_width && m_tilebuffer.size()) {
         // Handle tile emulation -- output the buffered pixels
-        OIIO_ASSERT(m_tilebuffer.size());
         ok &= write_scanlines(m_spec.y, m_spec.y + m_spec.height, 0,
                               m_spec.format, &m_tilebuffer[0]);
         std::vector<unsigned char>().swap(m_tilebuffer);
     }
+    return ok;
+}
+
+
 
-    fclose(m_fd);
+bool
+FitsOutput::close(void)
+{
+    if (!m_io || m_filename.empty()) {  // already closed
+        init();
+        return true;
+    }
+
+    bool ok = flush_tilebuffer();
     init();
     return ok;
 }
 
 
 
-void
+bool
 FitsOutput::create_fits_header(void)
 {
     std::string header;
@@ -221,11 +270,12 @@ FitsOutput::create_fits_header(void)
     if (hsize)
         header.resize(header.size() + hsize, ' ');
 
-    size_t byte_count = fwrite(&header[0], 1, header.size(), m_fd);
+    size_t byte_count = m_io->write(&header[0], header.size());
     if (byte_count != header.size()) {
-        // FIXME Bad Write
         errorf("Bad header write (err %d)", byte_count);
+        return false;
     }
+    return true;
 }
 
 
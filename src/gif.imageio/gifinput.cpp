@@ -2,7 +2,6 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
-#include <fcntl.h>
 #include <memory>
 #include <vector>
 
@@ -37,7 +36,13 @@ public:
     GIFInput() { init(); }
     virtual ~GIFInput() { close(); }
     virtual const char* format_name(void) const override { return "gif"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
+    virtual bool open(const std::string& name, ImageSpec& newspec,
+                      const ImageSpec& config) override;
     virtual bool close(void) override;
     virtual bool seek_subimage(int subimage, int miplevel) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
@@ -53,9 +58,16 @@ public:
         // No mipmap support
         return 0;
     }
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;          ///< Stash the filename
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     GifFileType* m_gif_file;         ///< GIFLIB handle
     int m_transparent_color;         ///< Transparent color index
     int m_subimage;                  ///< Current subimage index
@@ -92,6 +104,18 @@ private:
     /// Print error message.
     ///
     void report_last_error(void);
+
+    /// Release the GIFLIB handle, but keep the IOProxy.
+    ///
+    bool close_gif(void);
+
+    /// GIFLIB input callback: read from the IOProxy in UserData.
+    ///
+    static int readfunc(GifFileType* gif, GifByteType* buf, int len)
+    {
+        auto io = (Filesystem::IOProxy*)gif->UserData;
+        return int(io->read(buf, len));
+    }
 };
 
 
@@ -128,6 +152,8 @@ void
 GIFInput::init(void)
 {
     m_gif_file = nullptr;
+    m_io       = nullptr;
+    m_io_local.reset();
 }
 
 
@@ -139,6 +165,17 @@ GIFInput::open(const std::string& name, ImageSpec& newspec)
     m_subimage = -1;
     m_canvas.clear();
 
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
+        errorf("Could not open file \"%s\"", name);
+        close();
+        return false;
+    }
+
     bool ok = seek_subimage(0, 0);
     newspec = spec();
     return ok;
@@ -146,6 +183,18 @@ GIFInput::open(const std::string& name, ImageSpec& newspec)
 
 
 
+bool
+GIFInput::open(const std::string& name, ImageSpec& newspec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, newspec);
+}
+
+
+
 inline int
 GIFInput::decode_line_number(int line_number, int height)
 {
@@ -353,35 +402,29 @@ GIFInput::seek_subimage(int subimage, int miplevel)
 
     if (m_subimage > subimage) {
         // requested subimage is located before the current one
-        // file needs to be reopened
-        if (m_gif_file && !close()) {
+        // file needs to be reread from the start
+        if (m_gif_file && !close_gif()) {
             return false;
         }
+        m_canvas.clear();
     }
 
     if (!m_gif_file) {
-#if GIFLIB_MAJOR >= 5 && defined(_WIN32)
-        // On Windows, UTF-8 filenames won't work properly with Giflib. Jump
-        // through some hoops: get an integer file descriptor for Giflib.
-        int fd = Filesystem::open(m_filename, _O_RDONLY | _O_BINARY);
-        if (fd == -1) {
-            errorf("Error trying to open the file.");
-            return false;
-        }
-        int giflib_error;
-        if (!(m_gif_file = DGifOpenFileHandle(fd, &giflib_error))) {
-            errorf("%s", GifErrorString(giflib_error));
+        if (!m_io) {
+            errorf("File not open");
             return false;
         }
-#elif GIFLIB_MAJOR >= 5
+        // Giflib reads through our callback, so it works the same for
+        // files and for any other IOProxy.
+        m_io->seek(0);
+#if GIFLIB_MAJOR >= 5
         int giflib_error;
-        if (!(m_gif_file = DGifOpenFileName(m_filename.c_str(),
-                                            &giflib_error))) {
+        if (!(m_gif_file = DGifOpen(m_io, readfunc, &giflib_error))) {
             errorf("%s", GifErrorString(giflib_error));
             return false;
         }
 #else
-        if (!(m_gif_file = DGifOpenFileName(m_filename.c_str()))) {
+        if (!(m_gif_file = DGifOpen(m_io, readfunc))) {
             errorf("Error trying to open the file.");
             return false;
         }
@@ -449,8 +492,8 @@ GIFInput::report_last_error(void)
 
 
 
-inline bool
-GIFInput::close(void)
+bool
+GIFInput::close_gif(void)
 {
     if (m_gif_file) {
 #if GIFLIB_MAJOR > 5 || (GIFLIB_MAJOR == 5 && GIFLIB_MINOR >= 1)
@@ -463,9 +506,19 @@ GIFInput::close(void)
         }
         m_gif_file = NULL;
     }
-    m_canvas.clear();
-
     return true;
 }
 
+
+
+inline bool
+GIFInput::close(void)
+{
+    bool ok = close_gif();
+    m_canvas.clear();
+    m_io = nullptr;
+    m_io_local.reset();
+    return ok;
+}
+
 OIIO_PLUGIN_NAMESPACE_END
@@ -4,8 +4,8 @@
 
 
 #include <cassert>
-#include <cstdio>
 #include <iostream>
+#include <memory>
 
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imageio.h>
@@ -34,25 +34,38 @@ public:
     HdrInput() { init(); }
     virtual ~HdrInput() { close(); }
     virtual const char* format_name(void) const override { return "hdr"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& spec) override;
+    virtual bool open(const std::string& name, ImageSpec& spec,
+                      const ImageSpec& config) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
     virtual bool close() override;
     virtual int current_subimage(void) const override { return m_subimage; }
     virtual bool seek_subimage(int subimage, int miplevel) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;  ///< File name
-    FILE* m_fd;              ///< The open file handle
     int m_subimage;          ///< What subimage are we looking at?
     int m_next_scanline;     ///< Next scanline to read
     std::vector<int64_t>
         m_scanline_offsets;  ///< Cached scanline offsets for random access
     std::string rgbe_error;  ///< Buffer for RGBE library error msgs
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     void init()
     {
-        m_fd            = NULL;
+        m_io_local.reset();
+        m_io            = nullptr;
         m_subimage      = -1;
         m_next_scanline = 0;
         m_scanline_offsets.clear();
@@ -90,13 +103,37 @@ HdrInput::open(const std::string& name, ImageSpec& newspec)
 {
     m_filename = name;
 
-    bool ok = seek_subimage(0, 0);
-    newspec = spec();
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
+        errorf("Could not open file \"%s\"", name);
+        close();
+        return false;
+    }
+
+    m_subimage = -1;
+    bool ok    = seek_subimage(0, 0);
+    newspec    = spec();
     return ok;
 }
 
 
 
+bool
+HdrInput::open(const std::string& name, ImageSpec& newspec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, newspec);
+}
+
+
+
 bool
 HdrInput::seek_subimage(int subimage, int miplevel)
 {
@@ -109,18 +146,15 @@ HdrInput::seek_subimage(int subimage, int miplevel)
         return true;
     }
 
-    close();
-
-    // Check that file exists and can be opened
-    m_fd = Filesystem::fopen(m_filename, "rb");
-    if (m_fd == NULL) {
-        errorf("Could not open file \"%s\"", m_filename);
+    if (!m_io) {
+        errorf("File not open");
         return false;
     }
+    m_io->seek(0);
 
     rgbe_header_info h;
     int width, height;
-    int r = RGBE_ReadHeader(m_fd, &width, &height, &h, rgbe_error);
+    int r = RGBE_ReadHeader(m_io, &width, &height, &h, rgbe_error);
     if (r != RGBE_RETURN_SUCCESS) {
         errorf("%s", rgbe_error);
         close();
@@ -155,7 +189,7 @@ HdrInput::seek_subimage(int subimage, int miplevel)
     m_subimage      = subimage;
     m_next_scanline = 0;
     m_scanline_offsets.clear();
-    m_scanline_offsets.push_back(Filesystem::ftell(m_fd));
+    m_scanline_offsets.push_back(m_io->tell());
     return true;
 }
 
@@ -173,16 +207,16 @@ HdrInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
         // For random access, use cached file offsets of scanlines. This avoids
         // re-reading the same pixels many times over.
         m_next_scanline = std::min((size_t)y, m_scanline_offsets.size() - 1);
-        Filesystem::fseek(m_fd, m_scanline_offsets[m_next_scanline], SEEK_SET);
+        m_io->seek(m_scanline_offsets[m_next_scanline]);
     }
 
     while (m_next_scanline <= y) {
         // Keep reading until we've read the scanline we really need
-        int r = RGBE_ReadPixels_RLE(m_fd, (float*)data, m_spec.width, 1,
+        int r = RGBE_ReadPixels_RLE(m_io, (float*)data, m_spec.width, 1,
                                     rgbe_error);
         ++m_next_scanline;
         if ((size_t)m_next_scanline == m_scanline_offsets.size()) {
-            m_scanline_offsets.push_back(Filesystem::ftell(m_fd));
+            m_scanline_offsets.push_back(m_io->tell());
         }
         if (r != RGBE_RETURN_SUCCESS) {
             errorf("%s", rgbe_error);
@@ -197,9 +231,7 @@ HdrInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
 bool
 HdrInput::close()
 {
-    if (m_fd)
-        fclose(m_fd);
-    init();  // Reset to initial state
+    init();  // Reset to initial state, releasing any proxy we allocated
     return true;
 }
 
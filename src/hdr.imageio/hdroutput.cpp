@@ -4,8 +4,8 @@
 
 
 #include <cassert>
-#include <cstdio>
 #include <iostream>
+#include <memory>
 
 #include "rgbe.h"
 #include <OpenImageIO/filesystem.h>
@@ -19,6 +19,10 @@ public:
     HdrOutput() { init(); }
     virtual ~HdrOutput() { close(); }
     virtual const char* format_name(void) const override { return "hdr"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, const ImageSpec& spec,
                       OpenMode mode) override;
     virtual bool write_scanline(int y, int z, TypeDesc format, const void* data,
@@ -27,16 +31,23 @@ public:
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
     virtual bool close() override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::vector<unsigned char> scratch;
     std::string rgbe_error;  // Buffer for RGBE library error msgs
     std::vector<unsigned char> m_tilebuffer;
 
     void init(void)
     {
-        m_fd = NULL;
+        m_io = nullptr;
+        m_io_local.reset();
         rgbe_error.clear();
     }
 };
@@ -88,8 +99,15 @@ HdrOutput::open(const std::string& name, const ImageSpec& newspec,
 
     m_spec.set_format(TypeDesc::FLOAT);  // Native rgbe is float32 only
 
-    m_fd = Filesystem::fopen(name, "wb");
-    if (m_fd == NULL) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", name);
         return false;
     }
@@ -112,7 +130,7 @@ HdrOutput::open(const std::string& name, const ImageSpec& newspec,
     // FIXME -- should we do anything about gamma, exposure, software,
     // pixaspect, primaries?  (N.B. rgbe.c doesn't even handle most of them)
 
-    int r = RGBE_WriteHeader(m_fd, m_spec.width, m_spec.height, &h, rgbe_error);
+    int r = RGBE_WriteHeader(m_io, m_spec.width, m_spec.height, &h, rgbe_error);
     if (r != RGBE_RETURN_SUCCESS)
         errorf("%s", rgbe_error);
 
@@ -131,7 +149,7 @@ HdrOutput::write_scanline(int /*y*/, int /*z*/, TypeDesc format,
                           const void* data, stride_t xstride)
 {
     data  = to_native_scanline(format, data, xstride, scratch);
-    int r = RGBE_WritePixels_RLE(m_fd, (float*)data, m_spec.width, 1,
+    int r = RGBE_WritePixels_RLE(m_io, (float*)data, m_spec.width, 1,
                                  rgbe_error);
     if (r != RGBE_RETURN_SUCCESS)
         errorf("%s", rgbe_error);
@@ -154,7 +172,7 @@ HdrOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
 bool
 HdrOutput::close()
 {
-    if (!m_fd) {  // already closed
+    if (!m_io) {  // already closed
         init();
         return true;
     }
@@ -168,8 +186,6 @@ HdrOutput::close()
         std::vector<unsigned char>().swap(m_tilebuffer);
     }
 
-    fclose(m_fd);
-    m_fd = NULL;
     init();
 
     return ok;
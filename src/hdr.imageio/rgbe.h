@@ -12,8 +12,7 @@
    See rgbe.txt file for more details.
 */
 
-#include <cstdio>
-
+#include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imageio.h>
 
 OIIO_PLUGIN_NAMESPACE_BEGIN
@@ -46,23 +45,23 @@ typedef struct {
 
 /* read or write headers */
 /* you may set rgbe_header_info to null if you want to */
-int RGBE_WriteHeader(FILE *fp, int width, int height, rgbe_header_info *info,
+int RGBE_WriteHeader(Filesystem::IOProxy *fp, int width, int height, rgbe_header_info *info,
                      std::string &errbuf);
-int RGBE_ReadHeader(FILE *fp, int *width, int *height, rgbe_header_info *info,
+int RGBE_ReadHeader(Filesystem::IOProxy *fp, int *width, int *height, rgbe_header_info *info,
                     std::string &errbuf);
 
 /* read or write pixels */
 /* can read or write pixels in chunks of any size including single pixels*/
-int RGBE_WritePixels(FILE *fp, float *data, int64_t numpixels,
+int RGBE_WritePixels(Filesystem::IOProxy *fp, float *data, int64_t numpixels,
                      std::string &errbuf);
-int RGBE_ReadPixels(FILE *fp, float *data, int64_t numpixels,
+int RGBE_ReadPixels(Filesystem::IOProxy *fp, float *data, int64_t numpixels,
                     std::string &errbuf);
 
 /* read or write run length encoded files */
 /* must be called to read or write whole scanlines */
-int RGBE_WritePixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_WritePixels_RLE(Filesystem::IOProxy *fp, float *data, int scanline_width,
 			 int num_scanlines, std::string &errbuf);
-int RGBE_ReadPixels_RLE(FILE *fp, float *data, int scanline_width,
+int RGBE_ReadPixels_RLE(Filesystem::IOProxy *fp, float *data, int scanline_width,
 			int num_scanlines, std::string &errbuf);
 
 OIIO_PLUGIN_NAMESPACE_END
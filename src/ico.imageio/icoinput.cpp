@@ -25,7 +25,13 @@ public:
     ICOInput() { init(); }
     virtual ~ICOInput() { close(); }
     virtual const char* format_name(void) const override { return "ico"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
+    virtual bool open(const std::string& name, ImageSpec& newspec,
+                      const ImageSpec& config) override;
     virtual bool close() override;
     virtual int current_subimage(void) const override
     {
@@ -35,10 +41,16 @@ public:
     virtual bool seek_subimage(int subimage, int miplevel) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;            ///< Stash the filename
-    FILE* m_file;                      ///< Open image handle
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     ico_header m_ico;                  ///< ICO header
     std::vector<unsigned char> m_buf;  ///< Buffer the image pixels
     int m_subimage;                    ///< What subimage are we looking at?
@@ -58,7 +70,7 @@ private:
     void init()
     {
         m_subimage = -1;
-        m_file     = NULL;
+        m_io       = nullptr;
         m_png      = NULL;
         m_info     = NULL;
         memset(&m_ico, 0, sizeof(m_ico));
@@ -73,10 +85,21 @@ private:
     ///
     bool fread(void* buf, size_t itemsize, size_t nitems)
     {
-        size_t n = ::fread(buf, itemsize, nitems, m_file);
-        if (n != nitems)
+        size_t n = m_io->read(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
             errorf("Read error");
-        return n == nitems;
+        return n == itemsize * nitems;
+    }
+
+    // Callback for PNG that reads an embedded PNG icon from the IOProxy.
+    static void PngReadCallback(png_structp png_ptr, png_bytep data,
+                                png_size_t length)
+    {
+        ICOInput* icoinput = (ICOInput*)png_get_io_ptr(png_ptr);
+        OIIO_DASSERT(icoinput);
+        size_t bytes = icoinput->m_io->read(data, length);
+        if (bytes != length)
+            icoinput->errorf("Read error: requested %d got %d", length, bytes);
     }
 };
 
@@ -110,14 +133,22 @@ ICOInput::open(const std::string& name, ImageSpec& newspec)
 {
     m_filename = name;
 
-    m_file = Filesystem::fopen(name, "rb");
-    if (!m_file) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorf("Could not open file \"%s\"", name);
+        close();
         return false;
     }
+    m_io->seek(0);
 
-    if (!fread(&m_ico, 1, sizeof(m_ico)))
+    if (!fread(&m_ico, 1, sizeof(m_ico))) {
+        close();
         return false;
+    }
 
     if (bigendian()) {
         // ICOs are little endian
@@ -127,6 +158,7 @@ ICOInput::open(const std::string& name, ImageSpec& newspec)
     }
     if (m_ico.reserved != 0 || m_ico.type != 1) {
         errorf("File failed ICO header check");
+        close();
         return false;
     }
 
@@ -141,6 +173,18 @@ ICOInput::open(const std::string& name, ImageSpec& newspec)
 
 
 
+bool
+ICOInput::open(const std::string& name, ImageSpec& newspec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, newspec);
+}
+
+
+
 bool
 ICOInput::seek_subimage(int subimage, int miplevel)
 {
@@ -163,8 +207,7 @@ ICOInput::seek_subimage(int subimage, int miplevel)
     m_subimage = subimage;
 
     // read subimage header
-    fseek(m_file, sizeof(ico_header) + m_subimage * sizeof(ico_subimage),
-          SEEK_SET);
+    m_io->seek(sizeof(ico_header) + m_subimage * sizeof(ico_subimage));
     ico_subimage subimg;
     if (!fread(&subimg, 1, sizeof(subimg)))
         return false;
@@ -179,7 +222,7 @@ ICOInput::seek_subimage(int subimage, int miplevel)
         swap_endian(&subimg.numColours);
     }
 
-    fseek(m_file, subimg.ofs, SEEK_SET);
+    m_io->seek(subimg.ofs);
 
     // test for a PNG icon
     char temp[8];
@@ -202,7 +245,7 @@ ICOInput::seek_subimage(int subimage, int miplevel)
 
         //std::cerr << "[ico] reading PNG info\n";
 
-        png_init_io(m_png, m_file);
+        png_set_read_fn(m_png, this, PngReadCallback);
         png_set_sig_bytes(m_png, 8);  // already read 8 bytes
 
         PNG_pvt::read_info(m_png, m_info, m_bpp, m_color_type, m_interlace_type,
@@ -215,7 +258,7 @@ ICOInput::seek_subimage(int subimage, int miplevel)
 
     // otherwise it's a plain, ol' windoze DIB (device-independent bitmap)
     // roll back to where we began and read in the DIB header
-    fseek(m_file, subimg.ofs, SEEK_SET);
+    m_io->seek(subimg.ofs);
 
     ico_bitmapinfo bmi;
     if (!fread(&bmi, 1, sizeof(bmi)))
@@ -406,11 +449,7 @@ ICOInput::close()
 {
     if (m_png && m_info)
         PNG_pvt::destroy_read_struct(m_png, m_info);
-    if (m_file) {
-        fclose(m_file);
-        m_file = NULL;
-    }
-
+    m_io_local.reset();
     init();  // Reset to initial state
     return true;
 }
@@ -35,10 +35,15 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;                ///< Stash the filename
-    FILE* m_file;                          ///< Open image handle
+    bool m_opened;                         ///< Is a subimage being written?
     int m_color_type;                      ///< Requested colour type
     bool m_want_png;                       ///< Whether the client requested PNG
     std::vector<unsigned char> m_scratch;  ///< Scratch buffer
@@ -52,14 +57,18 @@ private:
     png_structp m_png;  ///< PNG read structure pointer
     png_infop m_info;   ///< PNG image info structure pointer
     std::vector<png_text> m_pngtext;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     /// Initialize private members to pre-opened state
     void init(void)
     {
-        m_file = NULL;
-        m_png  = NULL;
-        m_info = NULL;
+        m_opened = false;
+        m_png    = NULL;
+        m_info   = NULL;
         m_pngtext.clear();
+        m_io_local.reset();
+        m_io = nullptr;
     }
 
     /// Add a parameter to the output
@@ -69,26 +78,33 @@ private:
     /// Finish the writing of a PNG subimage
     void finish_png_image();
 
-    /// Helper: read, with error detection
+    /// Helper: write, with error detection
     ///
     template<class T>
     bool fwrite(const T* buf, size_t itemsize = sizeof(T), size_t nitems = 1)
     {
-        size_t n = ::fwrite(buf, itemsize, nitems, m_file);
-        if (n != nitems)
+        size_t n = m_io->write(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
             errorf("Write error");
-        return n == nitems;
+        return n == itemsize * nitems;
     }
 
-    /// Helper: read, with error detection
-    ///
-    template<class T>
-    bool fread(T* buf, size_t itemsize = sizeof(T), size_t nitems = 1)
+    // Callbacks for PNG that write an embedded PNG icon via the IOProxy.
+    static void PngWriteCallback(png_structp png_ptr, png_bytep data,
+                                 png_size_t length)
+    {
+        ICOOutput* icooutput = (ICOOutput*)png_get_io_ptr(png_ptr);
+        OIIO_DASSERT(icooutput);
+        size_t bytes = icooutput->m_io->write(data, length);
+        if (bytes != length)
+            icooutput->errorf("Write error");
+    }
+
+    static void PngFlushCallback(png_structp png_ptr)
     {
-        size_t n = ::fread(buf, itemsize, nitems, m_file);
-        if (n != nitems)
-            errorf("Read error");
-        return n == nitems;
+        ICOOutput* icooutput = (ICOOutput*)png_get_io_ptr(png_ptr);
+        OIIO_DASSERT(icooutput);
+        icooutput->m_io->flush();
     }
 };
 
@@ -132,7 +148,8 @@ ICOOutput::open(const std::string& name, const ImageSpec& userspec,
         return false;
     }
 
-    close();                                 // Close any already-opened file
+    if (m_opened)
+        close();                             // Close any already-opened file
     m_spec = userspec;                       // Stash the spec
     if (m_spec.format == TypeDesc::UNKNOWN)  // if unknown, default to 8 bits
         m_spec.set_format(TypeDesc::UINT8);
@@ -201,15 +218,42 @@ ICOOutput::open(const std::string& name, const ImageSpec& userspec,
 
     //std::cerr << "[ico] writing at " << m_bpp << "bpp\n";
 
-    m_file = Filesystem::fopen(name, mode == AppendSubimage ? "r+b" : "wb");
-    if (!m_file) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (mode == AppendSubimage && m_io) {
+        // Appending has to read back and move what's already written, and
+        // an IOProxy opened for writing can't be read.
+        errorf("%s can't append subimages to an IOProxy", format_name());
+        m_io = nullptr;
+        return false;
+    }
+    std::vector<unsigned char> existing;
+    if (mode == AppendSubimage) {
+        // Slurp the file written so far; it's rewritten below.
+        Filesystem::IOFile in(name, Filesystem::IOProxy::Mode::Read);
+        existing.resize(in.size());
+        if (!in.opened() || in.read(existing.data(), existing.size())
+                                != existing.size()) {
+            errorf("Could not read \"%s\"", name);
+            return false;
+        }
+    }
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", name);
+        init();
         return false;
     }
+    m_opened = true;
 
-    ico_header ico;
     if (mode == Create) {
         // creating new file, write ICO header
+        ico_header ico;
         memset(&ico, 0, sizeof(ico));
         ico.type  = 1;
         ico.count = 1;
@@ -224,90 +268,65 @@ ICOOutput::open(const std::string& name, const ImageSpec& userspec,
         m_offset = sizeof(ico_header) + sizeof(ico_subimage);
     } else {
         // we'll be appending data, so see what's already in the file
-        if (!fread(&ico))
+        ico_header ico;
+        if (existing.size() < sizeof(ico)) {
+            errorf("File failed ICO header check");
             return false;
+        }
+        memcpy(&ico, existing.data(), sizeof(ico));
         if (bigendian()) {
             // ICOs are little endian
             swap_endian(&ico.type);
             swap_endian(&ico.count);
         }
 
-        /*std::cerr << "[ico] reserved = " << ico.reserved << " type = "
-                  << ico.type << " count = " << ico.count << "\n";*/
-
-        if (ico.reserved != 0 || ico.type != 1) {
+        size_t dirsize = sizeof(ico_header) + ico.count * sizeof(ico_subimage);
+        if (ico.reserved != 0 || ico.type != 1 || existing.size() < dirsize) {
             errorf("File failed ICO header check");
             return false;
         }
 
-        // need to move stuff around to make room for another subimage header
+        // make room for another subimage header by shifting all the
+        // image data, so update the offsets in the existing subimage
+        // headers to point to their data correctly
         int subimage = ico.count++;
-        fseek(m_file, 0, SEEK_END);
-        int len = ftell(m_file);
-        unsigned char buf[512];
-        // append null data at the end of file so that we don't seek beyond eof
-        if (!fwrite(buf, sizeof(ico_subimage))) {
-            return false;
-        }
-
-        // do the actual moving, 0.5kB per iteration
-        int skip = sizeof(ico_header) + sizeof(ico_subimage) * (subimage - 1);
-        for (int left = len - skip; left > 0; left -= sizeof(buf)) {
-            int amount = std::min(left, (int)sizeof(buf));
-            /*std::cerr << "[ico] moving " << amount << " bytes (" << left
-                      << " vs " << sizeof (buf) << ")\n";*/
-            fseek(m_file, skip + left - amount, SEEK_SET);
-            if (!fread(buf, 1, amount))
-                return false;
-            fseek(m_file, skip + left - amount + sizeof(ico_subimage),
-                  SEEK_SET);
-            if (!fwrite(buf, 1, amount)) {
-                return false;
-            }
-        }
-
-        // update header
-        fseek(m_file, 0, SEEK_SET);
-        // swap these back to little endian, if needed
-        if (bigendian()) {
-            swap_endian(&ico.type);
-            swap_endian(&ico.count);
-        }
-
-        if (!fwrite(&ico)) {
-            return false;
-        }
-
-        // and finally, update the offsets in subimage headers to point to
-        // their data correctly
-        uint32_t temp;
-        fseek(m_file, offsetof(ico_subimage, ofs), SEEK_CUR);
         for (int i = 0; i < subimage; i++) {
-            if (!fread(&temp))
-                return false;
+            uint32_t temp;
+            unsigned char* ofs = existing.data() + sizeof(ico_header)
+                                 + i * sizeof(ico_subimage)
+                                 + offsetof(ico_subimage, ofs);
+            memcpy(&temp, ofs, sizeof(temp));
             if (bigendian())
                 swap_endian(&temp);
             temp += sizeof(ico_subimage);
             if (bigendian())
                 swap_endian(&temp);
-            // roll back 4 bytes, we need to rewrite the value we just read
-            fseek(m_file, -4, SEEK_CUR);
-            if (!fwrite(&temp)) {
-                return false;
-            }
+            memcpy(ofs, &temp, sizeof(temp));
+        }
 
-            // skip to the next subimage; subtract 4 bytes because that's how
-            // much we've just written
-            fseek(m_file, sizeof(ico_subimage) - 4, SEEK_CUR);
+        // write the updated header, then the old subimage headers, leave
+        // room for the new one, and then the old image data
+        if (bigendian()) {
+            swap_endian(&ico.type);
+            swap_endian(&ico.count);
+        }
+        ico_subimage blank;
+        memset(&blank, 0, sizeof(blank));
+        if (!fwrite(&ico)
+            || !fwrite(existing.data() + sizeof(ico_header), 1,
+                       dirsize - sizeof(ico_header))
+            || !fwrite(&blank)
+            || !fwrite(existing.data() + dirsize, 1,
+                       existing.size() - dirsize)) {
+            return false;
         }
 
         // offset at which we'll be writing new image data
-        m_offset = len + sizeof(ico_subimage);
+        m_offset = int(existing.size() + sizeof(ico_subimage));
 
         // next part of code expects the file pointer to be where the new
         // subimage header is to be written
-        fseek(m_file, sizeof(ico_header) + subimage * sizeof(ico_subimage),
-              SEEK_SET);
+        m_io->seek(sizeof(ico_header) + subimage * sizeof(ico_subimage));
     }
 
     // write subimage header
@@ -332,13 +351,13 @@ ICOOutput::open(const std::string& name, const ImageSpec& userspec,
         return false;
     }
 
-    fseek(m_file, m_offset, SEEK_SET);
+    m_io->seek(m_offset);
     if (m_want_png) {
         // unused still, should do conversion to unassociated
         bool convert_alpha;
         float gamma;
 
-        png_init_io(m_png, m_file);
+        png_set_write_fn(m_png, this, PngWriteCallback, PngFlushCallback);
         png_set_compression_level(m_png, Z_BEST_COMPRESSION);
 
         PNG_pvt::write_info(m_png, m_info, m_color_type, m_spec, m_pngtext,
@@ -375,7 +394,7 @@ ICOOutput::open(const std::string& name, const ImageSpec& userspec,
                 return false;
             }
         }
-        fseek(m_file, m_offset + sizeof(bmi), SEEK_SET);
+        m_io->seek(m_offset + sizeof(bmi));
     }
 
     // If user asked for tiles -- which this format doesn't support, emulate
@@ -396,6 +415,8 @@ ICOOutput::supports(string_view feature) const
         return true;
     if (Strutil::iequals(feature, "alpha"))
         return true;
+    if (Strutil::iequals(feature, "ioproxy"))
+        return true;
     return false;
 }
 
@@ -404,7 +425,7 @@ ICOOutput::supports(string_view feature) const
 bool
 ICOOutput::close()
 {
-    if (!m_file) {  // already closed
+    if (!m_opened) {  // already closed
         init();
         return true;
     }
@@ -421,8 +442,6 @@ ICOOutput::close()
     if (m_png) {
         PNG_pvt::finish_image(m_png, m_info);
     }
-    fclose(m_file);
-    m_file = NULL;
     init();  // re-initialize
     return ok;
 }
@@ -451,10 +470,8 @@ ICOOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
         unsigned char* bdata = (unsigned char*)data;
         unsigned char buf[4];
 
-        fseek(m_file,
-              m_offset + sizeof(ico_bitmapinfo)
-                  + (m_spec.height - y - 1) * m_xor_slb,
-              SEEK_SET);
+        m_io->seek(m_offset + sizeof(ico_bitmapinfo)
+                   + (m_spec.height - y - 1) * m_xor_slb);
         // write the XOR mask
         size_t buff_size = 0;
         for (int x = 0; x < m_spec.width; x++) {
@@ -489,10 +506,9 @@ ICOOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
             }
         }
 
-        fseek(m_file,
-              m_offset + sizeof(ico_bitmapinfo) + m_spec.height * m_xor_slb
-                  + (m_spec.height - y - 1) * m_and_slb,
-              SEEK_SET);
+        m_io->seek(m_offset + sizeof(ico_bitmapinfo)
+                   + m_spec.height * m_xor_slb
+                   + (m_spec.height - y - 1) * m_and_slb);
         // write the AND mask
         // It's required even for 32-bit images because it can be used when
         // drawing at colour depths lower than 24-bit. If it's not present,
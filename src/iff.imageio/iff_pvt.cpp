@@ -14,7 +14,7 @@ using namespace iff_pvt;
 
 
 bool
-IffFileHeader::read_header(FILE* fd, std::string& err)
+IffFileHeader::read_header(Filesystem::IOProxy* fd, std::string& err)
 {
     uint8_t type[4];
     uint32_t size;
@@ -39,7 +39,7 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
         if (type[0] == 'F' && type[1] == 'O' && type[2] == 'R'
             && type[3] == '4') {
             // get type
-            if (!fread(&type, 1, sizeof(type), fd)) {
+            if (fd->read(&type, sizeof(type)) != sizeof(type)) {
                 err = "could not read FDR4 type @ L" STRINGIZE(__LINE__);
                 return false;
             }
@@ -145,7 +145,7 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
                             if (type[0] == 'A' && type[1] == 'U'
                                 && type[2] == 'T' && type[3] == 'H') {
                                 std::vector<char> str(chunksize);
-                                if (!fread(&str[0], 1, chunksize, fd)) {
+                                if (fd->read(&str[0], chunksize) != chunksize) {
                                     err = "could not read author @ L" STRINGIZE(
                                         __LINE__);
                                     return false;
@@ -154,7 +154,7 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
                             } else if (type[0] == 'D' && type[1] == 'A'
                                        && type[2] == 'T' && type[3] == 'E') {
                                 std::vector<char> str(chunksize);
-                                if (!fread(&str[0], 1, chunksize, fd)) {
+                                if (fd->read(&str[0], chunksize) != chunksize) {
                                     err = "could not read date @ L" STRINGIZE(
                                         __LINE__);
                                     return false;
@@ -162,7 +162,7 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
                                 date = std::string(&str[0], size);
                             } else if (type[0] == 'F' && type[1] == 'O'
                                        && type[2] == 'R' && type[3] == '4') {
-                                if (!fread(&type, 1, sizeof(type), fd)) {
+                                if (fd->read(&type, sizeof(type)) != sizeof(type)) {
                                     err = "could not read FOR4 type @ L" STRINGIZE(
                                         __LINE__);
                                     return false;
@@ -174,7 +174,7 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
                                     // tbmp position for later user in in
                                     // read_native_tile
 
-                                    tbmp_start = ftell(fd);
+                                    tbmp_start = fd->tell();
 
                                     // read first RGBA block to detect tile size.
 
@@ -218,24 +218,24 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
                                         }
 
                                         // skip to the next block.
-                                        if (fseek(fd, chunksize, SEEK_CUR)) {
-                                            err = "could not fseek @ L" STRINGIZE(
+                                        if (!fd->seek(chunksize, SEEK_CUR)) {
+                                            err = "could not seek @ L" STRINGIZE(
                                                 __LINE__);
                                             return false;
                                         }
                                     }
                                 } else {
                                     // skip to the next block.
-                                    if (fseek(fd, chunksize, SEEK_CUR)) {
-                                        err = "could not fseek @ L" STRINGIZE(
+                                    if (!fd->seek(chunksize, SEEK_CUR)) {
+                                        err = "could not seek @ L" STRINGIZE(
                                             __LINE__);
                                         return false;
                                     }
                                 }
                             } else {
                                 // skip to the next block.
-                                if (fseek(fd, chunksize, SEEK_CUR)) {
-                                    err = "could not fseek @ L" STRINGIZE(
+                                if (!fd->seek(chunksize, SEEK_CUR)) {
+                                    err = "could not seek @ L" STRINGIZE(
                                         __LINE__);
                                     return false;
                                 }
@@ -246,16 +246,16 @@ IffFileHeader::read_header(FILE* fd, std::string& err)
                     }
 
                     // skip to the next block.
-                    if (fseek(fd, chunksize, SEEK_CUR)) {
-                        err = "could not fseek @ L" STRINGIZE(__LINE__);
+                    if (!fd->seek(chunksize, SEEK_CUR)) {
+                        err = "could not seek @ L" STRINGIZE(__LINE__);
                         return false;
                     }
                 }
             }
         }
         // skip to the next block.
-        if (fseek(fd, chunksize, SEEK_CUR)) {
-            err = "could not fseek @ L" STRINGIZE(__LINE__);
+        if (!fd->seek(chunksize, SEEK_CUR)) {
+            err = "could not seek @ L" STRINGIZE(__LINE__);
             return false;
         }
     }
@@ -314,7 +314,7 @@ IffOutput::write_header(IffFileHeader& header)
     write_meta_string("DATE", header.date);
 
     // for4 position for later user in close
-    header.for4_start = ftell(m_fd);
+    header.for4_start = m_io->tell();
 
     // write 'FOR4' type, with 0 length to reserve it for now
     if (!write_str("FOR4") || !write_int(0))
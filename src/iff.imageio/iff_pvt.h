@@ -33,7 +33,7 @@ const uint32_t BLACK   = 0x00000010;
 class IffFileHeader {
 public:
     // reads information about IFF file
-    bool read_header(FILE* fd, std::string& err);
+    bool read_header(Filesystem::IOProxy* fd, std::string& err);
 
     // header information
     uint32_t x;
@@ -60,23 +60,24 @@ public:
     uint32_t for4_start;
 
 private:
-    bool read(FILE* fd, uint32_t& data)
+    bool read(Filesystem::IOProxy* fd, uint32_t& data)
     {
-        bool ok = (fread(&data, 1, sizeof(data), fd) == sizeof(data));
+        bool ok = (fd->read(&data, sizeof(data)) == sizeof(data));
         if (littleendian())
             swap_endian(&data);
         return ok;
     }
-    bool read(FILE* fd, uint16_t& data)
+    bool read(Filesystem::IOProxy* fd, uint16_t& data)
     {
-        bool ok = (fread(&data, 1, sizeof(data), fd) == sizeof(data));
+        bool ok = (fd->read(&data, sizeof(data)) == sizeof(data));
         if (littleendian())
             swap_endian(&data);
         return ok;
     }
-    bool read_typesize(FILE* fd, uint8_t type[4], uint32_t& size)
+    bool read_typesize(Filesystem::IOProxy* fd, uint8_t type[4],
+                       uint32_t& size)
     {
-        return (fread(type, 1, 4, fd) == 4) && read(fd, size);
+        return (fd->read(type, 4) == 4) && read(fd, size);
     }
 };
 
@@ -135,15 +136,27 @@ public:
     IffInput() { init(); }
     virtual ~IffInput() { close(); }
     virtual const char* format_name(void) const override { return "iff"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& spec) override;
+    virtual bool open(const std::string& name, ImageSpec& spec,
+                      const ImageSpec& config) override;
     virtual bool close(void) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
     virtual bool read_native_tile(int subimage, int miplevel, int x, int y,
                                   int z, void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
     iff_pvt::IffFileHeader m_iff_header;
     std::vector<uint8_t> m_buf;
@@ -153,7 +166,8 @@ private:
     // init to initialize state
     void init(void)
     {
-        m_fd = NULL;
+        m_io_local.reset();
+        m_io = nullptr;
         m_filename.clear();
         m_buf.clear();
     }
@@ -166,7 +180,7 @@ private:
 
     bool read_short(uint16_t& val)
     {
-        bool ok = fread(&val, sizeof(val), 1, m_fd);
+        bool ok = m_io->read(&val, sizeof(val)) == sizeof(val);
         if (littleendian())
             swap_endian(&val);
         return ok;
@@ -174,7 +188,7 @@ private:
 
     bool read_int(uint32_t& val)
     {
-        bool ok = fread(&val, sizeof(val), 1, m_fd);
+        bool ok = m_io->read(&val, sizeof(val)) == sizeof(val);
         if (littleendian())
             swap_endian(&val);
         return ok;
@@ -185,10 +199,10 @@ private:
         const uint32_t big = 1024;
         char strbuf[big];
         len     = std::min(len, big);
-        bool ok = fread(strbuf, len, 1, m_fd);
+        bool ok = m_io->read(strbuf, len) == len;
         val.assign(strbuf, len);
-        for (uint32_t pad = len % round; pad; --pad)
-            fgetc(m_fd);
+        if (uint32_t pad = len % round)
+            m_io->seek(pad, SEEK_CUR);
         return ok;
     }
 
@@ -220,9 +234,15 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
     iff_pvt::IffFileHeader m_iff_header;
     std::vector<uint8_t> m_buf;
@@ -231,7 +251,8 @@ private:
 
     void init(void)
     {
-        m_fd = NULL;
+        m_io_local.reset();
+        m_io = nullptr;
         m_filename.clear();
     }
 
@@ -242,21 +263,21 @@ private:
     {
         if (littleendian())
             swap_endian(&val);
-        return fwrite(&val, sizeof(val), 1, m_fd);
+        return m_io->write(&val, sizeof(val)) == sizeof(val);
     }
     bool write_int(uint32_t val)
     {
         if (littleendian())
             swap_endian(&val);
-        return fwrite(&val, sizeof(val), 1, m_fd);
+        return m_io->write(&val, sizeof(val)) == sizeof(val);
     }
 
     bool write_str(string_view val, size_t round = 4)
     {
-        bool ok = fwrite(val.data(), val.size(), 1, m_fd);
+        bool ok = m_io->write(val.data(), val.size()) == val.size();
         for (size_t i = val.size(); i < round_to_multiple(val.size(), round);
              ++i)
-            ok &= (fputc(' ', m_fd) != EOF);
+            ok &= (m_io->write(" ", 1) == 1);
         return ok;
     }
 
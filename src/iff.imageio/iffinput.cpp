@@ -60,15 +60,21 @@ IffInput::open(const std::string& name, ImageSpec& spec)
     // saving 'name' for later use
     m_filename = name;
 
-    m_fd = Filesystem::fopen(m_filename, "rb");
-    if (!m_fd) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorf("Could not open file \"%s\"", name);
+        close();
         return false;
     }
+    m_io->seek(0);
 
     // we read header of the file that we think is IFF file
     std::string err;
-    if (!m_iff_header.read_header(m_fd, err)) {
+    if (!m_iff_header.read_header(m_io, err)) {
         errorf("\"%s\": could not read iff header (%s)", m_filename,
                err.size() ? err : std::string("unknown"));
         close();
@@ -127,6 +133,18 @@ IffInput::open(const std::string& name, ImageSpec& spec)
 
 
 
+bool
+IffInput::open(const std::string& name, ImageSpec& spec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, spec);
+}
+
+
+
 bool
 IffInput::read_native_scanline(int /*subimage*/, int /*miplevel*/, int /*y*/,
                                int /*z*/, void* /*data*/)
@@ -173,10 +191,6 @@ IffInput::read_native_tile(int subimage, int miplevel, int x, int y, int /*z*/,
 
 bool inline IffInput::close(void)
 {
-    if (m_fd) {
-        fclose(m_fd);
-        m_fd = NULL;
-    }
     init();
     return true;
 }
@@ -192,16 +206,16 @@ IffInput::readimg()
 
     // seek pos
     // set position tile may be called randomly
-    fseek(m_fd, m_tbmp_start, SEEK_SET);
+    m_io->seek(m_tbmp_start);
 
     // resize buffer
     m_buf.resize(m_spec.image_bytes());
 
     for (unsigned int t = 0; t < m_iff_header.tiles;) {
         // get type
-        if (!fread(&type, 1, sizeof(type), m_fd) ||
+        if (m_io->read(&type, sizeof(type)) != sizeof(type) ||
             // get length
-            !fread(&size, 1, sizeof(size), m_fd))
+            m_io->read(&size, sizeof(size)) != sizeof(size))
             return false;
 
         if (littleendian())
@@ -214,10 +228,10 @@ IffInput::readimg()
             && type[3] == 'A') {
             // get tile coordinates.
             uint16_t xmin, xmax, ymin, ymax;
-            if (!fread(&xmin, 1, sizeof(xmin), m_fd)
-                || !fread(&ymin, 1, sizeof(ymin), m_fd)
-                || !fread(&xmax, 1, sizeof(xmax), m_fd)
-                || !fread(&ymax, 1, sizeof(ymax), m_fd))
+            if (m_io->read(&xmin, sizeof(xmin)) != sizeof(xmin)
+                || m_io->read(&ymin, sizeof(ymin)) != sizeof(ymin)
+                || m_io->read(&xmax, sizeof(xmax)) != sizeof(xmax)
+                || m_io->read(&ymax, sizeof(ymax)) != sizeof(ymax))
                 return false;
 
             // swap endianness
@@ -268,7 +282,7 @@ IffInput::readimg()
                 // set bytes.
                 scratch.resize(image_size);
 
-                if (!fread(&scratch[0], 1, scratch.size(), m_fd))
+                if (m_io->read(&scratch[0], scratch.size()) != scratch.size())
                     return false;
 
                 // set tile data
@@ -330,7 +344,7 @@ IffInput::readimg()
                 // set bytes.
                 scratch.resize(image_size);
 
-                if (!fread(&scratch[0], 1, scratch.size(), m_fd))
+                if (m_io->read(&scratch[0], scratch.size()) != scratch.size())
                     return false;
 
                 // set tile data
@@ -431,7 +445,7 @@ IffInput::readimg()
 
         } else {
             // skip to the next block
-            if (fseek(m_fd, chunksize, SEEK_CUR))
+            if (!m_io->seek(chunksize, SEEK_CUR))
                 return false;
         }
     }
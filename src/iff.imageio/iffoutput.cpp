@@ -27,7 +27,8 @@ OIIO_PLUGIN_EXPORTS_END
 int
 IffOutput::supports(string_view feature) const
 {
-    return (feature == "tiles" || feature == "alpha" || feature == "nchannels");
+    return (feature == "tiles" || feature == "alpha" || feature == "nchannels"
+            || feature == "ioproxy");
 }
 
 
@@ -62,7 +63,8 @@ IffOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
         return false;
     }
 
-    close();  // Close any already-opened file
+    if (m_buf.size())
+        close();  // Close any already-opened file
     // saving 'name' and 'spec' for later use
     m_filename = name;
     m_spec     = spec;
@@ -72,9 +74,17 @@ IffOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
     m_spec.tile_height = tile_height();
     m_spec.tile_depth  = 1;
 
-    m_fd = Filesystem::fopen(m_filename, "wb");
-    if (!m_fd) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", m_filename);
+        init();
         return false;
     }
 
@@ -186,7 +196,7 @@ IffOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
 inline bool
 IffOutput::close(void)
 {
-    if (m_fd && m_buf.size()) {
+    if (m_io && m_buf.size()) {
         // flip buffer to make write tile easier,
         // from tga.imageio:
 
@@ -227,7 +237,8 @@ IffOutput::close(void)
 
                 // write 'RGBA' type
                 std::string tmpstr = "RGBA";
-                if (!fwrite(tmpstr.c_str(), tmpstr.length(), 1, m_fd))
+                if (m_io->write(tmpstr.c_str(), tmpstr.length())
+                    != tmpstr.length())
                     return false;
 
                 // length.
@@ -456,7 +467,7 @@ IffOutput::close(void)
                 if (littleendian())
                     swap_endian(&length);
 
-                if (!fwrite(&length, sizeof(length), 1, m_fd))
+                if (m_io->write(&length, sizeof(length)) != sizeof(length))
                     return false;
 
                 // write xmin, xmax, ymin and ymax
@@ -467,57 +478,54 @@ IffOutput::close(void)
                     swap_endian(&ymax);
                 }
 
-                if (!fwrite(&xmin, sizeof(xmin), 1, m_fd)
-                    || !fwrite(&ymin, sizeof(ymin), 1, m_fd)
-                    || !fwrite(&xmax, sizeof(xmax), 1, m_fd)
-                    || !fwrite(&ymax, sizeof(ymax), 1, m_fd))
+                if (m_io->write(&xmin, sizeof(xmin)) != sizeof(xmin)
+                    || m_io->write(&ymin, sizeof(ymin)) != sizeof(ymin)
+                    || m_io->write(&xmax, sizeof(xmax)) != sizeof(xmax)
+                    || m_io->write(&ymax, sizeof(ymax)) != sizeof(ymax))
                     return false;
 
                 // write tile
-                if (!fwrite(&scratch[0], tile_length, 1, m_fd))
+                if (m_io->write(&scratch[0], tile_length) != tile_length)
                     return false;
             }
         }
 
         // set sizes
         uint32_t pos, tmppos;
-        pos = ftell(m_fd);
+        pos = m_io->tell();
 
         uint32_t p0 = pos - 8;
         uint32_t p1 = p0 - m_iff_header.for4_start;
 
         // set pos
         tmppos = 4;
-        fseek(m_fd, tmppos, SEEK_SET);
+        m_io->seek(tmppos);
 
         // write FOR4 <size> CIMG
         if (littleendian()) {
             swap_endian(&p0);
         }
 
-        if (!fwrite(&p0, sizeof(p0), 1, m_fd))
+        if (m_io->write(&p0, sizeof(p0)) != sizeof(p0))
             return false;
 
         // set pos
         tmppos = m_iff_header.for4_start + 4;
-        fseek(m_fd, tmppos, SEEK_SET);
+        m_io->seek(tmppos);
 
         // write FOR4 <size> TBMP
         if (littleendian()) {
             swap_endian(&p1);
         }
 
-        if (!fwrite(&p1, sizeof(p1), 1, m_fd))
+        if (m_io->write(&p1, sizeof(p1)) != sizeof(p1))
             return false;
 
         m_buf.resize(0);
         m_buf.shrink_to_fit();
     }
-    if (m_fd) {
-        // close the stream
-        fclose(m_fd);
-        m_fd = NULL;
-    }
+    // close the stream
+    init();
     return true;
 }
 
@@ -294,7 +294,18 @@ OIIOC_API void
 OIIO_DeepData_all_data(const OIIO_DeepData* dd, const char** bytes,
                        int* nbytes);
 
-/// TODO: (AL) get_pointers
+/// Fill `pointers` with the address of each channel's first sample for
+/// every pixel, laid out as `pointers[pixel * channels + channel]`, or
+/// NULL for pixels with no samples. `pointers` must have room for
+/// `pixels() * channels()` entries. Together with `all_samples()`, this
+/// gives direct access to all the deep data without a call per sample.
+/// The pointers are invalidated by any call that changes the number of
+/// samples or their capacity.
+///
+/// Equivalent C++: `dd->get_pointers(pointers)`
+///
+OIIOC_API void
+OIIO_DeepData_get_pointers(const OIIO_DeepData* dd, void** pointers);
 
 /// Copy a deep sample from `src` to this `DeepData`. They must have the
 /// same channel layout. Return `true` if ok, `false` if the operation
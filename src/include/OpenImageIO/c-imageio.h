@@ -927,6 +927,42 @@ OIIO_ImageInput_read_image(OIIO_ImageInput* ii, int subimage, int miplevel,
                            OIIO_ProgressCallback progress_callback,
                            void* progress_callback_data);
 
+/// Read an arbitrary region of the given subimage and MIP level into a
+/// buffer with the given strides, in a single call. The region need not
+/// be aligned to scanline or tile boundaries: it is expanded internally
+/// to whatever the file can deliver and only the requested pixels and
+/// channels `[roi.chbegin,roi.chend)` are copied into `data`. Strides
+/// set to AutoStride imply contiguous data in the shape of the ROI. If
+/// `roi` is NULL or undefined, the whole data window and all channels
+/// are read. `format` may be TypeUnknown to keep the native data types.
+///
+/// This lets FFI bindings transfer a whole window without looping over
+/// scanlines or tiles on their side of the boundary.
+///
+/// Equivalent C++: `ii->read_scanlines(...)` or `ii->read_tiles(...)`
+/// covering `roi`, followed by `OIIO::copy_image()` if the region was not
+/// aligned.
+///
+OIIOC_API bool
+OIIO_ImageInput_read_roi(OIIO_ImageInput* ii, int subimage, int miplevel,
+                         const OIIO_ROI* roi, OIIO_TypeDesc format, void* data,
+                         stride_t xstride, stride_t ystride, stride_t zstride);
+
+/// Read all channels of each subimage in `[subimage_begin,subimage_end)`
+/// at the given MIP level, converting to `format`. Subimage `s` is
+/// stored contiguously in `data[s - subimage_begin]`, which must be large
+/// enough to hold that subimage (see `OIIO_ImageInput_spec_dimensions()`).
+/// Returns false, with an error set on the ImageInput, as soon as any
+/// subimage fails to read.
+///
+/// Equivalent C++: `ii->read_image(s, miplevel, 0, -1, format, data[s])`
+/// for each subimage `s`.
+///
+OIIOC_API bool
+OIIO_ImageInput_read_subimages(OIIO_ImageInput* ii, int subimage_begin,
+                               int subimage_end, int miplevel,
+                               OIIO_TypeDesc format, void* const* data);
+
 /// Is there a pending error message waiting to be retrieved?
 ///
 /// Equivalent C++: `ii->has_error()`
@@ -1130,6 +1166,23 @@ OIIO_ImageOutput_write_image(OIIO_ImageOutput* io, OIIO_TypeDesc format,
                              OIIO_ProgressCallback progress_callback,
                              void* progress_callback_data);
 
+/// Open a multi-subimage file with the given name and write every
+/// subimage in one call. `specs` and `data` are arrays of `nsubimages`
+/// elements; `data[s]` holds the contiguous pixels of subimage `s` in
+/// the given `format`. The file is left open, so the caller must still
+/// call `OIIO_ImageOutput_close()`.
+///
+/// Equivalent C++: `io->open(name, nsubimages, specs)` followed by
+/// `io->write_image(format, data[s])` and
+/// `io->open(name, specs[s], AppendSubimage)` for each subimage.
+///
+OIIOC_API bool
+OIIO_ImageOutput_write_subimages(OIIO_ImageOutput* io, const char* name,
+                                 int nsubimages,
+                                 const OIIO_ImageSpec* const* specs,
+                                 OIIO_TypeDesc format,
+                                 const void* const* data);
+
 /// Write deep scanlines containing pixels (*,y,z), for all y in the
 /// range [ybegin,yend), to a deep file. This will fail if it is not a
 /// deep file.
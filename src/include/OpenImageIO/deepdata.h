@@ -61,6 +61,13 @@ public:
     /// inexpensive to call set_capacity().
     bool allocated() const;
 
+    /// Allocate the sample storage for the capacities set so far, if that
+    /// hasn't already happened. Any access to the sample data does this
+    /// implicitly, but calling it before handing pixels to several threads
+    /// makes sure that it isn't done by one of them while others are
+    /// already changing their pixels.
+    void allocate();
+
     /// Retrieve the total number of pixels.
     int64_t pixels() const;
     /// Retrieve the number of channels.
@@ -106,6 +113,13 @@ public:
 
     /// Set the capacity of samples for the given pixel. This must be called
     /// after init().
+    ///
+    /// Growing a pixel's capacity (which `set_samples()` and
+    /// `insert_samples()` also do when they need more room) may move the
+    /// samples of other nearby pixels. So different threads may work on
+    /// the samples of different pixels at the same time only if no
+    /// capacity grows meanwhile, for example because enough was reserved
+    /// up front with `set_capacity()` or `set_all_samples()`.
     void set_capacity(int64_t pixel, int samps);
 
     /// Retrieve the capacity (number of allocated samples) for the given
@@ -145,6 +159,14 @@ public:
 
     cspan<TypeDesc> all_channeltypes() const;
     cspan<unsigned int> all_samples() const;
+    /// Return all the sample data (including any unused capacity of each
+    /// pixel) contiguously, in pixel order. The samples are not stored
+    /// this way internally, so each call refreshes a flattened copy held
+    /// by the `DeepData` and returns a view of it. The contents are a
+    /// snapshot that does not track later changes to the samples, but the
+    /// buffer stays at the same address across calls unless the total
+    /// capacity grows, and it is freed by `clear()`, `free()`, `init()`,
+    /// or destruction of the `DeepData`.
     cspan<char> all_data() const;
 
     /// Fill in the vector with pointers to the start of the first
@@ -127,6 +127,13 @@ OIIO_UTIL_API bool get_directory_entries (const std::string &dirname,
 OIIO_UTIL_API bool path_is_absolute (string_view path,
                                 bool dot_is_absolute=false);
 
+/// Return an absolute path for `path` with symbolic links, "." and ".."
+/// resolved, so that different spellings of the same file compare equal.
+/// The file itself need not exist: the longest leading part of the path
+/// that does is resolved, and the rest appended with "." and ".." applied.
+/// If the path can't be resolved, return it unchanged.
+OIIO_UTIL_API std::string canonical_path (string_view path) noexcept;
+
 /// Return true if the file exists.
 ///
 OIIO_UTIL_API bool exists (string_view path) noexcept;
@@ -336,6 +343,13 @@ OIIO_UTIL_API bool scan_for_matching_filenames (const std::string &pattern,
 class OIIO_UTIL_API IOProxy {
 public:
     enum Mode { Closed = 0, Read = 'r', Write = 'w' };
+    // One read of a pread_batch().
+    struct ReadRequest {
+        void* buf      = nullptr;  // Where to put the data
+        size_t size    = 0;        // Number of bytes to read
+        int64_t offset = 0;        // Position in the file to read from
+        size_t nread   = 0;        // Set to the number of bytes read
+    };
     IOProxy () {}
     IOProxy (string_view filename, Mode mode)
         : m_filename(filename), m_mode(mode) {}
@@ -351,8 +365,22 @@ public:
     // position, and are thread-safe (against each other).
     virtual size_t pread (void *buf, size_t size, int64_t offset);
     virtual size_t pwrite (const void *buf, size_t size, int64_t offset);
+    // Perform a batch of independent preads, which a proxy may issue
+    // concurrently (the default just does them one after another). Sets
+    // each request's nread, and returns true if every request was read in
+    // full. Like pread(), it doesn't alter the current position.
+    virtual bool pread_batch (span<ReadRequest> requests);
     virtual size_t size () const { return 0; }
     virtual void flush () const { }
+    // If the contents are directly addressable in memory (IOMemReader,
+    // IOMMap), return a pointer to the `size` bytes starting at `offset`,
+    // letting a reader use the data in place rather than copying it. Return
+    // nullptr if the proxy isn't memory-backed or the range is out of
+    // bounds. The pointer is valid until the proxy is closed. Like pread(),
+    // this does not alter the current position and is thread-safe.
+    virtual const void* mapped (int64_t /*offset*/, size_t /*size*/) const {
+        return nullptr;
+    }
 
     Mode mode () const { return m_mode; }
     const std::string& filename () const { return m_filename; }
@@ -414,6 +442,30 @@ protected:
 };
 
 
+/// IOFile subclass for reading that, on Linux when OIIO was built with
+/// liburing, submits all the reads of a pread_batch() to an io_uring at
+/// once, so that scattered reads (for example of a file's tiles or
+/// chunks, over a high-latency network file system) overlap rather than
+/// wait on each other. Elsewhere it behaves exactly like IOFile.
+class OIIO_UTIL_API IOUringFile : public IOFile {
+public:
+    // Open the file for reading, with up to `queue_depth` reads in flight.
+    IOUringFile(string_view filename, int queue_depth = 64);
+    virtual ~IOUringFile();
+    virtual const char* proxytype() const { return "uring"; }
+    virtual void close();
+    virtual bool pread_batch(span<ReadRequest> requests);
+
+    // Is io_uring actually being used (vs falling back to serial reads)?
+    bool async() const { return m_ring != nullptr; }
+
+protected:
+    void* m_ring = nullptr;  // struct io_uring*, if we have one
+    int m_queue_depth;
+    std::mutex m_ring_mutex;  // A ring is not safe for concurrent use
+};
+
+
 /// IOProxy subclass for writing that wraps a std::vector<char> that will
 /// grow as we write.
 class OIIO_UTIL_API IOVecOutput : public IOProxy {
@@ -469,6 +521,8 @@ public:
     virtual size_t pread(void* buf, size_t size, int64_t offset);
     virtual size_t size() const { return m_buf.size(); }
 
+    virtual const void* mapped(int64_t offset, size_t size) const;
+
     // Access the buffer (caveat emptor)
     cspan<unsigned char> buffer() const noexcept { return m_buf; }
 
@@ -476,6 +530,49 @@ protected:
     cspan<unsigned char> m_buf;
 };
 
+
+
+/// IOProxy subclass for reading a file by memory-mapping it. Reads are
+/// plain copies out of the mapping (no system calls or stdio buffering),
+/// and readers that use mapped() can decode straight from the mapped
+/// pages. The file should not be truncated while it is mapped.
+class OIIO_UTIL_API IOMMap : public IOProxy {
+public:
+    // Hints about how the mapped data will be accessed.
+    enum Advice { Normal, Sequential, Random, WillNeed };
+
+    // Open and map the file. If that fails, mode() will be Closed and
+    // error() will say why.
+    IOMMap(string_view filename, Advice advice = Sequential);
+    virtual ~IOMMap();
+    virtual const char* proxytype() const { return "mmap"; }
+    virtual void close();
+    virtual bool seek(int64_t offset)
+    {
+        m_pos = offset;
+        return true;
+    }
+    virtual size_t read(void* buf, size_t size);
+    virtual size_t pread(void* buf, size_t size, int64_t offset);
+    virtual size_t size() const { return m_size; }
+    virtual const void* mapped(int64_t offset, size_t size) const;
+
+    // Pass an access hint for the given byte range (all of the file past
+    // `offset` if `size` is 0) to the OS. Only a hint, so there is no
+    // error if it is not supported.
+    void advise(Advice advice, int64_t offset = 0, size_t size = 0);
+
+    // Access the mapped file (caveat emptor)
+    cspan<unsigned char> buffer() const noexcept
+    {
+        return cspan<unsigned char>(m_data, m_size);
+    }
+
+protected:
+    const unsigned char* m_data = nullptr;
+    size_t m_size               = 0;
+};
+
 };  // namespace Filesystem
 
 OIIO_NAMESPACE_END
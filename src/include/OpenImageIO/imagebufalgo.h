@@ -20,6 +20,7 @@
 #include <OpenImageIO/parallel.h>
 #include <OpenImageIO/span.h>
 
+#include <functional>
 #include <limits>
 
 #if !defined(__OPENCV_CORE_TYPES_H__) && !defined(OPENCV_CORE_TYPES_H)
@@ -2234,6 +2235,41 @@ bool OIIO_API deep_holdout (ImageBuf &dst, const ImageBuf &src,
                             ROI roi={}, int nthreads=0);
 
 
+/// Apply `op` to deep images from `inputs` and write the results to `out`,
+/// a horizontal strip at a time, without ever reading any of the images
+/// whole. Only one strip of each image is in memory at once, so the memory
+/// needed is bounded by the strip size rather than by the number of samples
+/// in the frame.
+///
+/// Each of `inputs` must be an open deep image, positioned at the desired
+/// subimage and MIP level, and they must all have the same (2D) data
+/// window. For each strip of `striprows` scanlines (rounded up to whole
+/// rows of tiles, if any of the files are tiled), that strip of every input
+/// is read into a deep ImageBuf whose data window is just the strip, and
+/// `op(dst, src)` is called with `src` holding those strips (in the same
+/// order as `inputs`) and `dst` an uninitialized ImageBuf. Typically `op`
+/// just calls one of the functions above, for example:
+///
+///     [](ImageBuf &dst, cspan<ImageBuf> src) {
+///         return ImageBufAlgo::deep_merge (dst, src[0], src[1]);
+///     }
+///
+/// The resulting `dst` strip, deep or flat, is then written to `out`,
+/// which must already be open, with the same data window as the inputs.
+///
+/// This only makes sense for operations in which each result pixel depends
+/// only on the same pixel of the inputs, such as `flatten()`,
+/// `deep_merge()`, `deep_holdout()`, or the per-pixel DeepData methods
+/// like `occlusion_cull()`.
+///
+/// Return true on success, or false if any read, `op`, or write failed, in
+/// which case the error message may be retrieved from `out->geterror()`.
+bool OIIO_API deep_stream (ImageOutput *out, cspan<ImageInput*> inputs,
+                           const std::function<bool(ImageBuf &dst,
+                                                    cspan<ImageBuf> src)> &op,
+                           int striprows = 64);
+
+
 
 
 ///////////////////////////////////////////////////////////////////////
@@ -24,6 +24,31 @@ using std::placeholders::_1;
 
 namespace ImageBufAlgo {
 
+/// Tile grid for Split_Tile decomposition, typically that of the source
+/// image so that no two threads work on the same tile at once. A zero tile
+/// size lets parallel_image choose one. (This is kept apart from
+/// parallel_image_options so that the layout of that class, which is
+/// passed by value to library functions, stays the same.)
+struct parallel_tile_grid {
+    int tilewidth     = 0;        // Tile size in x
+    int tileheight    = 0;        // Tile size in y
+    int tilexorigin   = 0;        // x coordinate of a tile corner
+    int tileyorigin   = 0;        // y coordinate of a tile corner
+    size_t tilebytes  = 0;        // Memory used by one tile (0 = unknown)
+    size_t cachebytes = 0;        // Cache budget for all threads' tiles
+                                  //   (0 = unlimited)
+};
+
+
+
+// Split_Tile implementation of parallel_image(): the ROI is cut along
+// `grid`, and threads claim groups of adjacent tiles, in Morton order,
+// until none are left. Implementation is in imagebufalgo.cpp.
+OIIO_API void
+parallel_image_tiles (ROI roi, const parallel_image_options& opt,
+                      const parallel_tile_grid& grid,
+                      std::function<void(ROI)> f);
+
 
 
 /// Helper template for generalized multithreading for image processing
@@ -36,7 +61,10 @@ namespace ImageBufAlgo {
 /// made. The default is Split_Y (vertical splits), which generally seems
 /// the fastest (due to cache layout issues?), but perhaps there are
 /// algorithms where it's better to split in X, Z, or along the longest
-/// axis.
+/// axis. Split_Tile calls f once per tile of `grid` (see
+/// parallel_options_for()), which is much kinder to the ImageCache than
+/// slabs when the source is cached or tiled. The grid is ignored by the
+/// other split directions.
 ///
 /// Most image operations will require additional arguments, including
 /// additional input and output images or other parameters.  The
@@ -50,7 +78,7 @@ namespace ImageBufAlgo {
 ///     parallel_image (bind(my_image_op,ref(R), cref(A),3.14,_1), roi);
 inline void
 parallel_image (ROI roi, parallel_image_options opt,
-                std::function<void(ROI)> f)
+                const parallel_tile_grid& grid, std::function<void(ROI)> f)
 {
     opt.resolve ();
     // Try not to assign a thread less than 16k pixels, or it's not worth
@@ -63,6 +91,11 @@ parallel_image (ROI roi, parallel_image_options opt,
         return;
     }
 
+    if (opt.splitdir == Split_Tile) {
+        parallel_image_tiles (roi, opt, grid, f);
+        return;
+    }
+
     // If splitdir was not explicit, find the longest edge.
     SplitDir splitdir = opt.splitdir;
     if (splitdir == Split_Biggest)
@@ -75,9 +108,6 @@ parallel_image (ROI roi, parallel_image_options opt,
     } else if (splitdir == Split_X) {
         ychunk = roi.height();
         // ychunk = std::max (64, minitems/xchunk);
-    } else if (splitdir == Split_Tile) {
-        int64_t n = std::min<imagesize_t>(opt.minitems, roi.npixels());
-        xchunk = ychunk = std::max (1, int(std::sqrt(n))/4);
     } else {
         xchunk = ychunk = std::max (int64_t(1), int64_t(std::sqrt(opt.maxthreads))/2);
     }
@@ -92,6 +122,14 @@ parallel_image (ROI roi, parallel_image_options opt,
 }
 
 
+inline void
+parallel_image (ROI roi, parallel_image_options opt,
+                std::function<void(ROI)> f)
+{
+    parallel_image (roi, opt, parallel_tile_grid(), f);
+}
+
+
 inline void
 parallel_image (ROI roi, std::function<void(ROI)> f)
 {
@@ -100,6 +138,19 @@ parallel_image (ROI roi, std::function<void(ROI)> f)
 
 
 
+/// Return parallel_image options suited to an operation that reads `src`
+/// with up to `nthreads` threads. If `src` is backed by the ImageCache and
+/// its file is tiled (or autotiled), this selects Split_Tile and sets
+/// `grid` to `src`'s tiles, with the tile memory and the cache's memory
+/// budget filled in so that the threads' combined working set stays well
+/// within the cache. Otherwise it is the usual Split_Y decomposition and
+/// `grid` is left alone. Pass both to parallel_image().
+OIIO_API parallel_image_options
+parallel_options_for (const ImageBuf& src, parallel_tile_grid& grid,
+                      int nthreads = 0);
+
+
+
 // DEPRECATED(1.8) -- eventually enable the OIIO_DEPRECATION
 template <class Func>
 // OIIO_DEPRECATED("switch to new parallel_image (1.8)")
@@ -210,6 +210,43 @@ public:
     ///           enabled, this reduces the number of file opens, at the
     ///           expense of not being able to open files if their format do
     ///           not actually match their filename extension). Default: 0
+    /// - `float max_compressed_memory_MB` :
+    ///           When nonzero, tiles that are evicted from the in-memory
+    ///           tile cache are compressed and kept in memory, up to this
+    ///           many MB of compressed data, and are decompressed (rather
+    ///           than reread from the file) if they are needed again. For
+    ///           memory-bound uses, this can greatly increase how much of
+    ///           the working set fits in memory. Tiles that don't compress
+    ///           well are simply discarded as usual. (Default: 0, meaning
+    ///           evicted tiles are not kept in compressed form.)
+    /// - `string diskcache` :
+    ///           When set to a file path, tiles that are evicted from the
+    ///           in-memory tile cache are saved (already decoded) in this
+    ///           memory-mapped file, which is checked before going back to
+    ///           the original image file when the tile is needed again.
+    ///           This is useful when the images live on slow or shared
+    ///           network storage and the cache file is on a fast local
+    ///           disk. The contents persist across runs, so the same file
+    ///           may be used by successive processes (but only one process
+    ///           may use it at a time). The default is "", meaning no disk
+    ///           cache.
+    /// - `float max_diskcache_MB` :
+    ///           The size of the disk cache, in MB. When it is full, the
+    ///           least recently stored tiles are overwritten. Changing the
+    ///           size of an existing cache file discards its contents.
+    ///           (Default: 1024.0 MB)
+    ///
+    /// - `int numa` :
+    ///           If nonzero, on machines with more than one NUMA node, the
+    ///           pixels of each tile are placed in the memory of the node
+    ///           whose thread read the tile, and each node is held to an
+    ///           equal share of `max_memory_MB`. (Default: 0)
+    ///
+    /// - `int numa_replicate` :
+    ///           In NUMA mode, if nonzero, a tile that is looked up this
+    ///           many times from threads on a node other than its own gets
+    ///           a copy on that node, so that those threads stop reading it
+    ///           remotely. Zero means never make copies. (Default: 0)
     ///
     /// - `string options`
     ///           This catch-all is simply a comma-separated list of
@@ -254,6 +291,33 @@ public:
     ///           opened (at the time of the query), and the peak number of
     ///           files opened at any time.
     ///
+    /// - `int64 stat:compressed_memory_used` ,
+    ///   `int64 stat:compressed_tiles_hits` :
+    ///           Bytes currently used for compressed tiles, and the number
+    ///           of tiles that were found in compressed form rather than
+    ///           being reread from their files.
+    ///
+    /// - `int64 stat:diskcache_hits` ,
+    ///   `int64 stat:diskcache_misses` ,
+    ///   `int64 stat:diskcache_writes` :
+    ///           Number of tiles found in the disk cache, number of tiles
+    ///           looked for there but not found, and the number of evicted
+    ///           tiles written to it (all zero if there is no disk cache).
+    ///
+    /// - `int64 stat:numa_replicas` :
+    ///           Number of NUMA node replicas of tiles that were created.
+    ///
+    /// - `int64 stat:numa_remote_uses` :
+    ///           Number of tile lookups served from another NUMA node's
+    ///           memory. Asking for an `int64[n]` array gives the count for
+    ///           each of the first n nodes, by the node of the thread doing
+    ///           the lookup.
+    ///
+    /// - `int64 stat:file_snapshot_entries` :
+    ///           Total number of entries in all the lock-free snapshots of
+    ///           the file name table that the cache has published, which
+    ///           are kept until it is destroyed.
+    ///
     /// - `int stat:find_tile_calls` :
     ///           Number of times a filename was looked up in the file cache.
     ///
@@ -953,6 +953,11 @@ public:
     /// - `"ioproxy"` :
     ///       Does this format reader support reading from an `IOProxy`?
     ///
+    /// - `"mmap"` :
+    ///       Does this format reader honor the `"oiio:mmap"` configuration
+    ///       hint (memory-mapping the file with `Filesystem::IOMMap`), and
+    ///       decode directly from memory-backed proxies where it can?
+    ///
     /// This list of queries may be extended in future releases. Since this
     /// can be done simply by recognizing new query strings, and does not
     /// require any new API entry points, addition of support for new
@@ -2480,6 +2485,15 @@ OIIO_API std::string geterror(bool clear = true);
 ///    may not read these correctly, but OIIO will. That's why the default
 ///    is not to support it.
 ///
+/// - `int io_uring`
+///
+///    When nonzero, readers that fetch many chunks of a file at once
+///    (currently OpenEXR, when using the OpenEXR Core library) open files
+///    with a `Filesystem::IOUringFile` proxy, which on Linux issues those
+///    reads concurrently through io_uring. This mostly helps files on
+///    high-latency network file systems. It has no effect if OIIO was not
+///    built with liburing. The default is 0.
+///
 /// - `int log_times`
 ///
 ///    When the `"log_times"` attribute is nonzero, `ImageBufAlgo` functions
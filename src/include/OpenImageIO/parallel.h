@@ -20,7 +20,9 @@
 
 OIIO_NAMESPACE_BEGIN
 
-/// Split strategies
+/// Split strategies. Split_Tile divides an image region along a grid of
+/// tiles (see ImageBufAlgo::parallel_tile_grid), which threads claim in
+/// groups as they become free, visiting them in Morton (Z curve) order.
 enum SplitDir { Split_X, Split_Y, Split_Z, Split_Biggest, Split_Tile };
 
 
@@ -47,7 +49,7 @@ public:
     // * If no pool was specified, use the default pool.
     // * If no max thread count was specified, use the pool size.
     // * If the calling thread is itself in the pool and the recursive flag
-    //   was not turned on, just use one thread.
+    //   was turned off, just use one thread.
     void resolve()
     {
         if (pool == nullptr)
@@ -62,7 +64,7 @@ public:
 
     int maxthreads    = 0;        // Max threads (0 = use all)
     SplitDir splitdir = Split_Y;  // Primary split direction
-    bool recursive    = false;    // Allow thread pool recursion
+    bool recursive    = true;     // Allow thread pool recursion
     size_t minitems   = 16384;    // Min items per task
     thread_pool* pool = nullptr;  // If non-NULL, custom thread pool
     string_view name;             // For debugging
@@ -91,6 +91,18 @@ hardware_concurrency();
 OIIO_API unsigned int
 physical_concurrency();
 
+/// Number of NUMA nodes (memory domains) on this machine. Returns 1 if it
+/// isn't a NUMA machine or if the topology can't be determined on this
+/// platform (currently it's only known on Linux).
+OIIO_API int
+numa_nodes();
+
+/// Return the NUMA node of the CPU that the calling thread is running on
+/// at this moment, in the range [0, numa_nodes()). Returns 0 if it can't
+/// be determined.
+OIIO_API int
+current_numa_node();
+
 /// Get the maximum number of open file handles allowed on this system.
 OIIO_API size_t
 max_open_files();
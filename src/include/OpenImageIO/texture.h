@@ -524,6 +524,21 @@ public:
     /// - `int max_errors_per_file` :
     ///             Limits how many errors to issue for each file. (default:
     ///             100)
+    /// - `float max_compressed_memory_MB` :
+    ///             If nonzero, memory to use for keeping evicted tiles in
+    ///             compressed form. (default: 0)
+    /// - `string diskcache` :
+    ///             If supplied, a file used as a persistent second-level
+    ///             cache for tiles evicted from memory.
+    /// - `float max_diskcache_MB` :
+    ///             Size of the disk cache, in MB. (default: 1024)
+    /// - `int numa` :
+    ///             If nonzero, place tiles in the memory of the NUMA node
+    ///             that reads them, with per-node memory budgets.
+    ///             (default: 0)
+    /// - `int numa_replicate` :
+    ///             In NUMA mode, copy a tile to another node after this
+    ///             many lookups from that node (0 = never). (default: 0)
     ///
     /// Texture-specific settings:
     /// - `matrix44 worldtocommon` / `matrix44 commontoworld` :
@@ -571,6 +586,12 @@ public:
     /// - `int flip_t` :
     ///             If nonzero, `t` coordinates will be flipped `1-t` for
     ///             all texture lookups. The default is 0.
+    /// - `string trace_file` :
+    ///             If supplied, every 2D texture lookup (file, options,
+    ///             coordinates, derivatives, and calling thread) is
+    ///             recorded to this file in a compact binary form, which
+    ///             `testtex --replay` can play back as a benchmark. Setting
+    ///             it to the empty string finishes the trace.
     ///
     /// - `string options`
     ///             This catch-all is simply a comma-separated list of
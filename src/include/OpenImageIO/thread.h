@@ -591,8 +591,13 @@ private:
 
 
 
-/// thread_pool is a persistent set of threads watching a queue to which
-/// tasks can be submitted.
+/// thread_pool is a persistent set of threads that run tasks submitted to
+/// it. Each worker thread has its own queue: tasks a worker submits (for
+/// example, by calling parallel_for from inside a task) go on its own queue
+/// and it runs the newest ones first, while idle workers steal the oldest
+/// tasks from the other queues. Tasks submitted by threads outside the
+/// pool go on a shared queue that every worker takes from. This lets
+/// parallel work nest without the nested part collapsing to one thread.
 ///
 /// Call default_thread_pool() to retrieve a pointer to a single shared
 /// thread_pool that will be initialized the first time it's needed, running
@@ -718,6 +723,19 @@ public:
     /// should be passed.
     bool run_one_task(std::thread::id id);
 
+    /// If any tasks that the calling thread submitted after its `since`'th
+    /// submission are still queued, pull the most recent one off and run
+    /// it (on this calling thread) and return true. Otherwise, return false
+    /// immediately. This is how a thread waiting on a task_set helps with
+    /// its own tasks, without picking up unrelated work that might need
+    /// resources it is holding.
+    bool run_own_task(uint64_t since);
+
+    /// Return how many tasks the calling thread has submitted so far, to
+    /// any pool. task_set records this when it is created, for use with
+    /// run_own_task().
+    static uint64_t submission_count();
+
     /// Return true if the calling thread is part of the thread pool. This
     /// can be used to limit a pool thread from unadvisedly adding its own
     /// subtasks to clog up the pool.
@@ -798,6 +816,7 @@ public:
     task_set(thread_pool* pool = nullptr)
         : m_pool(pool ? pool : default_thread_pool())
         , m_submitter_thread(std::this_thread::get_id())
+        , m_first_submission(thread_pool::submission_count())
     {
     }
     ~task_set() { wait(); }
@@ -829,7 +848,9 @@ public:
     // Wait for all tasks in the set to finish. If block == true, fully
     // block while waiting for the pool threads to all finish. If block is
     // false, then busy wait, and opportunistically run queue tasks yourself
-    // while you are waiting for other tasks to finish.
+    // while you are waiting for other tasks to finish. When the waiting
+    // thread is itself running pool work, it only runs tasks it submitted
+    // since this task_set was created, so waits can nest safely.
     void wait(bool block = false);
 
     // Debugging sanity check, called after wait(), to ensure that all the
@@ -842,8 +863,12 @@ public:
     }
 
 private:
+    // Run one queued task that the waiting thread may help with, if any.
+    bool help(bool nested);
+
     thread_pool* m_pool;
     std::thread::id m_submitter_thread;
+    uint64_t m_first_submission;
     std::vector<std::future<void>> m_futures;
 };
 
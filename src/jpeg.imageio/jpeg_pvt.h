@@ -60,6 +60,8 @@ public:
                       const ImageSpec& config) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                       int yend, int z, void* data) override;
     virtual bool close() override;
     virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
     {
@@ -83,6 +85,7 @@ private:
     std::string m_filename;
     int m_next_scanline;   // Which scanline is the next to read?
     bool m_raw;            // Read raw coefficients, not scanlines
+    int m_scale;           // Decode at 1/m_scale resolution (1, 2, 4, 8)
     bool m_cmyk;           // The input file is cmyk
     bool m_fatalerr;       // JPEG reader hit a fatal error
     bool m_decomp_create;  // Have we created the decompressor?
@@ -98,6 +101,7 @@ private:
     {
         m_fd            = NULL;
         m_raw           = false;
+        m_scale         = 1;
         m_cmyk          = false;
         m_fatalerr      = false;
         m_decomp_create = false;
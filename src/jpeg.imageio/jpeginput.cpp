@@ -168,7 +168,11 @@ JpgInput::open(const std::string& name, ImageSpec& newspec,
 {
     auto p = config.find_attribute("_jpeg:raw", TypeInt);
     m_raw  = p && *(int*)p->data();
-    p      = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    // libjpeg can shrink by 2, 4, or 8 as part of the inverse DCT, which is
+    // much cheaper than decoding at full resolution and resizing.
+    int scale = config.get_int_attribute("jpeg:scale", 1);
+    m_scale   = scale >= 8 ? 8 : scale >= 4 ? 4 : scale >= 2 ? 2 : 1;
+    p         = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
     if (p)
         m_io = p->get<Filesystem::IOProxy*>();
     m_config.reset(new ImageSpec(config));  // save config spec
@@ -263,6 +267,11 @@ JpgInput::open(const std::string& name, ImageSpec& newspec)
         m_cmyk                  = true;
     }
 
+    if (m_scale > 1 && !m_raw) {
+        m_cinfo.scale_num   = 1;
+        m_cinfo.scale_denom = m_scale;
+    }
+
     if (m_raw)
         m_coeffs = jpeg_read_coefficients(&m_cinfo);
     else
@@ -276,6 +285,8 @@ JpgInput::open(const std::string& name, ImageSpec& newspec)
 
     // Assume JPEG is in sRGB unless the Exif or XMP tags say otherwise.
     m_spec.attribute("oiio:ColorSpace", "sRGB");
+    if (m_scale > 1 && !m_raw)
+        m_spec.attribute("jpeg:scale", m_scale);
 
     if (m_cinfo.jpeg_color_space == JCS_CMYK)
         m_spec.attribute("jpeg:ColorSpace", "CMYK");
@@ -336,6 +347,11 @@ JpgInput::open(const std::string& name, ImageSpec& newspec)
         case 1: m_spec.attribute("ResolutionUnit", "in"); break;
         case 2: m_spec.attribute("ResolutionUnit", "cm"); break;
         }
+        if (m_scale > 1 && !m_raw) {
+            // The reduced image covers the same physical area
+            m_spec.attribute("XResolution", xdensity / m_scale);
+            m_spec.attribute("YResolution", ydensity / m_scale);
+        }
     }
 
     read_icc_profile(&m_cinfo, m_spec);  /// try to read icc profile
@@ -487,6 +503,47 @@ JpgInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
 
 
 
+bool
+JpgInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                int yend, int z, void* data)
+{
+    lock_guard lock(*this);
+    yend = std::min(yend, int(m_cinfo.output_height));
+    // CMYK needs a conversion pass for each row, so just let the single
+    // scanline reader handle it.
+    if (m_cmyk || yend - ybegin < 2)
+        return ImageInput::read_native_scanlines(subimage, miplevel, ybegin,
+                                                 yend, z, data);
+
+    // The first scanline takes care of seeking and rewinding.
+    if (!read_native_scanline(subimage, miplevel, ybegin, z, data))
+        return false;
+
+    // Then libjpeg can decode the rest straight into the caller's buffer,
+    // several rows per call.
+    size_t ystride = m_spec.scanline_bytes();
+    std::vector<JSAMPROW> rows(yend - ybegin - 1);
+    for (size_t i = 0; i < rows.size(); ++i)
+        rows[i] = (JSAMPROW)((char*)data + (i + 1) * ystride);
+    if (setjmp(m_jerr.setjmp_buffer)) {
+        // Jump to here if there's a libjpeg internal error
+        return false;
+    }
+    for (size_t done = 0; done < rows.size();) {
+        JDIMENSION n = jpeg_read_scanlines(&m_cinfo, &rows[done],
+                                           JDIMENSION(rows.size() - done));
+        if (n == 0 || m_fatalerr) {
+            errorf("JPEG failed scanline read (\"%s\")", filename());
+            return false;
+        }
+        done += n;
+        m_next_scanline += n;
+    }
+    return true;
+}
+
+
+
 bool
 JpgInput::close()
 {
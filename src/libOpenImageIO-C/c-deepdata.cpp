@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio
 
+#include <algorithm>
+#include <vector>
+
 #include <OpenImageIO/deepdata.h>
 #include <OpenImageIO/fmath.h>
 #include <OpenImageIO/strutil.h>
@@ -335,6 +338,16 @@ OIIO_DeepData_all_data(const OIIO_DeepData* dd, const char** bytes, int* nbytes)
 
 
 
+void
+OIIO_DeepData_get_pointers(const OIIO_DeepData* dd, void** pointers)
+{
+    std::vector<void*> ptrs;
+    to_cpp(dd)->get_pointers(ptrs);
+    std::copy(ptrs.begin(), ptrs.end(), pointers);
+}
+
+
+
 bool
 OIIO_DeepData_copy_deep_sample(OIIO_DeepData* dd, int64_t pixel, int sample,
                                const OIIO_DeepData* src, int64_t srcpixel,
@@ -2,7 +2,10 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio
 
+#include <algorithm>
 #include <limits>
+#include <memory>
+#include <vector>
 
 #include <OpenImageIO/deepdata.h>
 #include <OpenImageIO/filesystem.h>
@@ -892,6 +895,107 @@ OIIO_ImageInput_read_image(OIIO_ImageInput* ii, int subimage, int miplevel,
 
 
 
+bool
+OIIO_ImageInput_read_roi(OIIO_ImageInput* ii, int subimage, int miplevel,
+                         const OIIO_ROI* roi, OIIO_TypeDesc format, void* data,
+                         stride_t xstride, stride_t ystride, stride_t zstride)
+{
+    OIIO::ImageInput* in = to_cpp(ii);
+    OIIO::ImageSpec spec = in->spec_dimensions(subimage, miplevel);
+    if (spec.undefined())
+        return false;  // spec_dimensions already set the error
+    if (spec.deep) {
+        in->errorfmt("read_roi is not supported for deep images");
+        return false;
+    }
+    OIIO::ROI r = (roi && OIIO_ROI_defined(roi))
+                      ? bit_cast<OIIO_ROI, OIIO::ROI>(*roi)
+                      : spec.roi();
+    if (!spec.roi().contains(r) || r.nchannels() < 1) {
+        in->errorfmt(
+            "read_roi: region [{},{})x[{},{})x[{},{}) ch [{},{}) is not "
+            "contained in the data window",
+            r.xbegin, r.xend, r.ybegin, r.yend, r.zbegin, r.zend, r.chbegin,
+            r.chend);
+        return false;
+    }
+
+    OIIO::TypeDesc fmt = bit_cast<OIIO_TypeDesc, OIIO::TypeDesc>(format);
+    stride_t pixelsize = fmt.is_unknown()
+                             ? stride_t(
+                                 spec.pixel_bytes(r.chbegin, r.chend, true))
+                             : stride_t(fmt.size() * r.nchannels());
+    OIIO::ImageSpec::auto_stride(xstride, ystride, zstride, pixelsize, 1,
+                                 r.width(), r.height());
+
+    // Expand the region to what the file can deliver in one call: whole
+    // scanlines, or whole tiles. The offsets from the data window origin
+    // are never negative, so integer division rounds them down.
+    OIIO::ROI f = r;
+    if (spec.tile_width) {
+        int tw   = spec.tile_width;
+        int th   = spec.tile_height;
+        int td   = std::max(1, spec.tile_depth);
+        f.xbegin = spec.x + (r.xbegin - spec.x) / tw * tw;
+        f.ybegin = spec.y + (r.ybegin - spec.y) / th * th;
+        f.zbegin = spec.z + (r.zbegin - spec.z) / td * td;
+        f.xend   = std::min(spec.x + OIIO::round_to_multiple(r.xend - spec.x, tw),
+                            spec.x + spec.width);
+        f.yend   = std::min(spec.y + OIIO::round_to_multiple(r.yend - spec.y, th),
+                            spec.y + spec.height);
+        f.zend   = std::min(spec.z + OIIO::round_to_multiple(r.zend - spec.z, td),
+                            spec.z + spec.depth);
+    } else {
+        f.xbegin = spec.x;
+        f.xend   = spec.x + spec.width;
+    }
+
+    auto readblock = [&](void* buf, stride_t xs, stride_t ys, stride_t zs) {
+        if (spec.tile_width)
+            return in->read_tiles(subimage, miplevel, f.xbegin, f.xend,
+                                  f.ybegin, f.yend, f.zbegin, f.zend,
+                                  r.chbegin, r.chend, fmt, buf, xs, ys, zs);
+        for (int z = f.zbegin; z < f.zend; ++z)
+            if (!in->read_scanlines(subimage, miplevel, f.ybegin, f.yend, z,
+                                    r.chbegin, r.chend, fmt,
+                                    (char*)buf + (z - f.zbegin) * zs, xs, ys))
+                return false;
+        return true;
+    };
+
+    // Aligned requests go straight into the caller's buffer.
+    if (f == r)
+        return readblock(data, xstride, ystride, zstride);
+
+    stride_t fx = pixelsize, fy = fx * f.width(), fz = fy * f.height();
+    std::unique_ptr<char[]> buf(new char[fz * f.depth()]);
+    if (!readblock(buf.get(), fx, fy, fz))
+        return false;
+    const char* origin = buf.get() + (r.xbegin - f.xbegin) * fx
+                         + (r.ybegin - f.ybegin) * fy
+                         + (r.zbegin - f.zbegin) * fz;
+    return OIIO::copy_image(1, r.width(), r.height(), r.depth(), origin,
+                            pixelsize, fx, fy, fz, data, xstride, ystride,
+                            zstride);
+}
+
+
+
+bool
+OIIO_ImageInput_read_subimages(OIIO_ImageInput* ii, int subimage_begin,
+                               int subimage_end, int miplevel,
+                               OIIO_TypeDesc format, void* const* data)
+{
+    OIIO::TypeDesc fmt = bit_cast<OIIO_TypeDesc, OIIO::TypeDesc>(format);
+    for (int s = subimage_begin; s < subimage_end; ++s)
+        if (!to_cpp(ii)->read_image(s, miplevel, 0, -1, fmt,
+                                    data[s - subimage_begin]))
+            return false;
+    return true;
+}
+
+
+
 bool
 OIIO_ImageInput_read_native_deep_scanlines(OIIO_ImageInput* ii, int subimage,
                                            int miplevel, int ybegin, int yend,
@@ -1183,6 +1287,38 @@ OIIO_ImageOutput_write_image(OIIO_ImageOutput* io, OIIO_TypeDesc format,
 
 
 
+bool
+OIIO_ImageOutput_write_subimages(OIIO_ImageOutput* io, const char* name,
+                                 int nsubimages,
+                                 const OIIO_ImageSpec* const* specs,
+                                 OIIO_TypeDesc format, const void* const* data)
+{
+    OIIO::ImageOutput* out = to_cpp(io);
+    if (nsubimages < 1) {
+        out->errorfmt("write_subimages: no subimages to write");
+        return false;
+    }
+    std::vector<OIIO::ImageSpec> allspecs;
+    allspecs.reserve(nsubimages);
+    for (int s = 0; s < nsubimages; ++s)
+        allspecs.push_back(*to_cpp(specs[s]));
+    std::string sname(name);
+    if (!out->open(sname, nsubimages, allspecs.data()))
+        return false;
+    OIIO::TypeDesc fmt = bit_cast<OIIO_TypeDesc, OIIO::TypeDesc>(format);
+    for (int s = 0; s < nsubimages; ++s) {
+        if (s > 0
+            && !out->open(sname, allspecs[s],
+                          OIIO::ImageOutput::AppendSubimage))
+            return false;
+        if (!out->write_image(fmt, data[s]))
+            return false;
+    }
+    return true;
+}
+
+
+
 int
 OIIO_openimageio_version()
 {
@@ -14,6 +14,8 @@
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/thread.h>
 
+#include "imageio_pvt.h"
+
 OIIO_NAMESPACE_BEGIN
 
 
@@ -26,6 +28,82 @@ OIIO_NAMESPACE_BEGIN
 // need to lock the mutex. As long as capacity is not changing, threads may
 // change number of samples (inserting or deleting) as well as altering
 // data, simultaneously, as long as they are working on separate pixels.
+//
+// The sample data isn't one big array, but is split into chunks of
+// consecutive pixels, each with its own pool of samples and its own lock.
+// When a pixel outgrows its capacity, its samples move to the end of its
+// chunk's pool (leaving a hole that is reclaimed when the chunk is next
+// compacted), so growing a pixel costs time proportional to that pixel's
+// samples rather than to all the samples after it in the image.
+//
+// Growing a pixel resizes (and sometimes compacts) its chunk's pool under
+// the chunk's lock, but that moves the samples of every other pixel in the
+// chunk, and nothing else takes the lock to read or write samples. So
+// while any pixel of a chunk may grow, no other thread may touch that
+// chunk's samples: threads that may grow pixels must each own whole
+// chunks, as deep_parallel_pixels() arranges.
+
+static const int64_t chunk_pixels = pvt::deepdata_chunk_pixels;
+
+
+
+// split(), sort(), merge_overlaps() and merge_deep_pixels() don't work on
+// the samples in place, but on a copy of the pixel's raw samples, which is
+// copied back at the end. Reordering, duplicating and removing samples
+// only ever moves whole samples as bytes, so channels that are never used
+// in arithmetic (ids and the like) come through bit for bit, whatever
+// their type. The arithmetic reads and writes single values as floats,
+// rounded just as deep_value() and set_deep_value() would, through
+// conversions chosen once per channel in init() rather than by switching
+// on the type at every access.
+struct DeepChannelIO {
+    float (*get)(const char* src);
+    void (*set)(char* dst, float val);
+};
+
+
+template<typename T> struct DeepChannelConvert {
+    static float get(const char* src)
+    {
+        T val;
+        memcpy(&val, src, sizeof(T));
+        return convert_type<T, float>(val);
+    }
+    static void set(char* dst, float val)
+    {
+        T v = convert_type<float, T>(val);
+        memcpy(dst, &v, sizeof(T));
+    }
+};
+
+
+template<typename T>
+inline DeepChannelIO
+deep_channel_io()
+{
+    return { DeepChannelConvert<T>::get, DeepChannelConvert<T>::set };
+}
+
+
+static DeepChannelIO
+deep_channel_io(TypeDesc type)
+{
+    switch (type.basetype) {
+    case TypeDesc::FLOAT: return deep_channel_io<float>();
+    case TypeDesc::HALF: return deep_channel_io<half>();
+    case TypeDesc::UINT: return deep_channel_io<unsigned int>();
+    case TypeDesc::UINT8: return deep_channel_io<unsigned char>();
+    case TypeDesc::INT8: return deep_channel_io<char>();
+    case TypeDesc::UINT16: return deep_channel_io<unsigned short>();
+    case TypeDesc::INT16: return deep_channel_io<short>();
+    case TypeDesc::INT: return deep_channel_io<int>();
+    case TypeDesc::UINT64: return deep_channel_io<unsigned long long>();
+    case TypeDesc::INT64: return deep_channel_io<long long>();
+    default:
+        OIIO_ASSERT_MSG(0, "Unknown/unsupported data type %d", type.basetype);
+        return deep_channel_io<float>();
+    }
+}
 
 
 
@@ -33,14 +111,22 @@ class DeepData::Impl {  // holds all the nontrivial stuff
     friend class DeepData;
 
 public:
-    std::vector<TypeDesc> m_channeltypes;  // for each channel [c]
-    std::vector<size_t> m_channelsizes;    // for each channel [c]
-    std::vector<size_t> m_channeloffsets;  // for each channel [c]
-    std::vector<unsigned int> m_nsamples;  // for each pixel [p]
-    std::vector<unsigned int> m_capacity;  // for each pixel [p]
+    struct Chunk {
+        std::vector<char> data;  // sample pool [offset+s][c]
+        size_t live = 0;         // total capacity of the chunk's pixels
+        spin_mutex mutex;        // lock for changing capacities
+    };
+
+    std::vector<TypeDesc> m_channeltypes;    // for each channel [c]
+    std::vector<size_t> m_channelsizes;      // for each channel [c]
+    std::vector<size_t> m_channeloffsets;    // for each channel [c]
+    std::vector<DeepChannelIO> m_channelio;  // for each channel [c]
+    std::vector<unsigned int> m_nsamples;    // for each pixel [p]
+    std::vector<unsigned int> m_capacity;    // for each pixel [p]
     std::vector<unsigned int>
-        m_cumcapacity;         // cumulative capacity before pixel [p]
-    std::vector<char> m_data;  // for each sample [p][s][c]
+        m_offset;                  // first sample of pixel [p] in its chunk
+    std::vector<Chunk> m_chunks;   // for each chunk of chunk_pixels pixels
+    std::vector<char> m_flatdata;  // contiguous copy for all_data()
     std::vector<std::string> m_channelnames;  // For each channel[c]
     std::vector<int> m_myalphachannel;        // For each channel[c], its alpha
         // myalphachannel[c] gives the alpha channel corresponding to channel
@@ -66,10 +152,12 @@ public:
         m_channeltypes.clear();
         m_channelsizes.clear();
         m_channeloffsets.clear();
+        m_channelio.clear();
         m_nsamples.clear();
         m_capacity.clear();
-        m_cumcapacity.clear();
-        m_data.clear();
+        m_offset.clear();
+        m_chunks.clear();
+        m_flatdata.clear();
         m_channelnames.clear();
         m_myalphachannel.clear();
         m_samplesize    = 0;
@@ -82,44 +170,156 @@ public:
         m_allocated     = false;
     }
 
-    // If not already done, allocate data and cumcapacity
+    Chunk& chunk(int64_t pixel) { return m_chunks[pixel / chunk_pixels]; }
+    const Chunk& chunk(int64_t pixel) const
+    {
+        return m_chunks[pixel / chunk_pixels];
+    }
+
+    // Lay out the pixels of chunk c (whose total capacity is already in
+    // its live field) consecutively in newdata, copying their samples
+    // from the chunk's current pool if copy is true.
+    void layout_chunk(size_t c, std::vector<char>& newdata, bool copy)
+    {
+        Chunk& ch(m_chunks[c]);
+        newdata.resize(ch.live * m_samplesize);
+        int64_t pbegin = int64_t(c) * chunk_pixels;
+        int64_t pend   = std::min(pbegin + chunk_pixels,
+                                int64_t(m_capacity.size()));
+        size_t offset  = 0;
+        for (int64_t p = pbegin; p < pend; ++p) {
+            if (copy && m_nsamples[p] && m_samplesize)
+                memcpy(&newdata[offset * m_samplesize],
+                       &ch.data[m_offset[p] * m_samplesize],
+                       m_nsamples[p] * m_samplesize);
+            m_offset[p] = (unsigned int)offset;
+            offset += m_capacity[p];
+        }
+    }
+
+    // If not already done, allocate data and offsets
     void alloc(size_t npixels)
     {
         if (!m_allocated) {
             spin_lock lock(m_mutex);
             if (!m_allocated) {
-                // m_cumcapacity.resize (npixels);
-                size_t totalcapacity = 0;
-                for (size_t i = 0; i < npixels; ++i) {
-                    m_cumcapacity[i] = totalcapacity;
-                    totalcapacity += m_capacity[i];
-                }
-                m_data.resize(totalcapacity * m_samplesize);
+                m_chunks.resize((npixels + chunk_pixels - 1) / chunk_pixels);
+                for (size_t p = 0; p < npixels; ++p)
+                    chunk(p).live += m_capacity[p];
+                for (size_t c = 0, n = m_chunks.size(); c < n; ++c)
+                    layout_chunk(c, m_chunks[c].data, false);
                 m_allocated = true;
             }
         }
     }
 
-    size_t data_offset(int64_t pixel, int channel, int sample)
+    // Give pixel (in its chunk, which the caller has locked) room for
+    // samps samples, moving its samples to the end of the pool unless they
+    // are already there.
+    void grow(int64_t pixel, unsigned int samps)
     {
-        OIIO_DASSERT(int(m_cumcapacity.size()) > pixel);
+        Chunk& ch(chunk(pixel));
+        size_t oldcap = m_capacity[pixel];
+        if (!m_samplesize) {
+            // No channels: there is no pool, just keep the books.
+            m_capacity[pixel] = samps;
+            ch.live += samps - oldcap;
+            return;
+        }
+        size_t poolsize = ch.data.size() / m_samplesize;
+        if (m_offset[pixel] + oldcap != poolsize) {
+            size_t newoffset = poolsize;
+            ch.data.resize((newoffset + samps) * m_samplesize);
+            if (m_nsamples[pixel])
+                memcpy(&ch.data[newoffset * m_samplesize],
+                       &ch.data[m_offset[pixel] * m_samplesize],
+                       m_nsamples[pixel] * m_samplesize);
+            m_offset[pixel] = (unsigned int)newoffset;
+        } else {
+            ch.data.resize((m_offset[pixel] + samps) * m_samplesize);
+        }
+        m_capacity[pixel] = samps;
+        ch.live += samps - oldcap;
+        // Squeeze out the holes once they take up more than the samples
+        // in use, so the total copying stays proportional to the growth.
+        if (ch.data.size() / m_samplesize > 2 * ch.live + chunk_pixels) {
+            std::vector<char> newdata;
+            layout_chunk(size_t(pixel / chunk_pixels), newdata, true);
+            ch.data.swap(newdata);
+        }
+    }
+
+    size_t data_offset(int64_t pixel, int channel, int sample) const
+    {
+        OIIO_DASSERT(int64_t(m_offset.size()) > pixel);
         OIIO_DASSERT(m_capacity[pixel] >= m_nsamples[pixel]);
-        return (m_cumcapacity[pixel] + sample) * m_samplesize
+        return (m_offset[pixel] + sample) * m_samplesize
                + m_channeloffsets[channel];
     }
 
     void* data_ptr(int64_t pixel, int channel, int sample)
     {
         size_t offset = data_offset(pixel, channel, sample);
-        OIIO_DASSERT(offset < m_data.size());
-        return &m_data[offset];
+        OIIO_DASSERT(offset < chunk(pixel).data.size());
+        return &chunk(pixel).data[offset];
+    }
+
+    // Copy all the samples (including unused capacity) into m_flatdata,
+    // in pixel order. The buffer is reused, so it only moves if the total
+    // capacity has grown since the last call.
+    void flatten()
+    {
+        spin_lock lock(m_mutex);
+        size_t total = 0;
+        for (auto& ch : m_chunks)
+            total += ch.live;
+        m_flatdata.resize(total * m_samplesize);
+        size_t offset = 0;
+        for (size_t p = 0, n = m_capacity.size(); p < n; ++p) {
+            if (m_capacity[p] && m_samplesize)
+                memcpy(&m_flatdata[offset * m_samplesize],
+                       &chunk(p).data[m_offset[p] * m_samplesize],
+                       m_capacity[p] * m_samplesize);
+            offset += m_capacity[p];
+        }
+    }
+
+    int nchannels() const { return int(m_channeltypes.size()); }
+
+    // Copy the first n samples of pixel into buf.
+    void unpack(int64_t pixel, int n, std::vector<char>& buf)
+    {
+        buf.resize(size_t(n) * m_samplesize);
+        if (!buf.empty())
+            memcpy(buf.data(), data_ptr(pixel, 0, 0), buf.size());
     }
 
-    size_t total_capacity() const
+    // Copy n samples from buf back into pixel, which must already have
+    // that many samples.
+    void pack(int64_t pixel, int n, const std::vector<char>& buf)
     {
-        return m_cumcapacity.back() + m_capacity.back();
+        if (n && m_samplesize)
+            memcpy(data_ptr(pixel, 0, 0), buf.data(), size_t(n) * m_samplesize);
     }
 
+    float get(const std::vector<char>& buf, int s, int c) const
+    {
+        return m_channelio[c].get(
+            &buf[size_t(s) * m_samplesize + m_channeloffsets[c]]);
+    }
+
+    void set(std::vector<char>& buf, int s, int c, float val) const
+    {
+        m_channelio[c].set(&buf[size_t(s) * m_samplesize + m_channeloffsets[c]],
+                           val);
+    }
+
+    // The guts of DeepData::split, sort, and merge_overlaps, on an
+    // unpacked pixel of n samples.
+    bool split(std::vector<char>& buf, int& n, float depth) const;
+    void sort(std::vector<char>& buf, int n) const;
+    void merge_overlaps(std::vector<char>& buf, int& n) const;
+
     inline void sanity() const
     {
         // int nchannels = int (m_channeltypes.size());
@@ -127,15 +327,17 @@ public:
         OIIO_ASSERT(m_channeltypes.size() == m_channeloffsets.size());
         int64_t npixels = int64_t(m_capacity.size());
         OIIO_ASSERT(m_nsamples.size() == m_capacity.size());
-        OIIO_ASSERT(m_cumcapacity.size() == m_capacity.size());
+        OIIO_ASSERT(m_offset.size() == m_capacity.size());
         if (m_allocated) {
-            size_t totalcapacity = 0;
+            std::vector<size_t> live(m_chunks.size(), 0);
             for (int64_t p = 0; p < npixels; ++p) {
-                OIIO_ASSERT(m_cumcapacity[p] == totalcapacity);
-                totalcapacity += m_capacity[p];
                 OIIO_ASSERT(m_capacity[p] >= m_nsamples[p]);
+                OIIO_ASSERT((m_offset[p] + m_capacity[p]) * m_samplesize
+                            <= chunk(p).data.size());
+                live[p / chunk_pixels] += m_capacity[p];
             }
-            OIIO_ASSERT(totalcapacity * m_samplesize == m_data.size());
+            for (size_t c = 0; c < m_chunks.size(); ++c)
+                OIIO_ASSERT(live[c] == m_chunks[c].live);
         }
     }
 };
@@ -328,12 +530,13 @@ DeepData::init(int64_t npix, int nchan, cspan<TypeDesc> channeltypes,
     }
     m_impl->m_channelsizes.resize(m_nchannels);
     m_impl->m_channeloffsets.resize(m_nchannels);
+    m_impl->m_channelio.resize(m_nchannels);
     m_impl->m_channelnames.resize(m_nchannels);
     m_impl->m_myalphachannel.resize(m_nchannels, -1);
     m_impl->m_samplesize = 0;
     m_impl->m_nsamples.resize(m_npixels, 0);
     m_impl->m_capacity.resize(m_npixels, 0);
-    m_impl->m_cumcapacity.resize(m_npixels, 0);
+    m_impl->m_offset.resize(m_npixels, 0);
 
     // Channel name hunt
     // First, find Z, Zback, A
@@ -364,11 +567,14 @@ DeepData::init(int64_t npix, int nchan, cspan<TypeDesc> channeltypes,
                  && is_or_endswithdot(channelnames[c], "AB"))
             m_impl->m_AB_channel = c;
     }
+    for (int c = 0; c < m_nchannels; ++c)
+        m_impl->m_channelio[c] = deep_channel_io(m_impl->m_channeltypes[c]);
     // Now try to find which alpha corresponds to each channel
     for (int c = 0; c < m_nchannels; ++c) {
-        // Skip non-color channels
+        // Skip non-color channels: depths, and integer channels, which
+        // hold ids and the like rather than premultiplied colors.
         if (c == m_impl->m_z_channel || c == m_impl->m_zback_channel
-            || m_impl->m_channeltypes[c] == TypeDesc::UINT32)
+            || !m_impl->m_channeltypes[c].is_floating_point())
             continue;
         string_view name(channelnames[c]);
         // Alpha channels are their own alpha
@@ -452,6 +658,15 @@ DeepData::allocated() const
 
 
 
+void
+DeepData::allocate()
+{
+    if (m_impl)
+        m_impl->alloc(m_npixels);
+}
+
+
+
 int
 DeepData::capacity(int64_t pixel) const
 {
@@ -469,27 +684,14 @@ DeepData::set_capacity(int64_t pixel, int samps)
     if (pixel < 0 || pixel >= m_npixels)
         return;
     OIIO_DASSERT(m_impl);
-    spin_lock lock(m_impl->m_mutex);
     if (m_impl->m_allocated) {
         // Data already allocated. Expand capacity if necessary, don't
         // contract. (FIXME?)
-        int n = (int)capacity(pixel);
-        if (samps > n) {
-            int toadd = samps - n;
-            if (m_impl->m_data.empty()) {
-                size_t newtotal = (m_impl->total_capacity() + toadd);
-                m_impl->m_data.resize(newtotal * samplesize());
-            } else {
-                size_t offset = m_impl->data_offset(pixel, 0, n);
-                m_impl->m_data.insert(m_impl->m_data.begin() + offset,
-                                      toadd * samplesize(), 0);
-            }
-            // Adjust the cumulative prefix sum of samples for subsequent pixels
-            for (int64_t p = pixel + 1; p < m_npixels; ++p)
-                m_impl->m_cumcapacity[p] += toadd;
-            m_impl->m_capacity[pixel] = samps;
-        }
+        spin_lock lock(m_impl->chunk(pixel).mutex);
+        if (samps > capacity(pixel))
+            m_impl->grow(pixel, samps);
     } else {
+        spin_lock lock(m_impl->m_mutex);
         m_impl->m_capacity[pixel] = samps;
     }
 }
@@ -558,14 +760,13 @@ DeepData::insert_samples(int64_t pixel, int samplepos, int n)
     // is adjusted, we can alter nsamples or copy the data around within
     // the pixel without a lock, we presume that if multiple threads are
     // in play, they are working on separate pixels.
-    if (m_impl->m_allocated) {
+    if (m_impl->m_allocated && samplesize()) {
         // Move the data
         if (samplepos < oldsamps) {
-            size_t offset = m_impl->data_offset(pixel, 0, samplepos);
-            size_t end    = m_impl->data_offset(pixel, 0, oldsamps);
-            std::copy_backward(m_impl->m_data.begin() + offset,
-                               m_impl->m_data.begin() + end,
-                               m_impl->m_data.begin() + end + n * samplesize());
+            char* data = (char*)m_impl->data_ptr(pixel, 0, 0);
+            std::copy_backward(data + samplepos * samplesize(),
+                               data + oldsamps * samplesize(),
+                               data + (oldsamps + n) * samplesize());
         }
     }
     // Add to this pixel's sample count
@@ -581,14 +782,13 @@ DeepData::erase_samples(int64_t pixel, int samplepos, int n)
     // Because erase_samples only moves data within a pixel and doesn't
     // change the capacity, no lock is needed.
     n = std::min(n, int(m_impl->m_nsamples[pixel]));
-    if (m_impl->m_allocated) {
+    if (m_impl->m_allocated && n > 0 && samplesize()) {
         // Move the data
-        int oldsamps  = samples(pixel);
-        size_t offset = m_impl->data_offset(pixel, 0, samplepos);
-        size_t end    = m_impl->data_offset(pixel, 0, oldsamps);
-        std::copy(m_impl->m_data.begin() + offset + n * samplesize(),
-                  m_impl->m_data.begin() + end,
-                  m_impl->m_data.begin() + offset);
+        int oldsamps = samples(pixel);
+        char* data   = (char*)m_impl->data_ptr(pixel, 0, 0);
+        std::copy(data + (samplepos + n) * samplesize(),
+                  data + oldsamps * samplesize(),
+                  data + samplepos * samplesize());
     }
     m_impl->m_nsamples[pixel] -= n;
 }
@@ -611,7 +811,7 @@ const void*
 DeepData::data_ptr(int64_t pixel, int channel, int sample) const
 {
     if (pixel < 0 || pixel >= m_npixels || channel < 0 || channel >= m_nchannels
-        || !m_impl || !m_impl->m_data.size() || sample < 0
+        || !m_impl || !m_impl->m_allocated || sample < 0
         || sample >= int(m_impl->m_nsamples[pixel]))
         return NULL;
     return m_impl->data_ptr(pixel, channel, sample);
@@ -808,7 +1008,8 @@ DeepData::all_data() const
 {
     OIIO_DASSERT(m_impl);
     m_impl->alloc(m_npixels);
-    return m_impl->m_data;
+    m_impl->flatten();
+    return m_impl->m_flatdata;
 }
 
 
@@ -904,37 +1105,41 @@ DeepData::copy_deep_pixel(int64_t pixel, const DeepData& src, int64_t srcpixel)
 
 
 bool
-DeepData::split(int64_t pixel, float depth)
+DeepData::Impl::split(std::vector<char>& buf, int& n, float depth) const
 {
     using std::expm1;
     using std::log1p;
     bool splits_occurred = false;
-    int zchan            = m_impl->m_z_channel;
-    int zbackchan        = m_impl->m_zback_channel;
+    int zchan            = m_z_channel;
+    int zbackchan        = m_zback_channel;
     if (zchan < 0)
         return false;  // No channel labeled Z -- we don't know what to do
     if (zbackchan < 0)
         return false;  // The samples are not extended -- nothing to split
-    int nchans = channels();
-    for (int s = 0; s < samples(pixel); ++s) {
-        float zf = deep_value(pixel, zchan, s);      // z front
-        float zb = deep_value(pixel, zbackchan, s);  // z back
+    int nchans = nchannels();
+    for (int s = 0; s < n; ++s) {
+        float zf = get(buf, s, zchan);      // z front
+        float zb = get(buf, s, zbackchan);  // z back
         if (zf < depth && zb > depth) {
             // The sample spans depth, so split it.
             // See http://www.openexr.com/InterpretingDeepPixels.pdf
             splits_occurred = true;
-            insert_samples(pixel, s + 1);
-            copy_deep_sample(pixel, s + 1, *this, pixel, s);
-            set_deep_value(pixel, zbackchan, s, depth);
-            set_deep_value(pixel, zchan, s + 1, depth);
+            // Duplicate sample s
+            buf.resize(size_t(n + 1) * m_samplesize);
+            std::copy_backward(buf.begin() + size_t(s) * m_samplesize,
+                               buf.begin() + size_t(n) * m_samplesize,
+                               buf.end());
+            ++n;
+            set(buf, s, zbackchan, depth);
+            set(buf, s + 1, zchan, depth);
             // We have to proceed in two passes, since we may reuse the
             // alpha values, we can't overwrite them yet.
             for (int c = 0; c < nchans; ++c) {
-                int alphachan = m_impl->m_myalphachannel[c];
+                int alphachan = m_myalphachannel[c];
                 if (alphachan < 0       // No alpha
                     || alphachan == c)  // This is an alpha!
                     continue;
-                float a = clamp(deep_value(pixel, alphachan, s), 0.0f, 1.0f);
+                float a = clamp(get(buf, s, alphachan), 0.0f, 1.0f);
                 if (a == 1.0f)  // Opaque or channels without alpha, we're done.
                     continue;
                 float xf = (depth - zf) / (zb - zf);
@@ -942,21 +1147,21 @@ DeepData::split(int64_t pixel, float depth)
                 if (a > std::numeric_limits<float>::min()) {
                     float af  = -expm1(xf * log1p(-a));
                     float ab  = -expm1(xb * log1p(-a));
-                    float val = deep_value(pixel, c, s);
-                    set_deep_value(pixel, c, s, (af / a) * val);
-                    set_deep_value(pixel, c, s + 1, (ab / a) * val);
+                    float val = get(buf, s, c);
+                    set(buf, s, c, (af / a) * val);
+                    set(buf, s + 1, c, (ab / a) * val);
                 } else {
-                    float val = deep_value(pixel, c, s);
-                    set_deep_value(pixel, c, s, val * xf);
-                    set_deep_value(pixel, c, s + 1, val * xb);
+                    float val = get(buf, s, c);
+                    set(buf, s, c, val * xf);
+                    set(buf, s + 1, c, val * xb);
                 }
             }
             // Now that we've adjusted the colors, do the alphas
             for (int c = 0; c < nchans; ++c) {
-                int alphachan = m_impl->m_myalphachannel[c];
+                int alphachan = m_myalphachannel[c];
                 if (alphachan != c)
                     continue;  // skip if not an alpha
-                float a = clamp(deep_value(pixel, alphachan, s), 0.0f, 1.0f);
+                float a = clamp(get(buf, s, alphachan), 0.0f, 1.0f);
                 if (a == 1.0f)  // Opaque or channels without alpha, we're done.
                     continue;
                 float xf = (depth - zf) / (zb - zf);
@@ -964,11 +1169,11 @@ DeepData::split(int64_t pixel, float depth)
                 if (a > std::numeric_limits<float>::min()) {
                     float af = -expm1(xf * log1p(-a));
                     float ab = -expm1(xb * log1p(-a));
-                    set_deep_value(pixel, c, s, af);
-                    set_deep_value(pixel, c, s + 1, ab);
+                    set(buf, s, c, af);
+                    set(buf, s + 1, c, ab);
                 } else {
-                    set_deep_value(pixel, c, s, a * xf);
-                    set_deep_value(pixel, c, s + 1, a * xb);
+                    set(buf, s, c, a * xf);
+                    set(buf, s + 1, c, a * xb);
                 }
             }
         }
@@ -978,109 +1183,88 @@ DeepData::split(int64_t pixel, float depth)
 
 
 
-namespace {
-
-// Comparitor functor for depth sorting sample indices of a deep pixel.
-class SampleComparator {
-public:
-    SampleComparator(const DeepData& dd, int pixel, int zchan, int zbackchan)
-        : deepdata(dd)
-        , pixel(pixel)
-        , zchan(zchan)
-        , zbackchan(zbackchan)
-    {
-    }
-    bool operator()(int i, int j) const
-    {
-        // If either has a lower z, that's the lower
-        float iz = deepdata.deep_value(pixel, zchan, i);
-        float jz = deepdata.deep_value(pixel, zchan, j);
-        if (iz < jz)
-            return true;
-        if (iz > jz)
-            return false;
-        // If both z's are equal, sort based on zback
-        float izb = deepdata.deep_value(pixel, zbackchan, i);
-        float jzb = deepdata.deep_value(pixel, zbackchan, j);
-        return izb < jzb;
-    }
-
-private:
-    const DeepData& deepdata;
-    int pixel;
-    int zchan, zbackchan;
-};
-
-}  // namespace
+bool
+DeepData::split(int64_t pixel, float depth)
+{
+    if (m_impl->m_z_channel < 0 || m_impl->m_zback_channel < 0)
+        return false;
+    int n = samples(pixel);
+    std::vector<char> buf;
+    m_impl->unpack(pixel, n, buf);
+    if (!m_impl->split(buf, n, depth))
+        return false;
+    set_samples(pixel, n);
+    m_impl->pack(pixel, n, buf);
+    return true;
+}
 
 
 
 void
-DeepData::sort(int64_t pixel)
+DeepData::Impl::sort(std::vector<char>& buf, int n) const
 {
-    int zchan = m_impl->m_z_channel;
+    int zchan = m_z_channel;
     if (zchan < 0)
         return;  // No channel labeled Z -- we don't know what to do
-    int zbackchan = m_impl->m_z_channel;
-    if (zbackchan < 0)
-        zbackchan = zchan;
-    int nsamples = samples(pixel);
-    if (nsamples < 2)
+    if (n < 2)
         return;  // 0 or 1 samples -- no sort necessary
 
-    // Ick, std::sort and friends take a custom comparator, but not a custom
-    // swapper, so there's no way to std::sort a data type whose size is not
-    // known at compile time. So we just sort the indices!
-    int* sample_indices = OIIO_ALLOCA(int, nsamples);
-    std::iota(sample_indices, sample_indices + nsamples, 0);
-    std::stable_sort(sample_indices, sample_indices + nsamples,
-                     SampleComparator(*this, pixel, zchan, zbackchan));
-
-    // Now copy around using a temp buffer
-    size_t samplebytes = samplesize();
-    char* tmppixel     = OIIO_ALLOCA(char, samplebytes* nsamples);
-    memcpy(tmppixel, data_ptr(pixel, 0, 0), samplebytes * nsamples);
-    for (int i = 0; i < nsamples; ++i)
-        memcpy(data_ptr(pixel, 0, i),
-               tmppixel + samplebytes * sample_indices[i], samplebytes);
+    // Sort the sample indices by Z, then shuffle the samples to match.
+    int* sample_indices = OIIO_ALLOCA(int, n);
+    std::iota(sample_indices, sample_indices + n, 0);
+    std::stable_sort(sample_indices, sample_indices + n, [&](int i, int j) {
+        return get(buf, i, zchan) < get(buf, j, zchan);
+    });
+    std::vector<char> sorted(buf.size());
+    for (int i = 0; i < n; ++i)
+        memcpy(&sorted[size_t(i) * m_samplesize],
+               &buf[size_t(sample_indices[i]) * m_samplesize], m_samplesize);
+    buf.swap(sorted);
 }
 
 
 
 void
-DeepData::merge_overlaps(int64_t pixel)
+DeepData::sort(int64_t pixel)
+{
+    int n = samples(pixel);
+    if (m_impl->m_z_channel < 0 || n < 2)
+        return;
+    std::vector<char> buf;
+    m_impl->unpack(pixel, n, buf);
+    m_impl->sort(buf, n);
+    m_impl->pack(pixel, n, buf);
+}
+
+
+
+void
+DeepData::Impl::merge_overlaps(std::vector<char>& buf, int& n) const
 {
     using std::log1p;
-    int zchan     = m_impl->m_z_channel;
-    int zbackchan = m_impl->m_zback_channel;
+    int zchan     = m_z_channel;
+    int zbackchan = m_zback_channel;
     if (zchan < 0)
         return;  // No channel labeled Z -- we don't know what to do
     if (zbackchan < 0)
         zbackchan = zchan;  // Missing Zback -- use Z
-    int nchans = channels();
-    for (int s = 1 /* YES, 1 */; s < samples(pixel); ++s) {
-        float zf = deep_value(pixel, zchan, s);      // z front
-        float zb = deep_value(pixel, zbackchan, s);  // z back
-        if (zf == deep_value(pixel, zchan, s - 1)
-            && zb == deep_value(pixel, zbackchan, s - 1)) {
+    int nchans = nchannels();
+    for (int s = 1 /* YES, 1 */; s < n; ++s) {
+        float zf = get(buf, s, zchan);      // z front
+        float zb = get(buf, s, zbackchan);  // z back
+        if (zf == get(buf, s - 1, zchan) && zb == get(buf, s - 1, zbackchan)) {
             // The samples overlap exactly, merge them per
             // See http://www.openexr.com/InterpretingDeepPixels.pdf
             for (int c = 0; c < nchans; ++c) {  // set the colors
-                int alphachan = m_impl->m_myalphachannel[c];
+                int alphachan = m_myalphachannel[c];
                 if (alphachan < 0)
                     continue;  // Not color or alpha
                 if (alphachan == c)
                     continue;  // Adjust the alphas in a second pass below
-                float a1 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s - 1),
-                                       0.0f, 1.0f);
-                float a2 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s), 0.0f,
-                                       1.0f);
-                float c1 = deep_value(pixel, c, s - 1);
-                float c2 = deep_value(pixel, c, s);
+                float a1 = clamp(get(buf, s - 1, alphachan), 0.0f, 1.0f);
+                float a2 = clamp(get(buf, s, alphachan), 0.0f, 1.0f);
+                float c1 = get(buf, s - 1, c);
+                float c2 = get(buf, s, c);
                 float am = a1 + a2 - a1 * a2;
                 float cm;
                 if (a1 == 1.0f && a2 == 1.0f)
@@ -1099,25 +1283,23 @@ DeepData::merge_overlaps(int64_t pixel)
                     float w = (u > 1.0f || am < u * MAX) ? am / u : 1.0f;
                     cm      = (c1 * v1 + c2 * v2) * w;
                 }
-                set_deep_value(pixel, c, s - 1, cm);  // setting color
+                set(buf, s - 1, c, cm);  // setting color
             }
             for (int c = 0; c < nchans; ++c) {  // set the alphas
-                int alphachan = m_impl->m_myalphachannel[c];
+                int alphachan = m_myalphachannel[c];
                 if (alphachan != c)
                     continue;  // This pass is only for alphas
-                float a1 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s - 1),
-                                       0.0f, 1.0f);
-                float a2 = (alphachan < 0)
-                               ? 1.0f
-                               : clamp(deep_value(pixel, alphachan, s), 0.0f,
-                                       1.0f);
+                float a1 = clamp(get(buf, s - 1, alphachan), 0.0f, 1.0f);
+                float a2 = clamp(get(buf, s, alphachan), 0.0f, 1.0f);
                 float am = a1 + a2 - a1 * a2;
-                set_deep_value(pixel, c, s - 1, am);  // setting alpha
+                set(buf, s - 1, c, am);  // setting alpha
             }
             // Now eliminate sample s and revisit again
-            erase_samples(pixel, s, 1);
+            std::copy(buf.begin() + size_t(s + 1) * m_samplesize,
+                      buf.begin() + size_t(n) * m_samplesize,
+                      buf.begin() + size_t(s) * m_samplesize);
+            --n;
+            buf.resize(size_t(n) * m_samplesize);
             --s;
         }
     }
@@ -1125,6 +1307,24 @@ DeepData::merge_overlaps(int64_t pixel)
 
 
 
+void
+DeepData::merge_overlaps(int64_t pixel)
+{
+    int n = samples(pixel);
+    if (m_impl->m_z_channel < 0 || n < 2)
+        return;
+    std::vector<char> buf;
+    m_impl->unpack(pixel, n, buf);
+    int oldn = n;
+    m_impl->merge_overlaps(buf, n);
+    if (n == oldn)
+        return;
+    set_samples(pixel, n);
+    m_impl->pack(pixel, n, buf);
+}
+
+
+
 void
 DeepData::merge_deep_pixels(int64_t pixel, const DeepData& src, int srcpixel)
 {
@@ -1142,24 +1342,39 @@ DeepData::merge_deep_pixels(int64_t pixel, const DeepData& src, int srcpixel)
 
     // First, merge all of src's samples into our pixel
     set_samples(pixel, dstsamples + srcsamples);
-    for (int i = 0; i < srcsamples; ++i)
-        copy_deep_sample(pixel, dstsamples + i, src, srcpixel, i);
+    bool sametypes = samplesize() == src.samplesize();
+    if (sametypes)
+        for (int c = 0; c < m_nchannels; ++c)
+            sametypes &= (channeltype(c) == src.channeltype(c));
+    if (sametypes)
+        memcpy(data_ptr(pixel, 0, dstsamples), src.data_ptr(srcpixel, 0, 0),
+               samplesize() * srcsamples);
+    else
+        for (int i = 0; i < srcsamples; ++i)
+            copy_deep_sample(pixel, dstsamples + i, src, srcpixel, i);
 
     // Now ALL the samples from both images are in our pixel.
     // Mutually split the samples against each other.
-    sort(pixel);  // sort first so we only loop once
+    int n = dstsamples + srcsamples;
+    std::vector<char> buf;
+    m_impl->unpack(pixel, n, buf);
+    m_impl->sort(buf, n);  // sort first so we only loop once
     int zchan     = m_impl->m_z_channel;
     int zbackchan = m_impl->m_zback_channel;
-    for (int s = 0; s < samples(pixel); ++s) {
-        float z     = deep_value(pixel, zchan, s);
-        float zback = deep_value(pixel, zbackchan, s);
-        split(pixel, z);
-        split(pixel, zback);
+    if (zchan >= 0 && zbackchan >= 0) {
+        for (int s = 0; s < n; ++s) {
+            float z     = m_impl->get(buf, s, zchan);
+            float zback = m_impl->get(buf, s, zbackchan);
+            m_impl->split(buf, n, z);
+            m_impl->split(buf, n, zback);
+        }
     }
-    sort(pixel);
+    m_impl->sort(buf, n);
 
     // Now merge the overlaps
-    merge_overlaps(pixel);
+    m_impl->merge_overlaps(buf, n);
+    set_samples(pixel, n);
+    m_impl->pack(pixel, n, buf);
 }
 
 
@@ -1716,7 +1716,10 @@ template<class D, class S>
 static bool
 copy_pixels_impl(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads = 0)
 {
-    ImageBufAlgo::parallel_image(roi, { "copy_pixels", nthreads }, [&](ROI roi) {
+    ImageBufAlgo::parallel_tile_grid grid;
+    auto opt = ImageBufAlgo::parallel_options_for(src, grid, nthreads);
+    opt.name = "copy_pixels";
+    ImageBufAlgo::parallel_image(roi, opt, grid, [&](ROI roi) {
         int nchannels = roi.nchannels();
         if (is_same<D, S>::value) {
             // If both bufs are the same type, just directly copy the values
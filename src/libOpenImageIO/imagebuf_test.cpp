@@ -4,13 +4,18 @@
 
 
 #include <OpenImageIO/benchmark.h>
+#include <OpenImageIO/deepdata.h>
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/parallel.h>
 #include <OpenImageIO/unittest.h>
 
+#include "imageio_pvt.h"
+
 #include <iostream>
+#include <random>
 
 using namespace OIIO;
 
@@ -500,6 +505,184 @@ test_write_over()
 
 
 
+// Reference model of one deep sample for test_deepdata_stress.
+struct RefSample {
+    float r, z;
+    uint32_t id;
+};
+
+
+
+static RefSample
+make_ref_sample(uint32_t seed)
+{
+    // Keep the float values exactly representable as half.
+    return { float(seed % 64) / 4.0f, float(seed % 1000) * 0.5f,
+             seed * 2654435761u };
+}
+
+
+
+static void
+set_ref_sample(DeepData& dd, int64_t p, int s, const RefSample& r)
+{
+    dd.set_deep_value(p, 0, s, r.r);
+    dd.set_deep_value(p, 1, s, r.z);
+    dd.set_deep_value(p, 2, s, r.id);
+}
+
+
+
+static bool
+deepdata_matches(const DeepData& dd,
+                 const std::vector<std::vector<RefSample>>& ref)
+{
+    size_t totalcap = 0;
+    for (int64_t p = 0; p < dd.pixels(); ++p) {
+        const auto& pix(ref[p]);
+        if (dd.samples(p) != int(pix.size()) || dd.capacity(p) < dd.samples(p))
+            return false;
+        totalcap += dd.capacity(p);
+        for (int s = 0, n = int(pix.size()); s < n; ++s)
+            if (dd.deep_value(p, 0, s) != pix[s].r
+                || dd.deep_value(p, 1, s) != pix[s].z
+                || dd.deep_value_uint(p, 2, s) != pix[s].id)
+                return false;
+    }
+    return dd.all_data().size() == totalcap * dd.samplesize();
+}
+
+
+
+// Hammer a DeepData spanning several sample pool chunks with random
+// insert/erase/set_samples/set_capacity calls, checking it against a
+// simple reference model, first serially and then from many threads.
+void
+test_deepdata_stress()
+{
+    const int64_t npix = 3000;
+    TypeDesc types[] = { TypeHalf, TypeFloat, TypeUInt32 };
+    std::string names[] = { "R", "Z", "id" };
+    DeepData dd;
+    dd.init(npix, 3, types, names);
+    std::vector<std::vector<RefSample>> ref(npix);
+    for (int64_t p = 0; p < npix; p += 7) {
+        dd.set_samples(p, 1);
+        ref[p].resize(1);
+    }
+    for (int64_t p = 0; p < npix; ++p)
+        for (int s = 0; s < dd.samples(p); ++s) {
+            ref[p][s] = make_ref_sample(uint32_t(p + s));
+            set_ref_sample(dd, p, s, ref[p][s]);
+        }
+
+    std::mt19937 rng(42);
+    auto rand_int = [&](int n) {
+        return int(std::uniform_int_distribution<int>(0, n - 1)(rng));
+    };
+    bool ok = true;
+    for (int op = 0; op < 20000 && ok; ++op) {
+        int64_t p = rand_int(int(npix));
+        auto& pix(ref[p]);
+        int n     = int(pix.size());
+        switch (rand_int(4)) {
+        case 0: {  // set_samples, filling in any new samples
+            int samps = rand_int(9);
+            dd.set_samples(p, samps);
+            pix.resize(samps);
+            for (int s = n; s < samps; ++s) {
+                pix[s] = make_ref_sample(uint32_t(op + s));
+                set_ref_sample(dd, p, s, pix[s]);
+            }
+            break;
+        }
+        case 1: {  // insert_samples
+            int pos = rand_int(n + 1), k = 1 + rand_int(4);
+            dd.insert_samples(p, pos, k);
+            pix.insert(pix.begin() + pos, k, RefSample());
+            for (int s = pos; s < pos + k; ++s) {
+                pix[s] = make_ref_sample(uint32_t(op * 5 + s));
+                set_ref_sample(dd, p, s, pix[s]);
+            }
+            break;
+        }
+        case 2: {  // erase_samples
+            if (!n)
+                break;
+            int pos = rand_int(n), k = 1 + rand_int(n - pos);
+            dd.erase_samples(p, pos, k);
+            pix.erase(pix.begin() + pos, pix.begin() + pos + k);
+            break;
+        }
+        case 3:  // set_capacity never changes the samples
+            dd.set_capacity(p, rand_int(16));
+            break;
+        }
+        if (op % 2500 == 0)
+            ok = deepdata_matches(dd, ref);
+    }
+    OIIO_CHECK_ASSERT(ok && deepdata_matches(dd, ref));
+
+    // all_data() keeps handing back the same buffer if nothing grew
+    OIIO_CHECK_ASSERT(dd.all_data().data() == dd.all_data().data());
+
+    // Grow and shrink many pixels at once. Growing a pixel may move the
+    // samples of the other pixels in its chunk, so, just like the deep IBA
+    // functions, give each task whole chunks; the last one is partial.
+    const int64_t chunk = pvt::deepdata_chunk_pixels;
+    parallel_for(int64_t(0), (npix + chunk - 1) / chunk, [&](int64_t c) {
+        for (int64_t p = c * chunk, e = std::min(p + chunk, npix); p < e;
+             ++p) {
+            auto& pix(ref[p]);
+            for (int i = 0; i < 6; ++i) {
+                int n = int(pix.size());
+                dd.insert_samples(p, n / 2, 3);
+                pix.insert(pix.begin() + n / 2, 3, RefSample());
+                for (int s = n / 2; s < n / 2 + 3; ++s) {
+                    pix[s] = make_ref_sample(uint32_t(p * 31 + i * 7 + s));
+                    set_ref_sample(dd, p, s, pix[s]);
+                }
+                if (i & 1) {
+                    dd.erase_samples(p, 0, 2);
+                    pix.erase(pix.begin(), pix.begin() + 2);
+                }
+            }
+        }
+    });
+    OIIO_CHECK_ASSERT(deepdata_matches(dd, ref));
+
+    // A DeepData with no channels has no sample storage at all, but still
+    // has to keep track of the counts.
+    DeepData empty;
+    empty.init(npix, 0, types, {});
+    OIIO_CHECK_EQUAL(empty.samplesize(), 0);
+    for (int op = 0; op < 5000; ++op) {
+        int64_t p = rand_int(int(npix));
+        switch (rand_int(3)) {
+        case 0: empty.set_samples(p, rand_int(9)); break;
+        case 1: empty.insert_samples(p, 0, 1 + rand_int(4)); break;
+        case 2: empty.set_capacity(p, rand_int(16)); break;
+        }
+        OIIO_CHECK_ASSERT(empty.capacity(p) >= empty.samples(p));
+    }
+    empty.erase_samples(0, 0, empty.samples(0));
+    OIIO_CHECK_EQUAL(empty.samples(0), 0);
+    OIIO_CHECK_EQUAL(empty.all_data().size(), 0);
+
+    // Setting capacities doesn't allocate, but allocate() does, and keeps
+    // the capacities.
+    DeepData lazy;
+    lazy.init(npix, 3, types, names);
+    lazy.set_capacity(npix - 1, 5);
+    OIIO_CHECK_ASSERT(!lazy.allocated());
+    lazy.allocate();
+    OIIO_CHECK_ASSERT(lazy.allocated());
+    OIIO_CHECK_EQUAL(lazy.capacity(npix - 1), 5);
+    OIIO_CHECK_EQUAL(lazy.all_data().size(), 5 * lazy.samplesize());
+}
+
+
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
@@ -533,6 +716,8 @@ main(int /*argc*/, char* /*argv*/[])
 
     test_write_over();
 
+    test_deepdata_stress();
+
     Filesystem::remove("A_imagebuf_test.tif");
     return unit_test_failures;
 }
@@ -2,8 +2,11 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <memory>
+#include <vector>
 
 #include <OpenImageIO/dassert.h>
 #include <OpenImageIO/filter.h>
@@ -348,6 +351,138 @@ ImageBufAlgo::type_merge(TypeDesc::BASETYPE a, TypeDesc::BASETYPE b)
 
 
 
+// Interleave the bits of x and y, giving the position of (x,y) along a
+// Morton (Z-order) curve.
+static uint64_t
+morton2(uint32_t x, uint32_t y)
+{
+    auto spread = [](uint64_t v) {
+        v = (v | (v << 16)) & 0x0000ffff0000ffffULL;
+        v = (v | (v << 8)) & 0x00ff00ff00ff00ffULL;
+        v = (v | (v << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        v = (v | (v << 2)) & 0x3333333333333333ULL;
+        v = (v | (v << 1)) & 0x5555555555555555ULL;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+
+
+// Round v down to the grid of tiles of the given size that has a tile
+// corner at origin.
+static int
+tile_floor(int v, int origin, int size)
+{
+    int d = v - origin;
+    return origin + (d >= 0 ? d / size : -((size - 1 - d) / size)) * size;
+}
+
+
+
+int64_t
+pvt::parallel_tile_chunk(int64_t ntiles, int64_t tilepixels, int maxthreads,
+                         size_t minitems, size_t tilebytes, size_t cachebytes)
+{
+    // Make chunks as big as the minimum work per task asks for, but keep at
+    // least two per thread for load balancing, and keep the tiles all
+    // threads are working on within half of the cache budget.
+    int64_t chunk = 1;
+    while (chunk * tilepixels < int64_t(minitems)
+           && ntiles / (chunk * 4) >= 2 * maxthreads
+           && (!cachebytes || !tilebytes
+               || maxthreads * chunk * 4 * tilebytes <= cachebytes / 2))
+        chunk *= 4;
+    return chunk;
+}
+
+
+
+void
+ImageBufAlgo::parallel_image_tiles(ROI roi,
+                                   const parallel_image_options& options,
+                                   const parallel_tile_grid& grid,
+                                   std::function<void(ROI)> f)
+{
+    parallel_image_options opt(options);
+    opt.resolve();
+    int tw = grid.tilewidth, th = grid.tileheight;
+    int ox = grid.tilexorigin, oy = grid.tileyorigin;
+    if (tw < 1 || th < 1) {
+        // No source tiles to follow, so use squares a quarter the side of
+        // the minimum work per task, anchored at the ROI.
+        int64_t n = std::min<imagesize_t>(opt.minitems, roi.npixels());
+        tw = th = std::max(1, int(std::sqrt(n)) / 4);
+        ox      = roi.xbegin;
+        oy      = roi.ybegin;
+    }
+
+    // List the tiles overlapping the ROI in Morton order, so that any run
+    // of them is spatially compact. Runs of 4^k tiles are aligned squares.
+    int x0         = tile_floor(roi.xbegin, ox, tw);
+    int y0         = tile_floor(roi.ybegin, oy, th);
+    int nx         = (roi.xend - x0 + tw - 1) / tw;
+    int ny         = (roi.yend - y0 + th - 1) / th;
+    int64_t ntiles = int64_t(nx) * ny;
+    std::vector<std::pair<uint64_t, int64_t>> order;
+    order.reserve(ntiles);
+    for (int j = 0; j < ny; ++j)
+        for (int i = 0; i < nx; ++i)
+            order.emplace_back(morton2(i, j), int64_t(j) * nx + i);
+    std::sort(order.begin(), order.end());
+
+    // Threads claim a chunk of consecutive tiles at a time.
+    int64_t chunk   = pvt::parallel_tile_chunk(ntiles,
+                                               int64_t(tw) * th * roi.depth(),
+                                               opt.maxthreads, opt.minitems,
+                                               grid.tilebytes, grid.cachebytes);
+    int64_t nchunks = (ntiles + chunk - 1) / chunk;
+
+    std::atomic<int64_t> next(0);
+    auto claim = [&](int64_t /*begin*/, int64_t /*end*/) {
+        for (int64_t c; (c = next++) < nchunks;) {
+            for (int64_t t = c * chunk, e = std::min(ntiles, t + chunk); t < e;
+                 ++t) {
+                int i = int(order[t].second % nx);
+                int j = int(order[t].second / nx);
+                f(ROI(std::max(roi.xbegin, x0 + i * tw),
+                      std::min(roi.xend, x0 + (i + 1) * tw),
+                      std::max(roi.ybegin, y0 + j * th),
+                      std::min(roi.yend, y0 + (j + 1) * th), roi.zbegin,
+                      roi.zend, roi.chbegin, roi.chend));
+            }
+        }
+    };
+    int64_t nworkers = std::min(int64_t(opt.maxthreads), nchunks);
+    parallel_for_chunked(0, nworkers, 1, claim, opt);
+}
+
+
+
+ImageBufAlgo::parallel_image_options
+ImageBufAlgo::parallel_options_for(const ImageBuf& src,
+                                   parallel_tile_grid& grid, int nthreads)
+{
+    parallel_image_options opt(nthreads);
+    const ImageSpec& spec(src.spec());
+    if (src.storage() != ImageBuf::IMAGECACHE || spec.tile_width < 1
+        || spec.tile_height < 1)
+        return opt;
+    opt.splitdir     = Split_Tile;
+    grid.tilewidth   = spec.tile_width;
+    grid.tileheight  = spec.tile_height;
+    grid.tilexorigin = spec.x;
+    grid.tileyorigin = spec.y;
+    grid.tilebytes   = spec.tile_bytes(true);
+    grid.cachebytes  = 0;
+    float mb         = 0.0f;
+    if (src.imagecache() && src.imagecache()->getattribute("max_memory_MB", mb))
+        grid.cachebytes = size_t(double(mb) * 1024 * 1024);
+    return opt;
+}
+
+
+
 template<typename DSTTYPE, typename SRCTYPE>
 static bool
 convolve_(ImageBuf& dst, const ImageBuf& src, const ImageBuf& kernel,
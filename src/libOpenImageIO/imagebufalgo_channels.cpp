@@ -27,7 +27,9 @@ static bool
 channels_(ImageBuf& dst, const ImageBuf& src, cspan<int> channelorder,
           cspan<float> channelvalues, ROI roi, int nthreads = 0)
 {
-    ImageBufAlgo::parallel_image(roi, nthreads, [&](ROI roi) {
+    ImageBufAlgo::parallel_tile_grid grid;
+    auto opt = ImageBufAlgo::parallel_options_for(src, grid, nthreads);
+    ImageBufAlgo::parallel_image(roi, opt, grid, [&](ROI roi) {
         int nchannels = src.nchannels();
         ImageBuf::ConstIterator<DSTTYPE> s(src, roi);
         ImageBuf::Iterator<DSTTYPE> d(dst, roi);
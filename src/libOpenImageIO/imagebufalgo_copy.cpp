@@ -26,7 +26,9 @@ paste_(ImageBuf& dst, const ImageBuf& src, ROI dstroi, ROI srcroi, int nthreads)
     int relative_z = dstroi.zbegin - srcroi.zbegin;
 
     using namespace ImageBufAlgo;
-    parallel_image(srcroi, nthreads, [&](ROI roi) {
+    parallel_tile_grid grid;
+    auto opt = parallel_options_for(src, grid, nthreads);
+    parallel_image(srcroi, opt, grid, [&](ROI roi) {
         ROI droi(roi.xbegin + relative_x, roi.xend + relative_x,
                  roi.ybegin + relative_y, roi.yend + relative_y,
                  roi.zbegin + relative_z, roi.zend + relative_z, dstroi.chbegin,
@@ -136,7 +138,9 @@ static bool
 copy_(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads = 1)
 {
     using namespace ImageBufAlgo;
-    parallel_image(roi, nthreads, [&](ROI roi) {
+    parallel_tile_grid grid;
+    auto opt = parallel_options_for(src, grid, nthreads);
+    parallel_image(roi, opt, grid, [&](ROI roi) {
         ImageBuf::ConstIterator<S, D> s(src, roi);
         ImageBuf::Iterator<D, D> d(dst, roi);
         for (; !d.done(); ++d, ++s) {
@@ -21,6 +21,76 @@
 OIIO_NAMESPACE_BEGIN
 
 
+// Read a deep value of type T as a float, just as DeepData::deep_value()
+// would, but without switching on the channel type for every sample.
+template<typename T>
+static float
+deep_read(const char* ptr)
+{
+    return convert_type<T, float>(*(const T*)ptr);
+}
+
+typedef float (*DeepReader)(const char* ptr);
+
+static DeepReader
+deep_reader(TypeDesc type)
+{
+    switch (type.basetype) {
+    case TypeDesc::FLOAT: return deep_read<float>;
+    case TypeDesc::HALF: return deep_read<half>;
+    case TypeDesc::UINT: return deep_read<unsigned int>;
+    case TypeDesc::UINT8: return deep_read<unsigned char>;
+    case TypeDesc::INT8: return deep_read<char>;
+    case TypeDesc::UINT16: return deep_read<unsigned short>;
+    case TypeDesc::INT16: return deep_read<short>;
+    case TypeDesc::INT: return deep_read<int>;
+    case TypeDesc::UINT64: return deep_read<unsigned long long>;
+    case TypeDesc::INT64: return deep_read<long long>;
+    default:
+        OIIO_ASSERT_MSG(0, "Unknown/unsupported data type %d", type.basetype);
+        return deep_read<float>;
+    }
+}
+
+
+
+// Call f(pixel, x, y, z) for each pixel of deep image dst within roi, in
+// parallel. Each task gets whole DeepData chunks of consecutive pixels
+// (see pvt::deepdata_chunk_pixels). Growing a pixel can move the samples
+// of the other pixels in its chunk, so this is what makes it safe for the
+// threads to change the number of samples. The caller must make
+// sure dst's DeepData is already allocated if f will alter it.
+template<class FUNC>
+static void
+deep_parallel_pixels(const ImageBuf& dst, ROI roi, int nthreads, FUNC f)
+{
+    const ImageSpec& spec(dst.spec());
+    roi = roi_intersection(roi, get_roi(spec));
+    if (!roi.defined() || roi.npixels() == 0)
+        return;
+    const int64_t chunk = pvt::deepdata_chunk_pixels;
+    int64_t begin = dst.pixelindex(roi.xbegin, roi.ybegin, roi.zbegin, true);
+    int64_t end   = 1
+                  + dst.pixelindex(roi.xend - 1, roi.yend - 1, roi.zend - 1,
+                                   true);
+    int64_t w = spec.width, wh = int64_t(spec.width) * spec.height;
+    parallel_for_chunked(
+        begin / chunk, (end - 1) / chunk + 1, 0,
+        [&](int64_t cbegin, int64_t cend) {
+            int64_t pend = std::min(cend * chunk, end);
+            for (int64_t p = std::max(cbegin * chunk, begin); p < pend; ++p) {
+                int x = spec.x + int(p % w);
+                int y = spec.y + int((p % wh) / w);
+                int z = spec.z + int(p / wh);
+                if (roi.contains(x, y, z, roi.chbegin))
+                    f(p, x, y, z);
+            }
+        },
+        parallel_options(nthreads, Split_Y, 1));
+}
+
+
+
 // FIXME -- NOT CORRECT!  This code assumes sorted, non-overlapping samples.
 // That is not a valid assumption in general. We will come back to fix this.
 template<class DSTTYPE>
@@ -39,39 +109,52 @@ flatten_(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
         int R_channel      = srcspec.channelindex("R");
         int G_channel      = srcspec.channelindex("G");
         int B_channel      = srcspec.channelindex("B");
+        size_t samplesize  = dd->samplesize();
         float* val         = OIIO_ALLOCA(float, nc);
         float& ARval(val[AR_channel]);
         float& AGval(val[AG_channel]);
         float& ABval(val[AB_channel]);
 
+        // Sort out everything about the channels once, not per sample:
+        // how to read them, which alpha weights them (0 = the average,
+        // 1..3 = AR/AG/AB), and whether they are depths.
+        DeepReader* reader = OIIO_ALLOCA(DeepReader, nc);
+        int* weight        = OIIO_ALLOCA(int, nc);
+        bool* isz          = OIIO_ALLOCA(bool, nc);
+        const char** chan  = OIIO_ALLOCA(const char*, nc);
+        for (int c = 0; c < nc; ++c) {
+            reader[c] = deep_reader(dd->channeltype(c));
+            weight[c] = c == R_channel ? 1
+                        : c == G_channel ? 2
+                        : c == B_channel ? 3
+                                         : 0;
+            isz[c]    = (c == Z_channel || c == Zback_channel);
+        }
+
         for (ImageBuf::Iterator<DSTTYPE> r(dst, roi); !r.done(); ++r) {
             int x = r.x(), y = r.y(), z = r.z();
-            int samps = src.deep_samples(x, y, z);
+            int64_t pixel = src.pixelindex(x, y, z, true);
+            int samps     = dd->samples(pixel);
             // Clear accumulated values for this pixel (0 for colors, big for Z)
             memset(val, 0, nc * sizeof(float));
             if (Z_channel >= 0 && samps == 0)
                 val[Z_channel] = 1.0e30;
             if (Zback_channel >= 0 && samps == 0)
                 val[Zback_channel] = 1.0e30;
+            if (samps)
+                for (int c = 0; c < nc; ++c)
+                    chan[c] = (const char*)dd->data_ptr(pixel, c, 0);
             for (int s = 0; s < samps; ++s) {
-                float AR = ARval, AG = AGval, AB = ABval;  // make copies
-                float alpha = (AR + AG + AB) / 3.0f;
-                if (alpha >= 1.0f)
+                float a[4];
+                a[1] = ARval, a[2] = AGval, a[3] = ABval;  // make copies
+                a[0] = (a[1] + a[2] + a[3]) / 3.0f;
+                if (a[0] >= 1.0f)
                     break;
                 for (int c = 0; c < nc; ++c) {
-                    float v = src.deep_value(x, y, z, c, s);
-                    if (c == Z_channel || c == Zback_channel)
-                        val[c] *= alpha;  // because Z are not premultiplied
-                    float a;
-                    if (c == R_channel)
-                        a = AR;
-                    else if (c == G_channel)
-                        a = AG;
-                    else if (c == B_channel)
-                        a = AB;
-                    else
-                        a = alpha;
-                    val[c] += (1.0f - a) * v;
+                    float v = reader[c](chan[c] + s * samplesize);
+                    if (isz[c])
+                        val[c] *= a[0];  // because Z are not premultiplied
+                    val[c] += (1.0f - a[weight[c]]) * v;
                 }
             }
 
@@ -83,6 +166,7 @@ flatten_(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 }
 
 
+
 bool
 ImageBufAlgo::flatten(ImageBuf& dst, const ImageBuf& src, ROI roi, int nthreads)
 {
@@ -256,7 +340,8 @@ ImageBufAlgo::deep_merge(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
 
     // First, set the capacity of the dst image to reserve enough space for
     // the segments of both source images, including any splits that may
-    // occur.
+    // occur. The counting is done in parallel, with each pixel's depths
+    // read just once; the capacities are then set in one pass.
     DeepData& dstdd(*dst.deepdata());
     const DeepData& Add(*A.deepdata());
     const DeepData& Bdd(*B.deepdata());
@@ -264,84 +349,94 @@ ImageBufAlgo::deep_merge(ImageBuf& dst, const ImageBuf& A, const ImageBuf& B,
     int Azbackchan = Add.Zback_channel();
     int Bzchan     = Bdd.Z_channel();
     int Bzbackchan = Bdd.Zback_channel();
-    for (int z = roi.zbegin; z < roi.zend; ++z)
-        for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel            = dst.pixelindex(x, y, z, true);
-                int Apixel              = A.pixelindex(x, y, z, true);
-                int Bpixel              = B.pixelindex(x, y, z, true);
-                int Asamps              = Add.samples(Apixel);
-                int Bsamps              = Bdd.samples(Bpixel);
-                int nsplits             = 0;
-                int self_overlap_splits = 0;
-                for (int s = 0; s < Asamps; ++s) {
-                    float src_z     = Add.deep_value(Apixel, Azchan, s);
-                    float src_zback = Add.deep_value(Apixel, Azbackchan, s);
-                    for (int d = 0; d < Bsamps; ++d) {
-                        float dst_z     = Bdd.deep_value(Bpixel, Bzchan, d);
-                        float dst_zback = Bdd.deep_value(Bpixel, Bzbackchan, d);
-                        if (src_z > dst_z && src_z < dst_zback)
-                            ++nsplits;
-                        if (src_zback > dst_z && src_zback < dst_zback)
-                            ++nsplits;
-                        if (dst_z > src_z && dst_z < src_zback)
-                            ++nsplits;
-                        if (dst_zback > src_z && dst_zback < src_zback)
-                            ++nsplits;
-                    }
-                    // Check for splits src vs src -- in case they overlap!
-                    for (int ss = s; ss < Asamps; ++ss) {
-                        float src_z2     = Add.deep_value(Apixel, Azchan, ss);
-                        float src_zback2 = Add.deep_value(Apixel, Azbackchan,
-                                                          ss);
-                        if (src_z2 > src_z && src_z2 < src_zback)
-                            ++self_overlap_splits;
-                        if (src_zback2 > src_z && src_zback2 < src_zback)
-                            ++self_overlap_splits;
-                        if (src_z > src_z2 && src_z < src_zback2)
-                            ++self_overlap_splits;
-                        if (src_zback > src_z2 && src_zback < src_zback2)
-                            ++self_overlap_splits;
-                    }
-                }
-                // Check for splits dst vs dst -- in case they overlap!
-                for (int d = 0; d < Bsamps; ++d) {
-                    float dst_z     = Bdd.deep_value(Bpixel, Bzchan, d);
-                    float dst_zback = Bdd.deep_value(Bpixel, Bzbackchan, d);
-                    for (int dd = d; dd < Bsamps; ++dd) {
-                        float dst_z2     = Bdd.deep_value(Bpixel, Bzchan, dd);
-                        float dst_zback2 = Bdd.deep_value(Bpixel, Bzbackchan,
-                                                          dd);
-                        if (dst_z2 > dst_z && dst_z2 < dst_zback)
-                            ++self_overlap_splits;
-                        if (dst_zback2 > dst_z && dst_zback2 < dst_zback)
-                            ++self_overlap_splits;
-                        if (dst_z > dst_z2 && dst_z < dst_zback2)
-                            ++self_overlap_splits;
-                        if (dst_zback > dst_z2 && dst_zback < dst_zback2)
-                            ++self_overlap_splits;
-                    }
-                }
-
-                dstdd.set_capacity(dstpixel, Asamps + Bsamps + nsplits
-                                                 + self_overlap_splits);
+    std::vector<int> capacity(dstdd.pixels(), -1);
+    deep_parallel_pixels(dst, roi, nthreads, [&](int64_t dstpixel, int x,
+                                                 int y, int z) {
+        int Apixel = A.pixelindex(x, y, z, true);
+        int Bpixel = B.pixelindex(x, y, z, true);
+        int Asamps = Add.samples(Apixel);
+        int Bsamps = Bdd.samples(Bpixel);
+        float* depths;
+        OIIO_ALLOCATE_STACK_OR_HEAP(depths, float, 2 * (Asamps + Bsamps));
+        float* Az     = depths;
+        float* Azback = Az + Asamps;
+        float* Bz     = Azback + Asamps;
+        float* Bzback = Bz + Bsamps;
+        for (int s = 0; s < Asamps; ++s) {
+            Az[s]     = Add.deep_value(Apixel, Azchan, s);
+            Azback[s] = Add.deep_value(Apixel, Azbackchan, s);
+        }
+        for (int d = 0; d < Bsamps; ++d) {
+            Bz[d]     = Bdd.deep_value(Bpixel, Bzchan, d);
+            Bzback[d] = Bdd.deep_value(Bpixel, Bzbackchan, d);
+        }
+        int nsplits             = 0;
+        int self_overlap_splits = 0;
+        for (int s = 0; s < Asamps; ++s) {
+            float src_z     = Az[s];
+            float src_zback = Azback[s];
+            for (int d = 0; d < Bsamps; ++d) {
+                float dst_z     = Bz[d];
+                float dst_zback = Bzback[d];
+                if (src_z > dst_z && src_z < dst_zback)
+                    ++nsplits;
+                if (src_zback > dst_z && src_zback < dst_zback)
+                    ++nsplits;
+                if (dst_z > src_z && dst_z < src_zback)
+                    ++nsplits;
+                if (dst_zback > src_z && dst_zback < src_zback)
+                    ++nsplits;
+            }
+            // Check for splits src vs src -- in case they overlap!
+            for (int ss = s; ss < Asamps; ++ss) {
+                float src_z2     = Az[ss];
+                float src_zback2 = Azback[ss];
+                if (src_z2 > src_z && src_z2 < src_zback)
+                    ++self_overlap_splits;
+                if (src_zback2 > src_z && src_zback2 < src_zback)
+                    ++self_overlap_splits;
+                if (src_z > src_z2 && src_z < src_zback2)
+                    ++self_overlap_splits;
+                if (src_zback > src_z2 && src_zback < src_zback2)
+                    ++self_overlap_splits;
+            }
+        }
+        // Check for splits dst vs dst -- in case they overlap!
+        for (int d = 0; d < Bsamps; ++d) {
+            float dst_z     = Bz[d];
+            float dst_zback = Bzback[d];
+            for (int dd = d; dd < Bsamps; ++dd) {
+                float dst_z2     = Bz[dd];
+                float dst_zback2 = Bzback[dd];
+                if (dst_z2 > dst_z && dst_z2 < dst_zback)
+                    ++self_overlap_splits;
+                if (dst_zback2 > dst_z && dst_zback2 < dst_zback)
+                    ++self_overlap_splits;
+                if (dst_z > dst_z2 && dst_z < dst_zback2)
+                    ++self_overlap_splits;
+                if (dst_zback > dst_z2 && dst_zback < dst_zback2)
+                    ++self_overlap_splits;
             }
+        }
+        capacity[dstpixel] = Asamps + Bsamps + nsplits + self_overlap_splits;
+    });
+    for (int64_t p = 0, n = dstdd.pixels(); p < n; ++p)
+        if (capacity[p] >= 0)
+            dstdd.set_capacity(p, capacity[p]);
 
     bool ok = ImageBufAlgo::copy(dst, A, TypeDesc::UNKNOWN, roi, nthreads);
 
-    for (int z = roi.zbegin; z < roi.zend; ++z)
-        for (int y = roi.ybegin; y < roi.yend; ++y)
-            for (int x = roi.xbegin; x < roi.xend; ++x) {
-                int dstpixel = dst.pixelindex(x, y, z, true);
-                int Bpixel   = B.pixelindex(x, y, z, true);
-                OIIO_DASSERT(dstpixel >= 0);
-                // OIIO_UNUSED_OK int oldcap = dstdd.capacity (dstpixel);
-                dstdd.merge_deep_pixels(dstpixel, Bdd, Bpixel);
-                // OIIO_DASSERT (oldcap == dstdd.capacity(dstpixel) &&
-                //          "Broken: we did not preallocate enough capacity");
-                if (occlusion_cull)
-                    dstdd.occlusion_cull(dstpixel);
-            }
+    // Now merge B's pixels in, in parallel. Make sure the samples are
+    // allocated first, so that it doesn't happen on some thread while
+    // others are already changing their pixels.
+    dstdd.allocate();
+    deep_parallel_pixels(dst, roi, nthreads,
+                         [&](int64_t dstpixel, int x, int y, int z) {
+                             int Bpixel = B.pixelindex(x, y, z, true);
+                             dstdd.merge_deep_pixels(dstpixel, Bdd, Bpixel);
+                             if (occlusion_cull)
+                                 dstdd.occlusion_cull(dstpixel);
+                         });
     return ok;
 }
 
@@ -362,7 +457,7 @@ ImageBufAlgo::deep_merge(const ImageBuf& A, const ImageBuf& B,
 
 bool
 ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
-                           const ImageBuf& thresh, ROI roi, int /*nthreads*/)
+                           const ImageBuf& thresh, ROI roi, int nthreads)
 {
     pvt::LoggedTimer logtime("IBA::deep_holdout");
     if (!src.deep() || !thresh.deep()) {
@@ -388,22 +483,22 @@ ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
                 if (dstpixel >= 0 && srcpixel >= 0)
                     dstdd.set_capacity(dstpixel, srcdd.capacity(srcpixel));
             }
-    // Now we compute each pixel: We copy the src pixel to dst, then split
-    // any samples that span the opaque threshold, and then delete any
-    // samples that lie beyond the threshold.
+    // Now we compute each pixel, in parallel: We copy the src pixel to dst,
+    // then split any samples that span the opaque threshold, and then
+    // delete any samples that lie beyond the threshold.
     int Zchan     = dstdd.Z_channel();
     int Zbackchan = dstdd.Zback_channel();
     const DeepData& threshdd(*thresh.deepdata());
-    for (ImageBuf::Iterator<float> r(dst, roi); !r.done(); ++r) {
-        int x = r.x(), y = r.y(), z = r.z();
+    dstdd.allocate();  // before going parallel
+    deep_parallel_pixels(dst, roi, nthreads, [&](int64_t dstpixel, int x,
+                                                 int y, int z) {
         int srcpixel = src.pixelindex(x, y, z, true);
         if (srcpixel < 0)
-            continue;  // Nothing in this pixel
-        int dstpixel = dst.pixelindex(x, y, z, true);
+            return;  // Nothing in this pixel
         dstdd.copy_deep_pixel(dstpixel, srcdd, srcpixel);
         int threshpixel = thresh.pixelindex(x, y, z, true);
         if (threshpixel < 0)
-            continue;  // No threshold mask for this pixel
+            return;  // No threshold mask for this pixel
         float zthresh = threshdd.opaque_z(threshpixel);
         // Eliminate the samples that are entirely beyond the depth
         // threshold. Do this before the split; that makes it less
@@ -424,7 +519,7 @@ ImageBufAlgo::deep_holdout(ImageBuf& dst, const ImageBuf& src,
                 }
             }
         }
-    }
+    });
     return true;
 }
 
@@ -442,4 +537,139 @@ ImageBufAlgo::deep_holdout(const ImageBuf& src, const ImageBuf& thresh, ROI roi,
 }
 
 
+
+// Least common multiple of two positive ints.
+static int
+lcm(int a, int b)
+{
+    int x = a, y = b;
+    while (y) {
+        int t = x % y;
+        x     = y;
+        y     = t;
+    }
+    return a / x * b;
+}
+
+
+
+bool
+ImageBufAlgo::deep_stream(
+    ImageOutput* out, cspan<ImageInput*> inputs,
+    const std::function<bool(ImageBuf& dst, cspan<ImageBuf> src)>& op,
+    int striprows)
+{
+    pvt::LoggedTimer logtime("IBA::deep_stream");
+    if (!out)
+        return false;
+    if (!inputs.size()) {
+        out->errorfmt("deep_stream: no inputs");
+        return false;
+    }
+    const ImageSpec& spec(inputs[0]->spec());
+    const ImageSpec& outspec(out->spec());
+    if (spec.depth != 1) {
+        out->errorfmt("deep_stream does not support volume images");
+        return false;
+    }
+
+    // Every strip must be a whole number of tile rows of each tiled file.
+    int rowmultiple = outspec.tile_width ? outspec.tile_height : 1;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        const ImageSpec& inspec(inputs[i]->spec());
+        if (!inspec.deep) {
+            out->errorfmt("deep_stream: input {} is not a deep image", i);
+            return false;
+        }
+        if (inspec.x != spec.x || inspec.y != spec.y || inspec.z != spec.z
+            || inspec.width != spec.width || inspec.height != spec.height
+            || inspec.depth != spec.depth) {
+            out->errorfmt("deep_stream: input {} data window does not match",
+                          i);
+            return false;
+        }
+        if (inspec.tile_width)
+            rowmultiple = lcm(rowmultiple, inspec.tile_height);
+    }
+    if (outspec.x != spec.x || outspec.y != spec.y || outspec.z != spec.z
+        || outspec.width != spec.width || outspec.height != spec.height
+        || outspec.depth != spec.depth) {
+        out->errorfmt("deep_stream: output data window does not match");
+        return false;
+    }
+    int rows = round_to_multiple(std::max(striprows, 1), rowmultiple);
+
+    std::vector<ImageBuf> src(inputs.size());
+    int z = spec.z, xend = spec.x + spec.width;
+    for (int y = spec.y; y < spec.y + spec.height; y += rows) {
+        int yend = std::min(y + rows, spec.y + spec.height);
+
+        // Read this strip of each input
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            ImageInput* in = inputs[i];
+            ImageSpec stripspec(in->spec());
+            stripspec.y      = y;
+            stripspec.height = yend - y;
+            src[i].reset(stripspec, InitializePixels::No);
+            DeepData& dd(*src[i].deepdata());
+            int subimage = in->current_subimage();
+            int miplevel = in->current_miplevel();
+            bool ok      = stripspec.tile_width
+                               ? in->read_native_deep_tiles(subimage, miplevel,
+                                                            spec.x, xend, y,
+                                                            yend, z, z + 1, 0,
+                                                            stripspec.nchannels,
+                                                            dd)
+                               : in->read_native_deep_scanlines(
+                                   subimage, miplevel, y, yend, z, 0,
+                                   stripspec.nchannels, dd);
+            if (!ok) {
+                out->errorfmt("{}", in->geterror());
+                return false;
+            }
+        }
+
+        ImageBuf dst;
+        if (!op(dst, src)) {
+            out->errorfmt("{}", dst.has_error() ? dst.geterror()
+                                                : "deep_stream: op failed");
+            return false;
+        }
+        ROI r = dst.roi();
+        if (r.xbegin != spec.x || r.xend != xend || r.ybegin != y
+            || r.yend != yend || r.zbegin != z || r.zend != z + 1) {
+            out->errorfmt("deep_stream: op did not produce the strip {}-{}",
+                          y, yend - 1);
+            return false;
+        }
+
+        // Write the result strip
+        bool ok = true;
+        if (dst.deep()) {
+            const DeepData& dd(*dst.deepdata());
+            ok = outspec.tile_width
+                     ? out->write_deep_tiles(spec.x, xend, y, yend, z, z + 1,
+                                             dd)
+                     : out->write_deep_scanlines(y, yend, z, dd);
+        } else {
+            TypeDesc format    = dst.spec().format;
+            const void* pixels = dst.localpixels();
+            std::unique_ptr<char[]> tmp;
+            if (!pixels) {
+                tmp.reset(new char[dst.spec().image_bytes()]);
+                dst.get_pixels(r, format, tmp.get());
+                pixels = tmp.get();
+            }
+            ok = outspec.tile_width
+                     ? out->write_tiles(spec.x, xend, y, yend, z, z + 1, format,
+                                        pixels)
+                     : out->write_scanlines(y, yend, z, format, pixels);
+        }
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+
 OIIO_NAMESPACE_END
@@ -6,6 +6,7 @@
 #include <cstdio>
 #include <iomanip>
 #include <iostream>
+#include <random>
 #include <string>
 
 #include <OpenImageIO/platform.h>
@@ -20,13 +21,18 @@
 
 #include <OpenImageIO/argparse.h>
 #include <OpenImageIO/benchmark.h>
+#include <OpenImageIO/deepdata.h>
+#include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
+#include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
 #include <OpenImageIO/timer.h>
 #include <OpenImageIO/unittest.h>
 
+#include "imageio_pvt.h"
+
 using namespace OIIO;
 
 
@@ -879,6 +885,314 @@ test_IBAprep()
 
 
 
+void
+test_parallel_image_tiles()
+{
+    std::cout << "test parallel_image Split_Tile\n";
+    // An ROI that doesn't line up with the tile grid, to exercise the
+    // partial tiles on every edge.
+    ROI roi(-37, 301, 5, 230, 0, 1, 0, 3);
+    ImageSpec spec(roi, TypeDesc::INT);
+    ImageBuf hits(spec);
+    ImageBufAlgo::zero(hits);
+    ImageBufAlgo::parallel_image_options opt(0, Split_Tile, 1);
+    ImageBufAlgo::parallel_tile_grid grid;
+    grid.tilewidth   = 64;
+    grid.tileheight  = 32;
+    grid.tilexorigin = -64;
+    grid.tileyorigin = 0;
+    atomic_int misaligned(0);
+    ImageBufAlgo::parallel_image(roi, opt, grid, [&](ROI r) {
+        // Each piece must lie within a single tile of the grid.
+        if ((r.xbegin - grid.tilexorigin) / grid.tilewidth
+                != (r.xend - 1 - grid.tilexorigin) / grid.tilewidth
+            || (r.ybegin - grid.tileyorigin) / grid.tileheight
+                   != (r.yend - 1 - grid.tileyorigin) / grid.tileheight)
+            ++misaligned;
+        for (ImageBuf::Iterator<int> p(hits, r); !p.done(); ++p)
+            p[0] = p[0] + 1;
+    });
+    OIIO_CHECK_EQUAL(misaligned, 0);
+    // Every pixel must have been visited exactly once.
+    auto stats = ImageBufAlgo::computePixelStats(hits, roi);
+    OIIO_CHECK_EQUAL(stats.min[0], 1.0f);
+    OIIO_CHECK_EQUAL(stats.max[0], 1.0f);
+
+    // An ImageCache-backed tiled image gets Split_Tile along its own tiles,
+    // with the cache's memory budget.
+    ImageBuf tiled(ImageSpec(256, 128, 3, TypeDesc::UINT8));
+    ImageBufAlgo::fill(tiled, { 0.25f, 0.5f, 0.75f });
+    tiled.set_write_tiles(32, 16);
+    tiled.write("partiles_iba_test.tif");
+    ImageCache* ic = ImageCache::create(false);
+    ic->attribute("max_memory_MB", 10.0f);
+    float mb = 0.0f;
+    ic->getattribute("max_memory_MB", mb);
+    ImageBuf cached("partiles_iba_test.tif", 0, 0, ic);
+    cached.read(0, 0, false /*force*/);
+    OIIO_CHECK_ASSERT(cached.storage() == ImageBuf::IMAGECACHE);
+    ImageBufAlgo::parallel_tile_grid cgrid;
+    opt = ImageBufAlgo::parallel_options_for(cached, cgrid);
+    OIIO_CHECK_ASSERT(opt.splitdir == Split_Tile);
+    OIIO_CHECK_EQUAL(cgrid.tilewidth, 32);
+    OIIO_CHECK_EQUAL(cgrid.tileheight, 16);
+    OIIO_CHECK_EQUAL(cgrid.tilebytes, size_t(32 * 16 * 3));
+    OIIO_CHECK_EQUAL(cgrid.cachebytes, size_t(double(mb) * 1024 * 1024));
+    // With plenty of tiles and no minimum work per task to satisfy, the
+    // chunks of tiles that all threads claim must stay within half of the
+    // cache, and be smaller than they would be with no budget.
+    int maxthreads = 64;
+    int64_t ntiles = int64_t(1) << 20;
+    size_t minitems = size_t(1) << 40;
+    int64_t chunk = pvt::parallel_tile_chunk(ntiles, 32 * 16, maxthreads,
+                                             minitems, cgrid.tilebytes,
+                                             cgrid.cachebytes);
+    int64_t unbudgeted = pvt::parallel_tile_chunk(ntiles, 32 * 16,
+                                                  maxthreads, minitems,
+                                                  cgrid.tilebytes, 0);
+    OIIO_CHECK_LE(maxthreads * chunk * cgrid.tilebytes, cgrid.cachebytes / 2);
+    OIIO_CHECK_LT(chunk, unbudgeted);
+    // And copying through the tiled decomposition gets every pixel.
+    ImageBuf copied = ImageBufAlgo::copy(cached);
+    OIIO_CHECK_EQUAL(ImageBufAlgo::compare(copied, tiled, 0.0f, 0.0f).nfail,
+                     0);
+    // Don't let the ImageBuf outlive the ImageCache it uses.
+    cached.clear();
+    ImageCache::destroy(ic);
+    Filesystem::remove("partiles_iba_test.tif");
+}
+
+
+
+// Make a deep RGBAZZback image with 0-3 samples per pixel, whose depths
+// are on a coarse grid so that samples of different images (and of the
+// same pixel) often overlap or coincide.
+static ImageBuf
+make_deep_test_image(int xres, int yres, unsigned int seed)
+{
+    ImageSpec spec(xres, yres, 6, TypeFloat);
+    spec.channelnames = { "R", "G", "B", "A", "Z", "Zback" };
+    spec.alpha_channel = 3;
+    spec.z_channel     = 4;
+    spec.deep          = true;
+    ImageBuf buf(spec);
+    DeepData& dd(*buf.deepdata());
+    std::mt19937 rng(seed);
+    std::vector<unsigned int> nsamples(dd.pixels());
+    for (auto& n : nsamples)
+        n = rng() % 4;
+    dd.set_all_samples(nsamples);
+    const float alphas[] = { 0.25f, 0.5f, 0.75f, 1.0f };
+    for (int64_t p = 0; p < dd.pixels(); ++p) {
+        float z = float(rng() % 8) * 0.25f;
+        for (int s = 0; s < dd.samples(p); ++s) {
+            float a = alphas[rng() % 4];
+            dd.set_deep_value(p, 0, s, a * float(rng() % 5) * 0.25f);
+            dd.set_deep_value(p, 1, s, a * float(rng() % 5) * 0.25f);
+            dd.set_deep_value(p, 2, s, a * float(rng() % 5) * 0.25f);
+            dd.set_deep_value(p, 3, s, a);
+            dd.set_deep_value(p, 4, s, z);
+            dd.set_deep_value(p, 5, s, z + float(1 + rng() % 3) * 0.25f);
+            z += float(rng() % 3) * 0.25f;
+        }
+    }
+    return buf;
+}
+
+
+
+// Are the samples of two deep images bit for bit the same?
+static bool
+deep_identical(const ImageBuf& A, const ImageBuf& B)
+{
+    const DeepData& a(*A.deepdata());
+    const DeepData& b(*B.deepdata());
+    if (a.pixels() != b.pixels() || a.samplesize() != b.samplesize())
+        return false;
+    for (int64_t p = 0; p < a.pixels(); ++p) {
+        int n = a.samples(p);
+        if (n != b.samples(p))
+            return false;
+        if (n
+            && memcmp(a.data_ptr(p, 0, 0), b.data_ptr(p, 0, 0),
+                      n * a.samplesize()))
+            return false;
+    }
+    return true;
+}
+
+
+
+void
+test_deep_merge_holdout_parallel()
+{
+    std::cout << "test parallel deep_merge and deep_holdout\n";
+    // Big enough to span several DeepData chunks.
+    ImageBuf A = make_deep_test_image(83, 61, 1);
+    ImageBuf B = make_deep_test_image(83, 61, 2);
+
+    // deep_merge on many threads must match merging pixel by pixel.
+    ImageBuf ref;
+    ref.copy(A);
+    DeepData& refdd(*ref.deepdata());
+    for (int64_t p = 0; p < refdd.pixels(); ++p) {
+        refdd.merge_deep_pixels(p, *B.deepdata(), int(p));
+        refdd.occlusion_cull(p);
+    }
+    ImageBuf merged = ImageBufAlgo::deep_merge(A, B, true, {}, 8);
+    OIIO_CHECK_ASSERT(!merged.has_error());
+    OIIO_CHECK_ASSERT(deep_identical(merged, ref));
+
+    // deep_holdout on many threads must match doing it on one.
+    ImageBuf held1 = ImageBufAlgo::deep_holdout(A, B, {}, 1);
+    ImageBuf heldN = ImageBufAlgo::deep_holdout(A, B, {}, 8);
+    OIIO_CHECK_ASSERT(!held1.has_error() && !heldN.has_error());
+    OIIO_CHECK_ASSERT(deep_identical(held1, heldN));
+}
+
+
+
+void
+test_deep_stream()
+{
+    std::cout << "test deep_stream\n";
+    // One scanline file and one tiled file, whose tile height forces the
+    // strips to be rounded up.
+    {
+        ImageBuf A = make_deep_test_image(83, 61, 3);
+        ImageBuf B = make_deep_test_image(83, 61, 4);
+        A.write("deep_stream_A.exr");
+        B.set_write_tiles(16, 16);
+        B.write("deep_stream_B.exr");
+    }
+    ImageBuf A("deep_stream_A.exr"), B("deep_stream_B.exr");
+    A.read(0, 0, true);
+    B.read(0, 0, true);
+
+    auto inA = ImageInput::open("deep_stream_A.exr");
+    auto inB = ImageInput::open("deep_stream_B.exr");
+    OIIO_CHECK_ASSERT(inA && inB);
+    if (!inA || !inB)
+        return;
+    ImageInput* inputs[] = { inA.get(), inB.get() };
+
+    // Merge a strip at a time, deep result
+    {
+        auto out = ImageOutput::create("deep_stream_merge.exr");
+        OIIO_CHECK_ASSERT(out);
+        if (!out)
+            return;
+        OIIO_CHECK_ASSERT(out->open("deep_stream_merge.exr", A.spec()));
+        bool ok = ImageBufAlgo::deep_stream(
+            out.get(), inputs,
+            [](ImageBuf& dst, cspan<ImageBuf> src) {
+                return ImageBufAlgo::deep_merge(dst, src[0], src[1]);
+            },
+            7);
+        OIIO_CHECK_ASSERT(ok);
+        if (!ok)
+            std::cout << "  " << out->geterror() << "\n";
+        out->close();
+    }
+    ImageBuf merged("deep_stream_merge.exr");
+    merged.read(0, 0, true);
+    ImageBuf whole = ImageBufAlgo::deep_merge(A, B);
+    OIIO_CHECK_ASSERT(deep_identical(merged, whole));
+
+    // Flatten a strip at a time, flat result
+    {
+        ImageSpec flatspec(A.spec());
+        flatspec.deep = false;
+        auto out      = ImageOutput::create("deep_stream_flat.exr");
+        OIIO_CHECK_ASSERT(out);
+        if (!out)
+            return;
+        OIIO_CHECK_ASSERT(out->open("deep_stream_flat.exr", flatspec));
+        bool ok = ImageBufAlgo::deep_stream(
+            out.get(), cspan<ImageInput*>(inputs, 1),
+            [](ImageBuf& dst, cspan<ImageBuf> src) {
+                return ImageBufAlgo::flatten(dst, src[0]);
+            },
+            7);
+        OIIO_CHECK_ASSERT(ok);
+        if (!ok)
+            std::cout << "  " << out->geterror() << "\n";
+        out->close();
+    }
+    ImageBuf flat("deep_stream_flat.exr");
+    auto comp = ImageBufAlgo::compare(flat, ImageBufAlgo::flatten(A), 0.0f,
+                                      0.0f);
+    OIIO_CHECK_EQUAL(comp.nfail, 0);
+    OIIO_CHECK_EQUAL(comp.maxerror, 0.0f);
+
+    inA.reset();
+    inB.reset();
+    for (auto f : { "deep_stream_A.exr", "deep_stream_B.exr",
+                    "deep_stream_merge.exr", "deep_stream_flat.exr" })
+        Filesystem::remove(f);
+}
+
+
+
+void
+test_deep_int64_ids()
+{
+    std::cout << "test deep sort/split/merge of INT64 ids\n";
+    TypeDesc types[]    = { TypeFloat, TypeFloat, TypeHalf, TypeDesc::INT64 };
+    std::string names[] = { "Z", "Zback", "A", "id" };
+    auto setid = [](DeepData& dd, int64_t p, int s, int64_t id) {
+        memcpy(dd.data_ptr(p, 3, s), &id, sizeof(id));
+    };
+    auto getid = [](const DeepData& dd, int64_t p, int s) {
+        int64_t id = 0;
+        memcpy(&id, dd.data_ptr(p, 3, s), sizeof(id));
+        return id;
+    };
+    // Ids that can't survive a trip through a float.
+    const int64_t big = (int64_t(1) << 62) + 12345;
+
+    // Samples in reverse depth order, so sorting reverses them.
+    const int n = 6;
+    DeepData dd;
+    dd.init(1, 4, types, names);
+    dd.set_samples(0, n);
+    for (int s = 0; s < n; ++s) {
+        dd.set_deep_value(0, 0, s, float(n - s));
+        dd.set_deep_value(0, 1, s, float(n - s) + 0.5f);
+        dd.set_deep_value(0, 2, s, 0.5f);
+        setid(dd, 0, s, big + s);
+    }
+    dd.sort(0);
+    for (int s = 0; s < n; ++s) {
+        OIIO_CHECK_EQUAL(dd.deep_value(0, 0, s), float(s + 1));
+        OIIO_CHECK_EQUAL(getid(dd, 0, s), big + (n - 1 - s));
+    }
+
+    // Splitting the nearest sample duplicates its id.
+    OIIO_CHECK_ASSERT(dd.split(0, 1.25f));
+    OIIO_CHECK_EQUAL(dd.samples(0), n + 1);
+    OIIO_CHECK_EQUAL(getid(dd, 0, 0), big + (n - 1));
+    for (int s = 0; s < n; ++s)
+        OIIO_CHECK_EQUAL(getid(dd, 0, s + 1), big + (n - 1 - s));
+
+    // Merging in a sample in front of them all keeps every id.
+    DeepData src;
+    src.init(1, 4, types, names);
+    src.set_samples(0, 1);
+    src.set_deep_value(0, 0, 0, 0.25f);
+    src.set_deep_value(0, 1, 0, 0.5f);
+    src.set_deep_value(0, 2, 0, 0.5f);
+    setid(src, 0, 0, -big);
+    dd.merge_deep_pixels(0, src, 0);
+    OIIO_CHECK_EQUAL(dd.samples(0), n + 2);
+    OIIO_CHECK_EQUAL(getid(dd, 0, 0), -big);
+    OIIO_CHECK_EQUAL(getid(dd, 0, 1), big + (n - 1));
+    for (int s = 0; s < n; ++s)
+        OIIO_CHECK_EQUAL(getid(dd, 0, s + 2), big + (n - 1 - s));
+}
+
+
+
 void
 benchmark_parallel_image(int res, int iters)
 {
@@ -995,6 +1309,10 @@ main(int argc, char** argv)
     histogram_computation_test();
     test_maketx_from_imagebuf();
     test_IBAprep();
+    test_parallel_image_tiles();
+    test_deep_int64_ids();
+    test_deep_merge_holdout_parallel();
+    test_deep_stream();
     test_opencv();
 
     benchmark_parallel_image(64, iterations * 64);
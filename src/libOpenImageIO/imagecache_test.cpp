@@ -3,10 +3,13 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 
+#include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagecache.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/sysutil.h>
+#include <OpenImageIO/thread.h>
 #include <OpenImageIO/unittest.h>
 
 #include <iostream>
@@ -134,6 +137,194 @@ test_app_buffer()
 
 
 
+// A tiled image written to disk for the length of a test, with a box on a
+// black background, and removed again when it goes out of scope. The tier
+// tests read it through a cache too small to hold it.
+struct TiledTestImage {
+    TiledTestImage(string_view name, int res, TypeDesc format = TypeFloat)
+        : filename(name)
+        , res(res)
+    {
+        ImageSpec spec(res, res, 4, format);
+        spec.tile_width  = 64;
+        spec.tile_height = 64;
+        ImageBuf A(spec);
+        ImageBufAlgo::zero(A);
+        ImageBufAlgo::render_box(A, res / 10, res / 10, res * 8 / 10,
+                                 res * 7 / 10, { 0.5f, 0.25f, 1.0f, 1.0f },
+                                 true);
+        A.write(filename);
+        ref.resize(spec.image_pixels() * spec.nchannels);
+        A.get_pixels(A.roi(), TypeFloat, ref.data());
+    }
+    ~TiledTestImage() { Filesystem::remove(filename.string()); }
+
+    // Read the whole image through `ic`, return true if it matches.
+    bool read_matches(ImageCache* ic) const
+    {
+        std::vector<float> pixels(ref.size(), -1.0f);
+        return ic->get_pixels(filename, 0, 0, 0, res, 0, res, 0, 1, TypeFloat,
+                              pixels.data())
+               && pixels == ref;
+    }
+
+    ustring filename;
+    int res;
+    std::vector<float> ref;
+};
+
+
+
+// Test that tiles evicted from memory are held in compressed form, and are
+// retrieved from there rather than reread.
+void
+test_compressed_tiles()
+{
+    std::cout << "\nTesting compressed tiles\n";
+    TiledTestImage img("compressed_src.exr", 1024, TypeHalf);
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+    imagecache->attribute("forcefloat", 1);  // 16 MB of float tiles
+    imagecache->attribute("max_memory_MB", 10.0f);
+    imagecache->attribute("max_compressed_memory_MB", 16.0f);
+    for (int pass = 0; pass < 2; ++pass)
+        OIIO_CHECK_ASSERT(img.read_matches(imagecache));
+    long long hits = 0, used = 0;
+    imagecache->getattribute("stat:compressed_tiles_hits", TypeInt64, &hits);
+    imagecache->getattribute("stat:compressed_memory_used", TypeInt64, &used);
+    std::cout << "  " << hits << " hits, " << used << " bytes compressed\n";
+    OIIO_CHECK_ASSERT(hits > 0);
+    OIIO_CHECK_ASSERT(used <= 16 * 1024 * 1024);
+    ImageCache::destroy(imagecache);
+}
+
+
+
+// Test that tiles evicted from memory go to the disk cache, and that its
+// contents are still usable by a later ImageCache.
+void
+test_diskcache()
+{
+    std::cout << "\nTesting disk cache\n";
+    std::string cachename("diskcache_test.cache");
+    Filesystem::remove(cachename);
+
+    // A 16 MB float image overflows the 10 MB tile cache
+    TiledTestImage img("diskcache_src.exr", 1024);
+    for (int run = 0; run < 2; ++run) {
+        ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+        imagecache->attribute("max_memory_MB", 10.0f);
+        imagecache->attribute("diskcache", cachename);
+        imagecache->attribute("max_diskcache_MB", 64.0f);
+        // Read it all twice: the second pass finds evicted tiles in the
+        // disk cache. On the second run, they're there from the start.
+        for (int pass = 0; pass < 2; ++pass)
+            OIIO_CHECK_ASSERT(img.read_matches(imagecache));
+        long long writes = 0, hits = 0;
+        imagecache->getattribute("stat:diskcache_writes", TypeInt64, &writes);
+        imagecache->getattribute("stat:diskcache_hits", TypeInt64, &hits);
+        std::cout << "  run " << run << ": " << writes << " writes, " << hits
+                  << " hits\n";
+        OIIO_CHECK_ASSERT(hits > 0);
+        if (run == 0)
+            OIIO_CHECK_ASSERT(writes > 0);
+        ImageCache::destroy(imagecache);
+    }
+    Filesystem::remove(cachename);
+}
+
+
+
+// NUMA mode should give the same pixels, with several threads sharing a
+// cache small enough to force evictions.
+void
+test_numa()
+{
+    std::cout << "\nTesting NUMA mode (" << Sysutil::numa_nodes()
+              << " nodes)\n";
+    TiledTestImage img("numa_src.exr", 512);
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+    imagecache->attribute("max_memory_MB", 2.0f);  // Less than the 4 MB image
+    imagecache->attribute("numa", 1);
+    imagecache->attribute("numa_replicate", 1);
+    int numa = 0;
+    OIIO_CHECK_ASSERT(imagecache->getattribute("numa", numa) && numa == 1);
+    atomic_int mismatches(0);
+    thread_group threads;
+    for (int t = 0; t < 4; ++t)
+        threads.create_thread([&]() {
+            for (int pass = 0; pass < 2; ++pass)
+                if (!img.read_matches(imagecache))
+                    ++mismatches;
+        });
+    threads.join_all();
+    OIIO_CHECK_EQUAL(mismatches, 0);
+    long long replicas = -1;
+    imagecache->getattribute("stat:numa_replicas", TypeInt64, &replicas);
+    int nodes = Sysutil::numa_nodes();
+    std::vector<long long> remote(nodes, -1);
+    OIIO_CHECK_ASSERT(imagecache->getattribute("stat:numa_remote_uses",
+                                               TypeDesc(TypeDesc::INT64,
+                                                        nodes),
+                                               remote.data()));
+    long long total_remote = -1;
+    imagecache->getattribute("stat:numa_remote_uses", TypeInt64,
+                             &total_remote);
+    std::cout << "  " << replicas << " replicas, remote uses by node:";
+    long long sum = 0;
+    for (auto r : remote) {
+        std::cout << ' ' << r;
+        OIIO_CHECK_ASSERT(r >= 0);
+        sum += r;
+    }
+    std::cout << "\n";
+    OIIO_CHECK_EQUAL(sum, total_remote);
+    if (nodes == 1) {
+        OIIO_CHECK_EQUAL(replicas, 0);
+        OIIO_CHECK_EQUAL(total_remote, 0);
+    }
+    ImageCache::destroy(imagecache);
+}
+
+
+
+// Threads that keep adding new files, while also looking up each other's
+// recent ones (which often misses the lock-free snapshot), must not make
+// the cache publish a copy of the whole file table for every few files.
+void
+test_file_snapshot_growth()
+{
+    std::cout << "\nTesting file snapshot growth\n";
+    ImageCache* imagecache = ImageCache::create(false /*not shared*/);
+    const int nthreads = 4, nfiles = 2000;
+    thread_group threads;
+    for (int t = 0; t < nthreads; ++t)
+        threads.create_thread([&, t]() {
+            ustring exists("exists");
+            int e = 0;
+            for (int i = 0; i < nfiles; ++i) {
+                // None of these exist, but they all get cache entries.
+                std::string mine = Strutil::sprintf("snapshot_%d_%d.tx", t, i);
+                imagecache->get_image_info(ustring(mine), 0, 0, exists,
+                                           TypeInt, &e);
+                std::string other = Strutil::sprintf("snapshot_%d_%d.tx",
+                                                     (t + 1) % nthreads, i / 2);
+                imagecache->get_image_info(ustring(other), 0, 0, exists,
+                                           TypeInt, &e);
+            }
+        });
+    threads.join_all();
+    long long entries = -1;
+    OIIO_CHECK_ASSERT(imagecache->getattribute("stat:file_snapshot_entries",
+                                               TypeInt64, &entries));
+    std::cout << "  " << entries << " snapshot entries for "
+              << nthreads * nfiles << " files\n";
+    OIIO_CHECK_ASSERT(entries >= 0);
+    OIIO_CHECK_ASSERT(entries <= 10LL * nthreads * nfiles);
+    ImageCache::destroy(imagecache);
+}
+
+
+
 int
 main(int /*argc*/, char* /*argv*/[])
 {
@@ -145,6 +336,10 @@ main(int /*argc*/, char* /*argv*/[])
     test_get_pixels_cachechannels(6, 9, 6, 9);
 
     test_app_buffer();
+    test_compressed_tiles();
+    test_diskcache();
+    test_numa();
+    test_file_snapshot_growth();
 
     return unit_test_failures;
 }
@@ -308,7 +308,7 @@ catalog_builtin_plugins()
     DECLAREPLUG_RO (cineon);
 #endif
 #if !defined(DISABLE_DDS)
-    DECLAREPLUG_RO (dds);
+    DECLAREPLUG (dds);
 #endif
 #ifdef USE_DCMTK
 #if !defined(DISABLE_DICOM)
@@ -0,0 +1,200 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+
+#include <OpenImageIO/dassert.h>
+#include <OpenImageIO/thread.h>
+
+#include "imagecache_pvt.h"
+
+
+OIIO_NAMESPACE_BEGIN
+using namespace pvt;
+
+namespace pvt {
+
+
+// Regroup the bytes of n values of elemsize bytes each so that all the
+// first bytes come first, then all the second bytes, etc. For float and
+// half pixels, this puts the exponent and high mantissa bytes together,
+// which makes them far more compressible.
+static void
+shuffle_bytes(const char* src, char* dst, size_t n, int elemsize)
+{
+    for (int b = 0; b < elemsize; ++b, dst += n)
+        for (size_t i = 0; i < n; ++i)
+            dst[i] = src[i * elemsize + b];
+}
+
+
+
+static void
+unshuffle_bytes(const char* src, char* dst, size_t n, int elemsize)
+{
+    for (int b = 0; b < elemsize; ++b, src += n)
+        for (size_t i = 0; i < n; ++i)
+            dst[i * elemsize + b] = src[i];
+}
+
+
+
+void
+CompressedTileCache::max_memory(long long bytes)
+{
+    m_max_memory = std::max(bytes, 0LL);
+    // Shrink to the new budget right away
+    spin_lock lock(m_mutex);
+    while (m_mem_used > m_max_memory && !m_lru.empty())
+        erase(std::prev(m_lru.end()));
+}
+
+
+
+size_t
+CompressedTileCache::entries() const
+{
+    spin_lock lock(m_mutex);
+    return m_index.size();
+}
+
+
+
+void
+CompressedTileCache::erase(EntryList::iterator e)
+{
+    m_mem_used -= (long long)e->size;
+    m_rawsize -= (long long)e->rawsize;
+    m_index.erase(e->id);
+    m_lru.erase(e);
+}
+
+
+
+void
+CompressedTileCache::store(const TileID& id, const void* data, size_t size,
+                           int elemsize)
+{
+    if (!enabled() || size == 0)
+        return;
+    elemsize = std::max(elemsize, 1);
+
+    // Compress without holding the lock.
+    const char* src = (const char*)data;
+    std::unique_ptr<char[]> shuffled;
+    if (elemsize > 1 && size % elemsize == 0) {
+        shuffled.reset(new char[size]);
+        shuffle_bytes(src, shuffled.get(), size / elemsize, elemsize);
+        src = shuffled.get();
+    } else {
+        elemsize = 1;
+    }
+    uLongf csize = compressBound(uLong(size));
+    std::unique_ptr<char[]> compressed(new char[csize]);
+    if (compress2((Bytef*)compressed.get(), &csize, (const Bytef*)src,
+                  uLong(size), Z_BEST_SPEED)
+            != Z_OK
+        || csize > size - size / 8) {
+        // Not worth keeping if we saved less than 1/8 of the memory
+        ++m_rejects;
+        return;
+    }
+    // Trim the allocation down to what was actually used
+    std::unique_ptr<char[]> cdata(new char[csize]);
+    memcpy(cdata.get(), compressed.get(), csize);
+
+    spin_lock lock(m_mutex);
+    auto found = m_index.find(id);
+    if (found != m_index.end())
+        erase(found->second);  // Replace any older copy
+    m_lru.push_front(Entry { id, std::move(cdata), size_t(csize), size,
+                             elemsize });
+    m_index[id] = m_lru.begin();
+    m_mem_used += (long long)csize;
+    m_rawsize += (long long)size;
+    ++m_stores;
+    while (m_mem_used > m_max_memory && !m_lru.empty())
+        erase(std::prev(m_lru.end()));
+}
+
+
+
+bool
+CompressedTileCache::retrieve(const TileID& id, void* data, size_t size)
+{
+    if (!enabled())
+        return false;
+    Entry entry;
+    {
+        spin_lock lock(m_mutex);
+        auto found = m_index.find(id);
+        if (found == m_index.end() || found->second->rawsize != size) {
+            ++m_misses;
+            return false;
+        }
+        // Take it out: once it's back in the main cache, there's no point
+        // in also holding on to the compressed copy.
+        EntryList::iterator e = found->second;
+        entry.data            = std::move(e->data);
+        entry.size            = e->size;
+        entry.elemsize        = e->elemsize;
+        erase(e);
+    }
+
+    std::unique_ptr<char[]> shuffled;
+    char* dst = (char*)data;
+    if (entry.elemsize > 1) {
+        shuffled.reset(new char[size]);
+        dst = shuffled.get();
+    }
+    uLongf rawsize = uLongf(size);
+    if (uncompress((Bytef*)dst, &rawsize, (const Bytef*)entry.data.get(),
+                   uLong(entry.size))
+            != Z_OK
+        || rawsize != size) {
+        ++m_misses;
+        return false;
+    }
+    if (entry.elemsize > 1)
+        unshuffle_bytes(dst, (char*)data, size / entry.elemsize,
+                        entry.elemsize);
+    ++m_hits;
+    return true;
+}
+
+
+
+void
+CompressedTileCache::erase_file(const ImageCacheFile* file)
+{
+    spin_lock lock(m_mutex);
+    for (auto e = m_lru.begin(); e != m_lru.end();) {
+        auto next = std::next(e);
+        if (e->id.file_ptr() == file)
+            erase(e);
+        e = next;
+    }
+}
+
+
+
+void
+CompressedTileCache::clear()
+{
+    spin_lock lock(m_mutex);
+    m_lru.clear();
+    m_index.clear();
+    m_mem_used = 0;
+    m_rawsize  = 0;
+}
+
+
+}  // namespace pvt
+
+OIIO_NAMESPACE_END
@@ -603,10 +603,15 @@ TextureSystemImpl::environment(TextureHandle* texture_handle,
     opt.fill                = options.fill;
     opt.missingcolor        = options.missingcolor;
 
+    // Temp results, with room for any number of channels
+    int tmpchans = round_to_multiple(std::max(nchannels, 4), 4);
+    float* r     = OIIO_ALLOCA(float, 3 * tmpchans);
+    float* drds  = r + tmpchans;
+    float* drdt  = drds + tmpchans;
+
     bool ok          = true;
     Tex::RunMask bit = 1;
     for (int i = 0; i < Tex::BatchWidth; ++i, bit <<= 1) {
-        float r[4], drds[4], drdt[4];  // temp result
         if (mask & bit) {
             opt.sblur  = options.sblur[i];
             opt.tblur  = options.tblur[i];
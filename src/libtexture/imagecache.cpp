@@ -29,6 +29,14 @@
 #include "imagecache_pvt.h"
 #include "imageio_pvt.h"
 
+#ifdef __linux__
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    ifndef MPOL_MF_MOVE
+#        define MPOL_MF_MOVE (1 << 1)
+#    endif
+#endif
+
 
 OIIO_NAMESPACE_BEGIN
 using namespace pvt;
@@ -1179,9 +1187,15 @@ ImageCacheImpl::find_file(ustring filename,
     if (!m_substitute_image.empty())
         filename = m_substitute_image;
 
-    // Shortcut - check the per-thread microcache before grabbing a more
-    // expensive lock on the shared file cache.
+    // Shortcut - check the per-thread microcache, then the lock-free
+    // snapshot, before grabbing a more expensive lock on the shared file
+    // cache.
     ImageCacheFile* tf = replace ? nullptr : thread_info->find_file(filename);
+    if (!tf && !replace) {
+        tf = find_file_in_snapshot(filename);
+        if (tf)
+            thread_info->remember_filename(filename, tf);
+    }
 
     // Make sure the ImageCacheFile entry exists and is in the
     // file cache.  For this part, we need to lock the file cache.
@@ -1208,9 +1222,12 @@ ImageCacheImpl::find_file(ustring filename,
         }
 
         if (newfile) {
+            add_file_to_snapshot(filename, tf);
             check_max_files(thread_info);
             if (!tf->duplicate())
                 ++thread_info->m_stats.unique_files;
+        } else if (!replace) {
+            file_snapshot_miss();
         }
         thread_info->remember_filename(filename, tf);  // add to the microcache
 #if IMAGECACHE_TIME_STATS
@@ -1225,6 +1242,66 @@ ImageCacheImpl::find_file(ustring filename,
 
 
 
+void
+ImageCacheImpl::add_file_to_snapshot(ustring filename, ImageCacheFile* file)
+{
+    spin_lock lock(m_file_snapshot_mutex);
+    m_file_snapshot_pending.emplace_back(filename, file);
+    const FileSnapshot* snapshot = m_file_snapshot.load();
+    size_t batch = std::max(size_t(32), snapshot ? snapshot->size() / 2 : 0);
+    if (m_file_snapshot_pending.size() >= batch)
+        publish_file_snapshot();
+}
+
+
+
+void
+ImageCacheImpl::file_snapshot_miss()
+{
+    // A handful of misses means some threads are looking up files that
+    // are still waiting for a batch to fill up, so publish them early --
+    // but since that copies the whole map, only once they are a fair
+    // fraction of it. Until then, the misses take the locked path.
+    if (++m_file_snapshot_misses < 16)
+        return;
+    spin_lock lock(m_file_snapshot_mutex);
+    m_file_snapshot_misses       = 0;
+    const FileSnapshot* snapshot = m_file_snapshot.load();
+    size_t batch = std::max(size_t(1), snapshot ? snapshot->size() / 8 : 0);
+    if (m_file_snapshot_pending.size() >= batch)
+        publish_file_snapshot();
+}
+
+
+
+void
+ImageCacheImpl::publish_file_snapshot()
+{
+    const FileSnapshot* old = m_file_snapshot.load();
+    std::unique_ptr<FileSnapshot> snapshot(old ? new FileSnapshot(*old)
+                                               : new FileSnapshot);
+    snapshot->reserve(snapshot->size() + m_file_snapshot_pending.size());
+    for (auto& f : m_file_snapshot_pending)
+        snapshot->emplace(f.first, f.second);
+    m_file_snapshot_pending.clear();
+    m_file_snapshot.store(snapshot.get(), std::memory_order_release);
+    m_stat_file_snapshot_entries += snapshot->size();
+    m_file_snapshots.emplace_back(std::move(snapshot));
+}
+
+
+
+void
+ImageCacheImpl::seed_thread_files(ImageCachePerThreadInfo* thread_info) const
+{
+    const FileSnapshot* snapshot = m_file_snapshot.load(
+        std::memory_order_acquire);
+    if (snapshot)
+        thread_info->m_thread_files = *snapshot;
+}
+
+
+
 ImageCacheFile*
 ImageCacheImpl::verify_file(ImageCacheFile* tf,
                             ImageCachePerThreadInfo* thread_info,
@@ -1424,6 +1501,43 @@ ImageCacheImpl::set_min_cache_size(long long newsize)
 
 
 
+// Move whichever pages of the memory range aren't on the given NUMA node
+// over to it. Only whole pages are moved, since the partial pages at the
+// ends may be shared with other allocations.
+static void
+numa_migrate(void* ptr, size_t size, int node)
+{
+#if defined(__linux__) && defined(SYS_move_pages)
+    static const uintptr_t pagesize = uintptr_t(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = round_to_multiple(uintptr_t(ptr), pagesize);
+    uintptr_t end   = (uintptr_t(ptr) + size) / pagesize * pagesize;
+    if (end <= begin)
+        return;
+    size_t npages = (end - begin) / pagesize;
+    std::vector<void*> pages(npages);
+    std::vector<int> status(npages);
+    for (size_t i = 0; i < npages; ++i)
+        pages[i] = (void*)(begin + i * pagesize);
+    // Usually the pages are already local (the kernel places them where
+    // they're first touched), so just ask where they are first.
+    if (syscall(SYS_move_pages, 0, npages, pages.data(), nullptr,
+                status.data(), 0)
+        != 0)
+        return;
+    size_t nremote = 0;
+    for (size_t i = 0; i < npages; ++i)
+        if (status[i] >= 0 && status[i] != node)
+            pages[nremote++] = pages[i];
+    if (nremote) {
+        std::vector<int> nodes(nremote, node);
+        syscall(SYS_move_pages, 0, nremote, pages.data(), nodes.data(),
+                status.data(), MPOL_MF_MOVE);
+    }
+#endif
+}
+
+
+
 ImageCacheTile::ImageCacheTile(const TileID& id)
     : m_id(id)
     , m_valid(true)
@@ -1469,15 +1583,70 @@ ImageCacheTile::ImageCacheTile(const TileID& id, const void* pels,
 
 
 
+ImageCacheTile::ImageCacheTile(const ImageCacheTile& primary, int numa_node)
+    : m_id(primary.m_id)
+    , m_channelsize(primary.m_channelsize)
+    , m_pixelsize(primary.m_pixelsize)
+    , m_valid(true)
+    , m_numa_node(numa_node)
+{
+    OIIO_DASSERT(primary.pixels_ready() && primary.memsize());
+    m_pixels_size = primary.memsize();
+    m_pixels.reset(new char[m_pixels_size]);
+    memcpy(m_pixels.get(), primary.m_pixels.get(), m_pixels_size);
+    numa_migrate(m_pixels.get(), m_pixels_size, numa_node);
+    ImageCacheImpl& imagecache(m_id.file().imagecache());
+    imagecache.incr_tiles(m_pixels_size);
+    imagecache.incr_numa_mem(numa_node, m_pixels_size);
+    m_pixels_ready = true;
+}
+
+
+
 ImageCacheTile::~ImageCacheTile()
 {
-    m_id.file().imagecache().decr_tiles(memsize());
+    ImageCacheImpl& imagecache(m_id.file().imagecache());
+    imagecache.decr_tiles(memsize());
+    if (m_numa_node >= 0)
+        imagecache.decr_numa_mem(m_numa_node, memsize());
+    if (ImageCacheTile* replica = next_replica())
+        intrusive_ptr_release(replica);
+    delete[] m_remote_uses.load();
     if (m_nofree)
         m_pixels.release();  // release without freeing
 }
 
 
 
+int
+ImageCacheTile::count_remote_use(int node)
+{
+    atomic_int* uses = m_remote_uses.load();
+    if (!uses) {
+        // First remote use. If another thread allocates the counters at
+        // the same time, use theirs.
+        atomic_int* mine = new atomic_int[max_numa_counters] {};
+        if (m_remote_uses.compare_exchange_strong(uses, mine))
+            uses = mine;
+        else
+            delete[] mine;
+    }
+    return ++uses[node % max_numa_counters];
+}
+
+
+
+void
+ImageCacheTile::add_replica(ImageCacheTile* replica)
+{
+    OIIO_DASSERT(replica && !replica->next_replica());
+    intrusive_ptr_add_ref(replica);
+    replica->m_next_replica.store(m_next_replica.load());
+    m_next_replica.store(replica);
+}
+
+
+
 size_t
 ImageCacheTile::memsize_needed() const
 {
@@ -1503,12 +1672,31 @@ ImageCacheTile::read(ImageCachePerThreadInfo* thread_info)
     // Clear the end pad values so there aren't NaNs sucked up by simd loads
     memset(m_pixels.get() + size - OIIO_SIMD_MAX_SIZE_BYTES, 0,
            OIIO_SIMD_MAX_SIZE_BYTES);
-    m_valid = file.read_tile(thread_info, m_id.subimage(), m_id.miplevel(),
-                             m_id.x(), m_id.y(), m_id.z(), m_id.chbegin(),
-                             m_id.chend(), file.datatype(m_id.subimage()),
-                             &m_pixels[0]);
+    // Tiles evicted earlier may still be held compressed in memory, or in
+    // the disk cache, either of which is much cheaper than going back to
+    // the file.
+    ImageCacheImpl& imagecache(file.imagecache());
+    bool recovered = imagecache.compressed_tiles().retrieve(
+        m_id, &m_pixels[0], size - OIIO_SIMD_MAX_SIZE_BYTES);
+    if (!recovered && imagecache.diskcache()) {
+        if (uint64_t diskkey = imagecache.diskcache_key(m_id))
+            recovered = imagecache.diskcache()->read(
+                diskkey, &m_pixels[0], size - OIIO_SIMD_MAX_SIZE_BYTES);
+    }
+    m_valid = recovered
+              || file.read_tile(thread_info, m_id.subimage(), m_id.miplevel(),
+                                m_id.x(), m_id.y(), m_id.z(), m_id.chbegin(),
+                                m_id.chend(), file.datatype(m_id.subimage()),
+                                &m_pixels[0]);
     m_id.file().imagecache().incr_mem(size);
-    if (m_valid) {
+    if (m_valid && imagecache.numa()) {
+        // Make sure the pixels live on the node of the thread that asked
+        // for them.
+        m_numa_node = thread_info->current_numa_node();
+        numa_migrate(m_pixels.get(), size, m_numa_node);
+        imagecache.incr_numa_mem(m_numa_node, size);
+    }
+    if (m_valid && !recovered) {
         // Figure out if
         ImageCacheFile::LevelInfo& lev(
             file.levelinfo(m_id.subimage(), m_id.miplevel()));
@@ -1522,8 +1710,7 @@ ImageCacheTile::read(ImageCachePerThreadInfo* thread_info)
         int64_t oldval  = lev.tiles_read[index].fetch_or(bitmask);
         if (oldval & bitmask)  // Was it previously read?
             file.register_redundant_tile(lev.spec.tile_bytes());
-    } else {
-        // (! m_valid)
+    } else if (!m_valid) {
         m_used = false;  // Don't let it hold mem if invalid
         if (file.mod_time() != Filesystem::last_write_time(file.filename()))
             file.imagecache().error(
@@ -1614,6 +1801,7 @@ ImageCacheImpl::init()
     m_latlong_y_up_default = true;
     m_Mw2c.makeIdentity();
     m_mem_used                = 0;
+    m_max_diskcache_bytes     = 1024LL * 1024 * 1024;  // 1 GB disk cache
     m_statslevel              = 0;
     m_max_errors_per_file     = 100;
     m_stat_tiles_created      = 0;
@@ -1622,6 +1810,13 @@ ImageCacheImpl::init()
     m_stat_open_files_created = 0;
     m_stat_open_files_current = 0;
     m_stat_open_files_peak    = 0;
+    m_numa_nodes              = Sysutil::numa_nodes();
+    m_numa_mem_used.reset(new atomic_ll[m_numa_nodes]);
+    m_numa_remote_uses.reset(new atomic_ll[m_numa_nodes]);
+    for (int i = 0; i < m_numa_nodes; ++i) {
+        m_numa_mem_used[i]    = 0;
+        m_numa_remote_uses[i] = 0;
+    }
 
     // Allow environment variable to override default options
     const char* options = getenv("OPENIMAGEIO_IMAGECACHE_OPTIONS");
@@ -1896,6 +2091,39 @@ ImageCacheImpl::getstats(int level) const
             out << "    Failure reads followed by unexplained success: "
                 << stats.file_retry_success << " files, "
                 << stats.tile_retry_success << " tiles\n";
+        if (m_compressed_tiles.enabled()) {
+            long long used = m_compressed_tiles.memory_used();
+            long long raw  = m_compressed_tiles.uncompressed_size();
+            out << "  Compressed tiles: " << m_compressed_tiles.entries()
+                << " current, " << Strutil::memformat(used) << " (ratio "
+                << Strutil::sprintf("%.2f", used ? double(raw) / used : 0.0)
+                << ")\n";
+            out << "    " << m_compressed_tiles.hits() << " hits, "
+                << m_compressed_tiles.misses() << " misses, "
+                << m_compressed_tiles.stores() << " stored, "
+                << m_compressed_tiles.rejects() << " incompressible\n";
+        }
+        if (m_numa) {
+            out << "  NUMA: " << m_numa_nodes << " nodes, "
+                << m_stat_numa_replicas << " tile replicas created\n";
+            out << "    tile memory by node :";
+            for (int n = 0; n < m_numa_nodes; ++n)
+                out << ' ' << Strutil::memformat(m_numa_mem_used[n]);
+            out << "\n";
+            out << "    remote tile uses by node :";
+            for (int n = 0; n < m_numa_nodes; ++n)
+                out << ' ' << m_numa_remote_uses[n];
+            out << "\n";
+        }
+        if (m_diskcache) {
+            out << "  Disk cache: \"" << m_diskcache->filename() << "\", "
+                << Strutil::memformat(m_diskcache->capacity()) << "\n";
+            out << "    " << m_diskcache->entries() << " tiles held, "
+                << m_diskcache->hits() << " hits, " << m_diskcache->misses()
+                << " misses\n";
+            out << "    " << m_diskcache->writes() << " tiles written, "
+                << Strutil::memformat(m_diskcache->bytes_written()) << "\n";
+        }
     }
 
     if (level >= 2 && files.size()) {
@@ -2185,6 +2413,32 @@ ImageCacheImpl::attribute(string_view name, TypeDesc type, const void* val)
     } else if (name == "max_mip_res" && type == TypeInt) {
         m_max_mip_res = *(const int*)val;
         do_invalidate = true;
+    } else if (name == "max_compressed_memory_MB"
+               && (type == TypeDesc::FLOAT || type == TypeDesc::INT)) {
+        float size = type == TypeDesc::FLOAT ? *(const float*)val
+                                             : float(*(const int*)val);
+        m_compressed_tiles.max_memory(
+            (long long)(std::max(size, 0.0f) * (1024 * 1024)));
+    } else if (name == "diskcache" && type == TypeDesc::STRING) {
+        std::string path(*(const char**)val);
+        if (path != m_diskcache_path) {
+            m_diskcache_path = path;
+            reset_diskcache();
+        }
+    } else if (name == "max_diskcache_MB"
+               && (type == TypeDesc::FLOAT || type == TypeDesc::INT)) {
+        float size = type == TypeDesc::FLOAT ? *(const float*)val
+                                             : float(*(const int*)val);
+        long long bytes = (long long)(std::max(size, 1.0f) * (1024 * 1024));
+        if (bytes != m_max_diskcache_bytes) {
+            m_max_diskcache_bytes = bytes;
+            if (m_diskcache)
+                reset_diskcache();
+        }
+    } else if (name == "numa" && type == TypeInt) {
+        m_numa = *(const int*)val;
+    } else if (name == "numa_replicate" && type == TypeInt) {
+        m_numa_replicate = std::max(*(const int*)val, 0);
     } else {
         // Otherwise, unknown name
         return false;
@@ -2223,6 +2477,16 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
     ATTR_DECODE("failure_retries", int, m_failure_retries);
     ATTR_DECODE("total_files", int, m_files.size());
     ATTR_DECODE("max_mip_res", int, m_max_mip_res);
+    ATTR_DECODE("max_compressed_memory_MB", float,
+                m_compressed_tiles.max_memory() / (1024.0 * 1024.0));
+    ATTR_DECODE("max_compressed_memory_MB", int,
+                m_compressed_tiles.max_memory() / (1024 * 1024));
+    ATTR_DECODE("max_diskcache_MB", float,
+                m_max_diskcache_bytes / (1024.0 * 1024.0));
+    ATTR_DECODE("max_diskcache_MB", int,
+                m_max_diskcache_bytes / (1024 * 1024));
+    ATTR_DECODE("numa", int, m_numa);
+    ATTR_DECODE("numa_replicate", int, m_numa_replicate);
 
     // The cases that don't fit in the simple ATTR_DECODE scheme
     if (name == "searchpath" && type == TypeDesc::STRING) {
@@ -2251,6 +2515,10 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         *(const char**)val = m_substitute_image.c_str();
         return true;
     }
+    if (name == "diskcache" && type == TypeDesc::STRING) {
+        *(ustring*)val = m_diskcache_path;
+        return true;
+    }
     if (name == "all_filenames" && type.basetype == TypeDesc::STRING
         && type.is_sized_array()) {
         ustring* names = (ustring*)val;
@@ -2262,6 +2530,14 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         return true;
     }
 
+    if (name == "stat:numa_remote_uses" && type.basetype == TypeDesc::INT64
+        && type.arraylen > 0) {
+        long long* uses = (long long*)val;
+        for (int n = 0; n < type.arraylen; ++n)
+            uses[n] = n < m_numa_nodes ? (long long)m_numa_remote_uses[n] : 0;
+        return true;
+    }
+
     if (Strutil::starts_with(name, "stat:")) {
         // Stats we can just grab
         ATTR_DECODE("stat:cache_memory_used", long long, m_mem_used);
@@ -2271,6 +2547,25 @@ ImageCacheImpl::getattribute(string_view name, TypeDesc type, void* val) const
         ATTR_DECODE("stat:open_files_created", int, m_stat_open_files_created);
         ATTR_DECODE("stat:open_files_current", int, m_stat_open_files_current);
         ATTR_DECODE("stat:open_files_peak", int, m_stat_open_files_peak);
+        ATTR_DECODE("stat:compressed_memory_used", long long,
+                    m_compressed_tiles.memory_used());
+        ATTR_DECODE("stat:compressed_tiles_hits", long long,
+                    m_compressed_tiles.hits());
+        ATTR_DECODE("stat:diskcache_hits", long long,
+                    m_diskcache ? m_diskcache->hits() : 0);
+        ATTR_DECODE("stat:diskcache_misses", long long,
+                    m_diskcache ? m_diskcache->misses() : 0);
+        ATTR_DECODE("stat:numa_replicas", long long, m_stat_numa_replicas);
+        ATTR_DECODE("stat:file_snapshot_entries", long long,
+                    m_stat_file_snapshot_entries);
+        if (name == "stat:numa_remote_uses") {
+            long long total = 0;
+            for (int n = 0; n < m_numa_nodes; ++n)
+                total += m_numa_remote_uses[n];
+            ATTR_DECODE("stat:numa_remote_uses", long long, total);
+        }
+        ATTR_DECODE("stat:diskcache_writes", long long,
+                    m_diskcache ? m_diskcache->writes() : 0);
 
         // All the other stats are those that need to be summed from all
         // the threads.
@@ -2337,6 +2632,8 @@ ImageCacheImpl::find_tile_main_cache(const TileID& id, ImageCacheTileRef& tile,
             tile->use();
             OIIO_DASSERT(id == tile->id());
             OIIO_DASSERT(tile);
+            if (m_numa)
+                numa_localize(tile, thread_info);
             return true;
         }
     }
@@ -2402,8 +2699,10 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
     // Early out if the cache is empty
     if (m_tilecache.empty())
         return;
-    // Early out if we aren't exceeding the tile memory limit
-    if (m_mem_used < (long long)m_max_memory_bytes)
+    // Early out if we aren't exceeding the tile memory limit (or in NUMA
+    // mode, any node's share of it)
+    if (m_mem_used < (long long)m_max_memory_bytes
+        && !(m_numa && numa_over_budget()))
         return;
 
     // Try to grab the tile_sweep_mutex lock. If somebody else holds it,
@@ -2435,8 +2734,26 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
     // Loop while we still use too much tile memory.  Also, be careful
     // of looping for too long, exit the loop if we just keep spinning
     // uncontrollably.
+    // Tiles bound for the compressed or disk tiers are copied out as they
+    // are evicted, and only compressed/written once the sweep is done and
+    // the sweep lock released, so other threads aren't held up by it.
+    struct Evicted {
+        TileID id;
+        std::unique_ptr<char[]> data;
+        size_t size;
+        int elemsize;
+    };
+    std::vector<Evicted> evicted_tiles;
+
     int full_loops = 0;
-    while (m_mem_used >= (long long)m_max_memory_bytes && full_loops < 100) {
+    while (full_loops < 100) {
+        bool over_total = m_mem_used >= (long long)m_max_memory_bytes;
+        if (!over_total && !(m_numa && numa_over_budget()))
+            break;
+        // Bringing a single node back under its share is best effort. If
+        // its tiles are all in active use, don't keep sweeping for it.
+        if (!over_total && full_loops > 1)
+            break;
         // If we have fallen off the end of the cache, loop back to the
         // beginning and increment our full_loops count.
         if (!sweep) {
@@ -2449,13 +2766,29 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
             break;
         OIIO_DASSERT(sweep->second);
 
-        if (!sweep->second->release()) {
+        if (!over_total && !numa_tile_over_budget(*sweep->second)) {
+            // Only some node is over budget, and this tile isn't on it
+            ++sweep;
+        } else if (!sweep->second->release()) {
             // This is a tile we should delete.  To keep iterating
             // safely, we have a good trick:
             // 1. remember the TileID of the tile to delete
             TileID todelete = sweep->first;
             size_t size     = sweep->second->memsize();
             OIIO_DASSERT(m_mem_used >= (long long)size);
+            // Copy the pixels if they should go to a secondary cache.
+            // (Holding a ref instead would keep the tile's memory counted
+            // against the budget until the sweep ends.)
+            const ImageCacheTile& tile = *sweep->second;
+            if ((m_compressed_tiles.enabled() || m_diskcache) && tile.valid()
+                && tile.memsize() > OIIO_SIMD_MAX_SIZE_BYTES) {
+                size_t datasize = tile.memsize() - OIIO_SIMD_MAX_SIZE_BYTES;
+                Evicted v { todelete, std::unique_ptr<char[]>(
+                                          new char[datasize]),
+                            datasize, tile.channelsize() };
+                memcpy(v.data.get(), tile.data(), datasize);
+                evicted_tiles.push_back(std::move(v));
+            }
             // 2. Find the TileID of the NEXT item. We do this by
             // incrementing the sweep iterator and grabbing its id.
             ++sweep;
@@ -2479,14 +2812,124 @@ ImageCacheImpl::check_max_mem(ImageCachePerThreadInfo* /*thread_info*/)
     // Now we must save the tileid for next time.  Just set it to an
     // empty ID if we don't have a valid iterator at this point.
     m_tile_sweep_id = (sweep ? sweep->first : TileID());
+    sweep.unlock();
     m_tile_sweep_mutex.unlock();
 
+    for (auto& v : evicted_tiles) {
+        m_compressed_tiles.store(v.id, v.data.get(), v.size, v.elemsize);
+        if (m_diskcache)
+            if (uint64_t key = diskcache_key(v.id))
+                m_diskcache->write(key, v.data.get(), v.size);
+    }
+
     // N.B. As we exit, the iterators will go out of scope and we will
     // retain no locks on the cache.
 }
 
 
 
+bool
+ImageCacheImpl::numa_over_budget() const
+{
+    for (int n = 0; n < m_numa_nodes; ++n)
+        if (numa_node_over_budget(n))
+            return true;
+    return false;
+}
+
+
+
+bool
+ImageCacheImpl::numa_tile_over_budget(const ImageCacheTile& tile) const
+{
+    for (const ImageCacheTile* t = &tile; t; t = t->next_replica())
+        if (t->numa_node() >= 0 && numa_node_over_budget(t->numa_node()))
+            return true;
+    return false;
+}
+
+
+
+void
+ImageCacheImpl::numa_localize(ImageCacheTileRef& tile,
+                              ImageCachePerThreadInfo* thread_info)
+{
+    int node = thread_info->current_numa_node();
+    int home = tile->numa_node();
+    if (home < 0 || home == node || !tile->valid())
+        return;
+    if (ImageCacheTile* replica = tile->replica(node)) {
+        tile = replica;
+        return;
+    }
+    ++m_numa_remote_uses[node];
+    // Only replicate tiles that are used heavily from this node, and only
+    // if the node has room for them.
+    if (!m_numa_replicate || tile->count_remote_use(node) < m_numa_replicate
+        || numa_node_over_budget(node))
+        return;
+    // Copy without holding the lock. If another thread on our node beat
+    // us to it, use theirs and let ours go.
+    ImageCacheTileRef replica(new ImageCacheTile(*tile, node));
+    {
+        spin_lock lock(m_numa_mutex);
+        if (ImageCacheTile* existing = tile->replica(node)) {
+            replica = existing;
+        } else {
+            tile->add_replica(replica.get());
+            ++m_stat_numa_replicas;
+        }
+    }
+    tile = replica;
+    check_max_mem(thread_info);
+}
+
+
+
+uint64_t
+ImageCacheImpl::diskcache_key(const TileID& id) const
+{
+    const ImageCacheFile& file(id.file());
+    // Only tiles that can be reproduced from a plain file are eligible:
+    // not application buffers, procedural or custom inputs, or IOProxy.
+    if (file.m_inputcreator || !file.m_allow_release || file.mod_time() == 0)
+        return 0;
+    uint64_t filehash
+        = file.fingerprint().size()
+              ? farmhash::Hash64(file.fingerprint())
+              : farmhash::Hash64(Strutil::fmt::format(
+                  "{}:{}", file.filename(), (long long)file.mod_time()));
+    const ImageSpec& spec(file.spec(id.subimage(), id.miplevel()));
+    uint64_t key = fasthash::fasthash64(
+        { filehash, (uint64_t(id.x()) << 32) + uint32_t(id.y()),
+          (uint64_t(id.z()) << 32) + uint32_t(id.subimage()),
+          (uint64_t(id.miplevel()) << 32) + (uint64_t(id.chbegin()) << 16)
+              + uint64_t(id.chend()),
+          (uint64_t(spec.tile_width) << 32) + uint32_t(spec.tile_height),
+          (uint64_t(spec.tile_depth) << 32)
+              + (uint64_t(file.datatype(id.subimage()).basetype) << 1)
+              + uint64_t(m_unassociatedalpha) });
+    return key ? key : 1;  // 0 is reserved to mean "not cacheable"
+}
+
+
+
+void
+ImageCacheImpl::reset_diskcache()
+{
+    m_diskcache.reset();  // Close the old one first, releasing its lock
+    if (m_diskcache_path.empty())
+        return;
+    m_diskcache.reset(
+        new TileDiskCache(m_diskcache_path, m_max_diskcache_bytes));
+    if (!m_diskcache->valid()) {
+        error("{}", m_diskcache->error());
+        m_diskcache.reset();
+    }
+}
+
+
+
 std::string
 ImageCacheImpl::resolve_filename(const std::string& filename) const
 {
@@ -3268,6 +3711,7 @@ ImageCacheImpl::invalidate(ustring filename, bool force)
     // Safely erase all the tiles we found
     for (const TileID& id : tiles_to_delete)
         m_tilecache.erase(id);
+    m_compressed_tiles.erase_file(file.get());
 
     const ustring fingerprint = file->fingerprint();
 
@@ -3299,6 +3743,7 @@ ImageCacheImpl::invalidate_all(bool force)
         }
         for (const TileID& id : tiles_to_delete)
             m_tilecache.erase(id);
+        m_compressed_tiles.clear();
         // Invalidate (close and clear spec) all individual files
         for (FilenameMap::iterator fileit = m_files.begin(), e = m_files.end();
              fileit != e; ++fileit) {
@@ -3467,6 +3912,7 @@ ImageCacheImpl::create_thread_info()
 {
     ImageCachePerThreadInfo* p = new ImageCachePerThreadInfo;
     // printf ("New perthread %p\n", (void *)p);
+    seed_thread_files(p);
     spin_lock lock(m_perthread_info_mutex);
     m_all_perthread_info.push_back(p);
     p->shared = true;  // both the IC and the caller point to it
@@ -3501,6 +3947,7 @@ ImageCacheImpl::get_perthread_info(ImageCachePerThreadInfo* p)
         p = new ImageCachePerThreadInfo;
         m_perthread_info.reset(p);
         // printf ("New perthread %p\n", (void *)p);
+        seed_thread_files(p);
         spin_lock lock(m_perthread_info_mutex);
         m_all_perthread_info.push_back(p);
         p->shared = true;  // both the IC and the thread point to it
@@ -3512,6 +3959,7 @@ ImageCacheImpl::get_perthread_info(ImageCachePerThreadInfo* p)
         p->lasttile = NULL;
         p->purge    = 0;
         p->m_thread_files.clear();
+        seed_thread_files(p);
     }
     return p;
 }
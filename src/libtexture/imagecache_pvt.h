@@ -10,6 +10,9 @@
 #ifndef OPENIMAGEIO_IMAGECACHE_PVT_H
 #define OPENIMAGEIO_IMAGECACHE_PVT_H
 
+#include <list>
+#include <map>
+
 #include <tsl/robin_map.h>
 
 #include <boost/container/flat_map.hpp>
@@ -19,6 +22,7 @@
 #include <OpenImageIO/hash.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/refcnt.h>
+#include <OpenImageIO/sysutil.h>
 #include <OpenImageIO/texture.h>
 #include <OpenImageIO/timer.h>
 #include <OpenImageIO/unordered_map_concurrent.h>
@@ -567,6 +571,10 @@ public:
                    stride_t xstride, stride_t ystride, stride_t zstride,
                    bool copy = true);
 
+    /// Construct a replica of another tile's pixels, placed in the memory
+    /// of the given NUMA node.
+    ImageCacheTile(const ImageCacheTile& primary, int numa_node);
+
     ~ImageCacheTile();
 
     /// Actually read the pixels.  The caller had better be the thread
@@ -617,15 +625,19 @@ public:
     void use() { m_used = 1; }
 
     /// Mark the tile as not recently used, return its previous value.
-    ///
+    /// Use of any of its NUMA replicas counts as use of the tile.
     bool release()
     {
         if (!pixels_ready() || !valid())
             return true;  // Don't really release invalid or unready tiles
         // If m_used is 1, set it to zero and return true.  If it was already
         // zero, it's fine and return false.
-        int one = 1;
-        return m_used.compare_exchange_strong(one, 0);
+        bool used = false;
+        for (ImageCacheTile* t = this; t; t = t->next_replica()) {
+            int one = 1;
+            used |= t->m_used.compare_exchange_strong(one, 0);
+        }
+        return used;
     }
 
     /// Has this tile been recently used?
@@ -645,6 +657,33 @@ public:
     int channelsize() const { return m_channelsize; }
     int pixelsize() const { return m_pixelsize; }
 
+    /// The NUMA node holding this tile's pixels, or -1 if not known (NUMA
+    /// mode is off, or the pixels were supplied by the application).
+    int numa_node() const { return m_numa_node; }
+
+    /// Count a lookup from a thread on `node`, which is not numa_node(),
+    /// and return how many there have been from that node. (Nodes beyond
+    /// the first max_numa_counters share counters.) The counters are only
+    /// allocated once a tile is first used remotely, so tiles cost nothing
+    /// extra unless NUMA replication is on.
+    int count_remote_use(int node);
+
+    /// Replicas of a tile form a list, starting at the primary tile.
+    ImageCacheTile* next_replica() const { return m_next_replica.load(); }
+
+    /// Return the replica of this tile on the given node, or nullptr.
+    ImageCacheTile* replica(int numa_node) const
+    {
+        for (ImageCacheTile* t = next_replica(); t; t = t->next_replica())
+            if (t->m_numa_node == numa_node)
+                return t;
+        return nullptr;
+    }
+
+    /// Add a replica to the list, which takes over a reference to it. The
+    /// caller must make sure only one thread at a time adds replicas.
+    void add_replica(ImageCacheTile* replica);
+
 private:
     TileID m_id;                       ///< ID of this tile
     std::unique_ptr<char[]> m_pixels;  ///< The pixel data
@@ -657,6 +696,13 @@ private:
         false
     };                        ///< The pixels have been read from disk
     atomic_int m_used { 1 };  ///< Used recently
+    int m_numa_node { -1 };   ///< NUMA node of the pixels
+    static constexpr int max_numa_counters = 8;
+    /// Main cache hits from each other node, [max_numa_counters] once
+    /// allocated by count_remote_use()
+    std::atomic<atomic_int*> m_remote_uses { nullptr };
+    /// Next replica in the list (we hold a reference to it)
+    std::atomic<ImageCacheTile*> m_next_replica { nullptr };
 };
 
 
@@ -675,6 +721,167 @@ typedef unordered_map_concurrent<
     TileCache;
 
 
+/// In-memory store of compressed tiles, sitting between the main tile
+/// cache and the disk. Tiles evicted from the main cache are compressed
+/// (with a byte shuffle so that the bytes of each channel value are
+/// grouped, followed by fast zlib deflate) and kept here, with their own
+/// memory budget and LRU order. A main cache miss that finds the tile
+/// here decompresses it and moves it back to the main cache, which is
+/// usually much cheaper than rereading and decoding it from the file.
+///
+/// All methods are thread-safe. Compression and decompression are done
+/// without holding the lock.
+class CompressedTileCache {
+public:
+    CompressedTileCache() {}
+    ~CompressedTileCache() { clear(); }
+
+    CompressedTileCache(const CompressedTileCache&) = delete;
+    const CompressedTileCache& operator=(const CompressedTileCache&) = delete;
+
+    /// Set/get the memory budget for compressed tiles. Zero disables it.
+    void max_memory(long long bytes);
+    long long max_memory() const { return m_max_memory; }
+    bool enabled() const { return m_max_memory > 0; }
+
+    /// Compress and store `size` bytes of pixel data for the tile `id`,
+    /// whose channel values are `elemsize` bytes each. Tiles that don't
+    /// compress well are not stored.
+    void store(const TileID& id, const void* data, size_t size,
+               int elemsize);
+
+    /// If tile `id` is present, remove it and decompress its pixels
+    /// (which must be exactly `size` bytes) into `data`, returning true.
+    /// Return false if it is not present.
+    bool retrieve(const TileID& id, void* data, size_t size);
+
+    /// Forget all tiles belonging to the given file.
+    void erase_file(const ImageCacheFile* file);
+
+    /// Forget all tiles.
+    void clear();
+
+    long long memory_used() const { return m_mem_used; }
+    long long uncompressed_size() const { return m_rawsize; }
+    size_t entries() const;
+    long long hits() const { return m_hits; }
+    long long misses() const { return m_misses; }
+    long long stores() const { return m_stores; }
+    long long rejects() const { return m_rejects; }
+
+private:
+    struct Entry {
+        TileID id;
+        std::unique_ptr<char[]> data;  // Compressed bytes
+        size_t size;                   // Compressed size
+        size_t rawsize;                // Uncompressed size
+        int elemsize;                  // Bytes per channel value
+    };
+    typedef std::list<Entry> EntryList;
+
+    // Remove the entry, with the lock already held
+    void erase(EntryList::iterator e);
+
+    mutable spin_mutex m_mutex;  // Protects m_lru and m_index
+    EntryList m_lru;             // Most recently stored at the front
+    tsl::robin_map<TileID, EntryList::iterator, TileID::Hasher> m_index;
+    atomic_ll m_max_memory { 0 };
+    atomic_ll m_mem_used { 0 }, m_rawsize { 0 };
+    atomic_ll m_hits { 0 }, m_misses { 0 };
+    atomic_ll m_stores { 0 }, m_rejects { 0 };
+};
+
+
+
+/// Persistent second-level tile cache, backed by a memory-mapped file
+/// (typically on a fast local disk). Tiles evicted from the in-memory
+/// tile cache are written here, already decoded and converted to their
+/// cached data type, and a tile cache miss checks here before going back
+/// to the original ImageInput.
+///
+/// Entries are keyed by a 64 bit digest of the file identity (the
+/// fingerprint if the file has one, otherwise its name and modification
+/// time) and the TileID, so the contents remain valid across processes
+/// and survive restarts. The data area is used as a ring: records are
+/// appended at the head, overwriting the oldest records when it wraps. A
+/// tile that is evicted again while its record is in the older half of
+/// the ring is rewritten at the head, which approximates LRU without
+/// having to touch the file on every hit.
+///
+/// All methods are thread-safe. Only one process at a time may use a
+/// given cache file (it is locked while open).
+class TileDiskCache {
+public:
+    /// Open (or create) the cache file, with room for `capacity` bytes of
+    /// tile records. Check valid() to see if it succeeded, and if not,
+    /// error() for the reason.
+    TileDiskCache(string_view filename, int64_t capacity);
+    ~TileDiskCache();
+
+    TileDiskCache(const TileDiskCache&) = delete;
+    const TileDiskCache& operator=(const TileDiskCache&) = delete;
+
+    bool valid() const { return m_base != nullptr; }
+    const std::string& error() const { return m_error; }
+    const std::string& filename() const { return m_filename; }
+    int64_t capacity() const { return m_capacity; }
+
+    /// Copy the record for `key`, which must be exactly `size` bytes, into
+    /// `data`. Return true if found, false if not in the cache (or if the
+    /// record failed its integrity check).
+    bool read(uint64_t key, void* data, size_t size);
+
+    /// Store `size` bytes of tile data under `key`. Does nothing if the
+    /// tile is already present and recently written, or if it's too big
+    /// to be worth caching.
+    void write(uint64_t key, const void* data, size_t size);
+
+    int64_t hits() const { return m_hits; }
+    int64_t misses() const { return m_misses; }
+    int64_t writes() const { return m_writes; }
+    int64_t bytes_written() const { return m_bytes_written; }
+    size_t entries() const;
+
+private:
+    struct FileHeader;
+    struct RecordHeader;
+    struct Entry {
+        int64_t offset;  // Offset of the record within the data area
+        uint32_t size;   // Payload size
+    };
+
+    static int64_t record_bytes(size_t payload);
+    bool map_file(bool& created);
+    void unmap_file();
+    void rebuild_index();
+    void scan_records(int64_t begin, int64_t end);
+    void evict_range(int64_t begin, int64_t end);
+    void update_file_header();
+    char* data_area() const;
+    RecordHeader* record(int64_t offset) const;
+
+    std::string m_filename;
+    std::string m_error;
+    int64_t m_capacity = 0;  // Bytes in the data area
+    int64_t m_head     = 0;  // Where the next record will be written
+    uint64_t m_seq     = 0;  // Sequence number of the next record
+    char* m_base       = nullptr;  // Start of the mapping
+    size_t m_mapsize   = 0;        // Total size of the mapping
+#ifdef _WIN32
+    void* m_filehandle = nullptr;
+    void* m_maphandle  = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    mutable spin_rw_mutex m_mutex;  // Protects everything below
+    tsl::robin_map<uint64_t, Entry> m_index;  // key -> record
+    std::map<int64_t, uint64_t> m_byoffset;   // record offset -> key
+    atomic_ll m_hits { 0 }, m_misses { 0 };
+    atomic_ll m_writes { 0 }, m_bytes_written { 0 };
+};
+
+
+
 /// A very small amount of per-thread data that saves us from locking
 /// the mutex quite as often.  We store things here used by both
 /// ImageCache and TextureSystem, so they don't each need a costly
@@ -695,6 +902,8 @@ public:
     atomic_int purge;  // If set, tile ptrs need purging!
     ImageCacheStatistics m_stats;
     bool shared = false;  // Pointed to by the IC and thread_specific_ptr
+    int numa_node    = 0;  // NUMA node we were last seen running on
+    int numa_recheck = 0;  // Countdown until we check numa_node again
 
     ImageCachePerThreadInfo()
     {
@@ -719,6 +928,17 @@ public:
         auto f = m_thread_files.find(n);
         return f == m_thread_files.end() ? nullptr : f->second;
     }
+
+    // The NUMA node this thread is running on. Threads can migrate, but
+    // rarely, so only ask the OS every so often.
+    int current_numa_node()
+    {
+        if (--numa_recheck <= 0) {
+            numa_node    = Sysutil::current_numa_node();
+            numa_recheck = 256;
+        }
+        return numa_node;
+    }
 };
 
 
@@ -1058,9 +1278,30 @@ public:
 
     int max_mip_res() const noexcept { return m_max_mip_res; }
 
+    /// The store of compressed tiles evicted from the main cache.
+    CompressedTileCache& compressed_tiles() { return m_compressed_tiles; }
+
+    /// The second-level disk cache, or nullptr if not in use.
+    TileDiskCache* diskcache() const { return m_diskcache.get(); }
+
+    /// Compute the key identifying the tile in the disk cache, or return 0
+    /// if the tile isn't one that should be stored there.
+    uint64_t diskcache_key(const TileID& id) const;
+
+    /// Is NUMA-aware tile placement enabled?
+    bool numa() const { return m_numa; }
+
+    /// Account for tile memory on a NUMA node.
+    void incr_numa_mem(int node, size_t size) { m_numa_mem_used[node] += size; }
+    void decr_numa_mem(int node, size_t size) { m_numa_mem_used[node] -= size; }
+
 private:
     void init();
 
+    /// (Re-)open the disk cache according to m_diskcache_path and
+    /// m_max_diskcache_bytes, or close it if the path is empty.
+    void reset_diskcache();
+
     /// Find a tile identified by 'id' in the tile cache, paging it in if
     /// needed, and store a reference to the tile.  Return true if ok,
     /// false if no such tile exists in the file or could not be read.
@@ -1070,6 +1311,20 @@ private:
     /// Enforce the max memory for tile data.
     void check_max_mem(ImageCachePerThreadInfo* thread_info);
 
+    /// In NUMA mode, if the tile lives on a different node than the
+    /// calling thread, switch `tile` to (possibly first creating) its
+    /// replica on the thread's node.
+    void numa_localize(ImageCacheTileRef& tile,
+                       ImageCachePerThreadInfo* thread_info);
+
+    /// Is the node using more than its share of the tile memory?
+    bool numa_node_over_budget(int node) const
+    {
+        return m_numa_mem_used[node] >= m_max_memory_bytes / m_numa_nodes;
+    }
+    bool numa_over_budget() const;
+    bool numa_tile_over_budget(const ImageCacheTile& tile) const;
+
     /// Internal statistics printing routine
     ///
     void printstats() const;
@@ -1090,6 +1345,34 @@ private:
     /// Clear all the per-thread microcaches.
     void purge_perthread_microcaches();
 
+    /// Look up the file in the published snapshot of the filename map,
+    /// without any locking. Returns nullptr if it isn't there (which does
+    /// not mean it's not in m_files).
+    ImageCacheFile* find_file_in_snapshot(ustring filename) const
+    {
+        const FileSnapshot* snapshot = m_file_snapshot.load(
+            std::memory_order_acquire);
+        if (!snapshot)
+            return nullptr;
+        auto f = snapshot->find(filename);
+        return f == snapshot->end() ? nullptr : f->second;
+    }
+
+    /// Queue a newly added file for the next snapshot, publishing it if
+    /// enough files are waiting.
+    void add_file_to_snapshot(ustring filename, ImageCacheFile* file);
+
+    /// Note that a file was found in m_files but not in the snapshot,
+    /// publishing a new snapshot if that keeps happening.
+    void file_snapshot_miss();
+
+    /// Publish a new snapshot including all pending files. The
+    /// m_file_snapshot_mutex must already be held.
+    void publish_file_snapshot();
+
+    /// Fill a thread's filename map from the current snapshot.
+    void seed_thread_files(ImageCachePerThreadInfo* thread_info) const;
+
     /// Clear the fingerprint list, thread-safe.
     void clear_fingerprints();
 
@@ -1118,6 +1401,24 @@ private:
     ustring m_substitute_image;   ///< Substitute this image for all others
 
     mutable FilenameMap m_files;    ///< Map file names to ImageCacheFile's
+
+    // Read-mostly copy of m_files (minus the most recent additions),
+    // searchable without locks. Since files are never removed from
+    // m_files, a snapshot never goes stale, it only falls behind. New
+    // files are added in batches, by publishing a complete new snapshot.
+    // Readers never block, so we can't know when they are done with an
+    // old snapshot, and instead retire them all when the cache is
+    // destroyed. Every snapshot but the first few is at least 1/8 bigger
+    // than the one before it (even those published early because of
+    // misses), so the retired snapshots total at most about 8 times the
+    // size of the current one.
+    using FileSnapshot = ImageCachePerThreadInfo::ThreadFilenameMap;
+    std::atomic<const FileSnapshot*> m_file_snapshot { nullptr };
+    spin_mutex m_file_snapshot_mutex;  ///< Protects the pending list
+    std::vector<std::pair<ustring, ImageCacheFile*>> m_file_snapshot_pending;
+    std::vector<std::unique_ptr<const FileSnapshot>> m_file_snapshots;
+    atomic_int m_file_snapshot_misses { 0 };
+    atomic_ll m_stat_file_snapshot_entries { 0 };  ///< In all snapshots
     ustring m_file_sweep_name;      ///< Sweeper for "clock" paging algorithm
     spin_mutex m_file_sweep_mutex;  ///< Ensure only one in check_max_files
 
@@ -1129,6 +1430,20 @@ private:
     spin_mutex m_tile_sweep_mutex;  ///< Ensure only one in check_max_mem
 
     atomic_ll m_mem_used;       ///< Memory being used for tiles
+
+    CompressedTileCache m_compressed_tiles;  ///< Compressed evicted tiles
+    std::unique_ptr<TileDiskCache> m_diskcache;  ///< 2nd level tile cache
+    std::string m_diskcache_path;     ///< File backing the disk cache
+    long long m_max_diskcache_bytes;  ///< Size limit of the disk cache
+
+    bool m_numa          = false;                  ///< NUMA tile placement?
+    int m_numa_nodes     = 1;                      ///< Number of NUMA nodes
+    int m_numa_replicate = 0;                      ///< Remote hits to replicate
+    std::unique_ptr<atomic_ll[]> m_numa_mem_used;  ///< Tile mem per node
+    std::unique_ptr<atomic_ll[]> m_numa_remote_uses;  ///< Remote hits per node
+    spin_mutex m_numa_mutex;                       ///< Serializes add_replica
+    atomic_ll m_stat_numa_replicas { 0 };          ///< Replicas created
+
     int m_statslevel;           ///< Statistics level
     int m_max_errors_per_file;  ///< Max errors to print for each file.
 
@@ -21,6 +21,7 @@ class Filter1D;
 namespace pvt {
 
 class TextureSystemImpl;
+class TextureTraceWriter;
 
 #ifndef OPENIMAGEIO_IMAGECACHE_PVT_H
 class ImageCacheImpl;
@@ -566,6 +567,12 @@ private:
     mutable thread_specific_ptr<std::string> m_errormessage;
     Filter1D* hq_filter;  ///< Better filter for magnification
     int m_statslevel;
+    /// If non-null, every 2D texture lookup is recorded here. Lookups
+    /// read it without a lock, so a writer that is replaced is closed but
+    /// not freed until the TextureSystem is (it's kept in m_traces).
+    std::atomic<TextureTraceWriter*> m_trace { nullptr };
+    std::vector<std::unique_ptr<TextureTraceWriter>> m_traces;
+    spin_mutex m_trace_mutex;  ///< Serializes changes to m_trace
     friend class TextureSystem;
 };
 
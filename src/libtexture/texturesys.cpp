@@ -29,6 +29,7 @@
 
 #include "imagecache_pvt.h"
 #include "texture_pvt.h"
+#include "texturetrace.h"
 
 #define TEX_FAST_MATH 1
 
@@ -410,6 +411,9 @@ TextureSystemImpl::getstats(int level, bool icstats) const
             out << Strutil::sprintf("  Average anisotropic probes : 0\n");
         out << Strutil::sprintf("  Max anisotropy in the wild : %.3g\n",
                                 stats.max_aniso);
+        if (const TextureTraceWriter* trace = m_trace.load())
+            out << Strutil::fmt::format("  Trace : {} lookups written to {}\n",
+                                        trace->lookups(), trace->filename());
         if (icstats)
             out << "\n";
     }
@@ -473,6 +477,30 @@ TextureSystemImpl::attribute(string_view name, TypeDesc type, const void* val)
         m_statslevel = *(const int*)val;
         // DO NOT RETURN! pass the same message to the image cache
     }
+    if (name == "trace_file" && type == TypeString) {
+        string_view filename(*(const char**)val);
+        spin_lock lock(m_trace_mutex);
+        TextureTraceWriter* old = m_trace.load();
+        if (old && filename == old->filename())
+            return true;
+        std::unique_ptr<TextureTraceWriter> trace;
+        if (filename.size()) {
+            trace.reset(new TextureTraceWriter(filename));
+            if (!trace->valid()) {
+                error("{}", trace->error());
+                trace.reset();
+            }
+        }
+        // Finish any trace already in progress. Lookups that picked up
+        // the old writer before the swap may still be using it, which is
+        // why it isn't freed here.
+        m_trace.store(trace.get());
+        if (old)
+            old->close();
+        if (trace)
+            m_traces.push_back(std::move(trace));
+        return filename.empty() || m_trace.load() != nullptr;
+    }
     if (name == "unit_test" && type == TypeInt) {
         do_unit_test_texture = *(const int*)val;
         return true;
@@ -514,6 +542,11 @@ TextureSystemImpl::getattribute(string_view name, TypeDesc type,
         *(int*)val = m_max_tile_channels;
         return true;
     }
+    if (name == "trace_file" && type == TypeString) {
+        const TextureTraceWriter* trace = m_trace.load();
+        *(ustring*)val = trace ? ustring(trace->filename()) : ustring();
+        return true;
+    }
 
     // If not one of these, maybe it's an attribute meant for the image cache?
     return m_imagecache->getattribute(name, type, val);
@@ -1000,6 +1033,13 @@ TextureSystemImpl::texture(TextureHandle* texture_handle_,
         return true;
     }
 
+    // Wide lookups were split above, so each piece is traced separately.
+    TextureTraceWriter* trace = m_trace.load(std::memory_order_acquire);
+    if (trace && texture_handle_)
+        trace->record(((TextureFile*)texture_handle_)->filename(), options, s,
+                      t, dsdx, dtdx, dsdy, dtdy, nchannels,
+                      dresultds != nullptr);
+
     static const texture_lookup_prototype lookup_functions[] = {
         // Must be in the same order as Mipmode enum
         &TextureSystemImpl::texture_lookup,
@@ -1181,10 +1221,15 @@ TextureSystemImpl::texture(TextureHandle* texture_handle,
     opt.missingcolor        = options.missingcolor;
     // rwrap not needed for 2D texture
 
+    // Temp results, with room for any number of channels
+    int tmpchans = round_to_multiple(std::max(nchannels, 4), 4);
+    float* r     = OIIO_ALLOCA(float, 3 * tmpchans);
+    float* drds  = r + tmpchans;
+    float* drdt  = drds + tmpchans;
+
     bool ok          = true;
     Tex::RunMask bit = 1;
     for (int i = 0; i < Tex::BatchWidth; ++i, bit <<= 1) {
-        float r[4], drds[4], drdt[4];  // temp result
         if (mask & bit) {
             opt.sblur  = options.sblur[i];
             opt.tblur  = options.tblur[i];
@@ -0,0 +1,295 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+#include <cerrno>
+#include <cstring>
+
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/strutil.h>
+
+#include "texturetrace.h"
+
+
+OIIO_NAMESPACE_BEGIN
+using namespace pvt;
+
+namespace pvt {
+
+
+static const char k_trace_magic[8] = { 'O', 'I', 'I', 'O', 'T', 'R', 'C', '1' };
+static const size_t k_flush_size   = 1 << 20;  // Per thread
+
+static std::atomic<uint64_t> s_writer_serial { 0 };
+
+
+
+TextureTraceWriter::TextureTraceWriter(string_view filename)
+    : m_filename(filename)
+    , m_serial(++s_writer_serial)
+{
+    m_file = Filesystem::fopen(m_filename, "wb");
+    if (!m_file) {
+        m_error = Strutil::fmt::format("Could not open trace file \"{}\": {}",
+                                       m_filename, strerror(errno));
+        return;
+    }
+    TraceFileHeader header;
+    memcpy(header.magic, k_trace_magic, sizeof(k_trace_magic));
+    header.version     = 1;
+    header.lookup_size = uint32_t(sizeof(TraceLookupRecord));
+    write_locked(&header, sizeof(header));
+    // Id 0 is reserved to mean "no string"
+    m_string_ids[ustring()] = 0;
+}
+
+
+
+TextureTraceWriter::~TextureTraceWriter() { close(); }
+
+
+
+void
+TextureTraceWriter::close()
+{
+    m_closed = true;
+    spin_lock threads_lock(m_threads_mutex);
+    for (auto& t : m_threads) {
+        ThreadBuffer& buf(*t.second);
+        spin_lock buf_lock(buf.mutex);
+        flush_thread(buf);
+        buf.records.shrink_to_fit();
+    }
+    spin_lock lock(m_mutex);
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+
+
+long long
+TextureTraceWriter::lookups() const
+{
+    spin_lock threads_lock(const_cast<spin_mutex&>(m_threads_mutex));
+    long long total = 0;
+    for (auto& t : m_threads)
+        total += t.second->lookups;
+    return total;
+}
+
+
+
+void
+TextureTraceWriter::write_locked(const void* data, size_t size)
+{
+    if (m_file && size && fwrite(data, 1, size, m_file) != size)
+        m_error = Strutil::fmt::format("Error writing trace file \"{}\"",
+                                       m_filename);
+}
+
+
+
+void
+TextureTraceWriter::flush_thread(ThreadBuffer& buf)
+{
+    spin_lock lock(m_mutex);
+    // Strings first: buf may use ids that other threads assigned, whose
+    // records are still waiting here.
+    write_locked(m_strings.data(), m_strings.size());
+    m_strings.clear();
+    write_locked(buf.records.data(), buf.records.size());
+    buf.records.clear();
+    if (m_file)
+        fflush(m_file);
+}
+
+
+
+TextureTraceWriter::ThreadBuffer&
+TextureTraceWriter::thread_buffer()
+{
+    // Remember the last writer this thread recorded to, so the usual case
+    // needs no lock. The serial number, rather than the writer's address,
+    // identifies it, since a later writer could reuse the address.
+    struct Cached {
+        uint64_t serial = 0;
+        ThreadBuffer* buf = nullptr;
+    };
+    static thread_local Cached cached;
+    if (cached.serial == m_serial)
+        return *cached.buf;
+    spin_lock threads_lock(m_threads_mutex);
+    auto& buf = m_threads[std::this_thread::get_id()];
+    if (!buf) {
+        buf.reset(new ThreadBuffer);
+        buf->thread = uint32_t(m_threads.size() - 1);
+        buf->records.reserve(k_flush_size + sizeof(TraceLookupRecord));
+    }
+    cached.serial = m_serial;
+    cached.buf    = buf.get();
+    return *buf;
+}
+
+
+
+uint32_t
+TextureTraceWriter::string_id(ThreadBuffer& buf, ustring str)
+{
+    auto found = buf.string_ids.find(str);
+    if (found != buf.string_ids.end())
+        return found->second;
+    uint32_t id;
+    {
+        spin_lock lock(m_mutex);
+        auto global = m_string_ids.find(str);
+        if (global != m_string_ids.end()) {
+            id = global->second;
+        } else {
+            TraceStringRecord rec;
+            rec.type   = TraceString;
+            rec.id     = uint32_t(m_string_ids.size());
+            rec.length = uint32_t(str.length());
+            const char* p = (const char*)&rec;
+            m_strings.insert(m_strings.end(), p, p + sizeof(rec));
+            m_strings.insert(m_strings.end(), str.data(),
+                             str.data() + str.length());
+            m_string_ids[str] = rec.id;
+            id                = rec.id;
+        }
+    }
+    buf.string_ids[str] = id;
+    return id;
+}
+
+
+
+void
+TextureTraceWriter::record(ustring filename, const TextureOpt& options,
+                           float s, float t, float dsdx, float dtdx,
+                           float dsdy, float dtdy, int nchannels, bool derivs)
+{
+    TraceLookupRecord rec;
+    rec.type         = TraceLookup;
+    rec.nchannels    = uint16_t(nchannels);
+    rec.flags        = (derivs ? TraceLookupRecord::Derivs : 0)
+                | (options.conservative_filter
+                       ? TraceLookupRecord::ConservativeFilter
+                       : 0);
+    rec.firstchannel = options.firstchannel;
+    rec.subimage     = options.subimage;
+    rec.swrap        = uint8_t(options.swrap);
+    rec.twrap        = uint8_t(options.twrap);
+    rec.mipmode      = uint8_t(options.mipmode);
+    rec.interpmode   = uint8_t(options.interpmode);
+    rec.anisotropic  = options.anisotropic;
+    rec.sblur        = options.sblur;
+    rec.tblur        = options.tblur;
+    rec.swidth       = options.swidth;
+    rec.twidth       = options.twidth;
+    rec.fill         = options.fill;
+    rec.s            = s;
+    rec.t            = t;
+    rec.dsdx         = dsdx;
+    rec.dtdx         = dtdx;
+    rec.dsdy         = dsdy;
+    rec.dtdy         = dtdy;
+
+    if (m_closed.load(std::memory_order_relaxed))
+        return;
+    ThreadBuffer& buf(thread_buffer());
+    spin_lock lock(buf.mutex);
+    if (m_closed)
+        return;  // close() already flushed this buffer
+    rec.file         = string_id(buf, filename);
+    rec.subimagename = string_id(buf, options.subimagename);
+    rec.thread       = buf.thread;
+    const char* p    = (const char*)&rec;
+    buf.records.insert(buf.records.end(), p, p + sizeof(rec));
+    buf.lookups.store(buf.lookups.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+    if (buf.records.size() >= k_flush_size)
+        flush_thread(buf);
+}
+
+
+
+bool
+TextureTraceReader::open(string_view filename)
+{
+    close();
+    m_file = Filesystem::fopen(filename, "rb");
+    if (!m_file) {
+        m_error = Strutil::fmt::format("Could not open trace file \"{}\": {}",
+                                       filename, strerror(errno));
+        return false;
+    }
+    TraceFileHeader header;
+    if (fread(&header, sizeof(header), 1, m_file) != 1
+        || memcmp(header.magic, k_trace_magic, sizeof(k_trace_magic)) != 0
+        || header.version != 1
+        || header.lookup_size != sizeof(TraceLookupRecord)) {
+        m_error = Strutil::fmt::format("\"{}\" is not a texture trace file",
+                                       filename);
+        close();
+        return false;
+    }
+    m_strings.assign(1, ustring());
+    return true;
+}
+
+
+
+void
+TextureTraceReader::close()
+{
+    if (m_file)
+        fclose(m_file);
+    m_file = nullptr;
+    m_strings.clear();
+}
+
+
+
+bool
+TextureTraceReader::read(TraceLookupRecord& rec)
+{
+    if (!m_file)
+        return false;
+    uint32_t type;
+    while (fread(&type, sizeof(type), 1, m_file) == 1) {
+        if (type == TraceLookup) {
+            rec.type = type;
+            if (fread((char*)&rec + sizeof(type), sizeof(rec) - sizeof(type),
+                      1, m_file)
+                    != 1
+                || rec.file >= m_strings.size()
+                || rec.subimagename >= m_strings.size())
+                break;
+            return true;
+        }
+        if (type != TraceString)
+            break;
+        TraceStringRecord srec;
+        srec.type = type;
+        if (fread((char*)&srec + sizeof(type), sizeof(srec) - sizeof(type), 1,
+                  m_file)
+                != 1
+            || srec.id != m_strings.size())
+            break;
+        std::string str(srec.length, '\0');
+        if (srec.length && fread(&str[0], srec.length, 1, m_file) != 1)
+            break;
+        m_strings.emplace_back(str);
+    }
+    if (!feof(m_file))
+        m_error = "Corrupt texture trace file";
+    return false;
+}
+
+
+}  // namespace pvt
+
+OIIO_NAMESPACE_END
@@ -0,0 +1,218 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+/// \file
+/// Capture and playback of TextureSystem lookup traces.
+///
+/// A trace file starts with a TraceFileHeader, followed by a stream of
+/// records, each beginning with a uint32_t record type:
+///
+///   - TraceString: assigns a small integer id to a string (texture file
+///     name or subimage name). It is written the first time the string is
+///     referenced by a lookup, so it always precedes its first use.
+///     Followed by `length` bytes of characters.
+///   - TraceLookup: one 2D texture lookup, with its options, coordinates
+///     and derivatives, and the (dense, zero-based) index of the thread
+///     that issued it.
+///
+/// Records are written in the order the lookups were made, so replaying
+/// each recorded thread's lookups in file order reproduces its access
+/// pattern exactly. All values are stored in native (little endian on
+/// every platform we care about) byte order.
+
+
+#ifndef OPENIMAGEIO_TEXTURETRACE_H
+#define OPENIMAGEIO_TEXTURETRACE_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <tsl/robin_map.h>
+
+#include <OpenImageIO/export.h>
+#include <OpenImageIO/texture.h>
+#include <OpenImageIO/thread.h>
+#include <OpenImageIO/ustring.h>
+
+
+OIIO_NAMESPACE_BEGIN
+
+namespace pvt {
+
+
+struct TraceFileHeader {
+    char magic[8];         // "OIIOTRC1"
+    uint32_t version;      // 1
+    uint32_t lookup_size;  // sizeof(TraceLookupRecord), as a sanity check
+};
+
+enum TraceRecordType : uint32_t {
+    TraceString = 0x53435254,  // "TRCS"
+    TraceLookup = 0x4c435254   // "TRCL"
+};
+
+struct TraceStringRecord {
+    uint32_t type;    // TraceString
+    uint32_t id;      // Ids start at 1; 0 means "none"
+    uint32_t length;  // Number of characters that follow
+};
+
+struct TraceLookupRecord {
+    enum Flags : uint16_t {
+        Derivs             = 1,  // Caller asked for dresultds/dresultdt
+        ConservativeFilter = 2
+    };
+    uint32_t type;          // TraceLookup
+    uint32_t file;          // String id of the texture file name
+    uint32_t subimagename;  // String id of the subimage name, or 0
+    uint32_t thread;        // Dense index of the calling thread
+    uint16_t nchannels;
+    uint16_t flags;
+    int32_t firstchannel;
+    int32_t subimage;
+    uint8_t swrap, twrap, mipmode, interpmode;
+    int32_t anisotropic;
+    float sblur, tblur, swidth, twidth, fill;
+    float s, t, dsdx, dtdx, dsdy, dtdy;
+
+    /// Reconstruct the TextureOpt that was used for the lookup (without
+    /// the subimage name, which must be looked up separately).
+    TextureOpt options() const
+    {
+        TextureOpt opt;
+        opt.firstchannel        = firstchannel;
+        opt.subimage            = subimage;
+        opt.swrap               = TextureOpt::Wrap(swrap);
+        opt.twrap               = TextureOpt::Wrap(twrap);
+        opt.mipmode             = TextureOpt::MipMode(mipmode);
+        opt.interpmode          = TextureOpt::InterpMode(interpmode);
+        opt.anisotropic         = anisotropic;
+        opt.conservative_filter = (flags & ConservativeFilter) != 0;
+        opt.sblur               = sblur;
+        opt.tblur               = tblur;
+        opt.swidth              = swidth;
+        opt.twidth              = twidth;
+        opt.fill                = fill;
+        return opt;
+    }
+};
+
+static_assert(sizeof(TraceLookupRecord) == 80,
+              "TraceLookupRecord must not contain padding");
+
+
+
+/// Writes a trace of texture lookups. All methods are thread-safe.
+/// Each thread buffers its own records, and only takes the writer's lock
+/// to hand a full buffer to the file (or the first time it sees a
+/// string), so capturing has only a modest effect on lookup speed.
+///
+/// Records of different threads are written in chunks rather than
+/// interleaved exactly, but each thread's own records stay in order, and
+/// every string record precedes its first use.
+class TextureTraceWriter {
+public:
+    /// Create (or truncate) the trace file. Check valid() to see if it
+    /// succeeded, and if not, error() for the reason.
+    TextureTraceWriter(string_view filename);
+    ~TextureTraceWriter();
+
+    TextureTraceWriter(const TextureTraceWriter&) = delete;
+    const TextureTraceWriter& operator=(const TextureTraceWriter&) = delete;
+
+    bool valid() const { return m_file != nullptr; }
+    const std::string& error() const { return m_error; }
+    const std::string& filename() const { return m_filename; }
+    long long lookups() const;
+
+    /// Record one 2D texture lookup of `filename`. Does nothing once the
+    /// writer has been closed.
+    void record(ustring filename, const TextureOpt& options, float s, float t,
+                float dsdx, float dtdx, float dsdy, float dtdy, int nchannels,
+                bool derivs);
+
+    /// Write all buffered records and close the file. Lookups that are
+    /// still calling record() concurrently are safe, but are not captured.
+    void close();
+
+private:
+    // The records of one thread, not yet written to the file. Only its
+    // own thread appends to it; the lock is only contended by close().
+    struct ThreadBuffer {
+        spin_mutex mutex;
+        uint32_t thread = 0;
+        std::vector<char> records;
+        tsl::robin_map<ustring, uint32_t, ustringHash> string_ids;
+        atomic_ll lookups { 0 };
+    };
+
+    ThreadBuffer& thread_buffer();
+    // Return the id of the string, emitting its record if it's new. The
+    // caller holds buf.mutex.
+    uint32_t string_id(ThreadBuffer& buf, ustring str);
+    // Write buf's records to the file. The caller holds buf.mutex.
+    void flush_thread(ThreadBuffer& buf);
+    void write_locked(const void* data, size_t size);
+
+    std::string m_filename;
+    std::string m_error;
+    uint64_t m_serial;  // Distinguishes writers for the per-thread lookup
+    std::atomic<bool> m_closed { false };
+    // Protects m_threads. Held before any ThreadBuffer::mutex.
+    spin_mutex m_threads_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadBuffer>>
+        m_threads;
+    // Protects everything below. Held after any ThreadBuffer::mutex.
+    spin_mutex m_mutex;
+    FILE* m_file = nullptr;
+    std::vector<char> m_strings;  // String records not yet written
+    tsl::robin_map<ustring, uint32_t, ustringHash> m_string_ids;
+};
+
+
+
+/// Reads back a trace file written by TextureTraceWriter.
+class OIIO_API TextureTraceReader {
+public:
+    TextureTraceReader() {}
+    ~TextureTraceReader() { close(); }
+
+    TextureTraceReader(const TextureTraceReader&) = delete;
+    const TextureTraceReader& operator=(const TextureTraceReader&) = delete;
+
+    /// Open the trace file and check its header. Return true on success,
+    /// false (with the reason retrievable with error()) on failure.
+    bool open(string_view filename);
+    void close();
+    const std::string& error() const { return m_error; }
+
+    /// Read the next lookup record into `rec`, absorbing any string
+    /// records along the way. Return false at the end of the file or if
+    /// the file is corrupt (in which case error() will be non-empty).
+    bool read(TraceLookupRecord& rec);
+
+    /// Return the string with the given id (as found in the file and
+    /// subimagename fields of a lookup record), or an empty ustring.
+    ustring string(uint32_t id) const
+    {
+        return id < m_strings.size() ? m_strings[id] : ustring();
+    }
+
+private:
+    FILE* m_file = nullptr;
+    std::string m_error;
+    std::vector<ustring> m_strings;
+};
+
+
+}  // namespace pvt
+
+OIIO_NAMESPACE_END
+
+#endif  // OPENIMAGEIO_TEXTURETRACE_H
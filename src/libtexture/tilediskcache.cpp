@@ -0,0 +1,388 @@
+// Copyright 2008-present Contributors to the OpenImageIO project.
+// SPDX-License-Identifier: BSD-3-Clause
+// https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
+
+
+#include <cstring>
+#include <string>
+
+#include <OpenImageIO/dassert.h>
+#include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/fmath.h>
+#include <OpenImageIO/hash.h>
+#include <OpenImageIO/platform.h>
+#include <OpenImageIO/strutil.h>
+#include <OpenImageIO/thread.h>
+
+#include "imagecache_pvt.h"
+
+#ifdef _WIN32
+// # include <windows.h>   // Already done by platform.h
+#else
+#    include <fcntl.h>
+#    include <sys/file.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+
+OIIO_NAMESPACE_BEGIN
+using namespace pvt;
+
+namespace pvt {
+
+
+// Layout of the cache file: a FileHeader padded out to a page, followed
+// by the data area, which holds a ring of records. Each record is a
+// RecordHeader followed by the tile pixels, padded out to a multiple of
+// k_record_align bytes.
+
+static const char k_file_magic[8] = { 'O', 'I', 'I', 'O', 'T', 'D', 'C', '1' };
+static const uint32_t k_record_magic = 0x4f494443;  // "OIDC"
+static const int64_t k_header_size   = 4096;
+static const int64_t k_record_align  = 64;
+static const int64_t k_min_capacity  = 1 << 20;
+
+
+
+struct TileDiskCache::FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_align;
+    int64_t capacity;  // Size of the data area, in bytes
+    int64_t head;      // Offset of the next record to be written
+    int64_t tail;      // Offset of the oldest record past the head
+    uint64_t seq;      // Sequence number of the next record
+};
+
+
+
+struct TileDiskCache::RecordHeader {
+    uint32_t magic;
+    uint32_t size;      // Payload size, in bytes
+    uint64_t key;       // Tile key
+    uint64_t seq;       // Sequence number, larger is newer
+    uint64_t checksum;  // Hash of the payload
+};
+
+
+
+int64_t
+TileDiskCache::record_bytes(size_t payload)
+{
+    return round_to_multiple(int64_t(sizeof(RecordHeader) + payload),
+                             k_record_align);
+}
+
+
+
+TileDiskCache::TileDiskCache(string_view filename, int64_t capacity)
+    : m_filename(filename)
+    , m_capacity(round_to_multiple(std::max(capacity, k_min_capacity),
+                                   k_record_align))
+{
+    bool created = false;
+    if (!map_file(created)) {
+        unmap_file();
+        return;
+    }
+    if (!created)
+        rebuild_index();
+    if (m_index.empty()) {
+        // Brand new, or nothing salvageable -- start from a clean header.
+        FileHeader* header = (FileHeader*)m_base;
+        memcpy(header->magic, k_file_magic, sizeof(k_file_magic));
+        header->version      = 1;
+        header->record_align = uint32_t(k_record_align);
+        header->capacity     = m_capacity;
+        m_head               = 0;
+        m_seq                = 1;
+        memset(data_area(), 0, sizeof(RecordHeader));
+        update_file_header();
+    }
+}
+
+
+
+TileDiskCache::~TileDiskCache() { unmap_file(); }
+
+
+
+bool
+TileDiskCache::map_file(bool& created)
+{
+    m_mapsize = size_t(k_header_size + m_capacity);
+#ifdef _WIN32
+    std::wstring wname = Strutil::utf8_to_utf16(m_filename);
+    // No sharing allowed, which gives us exclusive use of the file.
+    HANDLE fh = CreateFileW(wname.c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+                            NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE) {
+        m_error = Strutil::fmt::format("Could not open disk cache \"{}\"",
+                                       m_filename);
+        return false;
+    }
+    m_filehandle = fh;
+    created      = (GetLastError() != ERROR_ALREADY_EXISTS);
+    LARGE_INTEGER oldsize;
+    if (!GetFileSizeEx(fh, &oldsize))
+        oldsize.QuadPart = 0;
+    created |= (oldsize.QuadPart != LONGLONG(m_mapsize));
+    LARGE_INTEGER mapsize;
+    mapsize.QuadPart = LONGLONG(m_mapsize);
+    HANDLE mh = CreateFileMappingW(fh, NULL, PAGE_READWRITE, mapsize.HighPart,
+                                   mapsize.LowPart, NULL);
+    if (!mh) {
+        m_error = Strutil::fmt::format("Could not map disk cache \"{}\"",
+                                       m_filename);
+        return false;
+    }
+    m_maphandle = mh;
+    m_base = (char*)MapViewOfFile(mh, FILE_MAP_ALL_ACCESS, 0, 0, m_mapsize);
+    if (!m_base) {
+        m_error = Strutil::fmt::format("Could not map disk cache \"{}\"",
+                                       m_filename);
+        return false;
+    }
+#else
+    m_fd = ::open(m_filename.c_str(), O_RDWR | O_CREAT, 0666);
+    if (m_fd < 0) {
+        m_error = Strutil::fmt::format("Could not open disk cache \"{}\": {}",
+                                       m_filename, strerror(errno));
+        return false;
+    }
+    if (flock(m_fd, LOCK_EX | LOCK_NB) != 0) {
+        m_error = Strutil::fmt::format(
+            "Disk cache \"{}\" is in use by another process", m_filename);
+        return false;
+    }
+    struct stat st;
+    created = (fstat(m_fd, &st) != 0 || st.st_size != off_t(m_mapsize));
+    if (created && ftruncate(m_fd, off_t(m_mapsize)) != 0) {
+        m_error = Strutil::fmt::format("Could not resize disk cache \"{}\": {}",
+                                       m_filename, strerror(errno));
+        return false;
+    }
+    void* p = mmap(nullptr, m_mapsize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   m_fd, 0);
+    if (p == MAP_FAILED) {
+        m_error = Strutil::fmt::format("Could not map disk cache \"{}\": {}",
+                                       m_filename, strerror(errno));
+        return false;
+    }
+    m_base = (char*)p;
+#endif
+    if (!created) {
+        const FileHeader* header = (const FileHeader*)m_base;
+        created = (memcmp(header->magic, k_file_magic, sizeof(k_file_magic))
+                       != 0
+                   || header->version != 1
+                   || header->record_align != uint32_t(k_record_align)
+                   || header->capacity != m_capacity);
+    }
+    return true;
+}
+
+
+
+void
+TileDiskCache::unmap_file()
+{
+#ifdef _WIN32
+    if (m_base)
+        UnmapViewOfFile(m_base);
+    if (m_maphandle)
+        CloseHandle(m_maphandle);
+    if (m_filehandle)
+        CloseHandle(m_filehandle);
+    m_maphandle  = nullptr;
+    m_filehandle = nullptr;
+#else
+    if (m_base)
+        munmap(m_base, m_mapsize);
+    if (m_fd >= 0)
+        ::close(m_fd);  // Also releases the flock
+    m_fd = -1;
+#endif
+    m_base = nullptr;
+}
+
+
+
+char*
+TileDiskCache::data_area() const
+{
+    return m_base + k_header_size;
+}
+
+
+
+TileDiskCache::RecordHeader*
+TileDiskCache::record(int64_t offset) const
+{
+    return (RecordHeader*)(data_area() + offset);
+}
+
+
+
+void
+TileDiskCache::rebuild_index()
+{
+    // The records from the start of the data area to the head were
+    // written on the current trip around the ring; the ones from the
+    // tail to the end survive from the previous trip.
+    const FileHeader* header = (const FileHeader*)m_base;
+    m_head = clamp(header->head, int64_t(0), m_capacity);
+    m_seq  = header->seq;
+    scan_records(0, m_head);
+    if (header->tail >= m_head)
+        scan_records(header->tail, m_capacity);
+    // If the process died mid-write, the header might lag the records.
+    // Make sure we never hand out a sequence number that's already used.
+    for (auto& r : m_byoffset)
+        m_seq = std::max(m_seq, record(r.first)->seq + 1);
+}
+
+
+
+void
+TileDiskCache::scan_records(int64_t begin, int64_t end)
+{
+    for (int64_t offset = begin;
+         offset + int64_t(sizeof(RecordHeader)) <= end;) {
+        const RecordHeader* rec = record(offset);
+        if (rec->magic != k_record_magic || rec->size == 0)
+            break;
+        int64_t nbytes = record_bytes(rec->size);
+        if (offset + nbytes > end)
+            break;
+        auto found = m_index.find(rec->key);
+        if (found == m_index.end()) {
+            m_index[rec->key] = Entry { offset, rec->size };
+            m_byoffset[offset] = rec->key;
+        } else if (record(found->second.offset)->seq < rec->seq) {
+            // A newer copy of a tile we already saw supersedes it
+            m_byoffset.erase(found->second.offset);
+            m_index[rec->key]  = Entry { offset, rec->size };
+            m_byoffset[offset] = rec->key;
+        }
+        offset += nbytes;
+    }
+}
+
+
+
+void
+TileDiskCache::evict_range(int64_t begin, int64_t end)
+{
+    auto first = m_byoffset.lower_bound(begin);
+    auto last  = first;
+    for (; last != m_byoffset.end() && last->first < end; ++last)
+        m_index.erase(last->second);
+    m_byoffset.erase(first, last);
+}
+
+
+
+void
+TileDiskCache::update_file_header()
+{
+    FileHeader* header = (FileHeader*)m_base;
+    auto oldest        = m_byoffset.lower_bound(m_head);
+    header->head       = m_head;
+    header->tail = oldest == m_byoffset.end() ? m_capacity : oldest->first;
+    header->seq  = m_seq;
+}
+
+
+
+size_t
+TileDiskCache::entries() const
+{
+    spin_rw_read_lock lock(m_mutex);
+    return m_index.size();
+}
+
+
+
+bool
+TileDiskCache::read(uint64_t key, void* data, size_t size)
+{
+    if (!valid())
+        return false;
+    spin_rw_read_lock lock(m_mutex);
+    auto found = m_index.find(key);
+    if (found != m_index.end() && found->second.size == size) {
+        const RecordHeader* rec = record(found->second.offset);
+        const char* payload     = (const char*)(rec + 1);
+        if (rec->magic == k_record_magic && rec->key == key
+            && rec->checksum == farmhash::Hash64(payload, size)) {
+            memcpy(data, payload, size);
+            ++m_hits;
+            return true;
+        }
+    }
+    ++m_misses;
+    return false;
+}
+
+
+
+void
+TileDiskCache::write(uint64_t key, const void* data, size_t size)
+{
+    if (!valid() || size == 0)
+        return;
+    int64_t nbytes = record_bytes(size);
+    if (nbytes > m_capacity / 4)
+        return;  // Don't let a few huge tiles flush everything else
+
+    spin_rw_write_lock lock(m_mutex);
+    auto found = m_index.find(key);
+    if (found != m_index.end()) {
+        // Already have it. If it was written recently, leave it be, but
+        // if it's in danger of being overwritten soon, move it back up
+        // to the head of the ring.
+        int64_t age = m_head - found->second.offset;
+        if (age < 0)
+            age += m_capacity;
+        if (age < m_capacity / 2)
+            return;
+        m_byoffset.erase(found->second.offset);
+        m_index.erase(found);
+    }
+
+    if (m_head + nbytes > m_capacity) {
+        // Not enough room before the end -- wrap around. Everything left
+        // past the head is lost, and a zero magic marks the end of the
+        // chain for the next rebuild_index().
+        evict_range(m_head, m_capacity);
+        if (m_head + int64_t(sizeof(RecordHeader)) <= m_capacity)
+            record(m_head)->magic = 0;
+        m_head = 0;
+    }
+    evict_range(m_head, m_head + nbytes);
+
+    // Write the payload before the header, so that a record is never
+    // seen with a valid header but a partial payload.
+    RecordHeader* rec = record(m_head);
+    rec->magic        = 0;
+    memcpy(rec + 1, data, size);
+    rec->size     = uint32_t(size);
+    rec->key      = key;
+    rec->seq      = m_seq++;
+    rec->checksum = farmhash::Hash64((const char*)(rec + 1), size);
+    rec->magic    = k_record_magic;
+    m_index[key]       = Entry { m_head, uint32_t(size) };
+    m_byoffset[m_head] = key;
+    m_head += nbytes;
+    update_file_header();
+    ++m_writes;
+    m_bytes_written += (long long)size;
+}
+
+
+}  // namespace pvt
+
+OIIO_NAMESPACE_END
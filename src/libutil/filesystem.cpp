@@ -26,6 +26,11 @@
 #    include <io.h>
 #    include <shellapi.h>
 #else
+#    ifdef USE_LIBURING
+#        include <liburing.h>
+#    endif
+#    include <sys/mman.h>
+#    include <sys/stat.h>
 #    include <unistd.h>
 #endif
 
@@ -281,6 +286,38 @@ Filesystem::get_directory_entries(const std::string& dirname,
 
 
 
+std::string
+Filesystem::canonical_path(string_view path) noexcept
+{
+    try {
+        error_code ec;
+        filesystem::path head = filesystem::absolute(u8path(path));
+        // Peel components off the end until what's left exists
+        std::vector<filesystem::path> tail;
+        while (!head.empty() && !filesystem::exists(head, ec)) {
+            tail.push_back(head.filename());
+            head = head.parent_path();
+        }
+        filesystem::path result;
+        if (!head.empty()) {
+            result = filesystem::canonical(head, ec);
+            if (ec)
+                return path;
+        }
+        for (auto t = tail.rbegin(); t != tail.rend(); ++t) {
+            if (*t == "..")
+                result = result.parent_path();
+            else if (!t->empty() && *t != ".")
+                result /= *t;
+        }
+        return pathstr(result);
+    } catch (...) {
+        return path;
+    }
+}
+
+
+
 bool
 Filesystem::path_is_absolute(string_view path, bool dot_is_absolute)
 {
@@ -969,6 +1006,18 @@ Filesystem::IOProxy::pwrite(const void* /*buf*/, size_t /*size*/,
 }
 
 
+bool
+Filesystem::IOProxy::pread_batch(span<ReadRequest> requests)
+{
+    bool ok = true;
+    for (auto& r : requests) {
+        r.nread = r.size ? pread(r.buf, r.size, r.offset) : 0;
+        ok &= (r.nread == r.size);
+    }
+    return ok;
+}
+
+
 
 // Shared mutex to guard IOProxy error get/set. Shared should be ok. If
 // enough file I/O errors are happening that multiple threads are
@@ -1126,6 +1175,144 @@ Filesystem::IOFile::flush() const
 
 
 
+Filesystem::IOUringFile::IOUringFile(string_view filename, int queue_depth)
+    : IOFile(filename, Read)
+    , m_queue_depth(std::max(queue_depth, 1))
+{
+#ifdef USE_LIBURING
+    if (m_file) {
+        io_uring* ring = new io_uring;
+        if (io_uring_queue_init(unsigned(m_queue_depth), ring, 0) == 0)
+            m_ring = ring;
+        else
+            delete ring;  // Old kernel, or not allowed: use plain preads
+    }
+#endif
+}
+
+Filesystem::IOUringFile::~IOUringFile() { close(); }
+
+void
+Filesystem::IOUringFile::close()
+{
+#ifdef USE_LIBURING
+    if (m_ring) {
+        io_uring_queue_exit((io_uring*)m_ring);
+        delete (io_uring*)m_ring;
+    }
+#endif
+    m_ring = nullptr;
+    IOFile::close();
+}
+
+bool
+Filesystem::IOUringFile::pread_batch(span<ReadRequest> requests)
+{
+#ifdef USE_LIBURING
+    // If another thread is using the ring, don't wait for it to finish
+    // its whole batch, just do ours the ordinary way.
+    std::unique_lock<std::mutex> lock(m_ring_mutex, std::try_to_lock);
+    if (!m_ring || !m_file || m_mode != Read || !lock.owns_lock()
+        || requests.size() < 2)
+        return IOFile::pread_batch(requests);
+
+    io_uring* ring = (io_uring*)m_ring;
+    int fd         = fileno(m_file);
+    size_t nreq    = size_t(requests.size());
+    for (auto& r : requests)
+        r.nread = 0;
+    bool ok         = true;
+    size_t next     = 0;
+    size_t queued   = 0;  // Prepared, but not yet submitted
+    size_t inflight = 0;  // Submitted, completion not yet reaped
+    while (next < nreq || queued || inflight) {
+        // Keep the queue as full as we can
+        for (; next < nreq && queued + inflight < size_t(m_queue_depth);
+             ++next) {
+            ReadRequest& r = requests[next];
+            if (!r.size)
+                continue;
+            io_uring_sqe* sqe = io_uring_get_sqe(ring);
+            if (!sqe)
+                break;
+            io_uring_prep_read(sqe, fd, r.buf, unsigned(r.size),
+                               uint64_t(r.offset));
+            io_uring_sqe_set_data(sqe, &r);
+            ++queued;
+        }
+        if (!queued && !inflight)
+            break;
+        io_uring_cqe* cqe = nullptr;
+        int rv            = 0;
+        if (queued) {
+            do {
+                rv = io_uring_submit(ring);
+            } while (rv == -EINTR);
+            if (rv > 0) {
+                inflight += size_t(rv);
+                queued -= std::min(size_t(rv), queued);
+            } else if (rv == 0 && !inflight) {
+                rv = -EAGAIN;  // Nothing would ever complete
+            }
+        }
+        if (rv >= 0) {
+            do {
+                rv = io_uring_wait_cqe(ring, &cqe);
+            } while (rv == -EINTR);
+        }
+        if (rv < 0) {
+            // Something is badly wrong with the ring. Reads the kernel
+            // already has may still land in the caller's buffers, so reap
+            // them all before tearing the ring down. Then finish the
+            // batch, and all future ones, with ordinary preads.
+            error(std::strerror(-rv));
+            while (inflight) {
+                int wrv;
+                do {
+                    wrv = io_uring_wait_cqe(ring, &cqe);
+                } while (wrv == -EINTR);
+                if (wrv < 0)
+                    break;
+                ReadRequest& r = *(ReadRequest*)io_uring_cqe_get_data(cqe);
+                if (cqe->res > 0)
+                    r.nread = size_t(cqe->res);
+                io_uring_cqe_seen(ring, cqe);
+                --inflight;
+            }
+            io_uring_queue_exit(ring);
+            delete ring;
+            m_ring = nullptr;
+            ok     = true;
+            for (auto& r : requests) {
+                if (r.nread != r.size)
+                    r.nread = pread(r.buf, r.size, r.offset);
+                ok &= (r.nread == r.size);
+            }
+            return ok;
+        }
+        ReadRequest& r = *(ReadRequest*)io_uring_cqe_get_data(cqe);
+        int res        = cqe->res;
+        io_uring_cqe_seen(ring, cqe);
+        --inflight;
+        if (res < 0)
+            error(std::strerror(-res));
+        else
+            r.nread = size_t(res);
+        if (res > 0 && r.nread < r.size) {
+            // Short read (not at the end of the file) -- finish it here
+            r.nread += pread((char*)r.buf + r.nread, r.size - r.nread,
+                             r.offset + int64_t(r.nread));
+        }
+        ok &= (r.nread == r.size);
+    }
+    return ok;
+#else
+    return IOFile::pread_batch(requests);
+#endif
+}
+
+
+
 size_t
 Filesystem::IOVecOutput::write(const void* buf, size_t size)
 {
@@ -1170,6 +1357,8 @@ size_t
 Filesystem::IOMemReader::pread(void* buf, size_t size, int64_t offset)
 {
     // N.B. No lock necessary
+    if (offset < 0 || size_t(offset) >= m_buf.size())
+        return 0;
     if (size + size_t(offset) > size_t(m_buf.size()))
         size = m_buf.size() - size_t(offset);
     memcpy(buf, m_buf.data() + offset, size);
@@ -1177,4 +1366,141 @@ Filesystem::IOMemReader::pread(void* buf, size_t size, int64_t offset)
 }
 
 
+const void*
+Filesystem::IOMemReader::mapped(int64_t offset, size_t size) const
+{
+    if (offset < 0 || size_t(offset) > m_buf.size()
+        || size > m_buf.size() - size_t(offset))
+        return nullptr;
+    return m_buf.data() + offset;
+}
+
+
+
+Filesystem::IOMMap::IOMMap(string_view filename, Advice advice)
+    : IOProxy(filename, Read)
+{
+#ifdef _WIN32
+    std::wstring wname = Strutil::utf8_to_utf16(m_filename);
+    HANDLE fh = CreateFileW(wname.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fh == INVALID_HANDLE_VALUE) {
+        m_mode = Closed;
+        error("could not open file");
+        return;
+    }
+    LARGE_INTEGER filesize;
+    if (GetFileSizeEx(fh, &filesize))
+        m_size = size_t(filesize.QuadPart);
+    if (m_size) {
+        // The view keeps the file alive, so we need no other handles.
+        HANDLE mh = CreateFileMappingW(fh, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mh) {
+            m_data = (const unsigned char*)MapViewOfFile(mh, FILE_MAP_READ, 0,
+                                                         0, 0);
+            CloseHandle(mh);
+        }
+    }
+    CloseHandle(fh);
+#else
+    int fd = ::open(m_filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        m_mode = Closed;
+        error(std::strerror(errno));
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0)
+        m_size = size_t(st.st_size);
+    if (m_size) {
+        void* p = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED)
+            m_data = (const unsigned char*)p;
+    }
+    ::close(fd);  // The mapping keeps the file alive
+#endif
+    if (m_size && !m_data) {
+        m_mode = Closed;
+        m_size = 0;
+        error("could not map file");
+        return;
+    }
+    advise(advice);
+}
+
+
+Filesystem::IOMMap::~IOMMap() { close(); }
+
+
+void
+Filesystem::IOMMap::close()
+{
+    if (m_data) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap((void*)m_data, m_size);
+#endif
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_mode = Closed;
+}
+
+
+size_t
+Filesystem::IOMMap::read(void* buf, size_t size)
+{
+    size = pread(buf, size, m_pos);
+    m_pos += size;
+    return size;
+}
+
+
+size_t
+Filesystem::IOMMap::pread(void* buf, size_t size, int64_t offset)
+{
+    // N.B. No lock necessary
+    if (!m_data || offset < 0 || size_t(offset) >= m_size)
+        return 0;
+    size = std::min(size, m_size - size_t(offset));
+    memcpy(buf, m_data + offset, size);
+    return size;
+}
+
+
+const void*
+Filesystem::IOMMap::mapped(int64_t offset, size_t size) const
+{
+    if (!m_data || offset < 0 || size_t(offset) > m_size
+        || size > m_size - size_t(offset))
+        return nullptr;
+    return m_data + offset;
+}
+
+
+void
+Filesystem::IOMMap::advise(Advice advice, int64_t offset, size_t size)
+{
+    if (!m_data || offset < 0 || size_t(offset) >= m_size)
+        return;
+    if (!size || size > m_size - size_t(offset))
+        size = m_size - size_t(offset);
+#ifdef _WIN32
+    // Windows has no per-range access pattern hints for views (and
+    // prefetching needs Windows 8), so rely on its own read-ahead.
+    (void)advice;
+#else
+    // madvise wants a page-aligned start
+    size_t pagesize = size_t(sysconf(_SC_PAGESIZE));
+    size_t begin    = size_t(offset) - size_t(offset) % pagesize;
+    int madv        = advice == Sequential ? MADV_SEQUENTIAL
+                      : advice == Random   ? MADV_RANDOM
+                      : advice == WillNeed ? MADV_WILLNEED
+                                           : MADV_NORMAL;
+    madvise((void*)(m_data + begin), size + (size_t(offset) - begin), madv);
+#endif
+}
+
+
 OIIO_NAMESPACE_END
@@ -505,6 +505,89 @@ test_mem_proxies()
         10, 13, 14, 13, 14, 15, 16, 17, 18, 19
     };
     OIIO_CHECK_ASSERT(output_buf == ref_buf);
+    OIIO_CHECK_ASSERT(in.mapped(2, 3) == input_buf.data() + 2);
+    OIIO_CHECK_ASSERT(in.mapped(8, 3) == nullptr);
+    OIIO_CHECK_ASSERT(out.mapped(0, 1) == nullptr);
+}
+
+
+
+void
+test_mmap_proxy()
+{
+    std::cout << "Testing memory-mapped file proxy:\n";
+    const char* filename = "testfile_mmap";
+    std::string contents = "abcdefghijklmnopqrstuvwxyz";
+    Filesystem::write_text_file(filename, contents);
+
+    Filesystem::IOMMap in(filename);
+    OIIO_CHECK_EQUAL(in.mode(), Filesystem::IOProxy::Read);
+    OIIO_CHECK_EQUAL(in.size(), contents.size());
+    char b[8];
+    OIIO_CHECK_EQUAL(in.read(b, 4), 4);
+    OIIO_CHECK_EQUAL(string_view(b, 4), "abcd");
+    OIIO_CHECK_EQUAL(in.tell(), 4);
+    OIIO_CHECK_EQUAL(in.pread(b, 8, 22), 4);  // truncated at the end
+    OIIO_CHECK_EQUAL(string_view(b, 4), "wxyz");
+    OIIO_CHECK_EQUAL(in.tell(), 4);
+    in.seek(10);
+    OIIO_CHECK_EQUAL(in.read(b, 3), 3);
+    OIIO_CHECK_EQUAL(string_view(b, 3), "klm");
+    const char* p = (const char*)in.mapped(5, 3);
+    OIIO_CHECK_ASSERT(p && string_view(p, 3) == "fgh");
+    OIIO_CHECK_ASSERT(in.mapped(24, 3) == nullptr);
+    in.advise(Filesystem::IOMMap::Random, 3, 10);
+    in.close();
+    OIIO_CHECK_EQUAL(in.mode(), Filesystem::IOProxy::Closed);
+    OIIO_CHECK_ASSERT(in.mapped(0, 1) == nullptr);
+
+    Filesystem::IOMMap missing("no_such_file_mmap");
+    OIIO_CHECK_EQUAL(missing.mode(), Filesystem::IOProxy::Closed);
+    OIIO_CHECK_ASSERT(missing.error().size());
+    Filesystem::remove(filename);
+}
+
+
+
+void
+test_pread_batch()
+{
+    std::cout << "Testing batched preads:\n";
+    const char* filename = "testfile_batch";
+    std::string contents;
+    for (int i = 0; i < 10000; ++i)
+        contents += char('a' + i % 26);
+    Filesystem::write_text_file(filename, contents);
+
+    Filesystem::IOUringFile uring(filename, 4);
+    Filesystem::IOFile file(filename, Filesystem::IOProxy::Read);
+    Filesystem::IOMemReader mem((void*)contents.data(), contents.size());
+    for (Filesystem::IOProxy* io :
+         { (Filesystem::IOProxy*)&uring, (Filesystem::IOProxy*)&file,
+           (Filesystem::IOProxy*)&mem }) {
+        // More requests than the queue depth, in no particular order, and
+        // the last one running off the end of the file.
+        char bufs[10][16];
+        Filesystem::IOProxy::ReadRequest reqs[10];
+        for (int i = 0; i < 10; ++i) {
+            reqs[i].buf    = bufs[i];
+            reqs[i].size   = 16;
+            reqs[i].offset = (i * 3719) % 9000;
+        }
+        reqs[9].offset = int64_t(contents.size()) - 5;
+        OIIO_CHECK_ASSERT(!io->pread_batch(reqs));
+        for (int i = 0; i < 9; ++i) {
+            OIIO_CHECK_EQUAL(reqs[i].nread, 16);
+            OIIO_CHECK_EQUAL(string_view(bufs[i], 16),
+                             string_view(contents).substr(reqs[i].offset, 16));
+        }
+        OIIO_CHECK_EQUAL(reqs[9].nread, 5);
+        span<Filesystem::IOProxy::ReadRequest> first9(reqs, 9);
+        OIIO_CHECK_ASSERT(io->pread_batch(first9));
+    }
+    uring.close();
+    file.close();
+    Filesystem::remove(filename);
 }
 
 
@@ -518,6 +601,8 @@ main(int /*argc*/, char* /*argv*/[])
     test_frame_sequences();
     test_scan_sequences();
     test_mem_proxies();
+    test_mmap_proxy();
+    test_pread_batch();
 
     return unit_test_failures;
 }
@@ -140,6 +140,32 @@ test_thread_pool_recursion()
 
 
 
+void
+test_nested_parallel_for()
+{
+    std::cout << "\nTesting nested parallel_for" << std::endl;
+    thread_pool* pool(default_thread_pool());
+    pool->resize(3);
+    // Three levels deep, with each level's tasks submitted from inside pool
+    // tasks. Every innermost iteration must run exactly once.
+    const int n = 32;
+    std::vector<atomic_int> hits(n * n * n);
+    for (auto& h : hits)
+        h = 0;
+    parallel_for(0, n, [&](int64_t i) {
+        parallel_for(0, n, [&](int64_t j) {
+            parallel_for(0, n, [&](int64_t k) {
+                hits[(i * n + j) * n + k] += 1;
+            });
+        });
+    });
+    bool all_one = std::all_of(hits.begin(), hits.end(),
+                               [](const atomic_int& h) { return h == 1; });
+    OIIO_CHECK_ASSERT(all_one);
+}
+
+
+
 void
 test_empty_thread_pool()
 {
@@ -181,6 +207,7 @@ main(int argc, char** argv)
     test_parallel_for_2D();
     time_parallel_for();
     test_thread_pool_recursion();
+    test_nested_parallel_for();
     test_empty_thread_pool();
 
     return unit_test_failures;
@@ -6,6 +6,7 @@
 #    define _POSIX_C_SOURCE 1  // for localtime_r
 #endif
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -15,8 +16,10 @@
 #include <signal.h>
 #include <string>
 #include <thread>
+#include <vector>
 
 #ifdef __linux__
+#    include <sched.h>
 #    include <sys/ioctl.h>
 #    include <sys/sysinfo.h>
 #    include <unistd.h>
@@ -558,6 +561,87 @@ Sysutil::physical_concurrency()
 
 
 
+namespace {
+
+// The mapping of CPUs to NUMA nodes, discovered once.
+struct NumaTopology {
+    int nodes = 1;
+    std::vector<int> cpu_node;  // Indexed by CPU number
+
+    NumaTopology()
+    {
+#ifdef __linux__
+        // Each node is a directory /sys/devices/system/node/nodeN, whose
+        // "cpulist" file lists its CPUs as ranges, like "0-15,32-47".
+        int maxnode = -1;
+        for (int node = 0; node < 1024; ++node) {
+            std::string cpulist;
+            std::string path = Strutil::sprintf(
+                "/sys/devices/system/node/node%d/cpulist", node);
+            FILE* file = fopen(path.c_str(), "r");
+            if (!file) {
+                if (node > maxnode + 64)
+                    break;  // Node numbers can be sparse, but not that sparse
+                continue;
+            }
+            char buf[4096];
+            if (fgets(buf, sizeof(buf), file))
+                cpulist = buf;
+            fclose(file);
+            maxnode = node;
+            for (string_view range : Strutil::splits(cpulist, ",")) {
+                range     = Strutil::strip(range);
+                auto ends = Strutil::splits(range, "-");
+                int first = ends.size() ? Strutil::stoi(ends[0]) : -1;
+                int last  = ends.size() > 1 ? Strutil::stoi(ends[1]) : first;
+                if (first < 0 || last < first || last > 65535)
+                    continue;
+                if (last >= int(cpu_node.size()))
+                    cpu_node.resize(last + 1, 0);
+                for (int cpu = first; cpu <= last; ++cpu)
+                    cpu_node[cpu] = node;
+            }
+        }
+        nodes = std::max(maxnode + 1, 1);
+#endif
+    }
+};
+
+const NumaTopology&
+numa_topology()
+{
+    static NumaTopology topology;
+    return topology;
+}
+
+}  // namespace
+
+
+
+int
+Sysutil::numa_nodes()
+{
+    return numa_topology().nodes;
+}
+
+
+
+int
+Sysutil::current_numa_node()
+{
+#ifdef __linux__
+    const NumaTopology& topology(numa_topology());
+    if (topology.nodes > 1) {
+        int cpu = sched_getcpu();
+        if (cpu >= 0 && cpu < int(topology.cpu_node.size()))
+            return topology.cpu_node[cpu];
+    }
+#endif
+    return 0;
+}
+
+
+
 size_t
 Sysutil::max_open_files()
 {
@@ -18,6 +18,7 @@
 #    define _ENABLE_ATOMIC_ALIGNMENT_FIX /* Avoid MSVS error, ugh */
 #endif
 
+#include <deque>
 #include <exception>
 #include <functional>
 #include <future>
@@ -30,57 +31,84 @@
 
 #include <boost/container/flat_map.hpp>
 
-#if 0
-
-// Use boost::lockfree::queue for the task queue
-#    include <boost/lockfree/queue.hpp>
-template<typename T> using Queue = boost::lockfree::queue<T>;
+namespace {
 
-#else
+// A task waiting to run. We remember which thread submitted it and in what
+// order, so that a thread waiting on a task_set can tell which of the
+// queued tasks are its own.
+struct Task {
+    std::function<void(int id)>* f = nullptr;
+    std::thread::id submitter;
+    uint64_t seq = 0;
+};
 
-#    include <queue>
 
-namespace {
 
-template<typename T> class Queue {
+// Double-ended task queue. Each pool worker owns one, pushing and popping
+// its own tasks at the back (LIFO, so nested work stays hot in its cache),
+// while idle threads steal from the front (FIFO, taking the oldest and
+// usually largest pieces of work). Tasks submitted by threads that are
+// not pool workers go to a separate shared queue.
+class WorkQueue {
 public:
-    Queue(int /*size*/) {}
-    bool push(T const& value)
+    void push(const Task& t)
     {
-        std::unique_lock<Mutex> lock(this->mutex);
-        this->q.push(value);
-        return true;
+        OIIO::spin_lock lock(m_mutex);
+        m_q.push_back(t);
     }
-    // deletes the retrieved element, do not use for non integral types
-    bool pop(T& v)
+    bool pop_back(Task& t)
     {
-        std::unique_lock<Mutex> lock(this->mutex);
-        if (this->q.empty())
+        OIIO::spin_lock lock(m_mutex);
+        if (m_q.empty())
             return false;
-        v = this->q.front();
-        this->q.pop();
+        t = m_q.back();
+        m_q.pop_back();
         return true;
     }
-    bool empty()
+    bool pop_front(Task& t)
     {
-        std::unique_lock<Mutex> lock(this->mutex);
-        return this->q.empty();
+        OIIO::spin_lock lock(m_mutex);
+        if (m_q.empty())
+            return false;
+        t = m_q.front();
+        m_q.pop_front();
+        return true;
     }
-    size_t size()
+    // Pop the newest task that `submitter` pushed after its `since`'th
+    // submission. A thread's tasks are queued in the order it submitted
+    // them, so we can stop at the first older one of its own.
+    bool pop_own(Task& t, std::thread::id submitter, uint64_t since)
     {
-        std::unique_lock<Mutex> lock(this->mutex);
-        return q.size();
+        OIIO::spin_lock lock(m_mutex);
+        for (auto i = m_q.rbegin(); i != m_q.rend(); ++i) {
+            if (i->submitter != submitter)
+                continue;
+            if (i->seq <= since)
+                return false;
+            t = *i;
+            m_q.erase(std::next(i).base());
+            return true;
+        }
+        return false;
     }
 
 private:
-    typedef OIIO::spin_mutex Mutex;
-    std::queue<T> q;
-    Mutex mutex;
+    std::deque<Task> m_q;
+    OIIO::spin_mutex m_mutex;
 };
 
+
+
+// How many tasks the calling thread has submitted to any pool.
+uint64_t&
+thread_submissions()
+{
+    thread_local uint64_t n = 0;
+    return n;
+}
+
 }  // namespace
 
-#endif
 
 
 OIIO_NAMESPACE_BEGIN
@@ -98,8 +126,7 @@ threads_default()
 
 class thread_pool::Impl {
 public:
-    Impl(int nThreads = 0, int queueSize = 1024)
-        : q(queueSize)
+    Impl(int nThreads = 0)
     {
         this->init();
         this->resize(nThreads);
@@ -131,6 +158,13 @@ public:
             int oldNThreads = size();
             if (oldNThreads
                 <= nThreads) {  // if the number of threads is increased
+                {
+                    // Worker queues are never destroyed before stop(), so
+                    // the pointers that threads hold to them stay valid.
+                    spin_rw_write_lock lock(m_queues_mutex);
+                    while (int(m_queues.size()) < nThreads)
+                        m_queues.emplace_back(new WorkQueue);
+                }
                 this->threads.resize(nThreads);
                 this->flags.resize(nThreads);
                 for (int i = oldNThreads; i < nThreads; ++i) {
@@ -158,28 +192,14 @@ public:
         m_size = nThreads;
     }
 
-    // empty the queue
+    // empty all the queues
     void clear_queue()
     {
-        std::function<void(int id)>* _f;
-        while (this->q.pop(_f))
-            delete _f;  // empty the queue
-    }
-
-    // pops a functional wraper to the original function
-    std::function<void(int)> pop()
-    {
-        std::function<void(int id)>* _f = nullptr;
-        this->q.pop(_f);
-        std::unique_ptr<std::function<void(int id)>> func(
-            _f);  // at return, delete the function even if an exception occurred
-        std::function<void(int)> f;
-        if (_f)
-            f = *_f;
-        return f;
+        Task t;
+        while (pop_any(t))
+            delete t.f;
     }
 
-
     // wait for all computing threads to finish and stop all threads
     // may be called asyncronously to not pause the calling thread while waiting
     // if isWait == true, all the functions in the queue are run, otherwise the queue is cleared without running the functions
@@ -238,9 +258,18 @@ public:
         this->flags.clear();
     }
 
+    // A pool worker keeps the tasks it submits in its own queue, where it
+    // will run them itself unless an idle thread steals them first. Any
+    // other thread submits to the shared queue.
     void push_queue_and_notify(std::function<void(int id)>* f)
     {
-        this->q.push(f);
+        Task t;
+        t.f         = f;
+        t.submitter = std::this_thread::get_id();
+        t.seq       = ++thread_submissions();
+        WorkQueue* q = (tl_pool == this) ? tl_queue : &m_shared;
+        q->push(t);
+        ++m_pending;
         std::unique_lock<std::mutex> lock(this->mutex);
         this->cv.notify_one();
     }
@@ -249,19 +278,26 @@ public:
     // thread.
     bool run_one_task(std::thread::id id)
     {
-        std::function<void(int)>* f = nullptr;
-        bool isPop                  = this->q.pop(f);
-        if (isPop) {
-            OIIO_DASSERT(f);
-            std::unique_ptr<std::function<void(int id)>> func(
-                f);  // at return, delete the function even if an exception occurred
-            register_worker(id);
-            (*f)(-1);
-            deregister_worker(id);
-        } else {
-            OIIO_DASSERT(f == nullptr);
-        }
-        return isPop;
+        Task t;
+        if (!pop_any(t))
+            return false;
+        run_as_helper(t, id);
+        return true;
+    }
+
+    // If the calling thread has submitted any tasks since its `since`'th
+    // submission that are still queued, pop the newest and run it.
+    bool run_own_task(uint64_t since)
+    {
+        std::thread::id id = std::this_thread::get_id();
+        Task t;
+        bool found = (tl_pool == this && tl_queue->pop_own(t, id, since))
+                     || m_shared.pop_own(t, id, since);
+        if (!found)
+            return false;
+        --m_pending;
+        run_as_helper(t, id);
+        return true;
     }
 
     void register_worker(std::thread::id id)
@@ -280,7 +316,7 @@ public:
         return m_worker_threadids[id] != 0;
     }
 
-    size_t jobs_in_queue() const { return q.size(); }
+    size_t jobs_in_queue() const { return size_t(std::max(0, int(m_pending))); }
 
     bool very_busy() const { return jobs_in_queue() > size_t(4 * m_size); }
 
@@ -290,38 +326,78 @@ private:
     Impl& operator=(const Impl&) = delete;
     Impl& operator=(Impl&&) = delete;
 
+    // Run a task on a thread that is not (or not only) a pool worker
+    // running its main loop, so it's passed an id of -1.
+    void run_as_helper(const Task& t, std::thread::id id)
+    {
+        std::unique_ptr<std::function<void(int id)>> func(
+            t.f);  // at return, delete the function even if an exception occurred
+        register_worker(id);
+        (*t.f)(-1);
+        deregister_worker(id);
+    }
+
+    // Steal the oldest task from the shared queue or any worker's queue,
+    // starting with the worker after `first`.
+    bool pop_any(Task& t, int first = -1)
+    {
+        bool found = m_shared.pop_front(t);
+        if (!found) {
+            spin_rw_read_lock lock(m_queues_mutex);
+            int n = int(m_queues.size());
+            for (int k = 1; k <= n && !found; ++k)
+                found = m_queues[(first + k + n) % n]->pop_front(t);
+        }
+        if (found)
+            --m_pending;
+        return found;
+    }
+
+    // A worker runs its own newest task first, then steals.
+    bool pop_task(WorkQueue* home, int i, Task& t)
+    {
+        if (home->pop_back(t)) {
+            --m_pending;
+            return true;
+        }
+        return pop_any(t, i);
+    }
+
     void set_thread(int i)
     {
         std::shared_ptr<std::atomic<bool>> flag(
             this->flags[i]);  // a copy of the shared ptr to the flag
-        auto f = [this, i, flag /* a copy of the shared ptr to the flag */]() {
+        WorkQueue* home = m_queues[i].get();
+        auto f = [this, i, home,
+                  flag /* a copy of the shared ptr to the flag */]() {
+            tl_pool  = this;
+            tl_queue = home;
             register_worker(std::this_thread::get_id());
             std::atomic<bool>& _flag = *flag;
-            std::function<void(int id)>* _f;
-            bool isPop = this->q.pop(_f);
-            while (true) {
-                while (isPop) {  // if there is anything in the queue
+            Task t;
+            while (!_flag) {
+                if (pop_task(home, i, t)) {
                     std::unique_ptr<std::function<void(int id)>> func(
-                        _f);  // at return, delete the function even if an exception occurred
-                    (*_f)(i);
-                    if (_flag) {
-                        // the thread is wanted to stop, return even if the queue is not empty yet
-                        return;
-                    } else {
-                        isPop = this->q.pop(_f);
-                    }
+                        t.f);  // at return, delete the function even if an exception occurred
+                    (*t.f)(i);
+                    continue;
                 }
-                // the queue is empty here, wait for the next command
+                // the queues are empty here, wait for the next command
                 std::unique_lock<std::mutex> lock(this->mutex);
                 ++this->nWaiting;
-                this->cv.wait(lock, [this, &_f, &isPop, &_flag]() {
-                    isPop = this->q.pop(_f);
-                    return isPop || this->isDone || _flag;
+                this->cv.wait(lock, [this, &_flag]() {
+                    return m_pending > 0 || this->isDone || _flag;
                 });
                 --this->nWaiting;
-                if (!isPop)
-                    break;  // if the queue is empty and this->isDone == true or *flag then return
+                if (this->isDone && m_pending <= 0)
+                    break;  // nothing left to run and we've been told to finish
             }
+            // Hand anything still in our queue to the rest of the pool
+            // (this only happens when the pool shrinks).
+            while (home->pop_front(t))
+                m_shared.push(t);
+            tl_pool  = nullptr;
+            tl_queue = nullptr;
             deregister_worker(std::this_thread::get_id());
         };
         this->threads[i].reset(
@@ -330,15 +406,19 @@ private:
 
     void init()
     {
-        this->nWaiting = 0;
-        this->isStop   = false;
-        this->isDone   = false;
+        this->nWaiting  = 0;
+        this->m_pending = 0;
+        this->isStop    = false;
+        this->isDone    = false;
     }
 
     std::vector<std::unique_ptr<std::thread>> threads;
     std::vector<std::unique_ptr<std::thread>> terminating_threads;
     std::vector<std::shared_ptr<std::atomic<bool>>> flags;
-    mutable Queue<std::function<void(int id)>*> q;
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;  // one per worker
+    spin_rw_mutex m_queues_mutex;  // guards growth of m_queues
+    WorkQueue m_shared;            // tasks from non-worker threads
+    std::atomic<int> m_pending;    // tasks queued but not yet started
     std::atomic<bool> isDone;
     std::atomic<bool> isStop;
     std::atomic<int> nWaiting;  // how many threads are waiting
@@ -347,8 +427,16 @@ private:
     std::condition_variable cv;
     mutable boost::container::flat_map<std::thread::id, int> m_worker_threadids;
     mutable spin_mutex m_worker_threadids_mutex;
+
+    // The pool (if any) that the calling thread is a worker of, and that
+    // worker's own queue.
+    static thread_local Impl* tl_pool;
+    static thread_local WorkQueue* tl_queue;
 };
 
+thread_local thread_pool::Impl* thread_pool::Impl::tl_pool = nullptr;
+thread_local WorkQueue* thread_pool::Impl::tl_queue        = nullptr;
+
 
 
 thread_pool::thread_pool(int nthreads)
@@ -406,6 +494,22 @@ thread_pool::run_one_task(std::thread::id id)
 
 
 
+bool
+thread_pool::run_own_task(uint64_t since)
+{
+    return m_impl->run_own_task(since);
+}
+
+
+
+uint64_t
+thread_pool::submission_count()
+{
+    return thread_submissions();
+}
+
+
+
 void
 thread_pool::push_queue_and_notify(std::function<void(int id)>* f)
 {
@@ -474,7 +578,7 @@ task_set::wait_for_task(size_t taskindex, bool block)
     if (taskindex >= m_futures.size())
         return;  // nothing to wait for
     auto& f(m_futures[taskindex]);
-    if (block || m_pool->is_worker(m_submitter_thread)) {
+    if (block) {
         // Block on completion of all the task and don't try to do any
         // of the work with the calling thread.
         f.wait();
@@ -482,6 +586,7 @@ task_set::wait_for_task(size_t taskindex, bool block)
     }
     // If we made it here, we want to allow the calling thread to help
     // do pool work if it's waiting around for a while.
+    bool nested = m_pool->is_worker(m_submitter_thread);
     const std::chrono::milliseconds wait_time(0);
     int tries = 0;
     while (1) {
@@ -495,7 +600,7 @@ task_set::wait_for_task(size_t taskindex, bool block)
         }
         // Since we're waiting, try to run a task ourselves to help
         // with the load. If none is available, just yield schedule.
-        if (!m_pool->run_one_task(m_submitter_thread)) {
+        if (!help(nested)) {
             // We tried to do a task ourselves, but there weren't any
             // left, so just wait for the rest to finish.
             yield();
@@ -505,13 +610,27 @@ task_set::wait_for_task(size_t taskindex, bool block)
 
 
 
+bool
+task_set::help(bool nested)
+{
+    // Our own tasks come first. A thread that is already in the middle of
+    // pool work may only run those: they are exactly what it would have
+    // run itself without the pool, so it can't pick up an unrelated task
+    // that needs a lock held further up its own stack. Other threads may
+    // help with anything in the pool.
+    if (m_pool->run_own_task(m_first_submission))
+        return true;
+    return !nested && m_pool->run_one_task(m_submitter_thread);
+}
+
+
+
 void
 task_set::wait(bool block)
 {
     OIIO_DASSERT(submitter() == std::this_thread::get_id());
     const std::chrono::milliseconds wait_time(0);
-    if (m_pool->is_worker(m_submitter_thread))
-        block = true;  // don't get into recursive work stealing
+    bool nested = m_pool->is_worker(m_submitter_thread);
     if (block == false) {
         int tries = 0;
         while (1) {
@@ -535,7 +654,7 @@ task_set::wait(bool block)
             }
             // Since we're waiting, try to run a task ourselves to help
             // with the load. If none is available, just yield schedule.
-            if (!m_pool->run_one_task(m_submitter_thread)) {
+            if (!help(nested)) {
                 // We tried to do a task ourselves, but there weren't any
                 // left, so just wait for the rest to finish.
 #if 1
@@ -571,10 +690,12 @@ task_set::wait(bool block)
 // thread pool. Call with the adjustment (i.e., parallel_recursive_depth(1)
 // to enter, parallel_recursive_depth(-1) to exit), and it will return the
 // new value. Call with default args (0) to just return the current depth.
+// Nested loops only run serially if the caller turned off
+// parallel_options::recursive.
 static int
 parallel_recursive_depth(int change = 0)
 {
-    thread_local int depth = 0;  // let's only allow one level of parallel work
+    thread_local int depth = 0;  // nesting depth of parallel loops
     depth += change;
     return depth;
 }
@@ -586,7 +707,7 @@ parallel_for_chunked(int64_t start, int64_t end, int64_t chunksize,
                      std::function<void(int id, int64_t b, int64_t e)>&& task,
                      parallel_options opt)
 {
-    if (parallel_recursive_depth(1) > 1)
+    if (parallel_recursive_depth(1) > 1 && !opt.recursive)
         opt.maxthreads = 1;
     opt.resolve();
     chunksize = std::min(chunksize, end - start);
@@ -624,7 +745,7 @@ parallel_for_chunked_2D(
     std::function<void(int id, int64_t, int64_t, int64_t, int64_t)>&& task,
     parallel_options opt)
 {
-    if (parallel_recursive_depth(1) > 1)
+    if (parallel_recursive_depth(1) > 1 && !opt.recursive)
         opt.maxthreads = 1;
     opt.resolve();
     if (opt.singlethread()
@@ -119,6 +119,8 @@ Oiiotool::clear_options()
     autopremult        = true;
     nativeread         = false;
     metamerge          = false;
+    parallel_subimages = false;
+    async_output       = false;
     cachesize          = 4096;
     autotile           = 0;  // was: 4096
     // FIXME: Turned off autotile by default Jan 2018 after thinking that
@@ -387,9 +389,52 @@ Oiiotool::process_pending()
 
 
 
+// The innermost MessageCapture of each thread, if any.
+static thread_local Oiiotool::MessageCapture* message_capture = nullptr;
+
+
+
+Oiiotool::MessageCapture::MessageCapture()
+    : m_prev(message_capture)
+{
+    message_capture = this;
+}
+
+
+
+Oiiotool::MessageCapture::~MessageCapture() { stop(); }
+
+
+
+void
+Oiiotool::MessageCapture::stop()
+{
+    if (message_capture == this)
+        message_capture = m_prev;
+}
+
+
+
+void
+Oiiotool::MessageCapture::replay(const Oiiotool& ot) const
+{
+    for (auto& m : m_messages) {
+        if (m.error)
+            ot.error(m.command, m.text);
+        else
+            ot.warning(m.command, m.text);
+    }
+}
+
+
+
 void
 Oiiotool::error(string_view command, string_view explanation) const
 {
+    if (message_capture) {
+        message_capture->m_messages.push_back({ true, command, explanation });
+        return;
+    }
     std::cerr << "oiiotool ERROR";
     if (command.size())
         std::cerr << ": " << command;
@@ -410,6 +455,10 @@ Oiiotool::error(string_view command, string_view explanation) const
 void
 Oiiotool::warning(string_view command, string_view explanation) const
 {
+    if (message_capture) {
+        message_capture->m_messages.push_back({ false, command, explanation });
+        return;
+    }
     std::cerr << "oiiotool WARNING";
     if (command.size())
         std::cerr << ": " << command;
@@ -422,6 +471,60 @@ Oiiotool::warning(string_view command, string_view explanation) const
 
 
 
+// Most outputs are encoded by a single thread, so a few at once in the
+// background overlap well with each other and with the rest of the
+// commands, but each holds a copy of its image, so don't let too many
+// pile up.
+static const size_t max_pending_outputs = 4;
+
+
+
+void
+Oiiotool::write_in_background(string_view filename,
+                              std::function<void()> write)
+{
+    while (m_pending_outputs.size() >= max_pending_outputs)
+        wait_for_pending(1);
+    auto task = [write]() {
+        std::shared_ptr<MessageCapture> messages(new MessageCapture);
+        write();
+        messages->stop();
+        return messages;
+    };
+    m_pending_outputs.push_back({ Filesystem::canonical_path(filename),
+                                  std::async(std::launch::async, task) });
+}
+
+
+
+void
+Oiiotool::wait_for_outputs(string_view filename)
+{
+    size_t n = m_pending_outputs.size();
+    if (n && filename.size()) {
+        // Match on the canonical path, so that "a.exr", "./a.exr" and
+        // "/abs/path/a.exr" all wait for the same background write.
+        std::string path = Filesystem::canonical_path(filename);
+        while (n && m_pending_outputs[n - 1].path != path)
+            --n;
+    }
+    wait_for_pending(n);
+}
+
+
+
+void
+Oiiotool::wait_for_pending(size_t n)
+{
+    for (; n && m_pending_outputs.size(); --n) {
+        auto messages = m_pending_outputs.front().done.get();
+        m_pending_outputs.pop_front();
+        messages->replay(*this);
+    }
+}
+
+
+
 ParamValueList
 Oiiotool::extract_options(string_view command)
 {
@@ -2276,6 +2379,7 @@ public:
         : OiiotoolOp(ot, opname, argc, argv, 1)
     {
         preserve_miplevels(true);
+        parallel_subimages(false);  // impl() uses ot.express
     }
     // Custom creation of new ImageRec result: don't copy, just change in
     // place.
@@ -3579,6 +3683,67 @@ public:
     OpResize(Oiiotool& ot, string_view opname, int argc, const char* argv[])
         : OiiotoolOp(ot, opname, argc, argv, 1)
     {
+        if (ot.extract_options(args(0)).get_int("jpegscale", 1))
+            prescale_jpeg();
+    }
+
+    // If the input is a JPEG file that hasn't been read yet, and we're
+    // shrinking it by at least half, let libjpeg do as much of the
+    // reduction as it can (by 2, 4, or 8) while decoding, which is far
+    // cheaper than decoding the full image and resizing all of it.
+    void prescale_jpeg()
+    {
+        ImageRecRef A = ir(1);
+        if (!A || A->elaborated() || A->subimages())
+            return;  // already read, or at least looked at
+        ustring uname(A->name());
+        ustring fileformat;
+        int subimages = 0;
+        if (!ot.imagecache->get_image_info(uname, 0, 0, ustring("fileformat"),
+                                           TypeString, &fileformat)
+            || fileformat != "jpeg"
+            || !ot.imagecache->get_image_info(uname, 0, 0,
+                                              ustring("subimages"), TypeInt,
+                                              &subimages)
+            || subimages != 1)
+            return;
+        const ImageSpec* spec = ot.imagecache->imagespec(uname, 0, 0);
+        if (!spec)
+            return;
+        ImageSpec newspec(*spec);
+        if (!ot.adjust_geometry(args(0), newspec.full_width,
+                                newspec.full_height, newspec.full_x,
+                                newspec.full_y, args(1).c_str(), true))
+            return;
+        int scale = 1;
+        while (scale < 8 && newspec.full_width * scale * 2 <= spec->full_width
+               && newspec.full_height * scale * 2 <= spec->full_height)
+            scale *= 2;
+        if (scale == 1)
+            return;
+        // The size argument may be relative ("50%"), so remember what it
+        // means for the original image. Applying it again to the reduced
+        // image in setup() would shrink it twice.
+        m_prescaled = true;
+        m_target    = newspec;
+        if (ot.debug)
+            std::cout << "  Reading " << uname << " at 1/" << scale
+                      << " resolution\n";
+
+        bool hadconfig = (A->configspec() != nullptr);
+        ImageSpec config;
+        if (hadconfig)
+            config = *A->configspec();
+        ImageSpec origconfig(config);
+        config.attribute("jpeg:scale", scale);
+        A->configspec(config);
+        ot.imagecache->add_file(uname, nullptr, &config, true);
+        // Read the reduced image into memory now, then put the cache back
+        // the way it was, so that any other use of the same file on the
+        // command line still sees it at full resolution.
+        ot.read(A, ReadNoCache);
+        ot.imagecache->add_file(uname, nullptr,
+                                hadconfig ? &origconfig : nullptr, true);
     }
     virtual bool setup() override
     {
@@ -3590,9 +3755,17 @@ public:
             const ImageSpec& Aspec(*ir(1)->spec(s));
             ImageSpec& newspec(newspecs[s]);
             newspec = Aspec;
-            ot.adjust_geometry(args(0), newspec.full_width, newspec.full_height,
-                               newspec.full_x, newspec.full_y,
-                               args(1).c_str() /*size*/, true);
+            if (m_prescaled) {
+                newspec.full_x      = m_target.full_x;
+                newspec.full_y      = m_target.full_y;
+                newspec.full_width  = m_target.full_width;
+                newspec.full_height = m_target.full_height;
+            } else {
+                ot.adjust_geometry(args(0), newspec.full_width,
+                                   newspec.full_height, newspec.full_x,
+                                   newspec.full_y, args(1).c_str() /*size*/,
+                                   true);
+            }
             if (newspec.full_width == Aspec.full_width
                 && newspec.full_height == Aspec.full_height) {
                 continue;
@@ -3634,6 +3807,10 @@ public:
         return ImageBufAlgo::resize(*img[0], *img[1], filtername, 0.0f,
                                     img[0]->roi());
     }
+
+private:
+    bool m_prescaled = false;  // Input was read at reduced resolution
+    ImageSpec m_target;        // Display window wanted, if m_prescaled
 };
 
 OP_CUSTOMCLASS(resize, OpResize, 1);
@@ -4537,6 +4714,9 @@ input_file(int argc, const char* argv[])
             ot.process_pending();
             break;
         }
+        // If we're still writing this file in the background, finish that
+        // before reading it back.
+        ot.wait_for_outputs(filename);
         Timer timer(ot.enable_function_timing);
         int exists = 1;
         if (ot.input_config_set) {
@@ -4775,6 +4955,107 @@ remove_all_cmd(std::string& str)
 
 
 
+// Write all the subimages and MIP levels of ir, with the given specs, to
+// filename (via a temp file). Apart from reporting errors and warnings,
+// this doesn't use any oiiotool state, so it may run in the background.
+static bool
+write_output_file(const std::string& command, const std::string& filename,
+                  ImageOutput* out, ImageRec& ir,
+                  const std::vector<ImageSpec>& subimagespecs,
+                  const std::vector<std::vector<ImageSpec>>& levelspecs,
+                  bool procedural)
+{
+    // Write the output to a temp file first, then rename it to the
+    // final destination (same directory). This improves robustness.
+    // There is less chance a crash during execution will leave behind a
+    // partially formed file, and it also protects us against corrupting
+    // an input if they are "oiiotooling in place" (especially
+    // problematic for large files that are ImageCache-based and so only
+    // partially read at the point that we open the file. We also force
+    // a unique filename to protect against multiple processes running
+    // at the same time on the same file.
+    std::string extension = Filesystem::extension(filename);
+    std::string tmpfilename
+        = Filesystem::replace_extension(filename,
+                                        ".%%%%%%%%.temp" + extension);
+    tmpfilename = Filesystem::unique_path(tmpfilename);
+
+    // Do the initial open
+    ImageOutput::OpenMode mode = ImageOutput::Create;
+    bool ok                    = true;
+    if (ir.subimages() > 1 && out->supports("multiimage")) {
+        if (!out->open(tmpfilename, ir.subimages(), &subimagespecs[0])) {
+            ot.error(command, out->geterror());
+            return false;
+        }
+    } else {
+        if (!out->open(tmpfilename, subimagespecs[0], mode)) {
+            ot.error(command, out->geterror());
+            return false;
+        }
+    }
+
+    // Output all the subimages and MIP levels
+    for (int s = 0, send = ir.subimages(); s < send; ++s) {
+        for (int m = 0, mend = ir.miplevels(s); m < mend && ok; ++m) {
+            const ImageSpec& spec(levelspecs[s][m]);
+            if (s > 0 || m > 0) {  // already opened first subimage/level
+                if (!out->open(tmpfilename, spec, mode)) {
+                    ot.error(command, out->geterror());
+                    ok = false;
+                    break;
+                }
+            }
+            if (!ir(s, m).write(out)) {
+                ot.error(command, ir(s, m).geterror());
+                ok = false;
+                break;
+            }
+            if (mend > 1) {
+                if (out->supports("mipmap")) {
+                    mode = ImageOutput::AppendMIPLevel;  // for next level
+                } else if (out->supports("multiimage")) {
+                    mode = ImageOutput::AppendSubimage;
+                } else {
+                    ot.warningf(command,
+                                "%s does not support MIP-maps for %s",
+                                out->format_name(), filename);
+                    break;
+                }
+            }
+        }
+        mode = ImageOutput::AppendSubimage;  // for next subimage
+        if (send > 1 && !out->supports("multiimage")) {
+            ot.warningf(command,
+                        "%s does not support multiple subimages for %s",
+                        out->format_name(), filename);
+            break;
+        }
+    }
+
+    if (!out->close()) {
+        ot.error(command, out->geterror());
+        ok = false;
+    }
+
+    // We wrote to a temporary file, so now atomically move it to the
+    // original desired location.
+    if (ok && !procedural) {
+        std::string err;
+        ok = Filesystem::rename(tmpfilename, filename, err);
+        if (!ok)
+            ot.errorf(
+                command,
+                "oiiotool ERROR: could not move temp file %s to %s: %s",
+                tmpfilename, filename, err);
+    }
+    if (!ok)
+        Filesystem::remove(tmpfilename);
+    return ok;
+}
+
+
+
 // -o
 static int
 output_file(int /*argc*/, const char* argv[])
@@ -4837,6 +5118,9 @@ output_file(int /*argc*/, const char* argv[])
         return 0;
     }
 
+    // Don't race with a background write of the same file
+    ot.wait_for_outputs(filename);
+
     if (ot.noclobber && Filesystem::exists(filename)) {
         ot.warningf(command, "%s already exists, not overwriting.", filename);
         return 0;
@@ -5006,7 +5290,15 @@ output_file(int /*argc*/, const char* argv[])
     // FIXME -- the various automatic transformations above neglect to handle
     // MIPmaps or subimages with full generality.
 
-    bool ok = true;
+    // The time to give the output file, if --adjust-time
+    std::time_t in_time      = ir->time();
+    std::string metadatatime = ir->spec(0, 0)->get_string_attribute(
+        "DateTime");
+    if (!metadatatime.empty())
+        DateTime_to_time_t(metadatatime.c_str(), in_time);
+
+    bool ok    = true;
+    bool async = false;
     if (do_tex || do_latlong || do_bumpslopes) {
         ImageSpec configspec;
         adjust_output_options(filename, configspec, nullptr, ot, supports_tiles,
@@ -5034,6 +5326,8 @@ output_file(int /*argc*/, const char* argv[])
     } else {
         // Non-texture case
         std::vector<ImageSpec> subimagespecs(ir->subimages());
+        std::vector<std::vector<ImageSpec>> levelspecs(ir->subimages());
+        bool deep = false;
         for (int s = 0; s < ir->subimages(); ++s) {
             ImageSpec spec = *ir->spec(s, 0);
             adjust_output_options(filename, spec, ir->nativespec(s), ot,
@@ -5046,111 +5340,50 @@ output_file(int /*argc*/, const char* argv[])
             if (!spec.tile_pixels() || ir->miplevels(s) <= 1)
                 spec.erase_attribute("textureformat");
             subimagespecs[s] = spec;
-        }
-
-        // Write the output to a temp file first, then rename it to the
-        // final destination (same directory). This improves robustness.
-        // There is less chance a crash during execution will leave behind a
-        // partially formed file, and it also protects us against corrupting
-        // an input if they are "oiiotooling in place" (especially
-        // problematic for large files that are ImageCache-based and so only
-        // partially read at the point that we open the file. We also force
-        // a unique filename to protect against multiple processes running
-        // at the same time on the same file.
-        std::string extension = Filesystem::extension(filename);
-        std::string tmpfilename
-            = Filesystem::replace_extension(filename,
-                                            ".%%%%%%%%.temp" + extension);
-        tmpfilename = Filesystem::unique_path(tmpfilename);
-
-        // Do the initial open
-        ImageOutput::OpenMode mode = ImageOutput::Create;
-        if (ir->subimages() > 1 && out->supports("multiimage")) {
-            if (!out->open(tmpfilename, ir->subimages(), &subimagespecs[0])) {
-                ot.error(command, out->geterror());
-                return 0;
-            }
-        } else {
-            if (!out->open(tmpfilename, subimagespecs[0], mode)) {
-                ot.error(command, out->geterror());
-                return 0;
-            }
-        }
-
-        // Output all the subimages and MIP levels
-        for (int s = 0, send = ir->subimages(); s < send; ++s) {
-            for (int m = 0, mend = ir->miplevels(s); m < mend && ok; ++m) {
+            deep |= spec.deep;
+            for (int m = 0, mend = ir->miplevels(s); m < mend; ++m) {
                 ImageSpec spec = *ir->spec(s, m);
                 adjust_output_options(filename, spec, ir->nativespec(s, m), ot,
                                       supports_tiles, fileoptions,
                                       (*ir)[s].was_direct_read());
-                if (s > 0 || m > 0) {  // already opened first subimage/level
-                    if (!out->open(tmpfilename, spec, mode)) {
-                        ot.error(command, out->geterror());
-                        ok = false;
-                        break;
-                    }
-                }
-                if (!(*ir)(s, m).write(out.get())) {
-                    ot.error(command, (*ir)(s, m).geterror());
-                    ok = false;
-                    break;
-                }
-                ot.check_peak_memory();
-                if (mend > 1) {
-                    if (out->supports("mipmap")) {
-                        mode = ImageOutput::AppendMIPLevel;  // for next level
-                    } else if (out->supports("multiimage")) {
-                        mode = ImageOutput::AppendSubimage;
-                    } else {
-                        ot.warningf(command,
-                                    "%s does not support MIP-maps for %s",
-                                    out->format_name(), filename);
-                        break;
-                    }
-                }
-            }
-            mode = ImageOutput::AppendSubimage;  // for next subimage
-            if (send > 1 && !out->supports("multiimage")) {
-                ot.warningf(command,
-                            "%s does not support multiple subimages for %s",
-                            out->format_name(), filename);
-                break;
+                levelspecs[s].push_back(spec);
             }
         }
 
-        if (!out->close()) {
-            ot.error(command, out->geterror());
-            ok = false;
-        }
-        out.reset();  // make extra sure it's cleaned up
-
-        // We wrote to a temporary file, so now atomically move it to the
-        // original desired location.
-        if (ok && !procedural) {
-            std::string err;
-            ok = Filesystem::rename(tmpfilename, filename, err);
-            if (!ok)
-                ot.errorf(
-                    command,
-                    "oiiotool ERROR: could not move temp file %s to %s: %s",
-                    tmpfilename, filename, err);
+        async = fileoptions.get_int("async", ot.async_output) && !deep;
+        if (async) {
+            // Later commands may alter the image in place, so unless the
+            // automatic transformations above made a fresh image that
+            // nothing else refers to, the background write needs its own
+            // copy of the pixels.
+            ot.curimg = saveimg;
+            if (ir.use_count() > 1)
+                ir.reset(new ImageRec(*ir, -1, -1, true /*writable*/));
+            std::shared_ptr<ImageOutput> sharedout(std::move(out));
+            std::string cmd(command), fname(filename);
+            bool adjust_time = ot.output_adjust_time;
+            ot.write_in_background(filename, [=]() {
+                bool ok = write_output_file(cmd, fname, sharedout.get(), *ir,
+                                            subimagespecs, levelspecs,
+                                            procedural);
+                ot.imagecache->invalidate(ustring(fname), true);
+                if (adjust_time && ok)
+                    Filesystem::last_write_time(fname, in_time);
+            });
+        } else {
+            ok = write_output_file(command, filename, out.get(), *ir,
+                                   subimagespecs, levelspecs, procedural);
+            out.reset();  // make extra sure it's cleaned up
         }
-        if (!ok)
-            Filesystem::remove(tmpfilename);
     }
 
-    // Make sure to invalidate any IC entries that think they are the
-    // file we just wrote.
-    ot.imagecache->invalidate(ustring(filename), true);
+    if (!async) {
+        // Make sure to invalidate any IC entries that think they are the
+        // file we just wrote.
+        ot.imagecache->invalidate(ustring(filename), true);
 
-    if (ot.output_adjust_time && ok) {
-        std::string metadatatime = ir->spec(0, 0)->get_string_attribute(
-            "DateTime");
-        std::time_t in_time = ir->time();
-        if (!metadatatime.empty())
-            DateTime_to_time_t(metadatatime.c_str(), in_time);
-        Filesystem::last_write_time(filename, in_time);
+        if (ot.output_adjust_time && ok)
+            Filesystem::last_write_time(filename, in_time);
     }
 
     ot.check_peak_memory();
@@ -5586,6 +5819,10 @@ getargs(int argc, char* argv[])
       .action(set_autotile);
     ap.arg("--metamerge", &ot.metamerge)
       .help("Always merge metadata of all inputs into output");
+    ap.arg("--parallel-subimages", &ot.parallel_subimages)
+      .help("Process the subimages and MIP levels of an image concurrently (with -a)");
+    ap.arg("--async-output", &ot.async_output)
+      .help("Write output files in the background while later commands run");
     ap.arg("--crash")
       .hidden()
       .action(crash_me);
@@ -5601,8 +5838,9 @@ getargs(int argc, char* argv[])
     ap.separator("Commands that write images:");
     ap.arg("-o %s:FILENAME")
       .help("Output the current image to the named file (options: "
-            "all=, autocc=, autocrop=, autotrim=, bits=, contig=, datatype=, "
-            "dither=, fileformatname=, scanline=, separate=, tile=, unpremult=)")
+            "all=, async=, autocc=, autocrop=, autotrim=, bits=, contig=, "
+            "datatype=, dither=, fileformatname=, scanline=, separate=, "
+            "tile=, unpremult=)")
       .action(output_file);
     ap.arg("-otex %s:FILENAME")
       .help("Output the current image as a texture")
@@ -6220,6 +6458,7 @@ handle_sequence(int argc, const char** argv)
         ot.clear_options();  // Careful to reset all command line options!
         ot.frame_number = frame_numbers[0][i];
         getargs(argc, (char**)&seq_argv[0]);
+        ot.wait_for_outputs();
 
         if (ap.aborted()) {
             if (!ot.skip_bad_frames)
@@ -6313,6 +6552,7 @@ main(int argc, char* argv[])
                            "pending command never executed");
         }
     }
+    ot.wait_for_outputs();
 
     if (!ot.printinfo && !ot.printstats && !ot.dumpdata && !ot.dryrun
         && !ot.printed_info && !ap.aborted()) {
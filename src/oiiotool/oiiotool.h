@@ -5,13 +5,16 @@
 
 #pragma once
 
+#include <deque>
 #include <functional>
+#include <future>
 #include <memory>
 
 #include <boost/container/flat_set.hpp>
 
 #include <OpenImageIO/color.h>
 #include <OpenImageIO/imagebuf.h>
+#include <OpenImageIO/parallel.h>
 #include <OpenImageIO/sysutil.h>
 #include <OpenImageIO/timer.h>
 
@@ -61,7 +64,9 @@ public:
     bool autopremult;              // auto premult unassociated alpha input
     bool nativeread;               // force native data type reads
     bool printinfo_verbose;
-    bool metamerge;  // Merge source input metadata into output
+    bool metamerge;           // Merge source input metadata into output
+    bool parallel_subimages;  // Run ops on subimages/MIPs concurrently
+    bool async_output;        // Write outputs in the background
     int cachesize;
     int autotile;
     int frame_padding;
@@ -234,6 +239,46 @@ public:
     void error(string_view command, string_view message = "") const;
     void warning(string_view command, string_view message = "") const;
 
+    // While a MessageCapture is alive, any error() or warning() issued by
+    // the thread that created it is saved rather than reported. Calling
+    // replay() later reports them, in their original order. This lets
+    // work that runs concurrently report its problems in a predictable
+    // order. Calling stop() (from the same thread) ends the capture early
+    // but keeps the messages for replay().
+    class MessageCapture {
+    public:
+        MessageCapture();
+        ~MessageCapture();
+        MessageCapture(const MessageCapture&) = delete;
+        const MessageCapture& operator=(const MessageCapture&) = delete;
+        void stop();
+        void replay(const Oiiotool& ot) const;
+
+    private:
+        friend class Oiiotool;
+        struct Message {
+            bool error;
+            std::string command, text;
+        };
+        std::vector<Message> m_messages;
+        MessageCapture* m_prev;
+    };
+
+    // Call write() in the background to write filename (for -o with
+    // --async-output). Any errors or warnings it issues are held until
+    // the write is waited for. write() must not touch any oiiotool state
+    // other than to report errors and warnings.
+    void write_in_background(string_view filename,
+                             std::function<void()> write);
+
+    // Wait for background writes to finish, and report their errors and
+    // warnings in the order that the writes were started. If filename is
+    // not empty, only wait as far as the last pending write of that file.
+    void wait_for_outputs(string_view filename = "");
+
+    // Wait for the oldest n background writes, reporting their messages.
+    void wait_for_pending(size_t n);
+
     // Formatted errors with printf-like notation
     template<typename... Args>
     void errorf(string_view command, const char* fmt, const Args&... args) const
@@ -285,6 +330,12 @@ private:
     int m_pending_argc;
     const char* m_pending_argv[4];
 
+    struct PendingOutput {
+        std::string path;  // Filesystem::canonical_path of the output
+        std::future<std::shared_ptr<MessageCapture>> done;
+    };
+    std::deque<PendingOutput> m_pending_outputs;
+
     void express_error(const string_view expr, const string_view s,
                        string_view explanation);
 
@@ -765,6 +816,13 @@ public:
 
     virtual void traverse_subimages(int subimages)
     {
+        if (parallel_subimages()
+            && options().get_int("parallel", ot.parallel_subimages)
+            && (subimages > 1 || ir(0)->miplevels() > 1)) {
+            traverse_subimages_parallel(subimages);
+            return;
+        }
+
         // For each subimage, find the ImageBuf's for input and output
         // images, and call impl().
         for (int s = 0; s < subimages; ++s) {
@@ -801,6 +859,80 @@ public:
         }
     }
 
+    // Like traverse_subimages, but calling impl() for many subimages and
+    // MIP levels at once. Those big enough to keep all the threads busy by
+    // themselves are still done one at a time (so that the IBA functions
+    // called by impl() can use the whole pool), and then all the small
+    // ones run concurrently, each on a single thread. Errors and warnings
+    // are held back and reported in subimage order afterwards, and each
+    // result only merges the metadata of its own inputs, so the outcome
+    // doesn't depend on the order in which things finish. An input with
+    // fewer subimages or MIP levels than the output is shared by several
+    // parts, so the inputs' errors are only collected on this thread once
+    // they are all done.
+    void traverse_subimages_parallel(int subimages)
+    {
+        struct Part {
+            int s, m;
+            std::vector<ImageBuf*> img;
+            std::unique_ptr<Oiiotool::MessageCapture> messages;
+        };
+        std::vector<Part> parts;
+        for (int s = 0; s < subimages; ++s) {
+            for (int m = 0, nmip = ir(0)->miplevels(); m < nmip; ++m) {
+                Part part { s, m, std::vector<ImageBuf*>(nimages()), nullptr };
+                for (int i = 0; i < nimages(); ++i)
+                    part.img[i] = &(
+                        (*ir(i))(std::min(s, ir(i)->subimages() - 1),
+                                 std::min(m, ir(i)->miplevels(s))));
+                parts.push_back(std::move(part));
+            }
+        }
+
+        auto run = [&](Part& part) {
+            part.messages.reset(new Oiiotool::MessageCapture);
+            if (subimage_is_active(part.s)) {
+                if (!impl(part.img))
+                    ot.errorf(opname(), "%s", part.img[0]->geterror());
+                if (ot.metamerge)
+                    for (int i = 1; i < nimages(); ++i)
+                        part.img[0]->specmod().extra_attribs.merge(
+                            part.img[i]->spec().extra_attribs);
+            } else if (nimages() >= 2) {
+                part.img[0]->copy(*part.img[1]);
+            }
+            // Only the output belongs to this part alone
+            if (part.img[0]->has_error())
+                ot.errorf(opname(), "%s", part.img[0]->geterror());
+            part.messages->stop();
+        };
+
+        // Size each part by its first input (the output may not have been
+        // allocated yet).
+        parallel_options opt;
+        opt.resolve();
+        imagesize_t big = imagesize_t(opt.minitems) * opt.maxthreads;
+        std::vector<Part*> small;
+        for (auto& part : parts) {
+            const ImageBuf* sized = part.img[nimages() > 1 ? 1 : 0];
+            if (sized->spec().image_pixels() >= big)
+                run(part);
+            else
+                small.push_back(&part);
+        }
+        parallel_for(0, int64_t(small.size()),
+                     [&](int64_t i) { run(*small[i]); });
+
+        for (auto& part : parts) {
+            m_ir[0]->update_spec_from_imagebuf(part.s, part.m);
+            part.messages->replay(ot);
+            // Make sure to forward any errors missed by the impl
+            for (int i = 1; i < nimages(); ++i)
+                if (part.img[i]->has_error())
+                    ot.errorf(opname(), "%s", part.img[i]->geterror());
+        }
+    }
+
     // THIS is the method that needs to be separately overloaded for each
     // different op. This is called once for each subimage, generally with
     // img[0] the destination ImageBuf, and img[1..] as the inputs. It's
@@ -956,6 +1088,12 @@ public:
     void skip_impl(bool val) { m_skip_impl = val; }
     bool skip_impl() const { return m_skip_impl; }
 
+    // Call parallel_subimages(false) if impl() must not run for several
+    // subimages/MIP levels at once (for example, because it modifies
+    // state in ot).
+    void parallel_subimages(bool val) { m_parallel_subimages = val; }
+    bool parallel_subimages() const { return m_parallel_subimages; }
+
 protected:
     Oiiotool& ot;
     std::string m_opname;
@@ -963,6 +1101,7 @@ protected:
     int m_nimages;
     bool m_preserve_miplevels = false;
     bool m_skip_impl          = false;
+    bool m_parallel_subimages = true;
     std::vector<ImageRecRef> m_ir;
     std::vector<ImageBuf*> m_img;
     std::vector<string_view> m_args;
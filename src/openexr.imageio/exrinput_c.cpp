@@ -117,6 +117,75 @@ oiio_exr_read_func(exr_const_context_t ctxt, void* userdata, void* buffer,
     return nread;
 }
 
+// The raw chunks for one multi-chunk read, fetched up front with a single
+// IOProxy::pread_batch() -- which an IOUringFile issues all at once,
+// instead of the decoder's one blocking read per chunk -- and then handed
+// to the decoder in place of its own reads. Only worth the extra copy of
+// the compressed data when the reads really do overlap.
+class ExrChunkPrefetch {
+public:
+    // Fetch the chunks' data. If there's no point (reads that wouldn't
+    // overlap, a single chunk, or too much data) or it fails, return false
+    // and leave the decoder to read the chunks itself.
+    bool fetch(Filesystem::IOProxy* io,
+               const std::vector<exr_chunk_info_t>& chunks)
+    {
+        auto uring = dynamic_cast<Filesystem::IOUringFile*>(io);
+        if (!uring || !uring->async() || chunks.size() < 2)
+            return false;
+        const uint64_t max_bytes = uint64_t(256) << 20;
+        uint64_t total           = 0;
+        for (auto& c : chunks)
+            total += c.packed_size;
+        if (total > max_bytes)
+            return false;
+        m_data.resize(size_t(total));
+        std::vector<Filesystem::IOProxy::ReadRequest> requests(chunks.size());
+        size_t pos = 0;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            requests[i].buf                 = m_data.data() + pos;
+            requests[i].size                = size_t(chunks[i].packed_size);
+            requests[i].offset              = int64_t(chunks[i].data_offset);
+            m_offsets[chunks[i].data_offset] = pos;
+            pos += requests[i].size;
+        }
+        if (!io->pread_batch(requests)) {
+            m_offsets.clear();
+            return false;
+        }
+        return true;
+    }
+
+    // Make the decoder take chunks from us. This must be done after
+    // exr_decoding_choose_default_routines(), which sets the read routine.
+    void install(exr_decode_pipeline_t& decoder)
+    {
+        if (m_offsets.size()) {
+            decoder.decoding_user_data = this;
+            decoder.read_fn            = &read_chunk;
+        }
+    }
+
+private:
+    static exr_result_t read_chunk(exr_decode_pipeline_t* decode)
+    {
+        auto self  = static_cast<ExrChunkPrefetch*>(decode->decoding_user_data);
+        auto found = self->m_offsets.find(decode->chunk.data_offset);
+        if (found == self->m_offsets.end())
+            return EXR_ERR_READ_IO;
+        // A zero allocation size tells the library the buffer isn't
+        // its own to free.
+        decode->packed_buffer     = self->m_data.data() + found->second;
+        decode->packed_alloc_size = 0;
+        return EXR_ERR_SUCCESS;
+    }
+
+    std::vector<uint8_t> m_data;
+    std::map<uint64_t, size_t> m_offsets;  // file offset -> index in m_data
+};
+
+
+
 class OpenEXRInput final : public ImageInput {
 public:
     OpenEXRInput();
@@ -425,8 +494,11 @@ OpenEXRInput::open(const std::string& name, ImageSpec& newspec,
     // Establish an input stream. If we weren't given an IOProxy, create one
     // now that just reads from the file.
     if (!m_userdata.m_io) {
-        m_userdata.m_io = new Filesystem::IOFile(name,
-                                                 Filesystem::IOProxy::Read);
+        if (OIIO::get_int_attribute("io_uring"))
+            m_userdata.m_io = new Filesystem::IOUringFile(name);
+        else
+            m_userdata.m_io = new Filesystem::IOFile(name,
+                                                     Filesystem::IOProxy::Read);
         m_local_io.reset(m_userdata.m_io);
     }
     if (m_userdata.m_io->mode() != Filesystem::IOProxy::Read) {
@@ -1242,10 +1314,28 @@ OpenEXRInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 #endif
     int endy = spec.y + spec.height;
     yend     = std::min(endy, yend);
+
+    // Look up all the chunks first, so their data can be fetched with one
+    // batch of reads.
+    std::vector<exr_chunk_info_t> chunks;
+    for (int y = ybegin - (ybegin - spec.y) % scansperchunk; y < yend;
+         y += scansperchunk) {
+        chunks.emplace_back();
+        if (exr_read_scanline_chunk_info(m_exr_context, subimage, y,
+                                         &chunks.back())
+            != EXR_ERR_SUCCESS) {
+            chunks.pop_back();
+            break;
+        }
+    }
+    ExrChunkPrefetch prefetch;
+    prefetch.fetch(m_userdata.m_io, chunks);
+
     std::vector<uint8_t> fullchunk;
-    bool first = true;
-    int nlines = scansperchunk;
-    for (int y = ybegin; y < yend; y += nlines) {
+    bool first        = true;
+    int nlines        = scansperchunk;
+    size_t chunkindex = 0;
+    for (int y = ybegin; y < yend; y += nlines, ++chunkindex) {
         uint8_t* cdata = linedata;
         // handle scenario where caller asked us to read a scanline
         // that isn't aligned to a chunk boundary
@@ -1262,7 +1352,11 @@ OpenEXRInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
         } else
             nlines = scansperchunk;
 
-        rv = exr_read_scanline_chunk_info(m_exr_context, subimage, y, &cinfo);
+        if (chunkindex < chunks.size())
+            cinfo = chunks[chunkindex];
+        else
+            rv = exr_read_scanline_chunk_info(m_exr_context, subimage, y,
+                                              &cinfo);
         if (rv != EXR_ERR_SUCCESS)
             break;
         if (first) {
@@ -1305,6 +1399,7 @@ OpenEXRInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
             if (rv != EXR_ERR_SUCCESS)
                 break;
         }
+        prefetch.install(decoder);
         rv = exr_decoding_run(m_exr_context, subimage, &decoder);
         if (rv != EXR_ERR_SUCCESS)
             break;
@@ -1505,6 +1600,24 @@ OpenEXRInput::read_native_tiles(int subimage, int miplevel, int xbegin,
 
 #endif
 
+    // Look up all the tiles' chunks first, so their data can be fetched
+    // with one batch of reads.
+    std::vector<exr_chunk_info_t> tilechunks(size_t(nxtiles) * nytiles);
+    std::vector<exr_result_t> tileresults(tilechunks.size());
+    std::vector<exr_chunk_info_t> found_chunks;
+    for (int ty = 0, i = 0; ty < nytiles; ++ty)
+        for (int tx = 0; tx < nxtiles; ++tx, ++i) {
+            tileresults[i] = exr_read_tile_chunk_info(m_exr_context, subimage,
+                                                      firstxtile + tx,
+                                                      firstytile + ty,
+                                                      miplevel, miplevel,
+                                                      &tilechunks[i]);
+            if (tileresults[i] == EXR_ERR_SUCCESS)
+                found_chunks.push_back(tilechunks[i]);
+        }
+    ExrChunkPrefetch prefetch;
+    prefetch.fetch(m_userdata.m_io, found_chunks);
+
     exr_chunk_info_t cinfo;
     exr_decode_pipeline_t decoder = EXR_DECODE_PIPELINE_INITIALIZER;
     bool first                    = true;
@@ -1517,8 +1630,8 @@ OpenEXRInput::read_native_tiles(int subimage, int miplevel, int xbegin,
         tilesetdata += ty * tileh * scanlinebytes;
         for (int tx = 0; tx < nxtiles; ++tx, ++curxtile) {
             uint8_t* curtilestart = tilesetdata + tx * tilew * pixelbytes;
-            rv = exr_read_tile_chunk_info(m_exr_context, subimage, curxtile,
-                                          curytile, miplevel, miplevel, &cinfo);
+            rv    = tileresults[ty * nxtiles + tx];
+            cinfo = tilechunks[ty * nxtiles + tx];
             if (rv != EXR_ERR_SUCCESS) {
                 retval &= check_fill_missing(xbegin + tx * tilew,
                                              xbegin + (tx + 1) * tilew,
@@ -1589,7 +1702,8 @@ OpenEXRInput::read_native_tiles(int subimage, int miplevel, int xbegin,
                 }
             }
             first = false;
-            rv    = exr_decoding_run(m_exr_context, subimage, &decoder);
+            prefetch.install(decoder);
+            rv = exr_decoding_run(m_exr_context, subimage, &decoder);
             if (rv != EXR_ERR_SUCCESS) {
                 retval &= check_fill_missing(xbegin + tx * tilew,
                                              xbegin + (tx + 1) * tilew,
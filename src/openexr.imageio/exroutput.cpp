@@ -8,6 +8,7 @@
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <memory>
 
@@ -18,6 +19,10 @@
 #include <OpenEXR/ImfOutputFile.h>
 #include <OpenEXR/ImfTiledOutputFile.h>
 
+#ifdef OIIO_USE_EXR_C_API
+#    include <OpenEXR/openexr.h>
+#endif
+
 #ifdef OPENEXR_VERSION_MAJOR
 #    define OPENEXR_CODED_VERSION                                    \
         (OPENEXR_VERSION_MAJOR * 10000 + OPENEXR_VERSION_MINOR * 100 \
@@ -74,6 +79,7 @@ OIIO_PRAGMA_VISIBILITY_POP
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/fmath.h>
 #include <OpenImageIO/imageio.h>
+#include <OpenImageIO/parallel.h>
 #include <OpenImageIO/strutil.h>
 #include <OpenImageIO/sysutil.h>
 #include <OpenImageIO/thread.h>
@@ -118,6 +124,16 @@ private:
 
 
 
+#ifdef OIIO_USE_EXR_C_API
+// What the Core library's I/O and error callbacks need to know.
+struct ExrCoreWriteData {
+    ImageOutput* m_img        = nullptr;
+    Filesystem::IOProxy* m_io = nullptr;
+};
+#endif
+
+
+
 class OpenEXROutput final : public ImageOutput {
 public:
     OpenEXROutput();
@@ -177,6 +193,19 @@ private:
     std::vector<Imf::Header> m_headers;
     Filesystem::IOProxy* m_io = nullptr;
     std::unique_ptr<Filesystem::IOProxy> m_local_io;
+#ifdef OIIO_USE_EXR_C_API
+    // When writing through the OpenEXR Core library, chunks are packed
+    // and compressed in parallel on our own thread pool, straight from
+    // the caller's buffer, instead of through an Imf::FrameBuffer.
+    exr_context_t m_exr_context = nullptr;  ///< Core context, if using it
+    ExrCoreWriteData m_core_data;
+    std::vector<unsigned char> m_core_lines;  ///< Partial scanline chunk
+    int m_core_lines_y    = 0;  ///< First scanline of the partial chunk
+    int m_core_nlines     = 0;  ///< Scanlines held in m_core_lines
+    int m_core_next_chunk = 0;  ///< Index of the next chunk to write
+    /// Compressed chunks that arrived before their turn, by chunk index
+    std::map<int, std::pair<Imath::V2i, std::vector<uint8_t>>> m_core_pending;
+#endif
 
     // Initialize private members to pre-opened state
     void init(void)
@@ -197,6 +226,15 @@ private:
         m_headers.shrink_to_fit();
         m_io = nullptr;
         m_local_io.reset();
+#ifdef OIIO_USE_EXR_C_API
+        if (m_exr_context)
+            exr_finish(&m_exr_context);
+        m_exr_context = nullptr;
+        m_core_lines.clear();
+        m_core_lines.shrink_to_fit();
+        m_core_nlines = 0;
+        m_core_pending.clear();
+#endif
     }
 
     // Set up the header based on the given spec.  Also may doctor the
@@ -217,6 +255,40 @@ private:
     // Helper: if the channel names are nonsensical, fix them to keep the
     // app from shooting itself in the foot.
     void sanity_check_channelnames();
+
+#ifdef OIIO_USE_EXR_C_API
+    // Should we write m_headers through the Core library?
+    bool use_core() const;
+
+    // Create the file and write all of m_headers through the Core library.
+    bool open_core(const std::string& name);
+
+    // Pack, compress, and write the given chunks through the Core library.
+    // Each chunk is a tile index (for tiled files) or the first scanline
+    // of a chunk (in .y, for scanline files). The pixels come from `base`,
+    // which holds pixel (xorigin, yorigin) with the given strides and
+    // channel data types, which must be half, float, or uint.
+    bool core_write_chunks(const std::vector<Imath::V2i>& chunks,
+                           const char* base, int xorigin, int yorigin,
+                           stride_t xstride, stride_t ystride,
+                           cspan<TypeDesc> chantypes);
+
+    // Write one compressed chunk, and any held chunks that can now follow.
+    exr_result_t core_write_chunk(const Imath::V2i& chunk, const void* data,
+                                  uint64_t size);
+    exr_result_t core_write_pending();
+    // Check that nothing is left staged or held for the current part,
+    // which would mean some of its chunks were never supplied.
+    bool core_check_complete();
+
+    bool core_write_scanlines(int ybegin, int yend, int z, TypeDesc format,
+                              const void* data, stride_t xstride,
+                              stride_t ystride);
+    bool core_write_tiles(int xbegin, int xend, int ybegin, int yend,
+                          int zbegin, int zend, TypeDesc format,
+                          const void* data, stride_t xstride, stride_t ystride,
+                          stride_t zstride);
+#endif
 };
 
 
@@ -299,6 +371,10 @@ OpenEXROutput::~OpenEXROutput()
     m_deep_tiled_output_part.reset();
     m_output_multipart.reset();
     m_output_stream.reset();
+#ifdef OIIO_USE_EXR_C_API
+    if (m_exr_context)
+        exr_finish(&m_exr_context);
+#endif
 }
 
 
@@ -372,6 +448,10 @@ OpenEXROutput::open(const std::string& name, const ImageSpec& userspec,
 
         if (!spec_to_header(m_spec, m_subimage, m_headers[m_subimage]))
             return false;
+#ifdef OIIO_USE_EXR_C_API
+        if (use_core())
+            return open_core(name);
+#endif
 
         try {
             if (!m_io) {
@@ -419,7 +499,11 @@ OpenEXROutput::open(const std::string& name, const ImageSpec& userspec,
     if (mode == AppendSubimage) {
         // OpenEXR 2.x supports subimages, but we only allow it to use the
         // open(name,subimages,specs[]) variety.
-        if (m_subimagespecs.size() == 0 || !m_output_multipart) {
+        bool core = false;
+#ifdef OIIO_USE_EXR_C_API
+        core = (m_exr_context != nullptr);
+#endif
+        if (m_subimagespecs.size() == 0 || !(m_output_multipart || core)) {
             errorf("%s not opened properly for subimages", format_name());
             return false;
         }
@@ -429,6 +513,22 @@ OpenEXROutput::open(const std::string& name, const ImageSpec& userspec,
             errorf("More subimages than originally declared.");
             return false;
         }
+#ifdef OIIO_USE_EXR_C_API
+        if (core) {
+            if (!core_check_complete())
+                return false;
+            // All the part headers were written when the file was opened
+            m_spec = m_subimagespecs[m_subimage];
+            sanity_check_channelnames();
+            compute_pixeltypes(m_spec);
+            m_miplevel        = 0;
+            m_core_lines_y    = m_spec.y;
+            m_core_nlines     = 0;
+            m_core_next_chunk = 0;
+            m_core_pending.clear();
+            return true;
+        }
+#endif
         // Close the current subimage, open the next one
         try {
             if (m_tiled_output_part) {
@@ -472,7 +572,11 @@ OpenEXROutput::open(const std::string& name, const ImageSpec& userspec,
     }
 
     if (mode == AppendMIPLevel) {
-        if (!m_output_scanline && !m_output_tiled) {
+        bool core = false;
+#ifdef OIIO_USE_EXR_C_API
+        core = (m_exr_context != nullptr && m_nsubimages == 1);
+#endif
+        if (!m_output_scanline && !m_output_tiled && !core) {
             errorf("Cannot append a MIP level if no file has been opened");
             return false;
         }
@@ -551,6 +655,10 @@ OpenEXROutput::open(const std::string& name, int subimages,
     m_spec = m_subimagespecs[0];
     sanity_check_channelnames();
     compute_pixeltypes(m_spec);
+#ifdef OIIO_USE_EXR_C_API
+    if (!deep && use_core())
+        return open_core(name);
+#endif
 
     // Create an ImfMultiPartOutputFile
     try {
@@ -871,7 +979,8 @@ static ExrMeta exr_meta_translation[] = {
     // user or from a file we read.
     ExrMeta("YResolution"), ExrMeta("planarconfig"), ExrMeta("type"),
     ExrMeta("tiles"), ExrMeta("version"), ExrMeta("chunkCount"),
-    ExrMeta("maxSamplesPerPixel"), ExrMeta("openexr:roundingmode")
+    ExrMeta("maxSamplesPerPixel"), ExrMeta("openexr:roundingmode"),
+    ExrMeta("openexr:core")
 };
 
 
@@ -1316,8 +1425,24 @@ OpenEXROutput::close()
     m_output_multipart.reset();
     m_output_stream.reset();
 
+#ifdef OIIO_USE_EXR_C_API
+    if (m_exr_context) {
+        bool complete = core_check_complete();
+        // Writes the chunk offset tables
+        exr_result_t rv = exr_finish(&m_exr_context);
+        m_exr_context   = nullptr;
+        if (rv != EXR_ERR_SUCCESS || !complete) {
+            if (!has_error())
+                errorf("Failed OpenEXR write: %s",
+                       exr_get_error_code_as_string(rv));
+            init();
+            return false;
+        }
+    }
+#endif
+
     init();       // re-initialize
-    return true;  // How can we fail?
+    return true;
 }
 
 
@@ -1326,6 +1451,11 @@ bool
 OpenEXROutput::write_scanline(int y, int /*z*/, TypeDesc format,
                               const void* data, stride_t xstride)
 {
+#ifdef OIIO_USE_EXR_C_API
+    if (m_exr_context)
+        return core_write_scanlines(y, y + 1, 0, format, data, xstride,
+                                    AutoStride);
+#endif
     if (!(m_output_scanline || m_scanline_output_part)) {
         errorf("called OpenEXROutput::write_scanline without an open file");
         return false;
@@ -1386,6 +1516,11 @@ OpenEXROutput::write_scanlines(int ybegin, int yend, int z, TypeDesc format,
                                const void* data, stride_t xstride,
                                stride_t ystride)
 {
+#ifdef OIIO_USE_EXR_C_API
+    if (m_exr_context)
+        return core_write_scanlines(ybegin, yend, z, format, data, xstride,
+                                    ystride);
+#endif
     if (!(m_output_scanline || m_scanline_output_part)) {
         errorf("called OpenEXROutput::write_scanlines without an open file");
         return false;
@@ -1490,6 +1625,11 @@ OpenEXROutput::write_tiles(int xbegin, int xend, int ybegin, int yend,
 {
     //    std::cerr << "exr::write_tiles " << xbegin << ' ' << xend
     //              << ' ' << ybegin << ' ' << yend << "\n";
+#ifdef OIIO_USE_EXR_C_API
+    if (m_exr_context)
+        return core_write_tiles(xbegin, xend, ybegin, yend, zbegin, zend,
+                                format, data, xstride, ystride, zstride);
+#endif
     if (!(m_output_tiled || m_tiled_output_part)) {
         errorf("called OpenEXROutput::write_tiles without an open file");
         return false;
@@ -1703,4 +1843,666 @@ OpenEXROutput::write_deep_tiles(int xbegin, int xend, int ybegin, int yend,
 }
 
 
+
+#ifdef OIIO_USE_EXR_C_API
+
+static int64_t
+oiio_exr_write_func(exr_const_context_t ctxt, void* userdata, const void* buf,
+                    uint64_t sz, uint64_t offset,
+                    exr_stream_error_func_ptr_t error_cb)
+{
+    ExrCoreWriteData* data = static_cast<ExrCoreWriteData*>(userdata);
+    size_t nwritten        = data->m_io->pwrite(buf, sz, offset);
+    if (nwritten != sz) {
+        error_cb(ctxt, EXR_ERR_WRITE_IO, "Could not write %llu bytes: %s",
+                 (unsigned long long)sz, data->m_io->error().c_str());
+        return -1;
+    }
+    return int64_t(nwritten);
+}
+
+
+
+static void
+oiio_exr_write_error_handler(exr_const_context_t ctxt, exr_result_t code,
+                             const char* msg)
+{
+    void* userdata = nullptr;
+    exr_get_user_data(ctxt, &userdata);
+    ExrCoreWriteData* data = static_cast<ExrCoreWriteData*>(userdata);
+    if (data && data->m_img) {
+        data->m_img->errorf("EXR Error (%s): %s %s",
+                            data->m_io ? data->m_io->filename().c_str()
+                                       : "<unknown>",
+                            exr_get_error_code_as_string(code),
+                            msg ? msg : exr_get_default_error_message(code));
+    }
+}
+
+
+
+// Attributes that open_core() sets up explicitly, or that the Core library
+// computes itself, rather than copying them from the Imf::Header.
+static const char* core_handled_attribs[] = {
+    "channels",          "compression",         "dataWindow",
+    "displayWindow",     "lineOrder",           "pixelAspectRatio",
+    "screenWindowCenter", "screenWindowWidth",  "tiles",
+    "type",              "name",                "version",
+    "chunkCount",        "dwaCompressionLevel", nullptr
+};
+
+
+
+// Copy one Imf::Attribute into part `part` of the Core context. If ctxt
+// is null, just return whether we know how to translate the attribute's
+// type. We go by the type name rather than dynamic_cast, so that this
+// doesn't depend on the RTTI visibility games the Imf headers play.
+static bool
+core_set_attribute(exr_context_t ctxt, int part, const char* name,
+                   const Imf::Attribute& attr, exr_result_t& rv)
+{
+    string_view type = attr.typeName();
+    rv               = EXR_ERR_SUCCESS;
+#    define CORE_ATTR(typname, attrtype, set)                            \
+        if (type == typname) {                                           \
+            if (ctxt) {                                                  \
+                const auto& v = static_cast<const attrtype&>(attr).value(); \
+                set;                                                     \
+            }                                                            \
+            return true;                                                 \
+        }
+#    define CORE_ATTR_RAW(typname, attrtype, coretype, setfunc)          \
+        CORE_ATTR(typname, attrtype, {                                   \
+            coretype c;                                                  \
+            static_assert(sizeof(c) == sizeof(v), "mismatched layout");  \
+            memcpy(&c, &v, sizeof(c));                                   \
+            rv = setfunc(ctxt, part, name, &c);                          \
+        })
+    CORE_ATTR("string", Imf::StringAttribute,
+              rv = exr_attr_set_string(ctxt, part, name, v.c_str()))
+    CORE_ATTR("int", Imf::IntAttribute,
+              rv = exr_attr_set_int(ctxt, part, name, v))
+    CORE_ATTR("float", Imf::FloatAttribute,
+              rv = exr_attr_set_float(ctxt, part, name, v))
+    CORE_ATTR("double", Imf::DoubleAttribute,
+              rv = exr_attr_set_double(ctxt, part, name, v))
+    CORE_ATTR_RAW("m33f", Imf::M33fAttribute, exr_attr_m33f_t,
+                  exr_attr_set_m33f)
+    CORE_ATTR_RAW("m33d", Imf::M33dAttribute, exr_attr_m33d_t,
+                  exr_attr_set_m33d)
+    CORE_ATTR_RAW("m44f", Imf::M44fAttribute, exr_attr_m44f_t,
+                  exr_attr_set_m44f)
+    CORE_ATTR_RAW("m44d", Imf::M44dAttribute, exr_attr_m44d_t,
+                  exr_attr_set_m44d)
+    CORE_ATTR_RAW("v2i", Imf::V2iAttribute, exr_attr_v2i_t, exr_attr_set_v2i)
+    CORE_ATTR_RAW("v2f", Imf::V2fAttribute, exr_attr_v2f_t, exr_attr_set_v2f)
+    CORE_ATTR_RAW("v2d", Imf::V2dAttribute, exr_attr_v2d_t, exr_attr_set_v2d)
+    CORE_ATTR_RAW("v3i", Imf::V3iAttribute, exr_attr_v3i_t, exr_attr_set_v3i)
+    CORE_ATTR_RAW("v3f", Imf::V3fAttribute, exr_attr_v3f_t, exr_attr_set_v3f)
+    CORE_ATTR_RAW("v3d", Imf::V3dAttribute, exr_attr_v3d_t, exr_attr_set_v3d)
+    CORE_ATTR_RAW("box2i", Imf::Box2iAttribute, exr_attr_box2i_t,
+                  exr_attr_set_box2i)
+    CORE_ATTR_RAW("box2f", Imf::Box2fAttribute, exr_attr_box2f_t,
+                  exr_attr_set_box2f)
+    CORE_ATTR("stringvector", Imf::StringVectorAttribute, {
+        std::vector<const char*> strs;
+        for (auto& s : v)
+            strs.push_back(s.c_str());
+        rv = exr_attr_set_string_vector(ctxt, part, name, int32_t(strs.size()),
+                                        strs.data());
+    })
+#    if OPENEXR_HAS_FLOATVECTOR
+    CORE_ATTR("floatvector", Imf::FloatVectorAttribute,
+              rv = exr_attr_set_float_vector(ctxt, part, name,
+                                             int32_t(v.size()), v.data()))
+#    endif
+    CORE_ATTR("rational", Imf::RationalAttribute, {
+        exr_attr_rational_t r;
+        r.num   = v.n;
+        r.denom = v.d;
+        rv      = exr_attr_set_rational(ctxt, part, name, &r);
+    })
+    CORE_ATTR("timecode", Imf::TimeCodeAttribute, {
+        exr_attr_timecode_t tc;
+        tc.time_and_flags = v.timeAndFlags();
+        tc.user_data      = v.userData();
+        rv                = exr_attr_set_timecode(ctxt, part, name, &tc);
+    })
+    CORE_ATTR("keycode", Imf::KeyCodeAttribute, {
+        exr_attr_keycode_t kc;
+        kc.film_mfc_code   = v.filmMfcCode();
+        kc.film_type       = v.filmType();
+        kc.prefix          = v.prefix();
+        kc.count           = v.count();
+        kc.perf_offset     = v.perfOffset();
+        kc.perfs_per_frame = v.perfsPerFrame();
+        kc.perfs_per_count = v.perfsPerCount();
+        rv                 = exr_attr_set_keycode(ctxt, part, name, &kc);
+    })
+    CORE_ATTR("chromaticities", Imf::ChromaticitiesAttribute, {
+        exr_attr_chromaticities_t c;
+        c.red_x   = v.red.x;
+        c.red_y   = v.red.y;
+        c.green_x = v.green.x;
+        c.green_y = v.green.y;
+        c.blue_x  = v.blue.x;
+        c.blue_y  = v.blue.y;
+        c.white_x = v.white.x;
+        c.white_y = v.white.y;
+        rv        = exr_attr_set_chromaticities(ctxt, part, name, &c);
+    })
+    CORE_ATTR("envmap", Imf::EnvmapAttribute,
+              rv = exr_attr_set_envmap(ctxt, part, name, exr_envmap_t(v)))
+#    undef CORE_ATTR_RAW
+#    undef CORE_ATTR
+    return false;
+}
+
+
+
+// Can the Core library take pixels of this type directly?
+static bool
+core_pixel_type(TypeDesc t, exr_pixel_type_t& pt)
+{
+    if (t == TypeDesc::HALF)
+        pt = EXR_PIXEL_HALF;
+    else if (t == TypeDesc::FLOAT)
+        pt = EXR_PIXEL_FLOAT;
+    else if (t == TypeDesc::UINT)
+        pt = EXR_PIXEL_UINT;
+    else
+        return false;
+    return true;
+}
+
+
+
+bool
+OpenEXROutput::use_core() const
+{
+    if (!m_spec.get_int_attribute("openexr:core", 1))
+        return false;
+    for (auto& h : m_headers) {
+        // We only write scanlines and tiles in order, and the Core library
+        // insists on getting chunks in the file's line order.
+        if (h.lineOrder() != Imf::INCREASING_Y)
+            return false;
+        for (auto a = h.begin(); a != h.end(); ++a) {
+            exr_result_t rv;
+            if (!core_set_attribute(nullptr, 0, a.name(), a.attribute(), rv))
+                return false;  // Unknown type, let the C++ library do it
+        }
+    }
+    return true;
+}
+
+
+
+bool
+OpenEXROutput::open_core(const std::string& name)
+{
+    if (!m_io) {
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Write);
+        m_local_io.reset(m_io);
+    }
+    if (m_io->mode() != Filesystem::IOProxy::Write) {
+        std::string e = m_io->error();
+        errorf("Could not open \"%s\" (%s)", name,
+               e.size() ? e : std::string("unknown error"));
+        return false;
+    }
+
+    m_core_data.m_img               = this;
+    m_core_data.m_io                = m_io;
+    exr_context_initializer_t cinit = EXR_DEFAULT_CONTEXT_INITIALIZER;
+    cinit.user_data                 = &m_core_data;
+    cinit.write_fn                  = oiio_exr_write_func;
+    cinit.error_handler_fn          = oiio_exr_write_error_handler;
+    exr_result_t rv = exr_start_write(&m_exr_context, name.c_str(),
+                                      EXR_WRITE_FILE_DIRECTLY, &cinit);
+    if (rv != EXR_ERR_SUCCESS) {
+        m_exr_context = nullptr;
+        return false;  // the error handler already reported it
+    }
+
+    for (auto& h : m_headers) {
+        bool tiled           = h.hasTileDescription();
+        const char* partname = h.hasName() ? h.name().c_str() : nullptr;
+        int part             = 0;
+        rv = exr_add_part(m_exr_context, partname,
+                          tiled ? EXR_STORAGE_TILED : EXR_STORAGE_SCANLINE,
+                          &part);
+        if (rv != EXR_ERR_SUCCESS)
+            return false;
+        // The Imf and Core enums have the same values, and Imath boxes and
+        // vectors have the same layout as the Core attribute structs.
+        exr_attr_box2i_t display, data;
+        exr_attr_v2f_t swcenter;
+        memcpy(&display, &h.displayWindow(), sizeof(display));
+        memcpy(&data, &h.dataWindow(), sizeof(data));
+        memcpy(&swcenter, &h.screenWindowCenter(), sizeof(swcenter));
+        rv = exr_initialize_required_attr(
+            m_exr_context, part, &display, &data, h.pixelAspectRatio(),
+            &swcenter, h.screenWindowWidth(), exr_lineorder_t(h.lineOrder()),
+            exr_compression_t(h.compression()));
+        for (auto c = h.channels().begin();
+             c != h.channels().end() && rv == EXR_ERR_SUCCESS; ++c) {
+            const Imf::Channel& chan = c.channel();
+            rv = exr_add_channel(m_exr_context, part, c.name(),
+                                 exr_pixel_type_t(chan.type),
+                                 chan.pLinear ? EXR_PERCEPTUALLY_LINEAR
+                                              : EXR_PERCEPTUALLY_LOGARITHMIC,
+                                 chan.xSampling, chan.ySampling);
+        }
+        if (tiled && rv == EXR_ERR_SUCCESS) {
+            const Imf::TileDescription& td = h.tileDescription();
+            rv = exr_set_tile_descriptor(
+                m_exr_context, part, td.xSize, td.ySize,
+                exr_tile_level_mode_t(td.mode),
+                exr_tile_round_mode_t(td.roundingMode));
+        }
+        if (auto dwa = h.findTypedAttribute<Imf::FloatAttribute>(
+                "dwaCompressionLevel"))
+            if (rv == EXR_ERR_SUCCESS)
+                rv = exr_set_dwa_compression_level(m_exr_context, part,
+                                                   dwa->value());
+        for (auto a = h.begin(); a != h.end() && rv == EXR_ERR_SUCCESS; ++a) {
+            bool handled = false;
+            for (int i = 0; core_handled_attribs[i] && !handled; ++i)
+                handled = !strcmp(a.name(), core_handled_attribs[i]);
+            if (!handled)
+                core_set_attribute(m_exr_context, part, a.name(),
+                                   a.attribute(), rv);
+        }
+        if (rv != EXR_ERR_SUCCESS)
+            return false;
+    }
+
+    rv = exr_write_header(m_exr_context);
+    if (rv != EXR_ERR_SUCCESS)
+        return false;
+    m_core_lines_y    = m_spec.y;
+    m_core_nlines     = 0;
+    m_core_next_chunk = 0;
+    return true;
+}
+
+
+
+// The Core library takes pixel and line strides as int32.
+static bool
+core_stride_fits(stride_t stride)
+{
+    return stride >= std::numeric_limits<int32_t>::min()
+           && stride <= std::numeric_limits<int32_t>::max();
+}
+
+
+
+bool
+OpenEXROutput::core_write_chunks(const std::vector<Imath::V2i>& chunks,
+                                 const char* base, int xorigin, int yorigin,
+                                 stride_t xstride, stride_t ystride,
+                                 cspan<TypeDesc> chantypes)
+{
+    if (!core_stride_fits(xstride) || !core_stride_fits(ystride)) {
+        errorf("OpenEXR: strides (%d, %d) are too large to write",
+               xstride, ystride);
+        return false;
+    }
+    int nchans = m_spec.nchannels;
+    std::vector<exr_pixel_type_t> usertypes(nchans);
+    std::vector<size_t> chanoffsets(nchans);
+    for (int c = 0, offset = 0; c < nchans; ++c) {
+        if (!core_pixel_type(chantypes[c], usertypes[c])) {
+            errorf("OpenEXR cannot write pixels of type %s", chantypes[c]);
+            return false;
+        }
+        chanoffsets[c] = offset;
+        offset += chantypes[c].size();
+    }
+    bool tiled = m_spec.tile_width != 0;
+
+    // Chunks are set up, then compressed in parallel, then written (or
+    // held until their turn comes) serially, a batch at a time so that
+    // we don't hold on to compressed copies of the whole image.
+    size_t batch = size_t(std::max(1, 4 * default_thread_pool()->size()));
+    std::unique_ptr<exr_encode_pipeline_t[]> encoders(
+        new exr_encode_pipeline_t[std::min(batch, chunks.size())]);
+    std::unique_ptr<exr_chunk_info_t[]> cinfo(
+        new exr_chunk_info_t[std::min(batch, chunks.size())]);
+    for (size_t first = 0; first < chunks.size(); first += batch) {
+        size_t n        = std::min(batch, chunks.size() - first);
+        exr_result_t rv = EXR_ERR_SUCCESS;
+        size_t ninit    = 0;
+        for (; ninit < n && rv == EXR_ERR_SUCCESS; ++ninit) {
+            const Imath::V2i& chunk    = chunks[first + ninit];
+            exr_encode_pipeline_t& enc = encoders[ninit];
+            exr_chunk_info_t& info     = cinfo[ninit];
+            enc                        = EXR_ENCODE_PIPELINE_INITIALIZER;
+            int x = m_spec.x, y = chunk.y;
+            if (tiled) {
+                rv = exr_write_tile_chunk_info(m_exr_context, m_subimage,
+                                               chunk.x, chunk.y, m_miplevel,
+                                               m_miplevel, &info);
+                x = m_spec.x + chunk.x * m_spec.tile_width;
+                y = m_spec.y + chunk.y * m_spec.tile_height;
+            } else {
+                rv = exr_write_scanline_chunk_info(m_exr_context, m_subimage,
+                                                   chunk.y, &info);
+            }
+            if (rv == EXR_ERR_SUCCESS)
+                rv = exr_encoding_initialize(m_exr_context, m_subimage, &info,
+                                             &enc);
+            if (rv != EXR_ERR_SUCCESS)
+                break;
+            const char* pixels = base + (x - xorigin) * xstride
+                                 + (y - yorigin) * ystride;
+            for (int i = 0; i < enc.channel_count; ++i) {
+                exr_coding_channel_info_t& ch = enc.channels[i];
+                int c = m_spec.channelindex(ch.channel_name);
+                if (c < 0)
+                    c = i;
+                ch.encode_from_ptr        = (const uint8_t*)pixels
+                                     + chanoffsets[c];
+                ch.user_pixel_stride      = int32_t(xstride);
+                ch.user_line_stride       = int32_t(ystride);
+                ch.user_data_type         = usertypes[c];
+                ch.user_bytes_per_element = int16_t(chantypes[c].size());
+            }
+            rv = exr_encoding_choose_default_routines(m_exr_context,
+                                                      m_subimage, &enc);
+            // Don't let the pipeline write the chunk itself -- that has to
+            // happen in order, after the parallel compression.
+            enc.write_fn = [](exr_encode_pipeline_t*) -> exr_result_t {
+                return EXR_ERR_SUCCESS;
+            };
+        }
+
+        std::vector<exr_result_t> results(n, EXR_ERR_SUCCESS);
+        if (rv == EXR_ERR_SUCCESS) {
+            parallel_for(
+                0, int64_t(n),
+                [&](int64_t i) {
+                    results[i] = exr_encoding_run(m_exr_context, m_subimage,
+                                                  &encoders[i]);
+                },
+                parallel_options(threads(), Split_Y, 1));
+        }
+
+        for (size_t i = 0; i < ninit; ++i) {
+            exr_encode_pipeline_t& enc = encoders[i];
+            if (rv == EXR_ERR_SUCCESS)
+                rv = results[i];
+            if (rv == EXR_ERR_SUCCESS) {
+                const Imath::V2i& chunk = chunks[first + i];
+                if (cinfo[i].idx == m_core_next_chunk) {
+                    rv = core_write_chunk(chunk, enc.compressed_buffer,
+                                          enc.compressed_bytes);
+                    rv = (rv == EXR_ERR_SUCCESS) ? core_write_pending() : rv;
+                } else {
+                    // Tiles that arrive early are held until all the ones
+                    // ahead of them in the file have been written.
+                    const uint8_t* p = (const uint8_t*)enc.compressed_buffer;
+                    auto& pending    = m_core_pending[cinfo[i].idx];
+                    pending.first    = chunk;
+                    pending.second.assign(p, p + enc.compressed_bytes);
+                }
+            }
+            exr_encoding_destroy(m_exr_context, &enc);
+        }
+        if (rv != EXR_ERR_SUCCESS) {
+            if (!has_error())
+                errorf("Failed OpenEXR write: %s",
+                       exr_get_error_code_as_string(rv));
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
+exr_result_t
+OpenEXROutput::core_write_chunk(const Imath::V2i& chunk, const void* data,
+                                uint64_t size)
+{
+    exr_result_t rv;
+    if (m_spec.tile_width)
+        rv = exr_write_tile_chunk(m_exr_context, m_subimage, chunk.x,
+                                  chunk.y, m_miplevel, m_miplevel, data,
+                                  size);
+    else
+        rv = exr_write_scanline_chunk(m_exr_context, m_subimage, chunk.y,
+                                      data, size);
+    ++m_core_next_chunk;
+    return rv;
+}
+
+
+
+exr_result_t
+OpenEXROutput::core_write_pending()
+{
+    exr_result_t rv = EXR_ERR_SUCCESS;
+    for (auto p = m_core_pending.begin();
+         p != m_core_pending.end() && p->first == m_core_next_chunk
+         && rv == EXR_ERR_SUCCESS;
+         p = m_core_pending.erase(p)) {
+        rv = core_write_chunk(p->second.first, p->second.second.data(),
+                              p->second.second.size());
+    }
+    return rv;
+}
+
+
+
+bool
+OpenEXROutput::core_check_complete()
+{
+    if (m_core_pending.size()) {
+        errorf("OpenEXR: %d chunks of subimage %d could not be written "
+               "because chunk %d was never supplied",
+               int(m_core_pending.size()), m_subimage, m_core_next_chunk);
+        m_core_pending.clear();
+        return false;
+    }
+    if (m_core_nlines) {
+        errorf("OpenEXR: scanlines %d-%d of subimage %d were never written "
+               "because the rest of their chunk was not supplied",
+               m_core_lines_y, m_core_lines_y + m_core_nlines - 1, m_subimage);
+        m_core_nlines = 0;
+        return false;
+    }
+    return true;
+}
+
+
+
+bool
+OpenEXROutput::core_write_scanlines(int ybegin, int yend, int z,
+                                    TypeDesc format, const void* data,
+                                    stride_t xstride, stride_t ystride)
+{
+    if (m_spec.tile_width) {
+        errorf("Attempt to write scanlines to a tiled file.");
+        return false;
+    }
+    int32_t linesperchunk = 1;
+    if (exr_get_scanlines_per_chunk(m_exr_context, m_subimage, &linesperchunk)
+        != EXR_ERR_SUCCESS)
+        return false;
+    int imageyend = m_spec.y + m_spec.height;
+    yend          = std::min(yend, imageyend);
+    if (ybegin != m_core_lines_y + m_core_nlines) {
+        errorf("OpenEXR scanlines must be written in order (expected y=%d, got %d)",
+               m_core_lines_y + m_core_nlines, ybegin);
+        return false;
+    }
+
+    bool native          = (format == TypeDesc::UNKNOWN);
+    size_t pixelbytes    = m_spec.pixel_bytes(true);
+    size_t scanlinebytes = m_spec.scanline_bytes(true);
+    if (native && xstride == AutoStride)
+        xstride = (stride_t)pixelbytes;
+    stride_t zstride = AutoStride;
+    m_spec.auto_stride(xstride, ystride, zstride, format, m_spec.nchannels,
+                       m_spec.width, m_spec.height);
+    std::vector<TypeDesc> nativetypes(m_spec.nchannels);
+    for (int c = 0; c < m_spec.nchannels; ++c)
+        nativetypes[c] = m_spec.channelformat(c);
+
+    // Add scanlines to the partial chunk, and write it once it's complete.
+    auto stage = [&](int y, int n, const char* d) -> bool {
+        const void* lines = to_native_rectangle(m_spec.x,
+                                                m_spec.x + m_spec.width, y,
+                                                y + n, z, z + 1, format, d,
+                                                xstride, ystride, zstride,
+                                                m_scratch);
+        m_core_lines.resize(linesperchunk * scanlinebytes);
+        memcpy(&m_core_lines[m_core_nlines * scanlinebytes], lines,
+               n * scanlinebytes);
+        m_core_nlines += n;
+        int chunkend = std::min(m_core_lines_y + linesperchunk, imageyend);
+        if (m_core_lines_y + m_core_nlines < chunkend)
+            return true;
+        bool ok = core_write_chunks({ Imath::V2i(0, m_core_lines_y) },
+                                    (const char*)m_core_lines.data(),
+                                    m_spec.x, m_core_lines_y, pixelbytes,
+                                    scanlinebytes, nativetypes);
+        m_core_lines_y = chunkend;
+        m_core_nlines  = 0;
+        return ok;
+    };
+
+    const char* d = (const char*)data;
+    int y         = ybegin;
+    if (m_core_nlines && y < yend) {
+        // Top off the chunk left over from an earlier call
+        int n = std::min(yend, m_core_lines_y + linesperchunk) - y;
+        if (!stage(y, n, d))
+            return false;
+        y += n;
+        d += n * ystride;
+    }
+
+    // Whole chunks get compressed straight out of the caller's buffer, if
+    // it's in a data type that the Core library can convert from itself.
+    int nchunks = (yend - y) / linesperchunk;
+    if (yend == imageyend && (yend - y) % linesperchunk)
+        ++nchunks;  // the short last chunk of the image
+    if (nchunks > 0) {
+        int ywhole = std::min(y + nchunks * linesperchunk, yend);
+        std::vector<Imath::V2i> chunks;
+        for (int cy = y; cy < ywhole; cy += linesperchunk)
+            chunks.emplace_back(0, cy);
+        const char* pixels = d;
+        stride_t xs = xstride, ys = ystride;
+        std::vector<TypeDesc> types(m_spec.nchannels, format);
+        exr_pixel_type_t pt;
+        bool direct = (native || core_pixel_type(format, pt))
+                      && core_stride_fits(xstride)
+                      && core_stride_fits(ystride);
+        if (direct) {
+            if (native)
+                types = nativetypes;
+        } else {
+            // Convert, or gather into a contiguous buffer
+            pixels = (const char*)to_native_rectangle(
+                m_spec.x, m_spec.x + m_spec.width, y, ywhole, z, z + 1, format,
+                d, xstride, ystride, zstride, m_scratch);
+            xs    = (stride_t)pixelbytes;
+            ys    = (stride_t)scanlinebytes;
+            types = nativetypes;
+        }
+        if (!core_write_chunks(chunks, pixels, m_spec.x, y, xs, ys, types))
+            return false;
+        d += (ywhole - y) * ystride;
+        y              = ywhole;
+        m_core_lines_y = y;
+    }
+
+    // Hold on to any leftover scanlines until the rest of their chunk
+    // arrives.
+    if (y < yend && !stage(y, yend - y, d))
+        return false;
+
+    // Don't keep giant scratch buffers around
+    if (m_scratch.size() > 1 * 1024 * 1024) {
+        std::vector<unsigned char> dummy;
+        std::swap(m_scratch, dummy);
+    }
+    return true;
+}
+
+
+
+bool
+OpenEXROutput::core_write_tiles(int xbegin, int xend, int ybegin, int yend,
+                                int zbegin, int zend, TypeDesc format,
+                                const void* data, stride_t xstride,
+                                stride_t ystride, stride_t zstride)
+{
+    if (!m_spec.tile_width) {
+        errorf("Attempt to write tiles to a scanline file.");
+        return false;
+    }
+    if (!m_spec.valid_tile_range(xbegin, xend, ybegin, yend, zbegin, zend)) {
+        errorf("Invalid tile range");
+        return false;
+    }
+
+    bool native       = (format == TypeDesc::UNKNOWN);
+    size_t pixelbytes = m_spec.pixel_bytes(true);
+    if (native && xstride == AutoStride)
+        xstride = (stride_t)pixelbytes;
+    m_spec.auto_stride(xstride, ystride, zstride, format, m_spec.nchannels,
+                       xend - xbegin, yend - ybegin);
+    std::vector<TypeDesc> types(m_spec.nchannels, format);
+    exr_pixel_type_t pt;
+    bool direct = (native || core_pixel_type(format, pt))
+                  && core_stride_fits(xstride) && core_stride_fits(ystride);
+    if (direct) {
+        if (native)
+            for (int c = 0; c < m_spec.nchannels; ++c)
+                types[c] = m_spec.channelformat(c);
+    } else {
+        // Convert, or gather into a contiguous buffer
+        data    = to_native_rectangle(xbegin, xend, ybegin, yend, zbegin, zend,
+                                      format, data, xstride, ystride, zstride,
+                                      m_scratch);
+        xstride = (stride_t)pixelbytes;
+        ystride = (stride_t)pixelbytes * (xend - xbegin);
+        for (int c = 0; c < m_spec.nchannels; ++c)
+            types[c] = m_spec.channelformat(c);
+    }
+
+    // Tiles on the right and bottom edges are only as big as the part
+    // inside the image, so the caller's buffer needs no padding.
+    xend           = std::min(xend, m_spec.x + m_spec.width);
+    yend           = std::min(yend, m_spec.y + m_spec.height);
+    int firstxtile = (xbegin - m_spec.x) / m_spec.tile_width;
+    int firstytile = (ybegin - m_spec.y) / m_spec.tile_height;
+    int nxtiles    = (xend - xbegin + m_spec.tile_width - 1)
+                  / m_spec.tile_width;
+    int nytiles = (yend - ybegin + m_spec.tile_height - 1)
+                  / m_spec.tile_height;
+    std::vector<Imath::V2i> chunks;
+    chunks.reserve(size_t(nxtiles) * size_t(nytiles));
+    for (int ty = 0; ty < nytiles; ++ty)
+        for (int tx = 0; tx < nxtiles; ++tx)
+            chunks.emplace_back(firstxtile + tx, firstytile + ty);
+    bool ok = core_write_chunks(chunks, (const char*)data, xbegin, ybegin,
+                                xstride, ystride, types);
+
+    // Don't keep giant scratch buffers around
+    if (m_scratch.size() > 1 * 1024 * 1024) {
+        std::vector<unsigned char> dummy;
+        std::swap(m_scratch, dummy);
+    }
+    return ok;
+}
+
+#endif  // OIIO_USE_EXR_C_API
+
 OIIO_PLUGIN_NAMESPACE_END
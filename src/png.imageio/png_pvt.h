@@ -391,6 +391,25 @@ read_next_scanline(png_structp& sp, void* buffer)
 
 
 
+/// Reads the next nrows scanlines from an open PNG file into the buffers
+/// pointed to by rows.
+/// \return empty string on success, error message on failure.
+///
+inline const std::string
+read_next_scanlines(png_structp& sp, png_bytepp rows, int nrows)
+{
+    // Must call this setjmp in every function that does PNG reads
+    if (setjmp(png_jmpbuf(sp)))  // NOLINT(cert-err52-cpp)
+        return "PNG library error";
+
+    png_read_rows(sp, rows, NULL, png_uint_32(nrows));
+
+    // success
+    return "";
+}
+
+
+
 /// Destroys a PNG read struct.
 ///
 inline void
@@ -687,17 +706,38 @@ write_row(png_structp& sp, png_byte* data)
 
 
 
+/// Writes a whole chunk, e.g. IDAT data that the caller compressed itself.
+///
+inline bool
+write_chunk(png_structp& sp, const char* name, const unsigned char* data,
+            size_t size)
+{
+    if (setjmp(png_jmpbuf(sp))) {  // NOLINT(cert-err52-cpp)
+        //error ("PNG library error");
+        return false;
+    }
+    png_write_chunk(sp, (png_const_bytep)name, data, size);
+    return true;
+}
+
+
+
 /// Helper function - finalizes writing the image and destroy the write
-/// struct.
+/// struct. If the IDAT chunks were written with write_chunk() rather than
+/// write_row(), libpng doesn't know about them, so we end the file
+/// ourselves.
 inline void
-finish_image(png_structp& sp, png_infop& ip)
+finish_image(png_structp& sp, png_infop& ip, bool wrote_idat_chunks = false)
 {
     // Must call this setjmp in every function that does PNG writes
     if (setjmp(png_jmpbuf(sp))) {  // NOLINT(cert-err52-cpp)
         //error ("PNG library error");
         return;
     }
-    png_write_end(sp, ip);
+    if (wrote_idat_chunks)
+        png_write_chunk(sp, (png_const_bytep) "IEND", nullptr, 0);
+    else
+        png_write_end(sp, ip);
     png_destroy_write_struct(&sp, &ip);
     sp = nullptr;
     ip = nullptr;
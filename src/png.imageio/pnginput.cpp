@@ -32,6 +32,8 @@ public:
     }
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                       int yend, int z, void* data) override;
     virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
     {
         m_io = ioproxy;
@@ -265,26 +267,37 @@ associateAlpha(T* data, int size, int channels, int alpha_channel, float gamma)
 
 
 bool
-PNGInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
+PNGInput::read_native_scanline(int subimage, int miplevel, int y, int z,
                                void* data)
+{
+    return read_native_scanlines(subimage, miplevel, y, y + 1, z, data);
+}
+
+
+
+bool
+PNGInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                int yend, int /*z*/, void* data)
 {
     lock_guard lock(*this);
     if (!seek_subimage(subimage, miplevel))
         return false;
 
-    y -= m_spec.y;
-    if (y < 0 || y >= m_spec.height)  // out of range scanline
+    ybegin -= m_spec.y;
+    yend = std::min(yend - m_spec.y, m_spec.height);
+    if (ybegin < 0 || ybegin >= yend)  // out of range scanlines
         return false;
+    int nrows   = yend - ybegin;
+    size_t size = spec().scanline_bytes();
 
     if (m_interlace_type != 0) {
         // Interlaced.  Punt and read the whole image
         if (m_buf.empty())
             readimg();
-        size_t size = spec().scanline_bytes();
-        memcpy(data, &m_buf[0] + y * size, size);
+        memcpy(data, &m_buf[0] + ybegin * size, nrows * size);
     } else {
-        // Not an interlaced image -- read just one row
-        if (m_next_scanline > y) {
+        // Not an interlaced image -- read just the rows we need
+        if (m_next_scanline > ybegin) {
             // User is trying to read an earlier scanline than the one we're
             // up to.  Easy fix: close the file and re-open.
             // Don't forget to save and restore any configuration settings.
@@ -298,9 +311,9 @@ PNGInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
                 return false;  // Somehow, the re-open failed
             assert(m_next_scanline == 0 && current_subimage() == subimage);
         }
-        while (m_next_scanline <= y) {
-            // Keep reading until we're read the scanline we really need
-            // std::cerr << "reading scanline " << m_next_scanline << "\n";
+        while (m_next_scanline < ybegin) {
+            // Skip ahead to the first scanline we really need, using the
+            // caller's buffer as scratch space.
             std::string s = PNG_pvt::read_next_scanline(m_png, data);
             if (s.length()) {
                 errorf("%s", s);
@@ -310,6 +323,19 @@ PNGInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
                 return false;  // error is already registered
             ++m_next_scanline;
         }
+        // Decode the whole block of rows straight into the caller's buffer
+        std::vector<png_bytep> rows(nrows);
+        for (int i = 0; i < nrows; ++i)
+            rows[i] = (png_bytep)data + i * size;
+        std::string s = PNG_pvt::read_next_scanlines(m_png, rows.data(),
+                                                     nrows);
+        if (s.length()) {
+            errorf("%s", s);
+            return false;
+        }
+        if (m_err)
+            return false;  // error is already registered
+        m_next_scanline += nrows;
     }
 
     // PNG specifically dictates unassociated (un-"premultiplied") alpha.
@@ -317,11 +343,11 @@ PNGInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
     if (m_spec.alpha_channel != -1 && !m_keep_unassociated_alpha) {
         float gamma = m_spec.get_float_attribute("oiio:Gamma", 1.0f);
         if (m_spec.format == TypeDesc::UINT16)
-            associateAlpha((unsigned short*)data, m_spec.width,
+            associateAlpha((unsigned short*)data, m_spec.width * nrows,
                            m_spec.nchannels, m_spec.alpha_channel, gamma);
         else
-            associateAlpha((unsigned char*)data, m_spec.width, m_spec.nchannels,
-                           m_spec.alpha_channel, gamma);
+            associateAlpha((unsigned char*)data, m_spec.width * nrows,
+                           m_spec.nchannels, m_spec.alpha_channel, gamma);
     }
 
     return true;
@@ -8,6 +8,8 @@
 #include <ctime>
 #include <iostream>
 
+#include <OpenImageIO/parallel.h>
+
 #include "png_pvt.h"
 
 
@@ -52,6 +54,24 @@ private:
     Filesystem::IOProxy* m_io = nullptr;
     bool m_err                = false;
 
+    // State for parallel encoding. Instead of handing rows to libpng one
+    // at a time, we collect a batch of rows, filter and deflate them in
+    // independent blocks on the thread pool, and write the concatenated
+    // result as IDAT chunks ourselves.
+    bool m_parallel   = false;
+    int m_zlevel      = 6;
+    int m_zstrategy   = Z_DEFAULT_STRATEGY;
+    int m_filters     = PNG_FILTER_NONE;  ///< Mask of allowed row filters
+    int m_next_row    = 0;                ///< Next row we expect to receive
+    int m_nbatch      = 0;                ///< Rows per batch
+    int m_npending    = 0;                ///< Rows in the current batch
+    size_t m_rowbytes = 0;
+    std::vector<unsigned char> m_rows;   ///< Prior row + pending raw rows
+    std::vector<unsigned char> m_ztail;  ///< Last 32k of filtered data
+    uLong m_adler    = 0;                ///< Running zlib checksum
+    bool m_zstarted  = false;            ///< Have we written the header?
+    bool m_zfinished = false;            ///< Have we ended the stream?
+
     // Initialize private members to pre-opened state
     void init(void)
     {
@@ -61,10 +81,24 @@ private:
         m_gamma         = 1.0;
         m_pngtext.clear();
         m_local_io.reset();
-        m_io  = nullptr;
-        m_err = false;
+        m_io        = nullptr;
+        m_err       = false;
+        m_parallel  = false;
+        m_next_row  = 0;
+        m_npending  = 0;
+        m_zstarted  = false;
+        m_zfinished = false;
+        std::vector<unsigned char>().swap(m_rows);
+        std::vector<unsigned char>().swap(m_ztail);
     }
 
+    // Set up parallel encoding, if it's enabled and worth it.
+    void setup_parallel();
+
+    // Filter and compress the pending rows and write them as IDAT chunks.
+    // If `last` is true, also end the zlib stream.
+    bool encode_pending_rows(bool last);
+
     // Add a parameter to the output
     bool put_parameter(const std::string& name, TypeDesc type,
                        const void* data);
@@ -162,31 +196,40 @@ PNGOutput::open(const std::string& name, const ImageSpec& userspec,
 
     png_set_write_fn(m_png, this, PngWriteCallback, PngFlushCallback);
 
-    png_set_compression_level(
-        m_png, std::max(std::min(m_spec.get_int_attribute(
+    m_zlevel = std::max(std::min(m_spec.get_int_attribute(
                                      "png:compressionLevel",
                                      6 /* medium speed vs size tradeoff */),
                                  Z_BEST_COMPRESSION),
-                        Z_NO_COMPRESSION));
+                        Z_NO_COMPRESSION);
+    png_set_compression_level(m_png, m_zlevel);
     std::string compression = m_spec.get_string_attribute("compression");
     if (compression.empty()) {
-        png_set_compression_strategy(m_png, Z_DEFAULT_STRATEGY);
+        m_zstrategy = Z_DEFAULT_STRATEGY;
     } else if (Strutil::iequals(compression, "default")) {
-        png_set_compression_strategy(m_png, Z_DEFAULT_STRATEGY);
+        m_zstrategy = Z_DEFAULT_STRATEGY;
     } else if (Strutil::iequals(compression, "filtered")) {
-        png_set_compression_strategy(m_png, Z_FILTERED);
+        m_zstrategy = Z_FILTERED;
     } else if (Strutil::iequals(compression, "huffman")) {
-        png_set_compression_strategy(m_png, Z_HUFFMAN_ONLY);
+        m_zstrategy = Z_HUFFMAN_ONLY;
     } else if (Strutil::iequals(compression, "rle")) {
-        png_set_compression_strategy(m_png, Z_RLE);
+        m_zstrategy = Z_RLE;
     } else if (Strutil::iequals(compression, "fixed")) {
-        png_set_compression_strategy(m_png, Z_FIXED);
+        m_zstrategy = Z_FIXED;
     } else {
-        png_set_compression_strategy(m_png, Z_DEFAULT_STRATEGY);
+        m_zstrategy = Z_DEFAULT_STRATEGY;
     }
-
-    png_set_filter(m_png, 0,
-                   spec().get_int_attribute("png:filter", PNG_NO_FILTERS));
+    png_set_compression_strategy(m_png, m_zstrategy);
+
+    int filter = spec().get_int_attribute("png:filter", PNG_NO_FILTERS);
+    png_set_filter(m_png, 0, filter);
+    // Same interpretation as png_set_filter: 0-4 name a single filter
+    // type, anything else is a mask of the PNG_FILTER_* bits.
+    if (filter >= PNG_FILTER_VALUE_NONE && filter < PNG_FILTER_VALUE_LAST)
+        m_filters = PNG_FILTER_NONE << filter;
+    else
+        m_filters = filter & PNG_ALL_FILTERS;
+    if (!m_filters)
+        m_filters = PNG_FILTER_NONE;
     // https://www.w3.org/TR/PNG-Encoders.html#E.Filter-selection
     // https://www.w3.org/TR/PNG-Rationale.html#R.Filtering
     // The official advice is to PNG_NO_FILTER for palette or < 8 bpp
@@ -228,6 +271,247 @@ PNGOutput::open(const std::string& name, const ImageSpec& userspec,
     if (m_spec.tile_width && m_spec.tile_height)
         m_tilebuffer.resize(m_spec.image_bytes());
 
+    setup_parallel();
+    return true;
+}
+
+
+
+// Number of rows in each independently compressed block. Each block is
+// primed with the last 32k of the data before it as the dictionary, so the
+// cost in file size of splitting is small as long as the blocks are not
+// too tiny.
+static size_t
+rows_per_zblock(size_t rowbytes)
+{
+    return std::max(size_t(1), size_t(256 * 1024) / (rowbytes + 1));
+}
+
+
+
+void
+PNGOutput::setup_parallel()
+{
+    // Small images aren't worth the trouble, and an explicit request for
+    // a single thread means the caller doesn't want us using the pool.
+    const imagesize_t min_parallel_bytes = 4 << 20;
+    int nthreads = threads() ? threads() : default_thread_pool()->size() + 1;
+    if (nthreads <= 1 || m_spec.image_bytes() < min_parallel_bytes
+        || !m_spec.get_int_attribute("png:parallel", 1))
+        return;
+
+    m_rowbytes         = m_spec.scanline_bytes();
+    int rows_per_block = int(rows_per_zblock(m_rowbytes));
+    m_nbatch   = std::min(rows_per_block * 2 * nthreads, m_spec.height);
+    m_parallel = true;
+    m_rows.assign((m_nbatch + 1) * m_rowbytes, 0);  // prior row starts as 0
+    m_adler = adler32(0L, Z_NULL, 0);
+}
+
+
+
+// Apply one PNG filter type to a row, writing the filter type byte and
+// then the filtered bytes to out[0..rowbytes]. The prior row for the
+// first row of the image is all zeroes.
+static void
+filter_row(int type, const unsigned char* row, const unsigned char* prior,
+           size_t rowbytes, size_t bpp, unsigned char* out)
+{
+    *out++ = (unsigned char)type;
+    switch (type) {
+    case PNG_FILTER_VALUE_SUB:
+        for (size_t i = 0; i < rowbytes; ++i)
+            out[i] = row[i] - (i >= bpp ? row[i - bpp] : 0);
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for (size_t i = 0; i < rowbytes; ++i)
+            out[i] = row[i] - prior[i];
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for (size_t i = 0; i < rowbytes; ++i)
+            out[i] = row[i]
+                     - (unsigned char)(((i >= bpp ? row[i - bpp] : 0)
+                                        + prior[i])
+                                       / 2);
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        for (size_t i = 0; i < rowbytes; ++i) {
+            int a  = i >= bpp ? row[i - bpp] : 0;
+            int b  = prior[i];
+            int c  = i >= bpp ? prior[i - bpp] : 0;
+            int pa = std::abs(b - c);
+            int pb = std::abs(a - c);
+            int pc = std::abs(a + b - 2 * c);
+            int pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+            out[i]   = row[i] - (unsigned char)pred;
+        }
+        break;
+    default: memcpy(out, row, rowbytes); break;
+    }
+}
+
+
+
+// Filter a row with the best of the filter types allowed by the mask,
+// using the usual heuristic of the smallest sum of absolute values of
+// the filtered bytes (taken as signed).
+static void
+filter_row_adaptive(int filters, const unsigned char* row,
+                    const unsigned char* prior, size_t rowbytes, size_t bpp,
+                    unsigned char* out, std::vector<unsigned char>& trial)
+{
+    int best       = -1;
+    size_t bestsum = 0;
+    for (int type = PNG_FILTER_VALUE_NONE; type < PNG_FILTER_VALUE_LAST;
+         ++type) {
+        if (!(filters & (PNG_FILTER_NONE << type)))
+            continue;
+        if (best < 0 && !(filters & ~(PNG_FILTER_NONE << type))) {
+            // The only choice, no need to evaluate it
+            filter_row(type, row, prior, rowbytes, bpp, out);
+            return;
+        }
+        filter_row(type, row, prior, rowbytes, bpp, trial.data());
+        size_t sum = 0;
+        for (size_t i = 1; i <= rowbytes; ++i)
+            sum += std::abs(int((signed char)trial[i]));
+        if (best < 0 || sum < bestsum) {
+            best    = type;
+            bestsum = sum;
+            memcpy(out, trial.data(), rowbytes + 1);
+        }
+    }
+}
+
+
+
+// Raw-deflate a block of the filtered stream, with `dict` holding the
+// data immediately preceding it. Non-final blocks end with a sync flush,
+// so that they end on a byte boundary and can simply be concatenated.
+static bool
+deflate_block(const unsigned char* data, size_t size,
+              const unsigned char* dict, size_t dictsize, bool last,
+              int level, int strategy, std::vector<unsigned char>& out)
+{
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (deflateInit2(&z, level, Z_DEFLATED, -15, 8, strategy) != Z_OK)
+        return false;
+    if (dictsize)
+        deflateSetDictionary(&z, dict, uInt(dictsize));
+    out.resize(deflateBound(&z, uLong(size)) + 64);
+    z.next_in   = (Bytef*)data;
+    z.avail_in  = uInt(size);
+    z.next_out  = out.data();
+    z.avail_out = uInt(out.size());
+    int flush   = last ? Z_FINISH : Z_SYNC_FLUSH;
+    int rv;
+    while ((rv = deflate(&z, flush)) == Z_OK && z.avail_out == 0) {
+        size_t used = out.size();
+        out.resize(used * 2);
+        z.next_out  = out.data() + used;
+        z.avail_out = uInt(out.size() - used);
+    }
+    out.resize(out.size() - z.avail_out);
+    deflateEnd(&z);
+    return last ? rv == Z_STREAM_END : rv == Z_OK;
+}
+
+
+
+bool
+PNGOutput::encode_pending_rows(bool last)
+{
+    const size_t window   = 32768;
+    const size_t fbytes   = m_rowbytes + 1;  // filtered row with type byte
+    const size_t bpp      = std::max(size_t(1), m_spec.pixel_bytes(true));
+    size_t rows_per_block = rows_per_zblock(m_rowbytes);
+    int nrows   = m_npending;
+    int nblocks = std::max(1, int((nrows + rows_per_block - 1)
+                                  / rows_per_block));
+    parallel_options popt(threads(), Split_Y, 1);
+
+    // The filtered rows are laid out after the tail of the previously
+    // filtered data, so every block has its dictionary right before it.
+    size_t dictsize = m_ztail.size();
+    std::vector<unsigned char> filtered(dictsize + nrows * fbytes);
+    if (dictsize)
+        memcpy(filtered.data(), m_ztail.data(), dictsize);
+    parallel_for(0, nblocks, [&](int64_t b) {
+        std::vector<unsigned char> trial(fbytes);
+        int r0 = int(b * rows_per_block);
+        int r1 = std::min(nrows, int((b + 1) * rows_per_block));
+        for (int r = r0; r < r1; ++r) {
+            const unsigned char* row = &m_rows[(r + 1) * m_rowbytes];
+            filter_row_adaptive(m_filters, row, row - m_rowbytes, m_rowbytes,
+                                bpp, &filtered[dictsize + r * fbytes], trial);
+        }
+    }, popt);
+
+    // Only now that all the filtering is done can we compress the blocks.
+    std::vector<std::vector<unsigned char>> zblocks(nblocks);
+    std::vector<uLong> adlers(nblocks);
+    std::vector<char> oks(nblocks, 0);
+    parallel_for(0, nblocks, [&](int64_t b) {
+        size_t begin = dictsize + b * rows_per_block * fbytes;
+        size_t end   = std::min(filtered.size(),
+                              dictsize + (b + 1) * rows_per_block * fbytes);
+        size_t dsize = std::min(window, begin);
+        adlers[b]    = adler32(adler32(0L, Z_NULL, 0), &filtered[begin],
+                            uInt(end - begin));
+        oks[b] = deflate_block(&filtered[begin], end - begin,
+                               &filtered[begin - dsize], dsize,
+                               last && b == nblocks - 1, m_zlevel,
+                               m_zstrategy, zblocks[b]);
+    }, popt);
+
+    // Stitch the blocks together, in order, into a single zlib stream.
+    for (int b = 0; b < nblocks; ++b) {
+        if (!oks[b]) {
+            errorf("PNG compression error");
+            return false;
+        }
+        size_t blocksize = std::min(filtered.size() - dictsize,
+                                    (b + 1) * rows_per_block * fbytes)
+                           - b * rows_per_block * fbytes;
+        m_adler = adler32_combine(m_adler, adlers[b], z_off_t(blocksize));
+        std::vector<unsigned char>& chunk(zblocks[b]);
+        if (!m_zstarted) {
+            // zlib header: deflate with a 32k window, no preset dictionary,
+            // and the level hint that zlib itself would have written.
+            int flevel   = (m_zstrategy >= Z_HUFFMAN_ONLY || m_zlevel < 2) ? 0
+                           : m_zlevel < 6                                  ? 1
+                           : m_zlevel == 6                                 ? 2
+                                                                           : 3;
+            unsigned int header = (0x78 << 8) | (flevel << 6);
+            header += 31 - (header % 31);
+            unsigned char hdr[2] = { (unsigned char)(header >> 8),
+                                     (unsigned char)(header & 0xff) };
+            chunk.insert(chunk.begin(), hdr, hdr + 2);
+            m_zstarted = true;
+        }
+        if (last && b == nblocks - 1) {
+            unsigned char trailer[4] = { (unsigned char)(m_adler >> 24),
+                                         (unsigned char)(m_adler >> 16),
+                                         (unsigned char)(m_adler >> 8),
+                                         (unsigned char)(m_adler) };
+            chunk.insert(chunk.end(), trailer, trailer + 4);
+            m_zfinished = true;
+        }
+        if (!PNG_pvt::write_chunk(m_png, "IDAT", chunk.data(), chunk.size())
+            || m_err) {
+            errorf("PNG library error");
+            return false;
+        }
+    }
+
+    // Keep what the next batch needs: the window of filtered data for its
+    // dictionary, and the last raw row as the prior row for filtering.
+    size_t keep = std::min(window, filtered.size());
+    m_ztail.assign(filtered.end() - keep, filtered.end());
+    if (nrows)
+        memcpy(&m_rows[0], &m_rows[nrows * m_rowbytes], m_rowbytes);
+    m_npending = 0;
     return true;
 }
 
@@ -250,8 +534,13 @@ PNGOutput::close()
         std::vector<unsigned char>().swap(m_tilebuffer);
     }
 
+    if (m_png && m_parallel && !m_zfinished) {
+        // Flush whatever is left, even if the caller didn't give us every
+        // row, so that the zlib stream is at least properly terminated.
+        ok &= encode_pending_rows(true);
+    }
     if (m_png) {
-        PNG_pvt::finish_image(m_png, m_info);
+        PNG_pvt::finish_image(m_png, m_info, m_parallel);
     }
 
     init();  // re-initialize
@@ -319,6 +608,21 @@ PNGOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
     if (littleendian() && m_spec.format == TypeDesc::UINT16)
         swap_endian((unsigned short*)data, m_spec.width * m_spec.nchannels);
 
+    if (m_parallel) {
+        // Rows must arrive in order; batch them up for encode_pending_rows.
+        if (y != m_next_row) {
+            errorf("PNG scanlines must be written in order (expected %d, got %d)",
+                   m_next_row + m_spec.y, y + m_spec.y);
+            return false;
+        }
+        memcpy(&m_rows[(m_npending + 1) * m_rowbytes], data, m_rowbytes);
+        ++m_npending;
+        ++m_next_row;
+        if (m_npending == m_nbatch || m_next_row == m_spec.height)
+            return encode_pending_rows(m_next_row == m_spec.height);
+        return true;
+    }
+
     if (!PNG_pvt::write_row(m_png, (png_byte*)data)) {
         errorf("PNG library error");
         return false;
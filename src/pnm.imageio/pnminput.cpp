@@ -3,7 +3,7 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 #include <cstdlib>
-#include <fstream>
+#include <istream>
 #include <string>
 
 #include <OpenImageIO/filesystem.h>
@@ -21,21 +21,90 @@ OIIO_PLUGIN_NAMESPACE_BEGIN
 //
 
 
+// Buffered, seekable streambuf that reads from an IOProxy, so that the
+// istream-based header and ASCII parsing below works for any proxy, not
+// just files.
+class IOProxyInStreambuf final : public std::streambuf {
+public:
+    explicit IOProxyInStreambuf(Filesystem::IOProxy* io)
+        : m_io(io)
+        , m_buf(64 * 1024)
+    {
+        setg(m_buf.data(), m_buf.data(), m_buf.data());
+    }
+
+protected:
+    virtual int_type underflow() override
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+        m_bufpos += egptr() - eback();
+        size_t n = m_io->pread(m_buf.data(), m_buf.size(), m_bufpos);
+        setg(m_buf.data(), m_buf.data(), m_buf.data() + n);
+        return n ? traits_type::to_int_type(*gptr()) : traits_type::eof();
+    }
+    virtual pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+                             std::ios_base::openmode which) override
+    {
+        if (dir == std::ios_base::cur)
+            off += m_bufpos + (gptr() - eback());
+        else if (dir == std::ios_base::end)
+            off += off_type(m_io->size());
+        return seekpos(pos_type(off), which);
+    }
+    virtual pos_type seekpos(pos_type pos,
+                             std::ios_base::openmode /*which*/) override
+    {
+        int64_t p = int64_t(off_type(pos));
+        if (p < 0)
+            return pos_type(off_type(-1));
+        if (p >= m_bufpos && p <= m_bufpos + (egptr() - eback())) {
+            // Still within the buffer, just move the read pointer
+            setg(eback(), eback() + (p - m_bufpos), egptr());
+        } else {
+            m_bufpos = p;
+            setg(m_buf.data(), m_buf.data(), m_buf.data());
+        }
+        return pos;
+    }
+
+private:
+    Filesystem::IOProxy* m_io;
+    std::vector<char> m_buf;
+    int64_t m_bufpos = 0;  // Proxy offset of the start of m_buf
+};
+
+
+
 class PNMInput final : public ImageInput {
 public:
     PNMInput() {}
     virtual ~PNMInput() { close(); }
     virtual const char* format_name(void) const override { return "pnm"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
+    virtual bool open(const std::string& name, ImageSpec& newspec,
+                      const ImageSpec& config) override;
     virtual bool close() override;
     virtual int current_subimage(void) const override { return 0; }
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     enum PNMType { P1, P2, P3, P4, P5, P6, Pf, PF };
 
-    OIIO::ifstream m_file;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
+    std::unique_ptr<IOProxyInStreambuf> m_streambuf;
+    std::istream m_file { nullptr };  // Reads through m_streambuf
     std::streampos m_header_end_pos;  // file position after the header
     std::string m_current_line;       ///< Buffer the image pixels
     const char* m_pos;
@@ -424,9 +493,24 @@ PNMInput::read_file_header()
 bool
 PNMInput::open(const std::string& name, ImageSpec& newspec)
 {
-    close();  //close previously opened file
-
-    Filesystem::open(m_file, name, std::ios::in | std::ios::binary);
+    // Close any already-opened file, but hold on to a proxy that was
+    // supplied with set_ioproxy() for the new one.
+    Filesystem::IOProxy* ioproxy = m_streambuf ? nullptr : m_io;
+    close();
+    m_io = ioproxy;
+
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
+        errorf("Could not open file \"%s\"", name);
+        close();
+        return false;
+    }
+    m_streambuf.reset(new IOProxyInStreambuf(m_io));
+    m_file.rdbuf(m_streambuf.get());
 
     m_current_line = "";
     m_pos          = m_current_line.c_str();
@@ -440,10 +524,25 @@ PNMInput::open(const std::string& name, ImageSpec& newspec)
 
 
 
+bool
+PNMInput::open(const std::string& name, ImageSpec& newspec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, newspec);
+}
+
+
+
 bool
 PNMInput::close()
 {
-    m_file.close();
+    m_file.rdbuf(nullptr);
+    m_streambuf.reset();
+    m_io = nullptr;
+    m_io_local.reset();
     return true;
 }
 
@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: BSD-3-Clause
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
-#include <fstream>
+#include <ostream>
 
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/imageio.h>
@@ -10,10 +10,52 @@
 OIIO_PLUGIN_NAMESPACE_BEGIN
 
 
+// Buffered streambuf that writes to an IOProxy, so that the ostream-based
+// writers below can target any proxy, not just files.
+class IOProxyOutStreambuf final : public std::streambuf {
+public:
+    explicit IOProxyOutStreambuf(Filesystem::IOProxy* io)
+        : m_io(io)
+        , m_buf(64 * 1024)
+    {
+        setp(m_buf.data(), m_buf.data() + m_buf.size());
+    }
+    ~IOProxyOutStreambuf() { sync(); }
+
+protected:
+    virtual int_type overflow(int_type c) override
+    {
+        if (sync() != 0)
+            return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    virtual int sync() override
+    {
+        size_t n = size_t(pptr() - pbase());
+        if (n && m_io->write(pbase(), n) != n)
+            return -1;
+        setp(m_buf.data(), m_buf.data() + m_buf.size());
+        return 0;
+    }
+
+private:
+    Filesystem::IOProxy* m_io;
+    std::vector<char> m_buf;
+};
+
+
 class PNMOutput final : public ImageOutput {
 public:
     virtual ~PNMOutput();
     virtual const char* format_name(void) const override { return "pnm"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, const ImageSpec& spec,
                       OpenMode mode = Create) override;
     virtual bool close() override;
@@ -22,10 +64,18 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;  ///< Stash the filename
-    OIIO::ofstream m_file;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
+    std::unique_ptr<IOProxyOutStreambuf> m_streambuf;
+    std::ostream m_file { nullptr };  // Writes through m_streambuf
     unsigned int m_max_val, m_pnm_type;
     unsigned int m_dither;
     std::vector<unsigned char> m_scratch;
@@ -135,7 +185,11 @@ PNMOutput::open(const std::string& name, const ImageSpec& userspec,
         return false;
     }
 
-    close();                             // Close any already-opened file
+    // Close any already-opened file, but hold on to a proxy that was
+    // supplied with set_ioproxy() for the new one.
+    Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+    close();
+    m_io   = ioproxy;
     m_spec = userspec;                   // Stash the spec
     m_spec.set_format(TypeDesc::UINT8);  // Force 8 bit output
     int bits_per_sample = m_spec.get_int_attribute("oiio:BitsPerSample", 8);
@@ -155,18 +209,25 @@ PNMOutput::open(const std::string& name, const ImageSpec& userspec,
         m_pnm_type = 5;
     else
         m_pnm_type = 6;
-    if (!m_spec.get_int_attribute("pnm:binary", 1)) {
+    if (!m_spec.get_int_attribute("pnm:binary", 1))
         m_pnm_type -= 3;
-        Filesystem::open(m_file, name);
 
-    } else {
-        Filesystem::open(m_file, name, std::ios::out | std::ios::binary);
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
     }
-
-    if (!m_file) {
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", name);
+        close();
         return false;
     }
+    m_filename = name;
+    m_streambuf.reset(new IOProxyOutStreambuf(m_io));
+    m_file.rdbuf(m_streambuf.get());
 
     m_max_val = (1 << bits_per_sample) - 1;
     // Write header
@@ -188,7 +249,10 @@ PNMOutput::open(const std::string& name, const ImageSpec& userspec,
 bool
 PNMOutput::close()
 {
-    if (!m_file) {  // already closed
+    if (!m_streambuf) {  // already closed
+        m_io = nullptr;
+        m_io_local.reset();
+        m_filename.clear();
         return true;
     }
 
@@ -201,8 +265,17 @@ PNMOutput::close()
         std::vector<unsigned char>().swap(m_tilebuffer);
     }
 
-    m_file.close();
-    return true;
+    m_file.flush();
+    if (!m_file.good()) {
+        errorf("Write error: %s", m_io->error());
+        ok = false;
+    }
+    m_file.rdbuf(nullptr);
+    m_streambuf.reset();
+    m_io = nullptr;
+    m_io_local.reset();
+    m_filename.clear();
+    return ok;
 }
 
 
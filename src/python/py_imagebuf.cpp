@@ -126,6 +126,67 @@ ImageBuf_get_pixels(const ImageBuf& buf, TypeDesc format, ROI roi = ROI::All())
 
 
 
+// Return a numpy array that is a view of (not a copy of) buf's pixels, so
+// reading or writing it reads or writes the ImageBuf itself. If the pixels
+// are backed by the ImageCache, they are read into local memory first.
+// The view keeps the ImageBuf alive, but is no longer valid if the ImageBuf
+// is reset or otherwise reallocates its pixels.
+py::object
+ImageBuf_pixels_view(py::object pyself)
+{
+    ImageBuf& buf(pyself.cast<ImageBuf&>());
+    if (!buf.initialized() || buf.deep()) {
+        buf.errorfmt("pixels_view requires an initialized, non-deep ImageBuf");
+        return py::none();
+    }
+    if (!buf.localpixels()) {
+        py::gil_scoped_release gil;
+        buf.make_writable();
+    }
+    void* data = buf.localpixels();
+    if (!data)
+        return py::none();
+
+    const ImageSpec& spec(buf.spec());
+    TypeDesc format = buf.pixeltype();
+    std::vector<ssize_t> shape, strides;
+    if (spec.depth > 1) {
+        shape.assign({ spec.depth, spec.height, spec.width, spec.nchannels });
+        strides.assign({ buf.z_stride(), buf.scanline_stride(),
+                         buf.pixel_stride(), ssize_t(format.size()) });
+    } else {
+        shape.assign({ spec.height, spec.width, spec.nchannels });
+        strides.assign({ buf.scanline_stride(), buf.pixel_stride(),
+                         ssize_t(format.size()) });
+    }
+    return make_numpy_view(format, data, shape, strides, pyself);
+}
+
+
+
+// Make an ImageBuf that wraps the memory of a numpy array (or other
+// writable buffer) holding the pixels described by spec, rather than
+// copying it. The data type of the buffer overrides spec.format.
+ImageBuf
+ImageBuf_wrap_buffer(const ImageSpec& spec_, py::buffer& buffer)
+{
+    ImageSpec spec(spec_);
+    py::buffer_info info = buffer.request(true /*writable*/);
+    oiio_bufinfo buf(info, spec.nchannels, spec.width, spec.height,
+                     spec.depth, spec.depth > 1 ? 3 : 2);
+    if (!buf.data || buf.error.size())
+        throw std::invalid_argument(Strutil::sprintf(
+            "ImageBuf: can't wrap pixels: %s",
+            buf.error.size() ? buf.error : "unknown data type"));
+    if (info.ndim && info.strides[info.ndim - 1] != info.itemsize)
+        throw std::invalid_argument(
+            "ImageBuf: can't wrap pixels whose channels are not contiguous");
+    spec.set_format(buf.format);
+    return ImageBuf(spec, buf.data, buf.xstride, buf.ystride, buf.zstride);
+}
+
+
+
 void
 ImageBuf_set_deep_value(ImageBuf& buf, int x, int y, int z, int c, int s,
                         float value)
@@ -198,6 +259,8 @@ declare_imagebuf(py::module& m)
             auto z = zero ? InitializePixels::Yes : InitializePixels::No;
             return ImageBuf(spec, z);
         }))
+        .def(py::init(&ImageBuf_wrap_buffer), "spec"_a, "pixels"_a,
+             py::keep_alive<1, 3>())
         .def(py::init([](const std::string& name, int subimage, int miplevel,
                          const ImageSpec& config) {
                  return ImageBuf(name, subimage, miplevel, nullptr, &config);
@@ -387,6 +450,7 @@ declare_imagebuf(py::module& m)
         .def("get_pixels", &ImageBuf_get_pixels, "format"_a = TypeFloat,
              "roi"_a = ROI::All())
         .def("set_pixels", &ImageBuf_set_pixels_buffer, "roi"_a, "pixels"_a)
+        .def("pixels_view", &ImageBuf_pixels_view)
 
         .def_property_readonly("deep", &ImageBuf::deep)
         .def("deep_samples", &ImageBuf::deep_samples, "x"_a, "y"_a, "z"_a = 0)
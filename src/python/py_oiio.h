@@ -583,6 +583,46 @@ make_numpy_array(TypeDesc format, void* data, int dims, size_t chans,
 
 
 
+// Make a numpy array that refers to (does NOT copy or take ownership of)
+// the memory at data, with the given shape and byte strides. The array
+// holds a reference to base, which must keep the memory alive.
+template<class T>
+inline py::array_t<T>
+make_numpy_view(T* data, const std::vector<ssize_t>& shape,
+                const std::vector<ssize_t>& strides, py::handle base)
+{
+    return py::array_t<T>(shape, strides, data, base);
+}
+
+
+
+inline py::object
+make_numpy_view(TypeDesc format, void* data, const std::vector<ssize_t>& shape,
+                const std::vector<ssize_t>& strides, py::handle base)
+{
+    if (format == TypeDesc::FLOAT)
+        return make_numpy_view((float*)data, shape, strides, base);
+    if (format == TypeDesc::UINT8)
+        return make_numpy_view((unsigned char*)data, shape, strides, base);
+    if (format == TypeDesc::UINT16)
+        return make_numpy_view((unsigned short*)data, shape, strides, base);
+    if (format == TypeDesc::INT8)
+        return make_numpy_view((char*)data, shape, strides, base);
+    if (format == TypeDesc::INT16)
+        return make_numpy_view((short*)data, shape, strides, base);
+    if (format == TypeDesc::DOUBLE)
+        return make_numpy_view((double*)data, shape, strides, base);
+    if (format == TypeDesc::HALF)
+        return make_numpy_view((half*)data, shape, strides, base);
+    if (format == TypeDesc::UINT)
+        return make_numpy_view((unsigned int*)data, shape, strides, base);
+    if (format == TypeDesc::INT)
+        return make_numpy_view((int*)data, shape, strides, base);
+    return py::none();
+}
+
+
+
 inline py::object
 ParamValue_getitem(const ParamValue& self, bool allitems = false)
 {
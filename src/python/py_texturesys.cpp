@@ -4,6 +4,9 @@
 
 #include "py_oiio.h"
 
+#include <OpenImageIO/parallel.h>
+#include <OpenImageIO/thread.h>
+
 namespace PyOpenImageIO {
 
 
@@ -65,6 +68,129 @@ public:
 
 
 
+// Contiguous float arrays, converted from any array-like if necessary.
+typedef py::array_t<float, py::array::c_style | py::array::forcecast>
+    FloatArray;
+
+
+
+// Retrieve the data of an optional per-point input that must have n*dims
+// values, or nullptr if it is None (meaning all zero).
+static const float*
+batch_input(const py::object& obj, FloatArray& array, ssize_t n, int dims,
+            const char* name)
+{
+    if (obj.is_none())
+        return nullptr;
+    array = py::cast<FloatArray>(obj);
+    if (array.size() != n * dims)
+        throw std::invalid_argument(Strutil::sprintf(
+            "%s has %d values, expected %d", name, array.size(), n * dims));
+    return array.data();
+}
+
+
+
+// Set up a TextureOptBatch whose options are opt's, for every lane.
+static void
+batch_options(const TextureOpt& opt, TextureOptBatch& bopt)
+{
+    std::fill_n(bopt.sblur, Tex::BatchWidth, opt.sblur);
+    std::fill_n(bopt.tblur, Tex::BatchWidth, opt.tblur);
+    std::fill_n(bopt.rblur, Tex::BatchWidth, opt.rblur);
+    std::fill_n(bopt.swidth, Tex::BatchWidth, opt.swidth);
+    std::fill_n(bopt.twidth, Tex::BatchWidth, opt.twidth);
+    std::fill_n(bopt.rwidth, Tex::BatchWidth, opt.rwidth);
+    bopt.firstchannel        = opt.firstchannel;
+    bopt.subimage            = opt.subimage;
+    bopt.subimagename        = opt.subimagename;
+    bopt.swrap               = (Tex::Wrap)opt.swrap;
+    bopt.twrap               = (Tex::Wrap)opt.twrap;
+    bopt.rwrap               = (Tex::Wrap)opt.rwrap;
+    bopt.mipmode             = (Tex::MipMode)opt.mipmode;
+    bopt.interpmode          = (Tex::InterpMode)opt.interpmode;
+    bopt.anisotropic         = opt.anisotropic;
+    bopt.conservative_filter = opt.conservative_filter;
+    bopt.fill                = opt.fill;
+    bopt.missingcolor        = opt.missingcolor;
+}
+
+
+
+// Look up n points, Tex::BatchWidth at a time, with the batches spread
+// across the thread pool. `inputs` are ninputs per-point quantities, each
+// an array of n*dims[k] floats ([point][dim], or nullptr for all zero),
+// which are transposed into the batch layout ([dim][lane]) and passed to
+// lookup(handle, thread_info, options, mask, batchinputs, batchresult).
+// The result is stored as [point][channel]. If any lookup fails, return
+// false with the first error message in `error` (texture system errors are
+// per-thread, so the caller couldn't retrieve those of the worker threads
+// itself). The caller must not hold the GIL.
+template<class LOOKUP>
+static bool
+lookup_points(TextureSystem& ts, ustring filename, const TextureOpt& opt,
+              int64_t n, int ninputs, const float* const* inputs,
+              const int* dims, int nchannels, float* result,
+              std::string& error, LOOKUP lookup)
+{
+    const int B = Tex::BatchWidth;
+    TextureSystem::TextureHandle* handle = ts.get_texture_handle(filename);
+    if (!handle) {
+        std::fill_n(result, n * nchannels, 0.0f);
+        error = ts.geterror();
+        if (error.empty())
+            error = Strutil::sprintf("Could not find texture \"%s\"",
+                                     filename);
+        return false;
+    }
+    bool ok = true;
+    spin_mutex error_mutex;
+    parallel_for_chunked(0, n, 64 * B, [&](int64_t begin, int64_t end) {
+        TextureSystem::Perthread* thread_info = ts.get_perthread_info();
+        TextureOptBatch options;
+        batch_options(opt, options);
+        // Per-batch inputs and results, in the [dim][lane] layout
+        int nvalues = 0;
+        for (int k = 0; k < ninputs; ++k)
+            nvalues += dims[k];
+        std::vector<float> values(size_t(nvalues + nchannels) * B);
+        std::vector<float*> batchinputs(ninputs);
+        for (int k = 0, v = 0; k < ninputs; v += dims[k++])
+            batchinputs[k] = &values[size_t(v) * B];
+        float* batchresult = &values[size_t(nvalues) * B];
+
+        for (int64_t i = begin; i < end; i += B) {
+            int m             = int(std::min(int64_t(B), end - i));
+            Tex::RunMask mask = m == B ? Tex::RunMaskOn
+                                       : (Tex::RunMask(1) << m) - 1;
+            for (int k = 0; k < ninputs; ++k) {
+                float* in = batchinputs[k];
+                for (int d = 0; d < dims[k]; ++d)
+                    for (int j = 0; j < m; ++j)
+                        in[d * B + j] = inputs[k]
+                                            ? inputs[k][(i + j) * dims[k] + d]
+                                            : 0.0f;
+            }
+            if (!lookup(handle, thread_info, options, mask,
+                        batchinputs.data(), batchresult)) {
+                std::string err = ts.geterror();  // also clears it
+                spin_lock lock(error_mutex);
+                if (ok)
+                    error = err;
+                ok = false;
+            }
+            for (int j = 0; j < m; ++j)
+                for (int c = 0; c < nchannels; ++c)
+                    result[(i + j) * nchannels + c] = batchresult[c * B + j];
+        }
+    });
+    if (!ok && error.empty())
+        error = Strutil::sprintf("Texture lookup failed for \"%s\"", filename);
+    return ok;
+}
+
+
+
 void
 declare_wrap(py::module& m)
 {
@@ -282,6 +408,98 @@ declare_texturesystem(py::module& m)
             },
             "filename"_a, "options"_a, "R"_a, "dRdx"_a, "dRdy"_a, "nchannels"_a)
 
+        .def(
+            "texture_batch",
+            [](const TextureSystemWrap& ts, const std::string& filename,
+               TextureOptWrap& options, FloatArray s, FloatArray t,
+               int nchannels, const py::object& dsdx,
+               const py::object& dtdx, const py::object& dsdy,
+               const py::object& dtdy) -> py::object {
+                if (!ts.m_texsys || nchannels < 1)
+                    return py::none();
+                ssize_t n = s.size();
+                if (t.size() != n)
+                    throw std::invalid_argument(
+                        "texture_batch: s and t must be the same length");
+                FloatArray derivs[4];
+                const float* inputs[6]
+                    = { s.data(),
+                        t.data(),
+                        batch_input(dsdx, derivs[0], n, 1, "dsdx"),
+                        batch_input(dtdx, derivs[1], n, 1, "dtdx"),
+                        batch_input(dsdy, derivs[2], n, 1, "dsdy"),
+                        batch_input(dtdy, derivs[3], n, 1, "dtdy") };
+                const int dims[6] = { 1, 1, 1, 1, 1, 1 };
+                FloatArray result(std::vector<ssize_t> { n, nchannels });
+                float* out = result.mutable_data();
+                std::string error;
+                bool ok;
+                {
+                    py::gil_scoped_release gil;
+                    ok = lookup_points(
+                        *ts.m_texsys, ustring(filename), options, n, 6, inputs,
+                        dims, nchannels, out, error,
+                        [&](TextureSystem::TextureHandle* handle,
+                            TextureSystem::Perthread* thread_info,
+                            TextureOptBatch& opt, Tex::RunMask mask,
+                            const float* const* in, float* r) {
+                            return ts.m_texsys->texture(handle, thread_info,
+                                                        opt, mask, in[0], in[1],
+                                                        in[2], in[3], in[4],
+                                                        in[5], nchannels, r);
+                        });
+                }
+                if (!ok)
+                    throw std::runtime_error(error);
+                return result;
+            },
+            "filename"_a, "options"_a, "s"_a, "t"_a, "nchannels"_a,
+            "dsdx"_a = py::none(), "dtdx"_a = py::none(),
+            "dsdy"_a = py::none(), "dtdy"_a = py::none())
+
+        .def(
+            "environment_batch",
+            [](const TextureSystemWrap& ts, const std::string& filename,
+               TextureOptWrap& options, FloatArray R, int nchannels,
+               const py::object& dRdx, const py::object& dRdy) -> py::object {
+                if (!ts.m_texsys || nchannels < 1)
+                    return py::none();
+                if (R.size() % 3)
+                    throw std::invalid_argument(
+                        "environment_batch: R must be an array of 3-vectors");
+                ssize_t n = R.size() / 3;
+                FloatArray derivs[2];
+                const float* inputs[3]
+                    = { R.data(), batch_input(dRdx, derivs[0], n, 3, "dRdx"),
+                        batch_input(dRdy, derivs[1], n, 3, "dRdy") };
+                const int dims[3] = { 3, 3, 3 };
+                FloatArray result(std::vector<ssize_t> { n, nchannels });
+                float* out = result.mutable_data();
+                std::string error;
+                bool ok;
+                {
+                    py::gil_scoped_release gil;
+                    ok = lookup_points(
+                        *ts.m_texsys, ustring(filename), options, n, 3, inputs,
+                        dims, nchannels, out, error,
+                        [&](TextureSystem::TextureHandle* handle,
+                            TextureSystem::Perthread* thread_info,
+                            TextureOptBatch& opt, Tex::RunMask mask,
+                            const float* const* in, float* r) {
+                            return ts.m_texsys->environment(handle,
+                                                            thread_info, opt,
+                                                            mask, in[0], in[1],
+                                                            in[2], nchannels,
+                                                            r);
+                        });
+                }
+                if (!ok)
+                    throw std::runtime_error(error);
+                return result;
+            },
+            "filename"_a, "options"_a, "R"_a, "nchannels"_a,
+            "dRdx"_a = py::none(), "dRdy"_a = py::none())
+
         .def(
             "resolve_filename",
             [](TextureSystemWrap& ts, const std::string& filename) {
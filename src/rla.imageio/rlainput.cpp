@@ -24,7 +24,13 @@ public:
     RLAInput() { init(); }
     virtual ~RLAInput() { close(); }
     virtual const char* format_name(void) const override { return "rla"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
+    virtual bool open(const std::string& name, ImageSpec& newspec,
+                      const ImageSpec& config) override;
     virtual int current_subimage(void) const override
     {
         lock_guard lock(*this);
@@ -34,21 +40,28 @@ public:
     virtual bool close() override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;            ///< Stash the filename
-    FILE* m_file;                      ///< Open image handle
     RLAHeader m_rla;                   ///< Wavefront RLA header
     std::vector<unsigned char> m_buf;  ///< Buffer the image pixels
     int m_subimage;                    ///< Current subimage index
     std::vector<uint32_t> m_sot;       ///< Scanline offsets table
     int m_stride;                      ///< Number of bytes a contig pixel takes
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     /// Reset everything to initial state
     ///
     void init()
     {
-        m_file = NULL;
+        m_io = nullptr;
+        m_io_local.reset();
         m_buf.clear();
     }
 
@@ -56,11 +69,12 @@ private:
     ///
     bool fread(void* buf, size_t itemsize, size_t nitems)
     {
-        size_t n = ::fread(buf, itemsize, nitems, m_file);
-        if (n != nitems)
-            errorf("Read error: read %d records but %d expected %s", (int)n,
-                   (int)nitems, feof(m_file) ? " (hit EOF)" : "");
-        return n == nitems;
+        size_t n = m_io->read(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
+            errorf("Read error: read %d bytes but %d expected %s", (int)n,
+                   (int)(itemsize * nitems),
+                   m_io->tell() >= int64_t(m_io->size()) ? " (hit EOF)" : "");
+        return n == itemsize * nitems;
     }
 
     /// Helper: read buf[0..nitems-1], swap endianness if necessary
@@ -102,8 +116,7 @@ private:
     // debugging aid
     void preview(std::ostream& out)
     {
-        OIIO_DASSERT(!feof(m_file));
-        long pos = ftell(m_file);
+        int64_t pos = m_io->tell();
         out << "@" << pos << ", next 4 bytes are ";
         union {  // trickery to avoid punned pointer warnings
             unsigned char c[4];
@@ -121,7 +134,7 @@ private:
                                 u.c[0], ((char*)u.c)[0], u.c[1],
                                 ((char*)u.c)[1], u.c[2], ((char*)u.c)[2],
                                 u.c[3], ((char*)u.c)[3], s[0], s[1], i);
-        fseek(m_file, pos, SEEK_SET);
+        m_io->seek(pos);
     }
 };
 
@@ -155,8 +168,12 @@ RLAInput::open(const std::string& name, ImageSpec& newspec)
 {
     m_filename = name;
 
-    m_file = Filesystem::fopen(name, "rb");
-    if (!m_file) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorf("Could not open file \"%s\"", name);
         return false;
     }
@@ -171,6 +188,18 @@ RLAInput::open(const std::string& name, ImageSpec& newspec)
 
 
 
+bool
+RLAInput::open(const std::string& name, ImageSpec& newspec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, newspec);
+}
+
+
+
 inline bool
 RLAInput::read_header()
 {
@@ -227,14 +256,14 @@ RLAInput::seek_subimage(int subimage, int miplevel)
     if (subimage - current_subimage() < 0) {
         // If we are requesting an image earlier than the current one,
         // reset to the first subimage.
-        fseek(m_file, 0, SEEK_SET);
+        m_io->seek(0);
         if (!read_header())
             return false;  // read_header always calls error()
         diff = subimage;
     }
     // forward scrolling -- skip subimages until we're at the right place
     while (diff > 0 && m_rla.NextOffset != 0) {
-        if (!fseek(m_file, m_rla.NextOffset, SEEK_SET)) {
+        if (!m_io->seek(m_rla.NextOffset)) {
             errorf("Could not seek to header offset. Corrupted file?");
             return false;
         }
@@ -458,12 +487,7 @@ RLAInput::seek_subimage(int subimage, int miplevel)
 bool
 RLAInput::close()
 {
-    if (m_file) {
-        fclose(m_file);
-        m_file = NULL;
-    }
-
-    init();  // Reset to initial state
+    init();  // Reset to initial state, releasing any proxy we allocated
     return true;
 }
 
@@ -636,7 +660,7 @@ RLAInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
     y = m_spec.height - (y - m_spec.y) - 1;
 
     // Seek to scanline start, based on the scanline offset table
-    fseek(m_file, m_sot[y], SEEK_SET);
+    m_io->seek(m_sot[y]);
 
     // Now decode and interleave the channels.
     // The channels are non-interleaved (i.e. rrrrrgggggbbbbb...).
@@ -38,10 +38,16 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    std::string m_filename;  ///< Stash the filename
-    FILE* m_file;            ///< Open image handle
+    std::string m_filename;  ///< Stash the filename (empty if not open)
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::vector<unsigned char> m_scratch;
     RLAHeader m_rla;                   ///< Wavefront RLA header
     std::vector<uint32_t> m_sot;       ///< Scanline offset table
@@ -52,7 +58,9 @@ private:
     // Initialize private members to pre-opened state
     void init(void)
     {
-        m_file = NULL;
+        m_io = nullptr;
+        m_io_local.reset();
+        m_filename.clear();
         m_sot.clear();
     }
 
@@ -69,10 +77,11 @@ private:
     /// Helper - write, with error detection
     bool fwrite(const void* buf, size_t itemsize, size_t nitems)
     {
-        size_t n = ::fwrite(buf, itemsize, nitems, m_file);
-        if (n != nitems)
-            errorf("Write error: wrote %d records of %d", (int)n, (int)nitems);
-        return n == nitems;
+        size_t n = m_io->write(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
+            errorf("Write error: wrote %d bytes of %d", (int)n,
+                   (int)(itemsize * nitems));
+        return n == itemsize * nitems;
     }
 
     /// Helper: write buf[0..nitems-1], swap endianness if necessary
@@ -137,6 +146,8 @@ RLAOutput::supports(string_view feature) const
         return true;
     if (feature == "channelformats")
         return true;
+    if (feature == "ioproxy")
+        return true;
     // Support nothing else nonstandard
     return false;
 }
@@ -156,16 +167,28 @@ RLAOutput::open(const std::string& name, const ImageSpec& userspec,
         // anybody actually encounters a multi-subimage RLA in the wild.
     }
 
-    close();            // Close any already-opened file
+    // Close any already-opened file, but hold on to a proxy that was
+    // supplied with set_ioproxy() for the new one.
+    Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+    close();
+    m_io   = ioproxy;
     m_spec = userspec;  // Stash the spec
     if (m_spec.format == TypeDesc::UNKNOWN)
         m_spec.format = TypeDesc::UINT8;  // Default to uint8 if unknown
 
-    m_file = Filesystem::fopen(name, "wb");
-    if (!m_file) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", name);
         return false;
     }
+    m_filename = name;  // Also marks the file as open
 
     // Check for things this format doesn't support
     if (m_spec.width < 1 || m_spec.height < 1) {
@@ -401,7 +424,7 @@ RLAOutput::set_chromaticity(const ParamValue* p, char* dst, size_t field_size,
 bool
 RLAOutput::close()
 {
-    if (!m_file) {  // already closed
+    if (!m_io || m_filename.empty()) {  // already closed
         init();
         return true;
     }
@@ -417,12 +440,10 @@ RLAOutput::close()
 
     // Now that all scanlines have been output, return to write the
     // correct scanline offset table to file and close the stream.
-    fseek(m_file, sizeof(RLAHeader), SEEK_SET);
-    write(&m_sot[0], m_sot.size());
-    fclose(m_file);
-    m_file = NULL;
+    m_io->seek(sizeof(RLAHeader));
+    write(m_sot.data(), m_sot.size());
 
-    init();  // re-initialize
+    init();  // re-initialize, closing the stream if we opened it
     return ok;
 }
 
@@ -548,7 +569,7 @@ RLAOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
 
     // store the offset to the scanline.  We'll swap_endian if necessary
     // when we go to actually write it.
-    m_sot[m_spec.height - 1 - (y - m_spec.y)] = (uint32_t)ftell(m_file);
+    m_sot[m_spec.height - 1 - (y - m_spec.y)] = (uint32_t)m_io->tell();
 
     size_t pixelsize = m_spec.pixel_bytes(true /*native*/);
     int offset       = 0;
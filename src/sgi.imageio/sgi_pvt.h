@@ -6,7 +6,7 @@
 
 // Format reference: ftp://ftp.sgi.com/graphics/SGIIMAGESPEC
 
-#include <cstdio>
+#include <memory>
 
 #include <OpenImageIO/filesystem.h>
 #include <OpenImageIO/fmath.h>
@@ -67,14 +67,26 @@ public:
     SgiInput() { init(); }
     virtual ~SgiInput() { close(); }
     virtual const char* format_name(void) const override { return "sgi"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool valid_file(const std::string& filename) const override;
     virtual bool open(const std::string& name, ImageSpec& spec) override;
+    virtual bool open(const std::string& name, ImageSpec& spec,
+                      const ImageSpec& config) override;
     virtual bool close(void) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd = nullptr;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
     sgi_pvt::SgiHeader m_sgi_header;
     std::vector<uint32_t> start_tab;
@@ -82,7 +94,8 @@ private:
 
     void init()
     {
-        m_fd = nullptr;
+        m_io = nullptr;
+        m_io_local.reset();
         memset(&m_sgi_header, 0, sizeof(m_sgi_header));
     }
 
@@ -106,10 +119,10 @@ private:
     ///
     bool fread(void* buf, size_t itemsize, size_t nitems)
     {
-        size_t n = ::fread(buf, itemsize, nitems, m_fd);
-        if (n != nitems)
+        size_t n = m_io->read(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
             error("Read error");
-        return n == nitems;
+        return n == itemsize * nitems;
     }
 };
 
@@ -129,15 +142,26 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    FILE* m_fd = nullptr;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     std::string m_filename;
     std::vector<unsigned char> m_scratch;
     unsigned int m_dither;
     std::vector<unsigned char> m_tilebuffer;
 
-    void init() { m_fd = NULL; }
+    void init()
+    {
+        m_io = nullptr;
+        m_io_local.reset();
+        m_filename.clear();
+    }
 
     bool create_and_write_header();
 
@@ -145,11 +169,11 @@ private:
     template<class T>
     bool fwrite(const T* buf, size_t itemsize = sizeof(T), size_t nitems = 1)
     {
-        size_t n = std::fwrite(buf, itemsize, nitems, m_fd);
-        if (n != nitems)
-            errorfmt("Error writing \"{}\" (wrote {}/{} records)", m_filename,
-                     n, nitems);
-        return n == nitems;
+        size_t n = m_io->write(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
+            errorfmt("Error writing \"{}\" (wrote {}/{} bytes)", m_filename,
+                     n, itemsize * nitems);
+        return n == itemsize * nitems;
     }
 };
 
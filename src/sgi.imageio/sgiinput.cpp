@@ -52,11 +52,16 @@ SgiInput::open(const std::string& name, ImageSpec& spec)
     // saving name for later use
     m_filename = name;
 
-    m_fd = Filesystem::fopen(m_filename, "rb");
-    if (!m_fd) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorfmt("Could not open file \"{}\"", name);
         return false;
     }
+    m_io->seek(0);
 
     if (!read_header())
         return false;
@@ -114,6 +119,18 @@ SgiInput::open(const std::string& name, ImageSpec& spec)
 
 
 
+bool
+SgiInput::open(const std::string& name, ImageSpec& spec,
+               const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, spec);
+}
+
+
+
 bool
 SgiInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
                                void* data)
@@ -147,7 +164,7 @@ SgiInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
             ptrdiff_t off             = y + c * m_spec.height;
             ptrdiff_t scanline_offset = sgi_pvt::SGI_HEADER_LEN
                                         + off * m_spec.width * bpc;
-            Filesystem::fseek(m_fd, scanline_offset, SEEK_SET);
+            m_io->seek(scanline_offset);
             channeldata[c].resize(m_spec.width * bpc);
             if (!fread(&(channeldata[c][0]), 1, m_spec.width * bpc))
                 return false;
@@ -184,7 +201,7 @@ SgiInput::uncompress_rle_channel(int scanline_off, int scanline_len,
     int bpc = m_sgi_header.bpc;
     std::unique_ptr<unsigned char[]> rle_scanline(
         new unsigned char[scanline_len]);
-    Filesystem::fseek(m_fd, scanline_off, SEEK_SET);
+    m_io->seek(scanline_off);
     if (!fread(&rle_scanline[0], 1, scanline_len))
         return false;
     int limit = m_spec.width;
@@ -263,8 +280,8 @@ SgiInput::uncompress_rle_channel(int scanline_off, int scanline_len,
 bool
 SgiInput::close()
 {
-    if (m_fd)
-        fclose(m_fd);
+    // N.B. init() releases m_io_local if we allocated our own proxy, but
+    // never closes one that was supplied by the caller.
     init();
     return true;
 }
@@ -292,7 +309,7 @@ SgiInput::read_header()
         return false;
 
     //don't read dummy bytes
-    Filesystem::fseek(m_fd, 404, SEEK_CUR);
+    m_io->seek(404, SEEK_CUR);
 
     if (littleendian()) {
         swap_endian(&m_sgi_header.magic);
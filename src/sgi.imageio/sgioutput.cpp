@@ -23,7 +23,8 @@ OIIO_PLUGIN_EXPORTS_END
 int
 SgiOutput::supports(string_view feature) const
 {
-    return (feature == "alpha" || feature == "nchannels");
+    return (feature == "alpha" || feature == "nchannels"
+            || feature == "ioproxy");
 }
 
 
@@ -36,21 +37,31 @@ SgiOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
         return false;
     }
 
-    close();  // Close any already-opened file
-    // saving 'name' and 'spec' for later use
-    m_filename = name;
-    m_spec     = spec;
+    // Close any already-opened file, but hold on to a proxy that was
+    // supplied with set_ioproxy() for the new one.
+    Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+    close();
+    m_io   = ioproxy;
+    m_spec = spec;
 
     if (m_spec.width >= 65535 || m_spec.height >= 65535) {
         error("Exceeds the maximum resolution (65535)");
         return false;
     }
 
-    m_fd = Filesystem::fopen(m_filename, "wb");
-    if (!m_fd) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorfmt("Could not open \"{}\"", name);
         return false;
     }
+    m_filename = name;  // Also marks the file as open
 
     // SGI image files only supports UINT8 and UINT16.  If something
     // else was requested, revert to the one most likely to be readable
@@ -104,7 +115,7 @@ SgiOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
         ptrdiff_t scanline_offset = sgi_pvt::SGI_HEADER_LEN
                                     + ptrdiff_t(c * m_spec.height + y)
                                           * m_spec.width * bpc;
-        Filesystem::fseek(m_fd, scanline_offset, SEEK_SET);
+        m_io->seek(scanline_offset);
         if (!fwrite(&channeldata[0], 1, m_spec.width * bpc)) {
             return false;
         }
@@ -129,7 +140,7 @@ SgiOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
 bool
 SgiOutput::close()
 {
-    if (!m_fd) {  // already closed
+    if (!m_io || m_filename.empty()) {  // already closed
         init();
         return true;
     }
@@ -143,7 +154,6 @@ SgiOutput::close()
         std::vector<unsigned char>().swap(m_tilebuffer);
     }
 
-    fclose(m_fd);
     init();
     return ok;
 }
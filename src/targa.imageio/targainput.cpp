@@ -25,28 +25,39 @@ public:
     TGAInput() { init(); }
     virtual ~TGAInput() { close(); }
     virtual const char* format_name(void) const override { return "targa"; }
+    virtual int supports(string_view feature) const override
+    {
+        return feature == "ioproxy";
+    }
     virtual bool open(const std::string& name, ImageSpec& newspec) override;
     virtual bool open(const std::string& name, ImageSpec& newspec,
                       const ImageSpec& config) override;
     virtual bool close() override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;            ///< Stash the filename
-    FILE* m_file;                      ///< Open image handle
     tga_header m_tga;                  ///< Targa header
     tga_footer m_foot;                 ///< Targa 2.0 footer
     unsigned int m_ofs_colcorr_tbl;    ///< Offset to colour correction table
     tga_alpha_type m_alpha_type;       ///< Alpha type
     bool m_keep_unassociated_alpha;    ///< Do not convert unassociated alpha
     std::vector<unsigned char> m_buf;  ///< Buffer the image pixels
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     /// Reset everything to initial state
     ///
     void init()
     {
-        m_file = NULL;
+        m_io = nullptr;
+        m_io_local.reset();
         m_buf.clear();
         m_ofs_colcorr_tbl         = 0;
         m_alpha_type              = TGA_ALPHA_NONE;
@@ -66,10 +77,10 @@ private:
     ///
     bool fread(void* buf, size_t itemsize, size_t nitems)
     {
-        size_t n = ::fread(buf, itemsize, nitems, m_file);
-        if (n != nitems)
+        size_t n = m_io->read(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
             errorf("Read error");
-        return n == nitems;
+        return n == itemsize * nitems;
     }
 };
 
@@ -103,11 +114,16 @@ TGAInput::open(const std::string& name, ImageSpec& newspec)
 {
     m_filename = name;
 
-    m_file = Filesystem::fopen(name, "rb");
-    if (!m_file) {
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
         errorf("Could not open file \"%s\"", name);
         return false;
     }
+    m_io->seek(0);
 
     // due to struct packing, we may get a corrupt header if we just load the
     // struct from file; to address that, read every member individually
@@ -224,10 +240,10 @@ TGAInput::open(const std::string& name, ImageSpec& newspec)
         m_spec.attribute("targa:ImageID", id);
     }
 
-    int64_t ofs = Filesystem::ftell(m_file);
+    int64_t ofs = m_io->tell();
     // now try and see if it's a TGA 2.0 image
     // TGA 2.0 files are identified by a nifty "TRUEVISION-XFILE.\0" signature
-    fseek(m_file, -26, SEEK_END);
+    m_io->seek(-26, SEEK_END);
     if (fread(&m_foot.ofs_ext, sizeof(m_foot.ofs_ext), 1)
         && fread(&m_foot.ofs_dev, sizeof(m_foot.ofs_dev), 1)
         && fread(&m_foot.signature, sizeof(m_foot.signature), 1)
@@ -239,7 +255,7 @@ TGAInput::open(const std::string& name, ImageSpec& newspec)
         }
 
         // read the extension area
-        Filesystem::fseek(m_file, m_foot.ofs_ext, SEEK_SET);
+        m_io->seek(m_foot.ofs_ext);
         // check if this is a TGA 2.0 extension area
         // according to the 2.0 spec, the size for valid 2.0 files is exactly
         // 495 bytes, and the reader should only read as much as it understands
@@ -400,7 +416,7 @@ TGAInput::open(const std::string& name, ImageSpec& newspec)
 
             // now load the thumbnail
             if (ofs_thumb) {
-                Filesystem::fseek(m_file, ofs_thumb, SEEK_SET);
+                m_io->seek(ofs_thumb);
                 // Read the thumbnail dimensions -- sometimes it's 0x0 to
                 // indicate no thumbnail.
                 if (!fread(&buf.c, 2, 1))
@@ -427,12 +443,12 @@ TGAInput::open(const std::string& name, ImageSpec& newspec)
                 // read palette, if there is any
                 std::unique_ptr<unsigned char[]> palette;
                 if (m_tga.cmap_type) {
-                    fseek(m_file, ofs, SEEK_SET);
+                    m_io->seek(ofs);
                     palette.reset(
                         new unsigned char[palbytespp * m_tga.cmap_length]);
                     if (!fread(palette.get(), palbytespp, m_tga.cmap_length))
                         return false;
-                    fseek(m_file, ofs_thumb + 2, SEEK_SET);
+                    m_io->seek(ofs_thumb + 2);
                 }
                 unsigned char pixel[4];
                 unsigned char in[4];
@@ -465,7 +481,7 @@ TGAInput::open(const std::string& name, ImageSpec& newspec)
         if (m_keep_unassociated_alpha)
             m_spec.attribute("oiio:UnassociatedAlpha", 1);
 
-    fseek(m_file, ofs, SEEK_SET);
+    m_io->seek(ofs);
 
     newspec = spec();
     return true;
@@ -480,6 +496,9 @@ TGAInput::open(const std::string& name, ImageSpec& newspec,
     // Check 'config' for any special requests
     if (config.get_int_attribute("oiio:UnassociatedAlpha", 0) == 1)
         m_keep_unassociated_alpha = true;
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
     return open(name, newspec);
 }
 
@@ -764,12 +783,7 @@ TGAInput::readimg()
 bool
 TGAInput::close()
 {
-    if (m_file) {
-        fclose(m_file);
-        m_file = NULL;
-    }
-
-    init();  // Reset to initial state
+    init();  // Reset to initial state, releasing any proxy we allocated
     return true;
 }
 
@@ -27,7 +27,7 @@ public:
     virtual const char* format_name(void) const override { return "targa"; }
     virtual int supports(string_view feature) const override
     {
-        return (feature == "alpha");
+        return (feature == "alpha" || feature == "ioproxy");
     }
     virtual bool open(const std::string& name, const ImageSpec& spec,
                       OpenMode mode = Create) override;
@@ -37,10 +37,14 @@ public:
     virtual bool write_tile(int x, int y, int z, TypeDesc format,
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
-    std::string m_filename;  ///< Stash the filename
-    FILE* m_file;            ///< Open image handle
+    std::string m_filename;  ///< Stash the filename (empty if not open)
     bool m_want_rle;         ///< Whether the client asked for RLE
     bool m_convert_alpha;    ///< Do we deassociate alpha?
     float m_gamma;           ///< Gamma to use for alpha conversion
@@ -48,13 +52,17 @@ private:
     int m_idlen;  ///< Length of the TGA ID block
     unsigned int m_dither;
     std::vector<unsigned char> m_tilebuffer;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     // Initialize private members to pre-opened state
     void init(void)
     {
-        m_file          = NULL;
+        m_io            = nullptr;
         m_convert_alpha = true;
         m_gamma         = 1.0;
+        m_io_local.reset();
+        m_filename.clear();
     }
 
     // Helper function to write the TGA 2.0 data fields, called by close()
@@ -74,10 +82,11 @@ private:
     {
         if (itemsize * nitems == 0)
             return true;
-        size_t n = std::fwrite(buf, itemsize, nitems, m_file);
-        if (n != nitems)
-            errorf("Write error: wrote %d records of %d", (int)n, (int)nitems);
-        return n == nitems;
+        size_t n = m_io->write(buf, itemsize * nitems);
+        if (n != itemsize * nitems)
+            errorf("Write error: wrote %d bytes of %d", (int)n,
+                   (int)(itemsize * nitems));
+        return n == itemsize * nitems;
     }
 
     /// Helper -- write a 'short' with byte swapping if necessary
@@ -97,9 +106,12 @@ private:
     /// Helper -- pad with zeroes
     bool pad(size_t n = 1)
     {
-        while (n--)
-            if (fputc(0, m_file))
+        static const char zeroes[64] = { 0 };
+        for (size_t c; n; n -= c) {
+            c = std::min(n, sizeof(zeroes));
+            if (m_io->write(zeroes, c) != c)
                 return false;
+        }
         return true;
     }
 
@@ -150,7 +162,11 @@ TGAOutput::open(const std::string& name, const ImageSpec& userspec,
         return false;
     }
 
-    close();            // Close any already-opened file
+    // Close any already-opened file, but hold on to a proxy that was
+    // supplied with set_ioproxy() for the new one.
+    Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+    close();
+    m_io   = ioproxy;
     m_spec = userspec;  // Stash the spec
 
     // Check for things this format doesn't support
@@ -186,8 +202,15 @@ TGAOutput::open(const std::string& name, const ImageSpec& userspec,
         return false;
     }
 
-    m_file = Filesystem::fopen(name, "wb");
-    if (!m_file) {
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
         errorf("Could not open \"%s\"", name);
         return false;
     }
@@ -262,19 +285,18 @@ TGAOutput::open(const std::string& name, const ImageSpec& userspec,
         || !fwrite(&tga.cmap_size) || !fwrite(&tga.x_origin)
         || !fwrite(&tga.y_origin) || !fwrite(&tga.width) || !fwrite(&tga.height)
         || !fwrite(&tga.bpp) || !fwrite(&tga.attr)) {
-        fclose(m_file);
-        m_file = NULL;
+        init();
         return false;
     }
 
     // dump comment to file, don't bother about null termination
     if (tga.idlen) {
         if (!fwrite(id.c_str(), tga.idlen)) {
-            fclose(m_file);
-            m_file = NULL;
+            init();
             return false;
         }
     }
+    m_filename = name;  // Also marks the file as open
 
     // If user asked for tiles -- which this format doesn't support, emulate
     // it by buffering the whole image.
@@ -289,14 +311,14 @@ TGAOutput::open(const std::string& name, const ImageSpec& userspec,
 bool
 TGAOutput::write_tga20_data_fields()
 {
-    if (m_file) {
+    if (m_io) {
         // write out the TGA 2.0 data fields
 
         // FIXME: write out the developer area; according to Larry,
         // it's probably safe to ignore it altogether until someone complains
         // that it's missing :)
 
-        Filesystem::fseek(m_file, 0, SEEK_END);
+        m_io->seek(0, SEEK_END);
 
         // write out the thumbnail, if there is one
         uint32_t ofs_thumb = 0;
@@ -306,7 +328,7 @@ TGAOutput::write_tga20_data_fields()
         if (tw && th && tc == m_spec.nchannels) {
             ParamValue* p = m_spec.find_attribute("thumbnail_image");
             if (p) {
-                ofs_thumb = (uint32_t)ftell(m_file);
+                ofs_thumb = (uint32_t)m_io->tell();
                 // dump thumbnail size
                 if (!fwrite(&tw) || !fwrite(&th)
                     || !fwrite(p->data(), p->datasize())) {
@@ -316,7 +338,7 @@ TGAOutput::write_tga20_data_fields()
         }
 
         // prepare the footer
-        tga_footer foot = { (uint32_t)ftell(m_file), 0, "TRUEVISION-XFILE." };
+        tga_footer foot = { (uint32_t)m_io->tell(), 0, "TRUEVISION-XFILE." };
 
         // write out the extension area
 
@@ -441,7 +463,7 @@ TGAOutput::write_tga20_data_fields()
 bool
 TGAOutput::close()
 {
-    if (!m_file) {  // already closed
+    if (!m_io || m_filename.empty()) {  // already closed
         init();
         return true;
     }
@@ -456,10 +478,7 @@ TGAOutput::close()
     }
 
     ok &= write_tga20_data_fields();
-    fclose(m_file);  // close the stream
-    m_file = NULL;
-
-    init();  // re-initialize
+    init();  // re-initialize, closing the stream if we opened it
     return ok;
 }
 
@@ -684,9 +703,7 @@ TGAOutput::write_scanline(int y, int z, TypeDesc format, const void* data,
         // seek to the correct scanline
         int n     = m_spec.nchannels;
         int64_t w = m_spec.width;
-        Filesystem::fseek(m_file,
-                          18 + m_idlen + int64_t(m_spec.height - y - 1) * w * n,
-                          SEEK_SET);
+        m_io->seek(18 + m_idlen + int64_t(m_spec.height - y - 1) * w * n);
         if (n <= 2) {
             // 1- and 2-channels can write directly
             if (!fwrite(bdata, n, w)) {
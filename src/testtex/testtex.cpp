@@ -3,6 +3,8 @@
 // https://github.com/OpenImageIO/oiio/blob/master/LICENSE.md
 
 
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -14,6 +16,7 @@
 #include <OpenImageIO/argparse.h>
 #include <OpenImageIO/benchmark.h>
 #include <OpenImageIO/filesystem.h>
+#include <OpenImageIO/hash.h>
 #include <OpenImageIO/imagebuf.h>
 #include <OpenImageIO/imagebufalgo.h>
 #include <OpenImageIO/imagebufalgo_util.h>
@@ -25,6 +28,7 @@
 #include <OpenImageIO/ustring.h>
 
 #include "../libtexture/imagecache_pvt.h"
+#include "../libtexture/texturetrace.h"
 
 using namespace OIIO;
 
@@ -81,6 +85,7 @@ static bool invalidate_before_iter = true;
 static bool close_before_iter      = false;
 static Imath::M33f xform;
 static std::string texoptions;
+static std::string replay_filename;
 void* dummyptr;
 
 typedef void (*Mapping2D)(const int&, const int&, float&, float&, float&,
@@ -211,12 +216,14 @@ getargs(int argc, const char* argv[])
       .help("Test ImageCache write ability (1=seeded, 2=generated)");
     ap.arg("--teststatquery", &test_statquery)
       .help("Test queries of statistics");
+    ap.arg("--replay %s:TRACEFILE", &replay_filename)
+      .help("Replay a trace captured with the \"trace_file\" attribute, and report timings");
 
     // clang-format on
     ap.parse(argc, argv);
 
     if (filenames.size() < 1 && !test_construction && !test_getimagespec
-        && !testhash) {
+        && !testhash && replay_filename.empty()) {
         std::cerr << "testtex: Must have at least one input file\n";
         ap.usage();
         exit(EXIT_FAILURE);
@@ -1285,6 +1292,128 @@ launch_tex_threads(int numthreads, int iterations)
 
 
 
+// Replay one thread's share of the traced lookups, in their original
+// order. Record the latency of each lookup, and accumulate a checksum of
+// the results that doesn't depend on how the lookups were divided among
+// the threads.
+static void
+replay_thread(const pvt::TextureTraceReader& reader,
+              const std::vector<pvt::TraceLookupRecord>& records,
+              std::vector<float>& latencies, uint64_t& checksum)
+{
+    using clock = std::chrono::steady_clock;
+    TextureSystem::Perthread* perthread_info = texsys->get_perthread_info();
+    std::vector<TextureSystem::TextureHandle*> handles;
+    latencies.reserve(records.size());
+    checksum = 0;
+    for (auto& rec : records) {
+        if (rec.file >= handles.size())
+            handles.resize(rec.file + 1, nullptr);
+        if (!handles[rec.file])
+            handles[rec.file]
+                = texsys->get_texture_handle(reader.string(rec.file),
+                                             perthread_info);
+        TextureOpt opt   = rec.options();
+        opt.subimagename = reader.string(rec.subimagename);
+        int nchannels    = std::min(int(rec.nchannels), 4);
+        bool derivs      = (rec.flags & pvt::TraceLookupRecord::Derivs);
+        float result[4]  = { 0, 0, 0, 0 };
+        float dresultds[4], dresultdt[4];
+
+        auto start = clock::now();
+        texsys->texture(handles[rec.file], perthread_info, opt, rec.s, rec.t,
+                        rec.dsdx, rec.dtdx, rec.dsdy, rec.dtdy, nchannels,
+                        result, derivs ? dresultds : nullptr,
+                        derivs ? dresultdt : nullptr);
+        auto end = clock::now();
+        latencies.push_back(
+            std::chrono::duration<float, std::micro>(end - start).count());
+        checksum += fasthash::fasthash64(result, nchannels * sizeof(float));
+    }
+}
+
+
+
+static void
+replay_trace(const std::string& tracefile)
+{
+    pvt::TextureTraceReader reader;
+    if (!reader.open(tracefile)) {
+        Strutil::fprintf(std::cerr, "testtex: %s\n", reader.error());
+        return;
+    }
+    int nt = nthreads ? nthreads : Sysutil::hardware_concurrency();
+    std::vector<std::vector<pvt::TraceLookupRecord>> work(nt);
+    pvt::TraceLookupRecord rec;
+    size_t nlookups            = 0;
+    uint32_t nrecorded_threads = 0;
+    while (reader.read(rec)) {
+        work[rec.thread % nt].push_back(rec);
+        nrecorded_threads = std::max(nrecorded_threads, rec.thread + 1);
+        ++nlookups;
+    }
+    if (reader.error().size())
+        Strutil::fprintf(std::cerr, "testtex: %s (replaying %d lookups)\n",
+                         reader.error(), nlookups);
+
+    if (invalidate_before_iter)
+        texsys->invalidate_all(true);
+    texsys->reset_stats();
+    std::vector<std::vector<float>> latencies(nt);
+    std::vector<uint64_t> checksums(nt, 0);
+    Timer timer;
+    OIIO::thread_group threads;
+    for (int i = 0; i < nt; ++i)
+        threads.create_thread(std::bind(replay_thread, std::cref(reader),
+                                        std::cref(work[i]),
+                                        std::ref(latencies[i]),
+                                        std::ref(checksums[i])));
+    threads.join_all();
+    double time = timer();
+
+    std::vector<float> all;
+    all.reserve(nlookups);
+    uint64_t checksum = 0;
+    for (int i = 0; i < nt; ++i) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        checksum += checksums[i];
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) {
+        return all.size() ? all[std::min(all.size() - 1,
+                                         size_t(p * 0.01 * all.size()))]
+                          : 0.0f;
+    };
+
+    long long find_tile_calls   = 0;
+    long long microcache_misses = 0;
+    int cache_misses            = 0;
+    texsys->getattribute("stat:find_tile_calls", TypeInt64, &find_tile_calls);
+    texsys->getattribute("stat:find_tile_microcache_misses", TypeInt64,
+                         &microcache_misses);
+    texsys->getattribute("stat:find_tile_cache_misses", TypeInt, &cache_misses);
+
+    std::cout << Strutil::sprintf(
+        "Replayed %d lookups (from %d recorded threads) on %d threads\n",
+        nlookups, nrecorded_threads, nt);
+    std::cout << Strutil::sprintf("  Time: %.3f s, %.3f Mlookups/s\n", time,
+                                  time > 0 ? 1.0e-6 * nlookups / time : 0.0);
+    std::cout << Strutil::sprintf(
+        "  Latency (us): p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  max %.2f\n",
+        percentile(50), percentile(90), percentile(99), percentile(99.9),
+        all.size() ? all.back() : 0.0f);
+    if (find_tile_calls)
+        std::cout << Strutil::sprintf(
+            "  Tile hit rates: microcache %.2f%%, main cache %.2f%%\n",
+            100.0 * (find_tile_calls - microcache_misses) / find_tile_calls,
+            microcache_misses ? 100.0 * (microcache_misses - cache_misses)
+                                    / microcache_misses
+                              : 100.0);
+    std::cout << Strutil::sprintf("  Result checksum: %016x\n", checksum);
+}
+
+
+
 class GridImageInput final : public ImageInput {
 public:
     GridImageInput()
@@ -1495,6 +1624,11 @@ main(int argc, const char* argv[])
         test_hash();
     }
 
+    if (replay_filename.size()) {
+        replay_trace(replay_filename);
+        iters = 0;
+    }
+
     Imath::M33f scale;
     scale.scale(Imath::V2f(0.3, 0.3));
     Imath::M33f rot;
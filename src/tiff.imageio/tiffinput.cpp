@@ -405,41 +405,18 @@ private:
             }
     }
 
-    void uncompress_one_strip(void* compressed_buf, unsigned long csize,
-                              void* uncompressed_buf, size_t strip_bytes,
-                              int channels, int width, int height, bool* ok)
-    {
-        OIIO_DASSERT (m_compression == COMPRESSION_ADOBE_DEFLATE /*||
-                      m_compression == COMPRESSION_NONE*/);
-        if (m_compression == COMPRESSION_NONE) {
-            // just copy if there's no compression
-            memcpy(uncompressed_buf, compressed_buf, csize);
-            if (m_is_byte_swapped && m_spec.format == TypeUInt16)
-                TIFFSwabArrayOfShort((unsigned short*)uncompressed_buf,
-                                     width * height * channels);
-            return;
-        }
-        uLong uncompressed_size = (uLong)strip_bytes;
-        auto zok = uncompress((Bytef*)uncompressed_buf, &uncompressed_size,
-                              (const Bytef*)compressed_buf, csize);
-        if (zok != Z_OK || uncompressed_size != strip_bytes) {
-            *ok = false;
-            return;
-        }
-        if (m_is_byte_swapped && m_spec.format == TypeUInt16)
-            TIFFSwabArrayOfShort((unsigned short*)uncompressed_buf,
-                                 width * height * channels);
-        if (m_predictor == PREDICTOR_HORIZONTAL) {
-            if (m_spec.format == TypeUInt8)
-                undo_horizontal_predictor((unsigned char*)uncompressed_buf,
-                                          (unsigned char*)uncompressed_buf,
-                                          channels, width, height);
-            else if (m_spec.format == TypeUInt16)
-                undo_horizontal_predictor((unsigned short*)uncompressed_buf,
-                                          (unsigned short*)uncompressed_buf,
-                                          channels, width, height);
-        }
-    }
+    // Can we decode raw (still compressed) strips or tiles ourselves,
+    // and therefore in parallel, rather than leaving it to libtiff, which
+    // is totally serialized?
+    bool can_decode_raw_chunks() const;
+
+    // Decode one raw strip or tile (of one plane, for "separate"
+    // planarconfig) of chans x width x height values into ubytes bytes at
+    // ubuf, undoing any predictor and byte swapping. Return false if it
+    // couldn't be decoded, in which case the caller should fall back to
+    // having libtiff read it.
+    bool decode_raw_chunk(const void* cbuf, size_t csize, void* ubuf,
+                          size_t ubytes, int chans, int width, int height);
 
     int tile_index(int x, int y, int z)
     {
@@ -1729,17 +1706,251 @@ TIFFInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
 
 
 
+// Generous upper bound on the raw size of a chunk that decodes to
+// `bytes` bytes, for any of the compression methods we decode ourselves
+// (LZW can expand incompressible data by as much as 50%). A chunk that
+// is bigger than this anyway is simply read truncated, will fail to
+// decode, and gets handed back to libtiff.
+static size_t
+raw_chunk_bound(size_t bytes)
+{
+    return std::max(size_t(compressBound(uLong(bytes))),
+                    bytes + bytes / 2 + 1024);
+}
+
+
+
+// Decode TIFF's flavor of LZW: codes are packed most significant bit
+// first, and the code width grows one code earlier than in classic LZW.
+// Old-style (pre-TIFF 6.0, LSB first) LZW is not handled. Return true
+// only if exactly outsize bytes were decoded.
+static bool
+lzw_decode(const unsigned char* in, size_t insize, unsigned char* out,
+           size_t outsize)
+{
+    if (insize >= 2 && in[0] == 0 && (in[1] & 1))
+        return false;  // Old-style LZW, leave it to libtiff
+    const int Clear = 256, EOI = 257, MaxCode = 4096;
+    uint16_t prefix[MaxCode], length[MaxCode];
+    unsigned char suffix[MaxCode], first[MaxCode];
+    for (int c = 0; c < 256; ++c) {
+        prefix[c] = 0;
+        length[c] = 1;
+        suffix[c] = first[c] = (unsigned char)c;
+    }
+    size_t bitpos = 0, inbits = insize * 8, outpos = 0;
+    int nbits = 9, next = EOI + 1, prev = -1;
+    while (bitpos + nbits <= inbits) {
+        size_t byte = bitpos >> 3;
+        uint32_t bits = uint32_t(in[byte]) << 16;
+        if (byte + 1 < insize)
+            bits |= uint32_t(in[byte + 1]) << 8;
+        if (byte + 2 < insize)
+            bits |= uint32_t(in[byte + 2]);
+        int code = (bits >> (24 - int(bitpos & 7) - nbits))
+                   & ((1 << nbits) - 1);
+        bitpos += nbits;
+        if (code == EOI)
+            break;
+        if (code == Clear) {
+            nbits = 9;
+            next  = EOI + 1;
+            prev  = -1;
+            continue;
+        }
+        if (prev < 0) {
+            // First code after a clear is always a literal
+            if (code > 255 || outpos >= outsize)
+                return false;
+            out[outpos++] = (unsigned char)code;
+            prev          = code;
+            continue;
+        }
+        if (code > next || (code == next && next == MaxCode))
+            return false;
+        if (next < MaxCode) {
+            // New entry is the previous string plus the first character
+            // of this one (which, if this code is the entry we're about
+            // to add, is the first character of the previous string).
+            prefix[next] = uint16_t(prev);
+            suffix[next] = first[code < next ? code : prev];
+            first[next]  = first[prev];
+            length[next] = length[prev] + 1;
+            if (++next >= (1 << nbits) - 1 && nbits < 12)
+                ++nbits;
+        }
+        size_t len = length[code];
+        if (outpos + len > outsize)
+            return false;
+        unsigned char* o = out + outpos + len;
+        for (int c = code;; c = prefix[c]) {
+            *--o = suffix[c];
+            if (c < 256)
+                break;
+        }
+        outpos += len;
+        prev = code;
+    }
+    return outpos == outsize;
+}
+
+
+
+static bool
+packbits_decode(const unsigned char* in, size_t insize, unsigned char* out,
+                size_t outsize)
+{
+    size_t i = 0, o = 0;
+    while (i < insize && o < outsize) {
+        int n = (signed char)in[i++];
+        if (n >= 0) {  // n+1 literal bytes
+            size_t count = size_t(n) + 1;
+            if (i + count > insize || o + count > outsize)
+                return false;
+            memcpy(out + o, in + i, count);
+            i += count;
+            o += count;
+        } else if (n != -128) {  // next byte repeated 1-n times
+            size_t count = size_t(1 - n);
+            if (i >= insize || o + count > outsize)
+                return false;
+            memset(out + o, in[i++], count);
+            o += count;
+        }
+    }
+    return o == outsize;
+}
+
+
+
+// Undo the floating point predictor on height rows of chans x width
+// values of elemsize bytes each. The encoder split each row's bytes into
+// planes (most significant byte first), then differenced them.
+static void
+undo_float_predictor(unsigned char* data, int elemsize, int chans, int width,
+                     int height)
+{
+    size_t nvals    = size_t(width) * chans;
+    size_t rowbytes = nvals * elemsize;
+    std::unique_ptr<unsigned char[]> tmp(new unsigned char[rowbytes]);
+    for (int y = 0; y < height; ++y, data += rowbytes) {
+        for (size_t i = chans; i < rowbytes; ++i)
+            data[i] += data[i - chans];
+        memcpy(tmp.get(), data, rowbytes);
+        for (size_t v = 0; v < nvals; ++v)
+            for (int b = 0; b < elemsize; ++b)
+                data[v * elemsize + b]
+                    = tmp[(littleendian() ? elemsize - 1 - b : b) * nvals + v];
+    }
+}
+
+
+
+bool
+TIFFInput::can_decode_raw_chunks() const
+{
+    size_t elemsize = m_spec.format.size();
+    bool predicted  = (m_compression == COMPRESSION_ADOBE_DEFLATE
+                      || m_compression == COMPRESSION_DEFLATE
+                      || m_compression == COMPRESSION_LZW);
+    return (predicted || m_compression == COMPRESSION_NONE
+            || m_compression == COMPRESSION_PACKBITS)
+           // predictors we know how to undo
+           && (!predicted || m_predictor == PREDICTOR_NONE
+               || m_predictor == PREDICTOR_HORIZONTAL
+               || (m_predictor == PREDICTOR_FLOATINGPOINT
+                   && m_spec.format.is_floating_point()))
+           // no non-multiple-of-8 bits per sample
+           && elemsize * 8 == m_bitspersample
+           // and not palette or cmyk color separated conversions
+           && m_photometric != PHOTOMETRIC_SEPARATED
+           && m_photometric != PHOTOMETRIC_PALETTE
+           // No other unusual cases
+           && !m_use_rgba_interface;
+}
+
+
+
+bool
+TIFFInput::decode_raw_chunk(const void* cbuf, size_t csize, void* ubuf,
+                            size_t ubytes, int chans, int width, int height)
+{
+    const unsigned char* in = (const unsigned char*)cbuf;
+    unsigned char* out      = (unsigned char*)ubuf;
+    int predictor           = PREDICTOR_NONE;
+    switch (m_compression) {
+    case COMPRESSION_NONE:
+        if (csize < ubytes)
+            return false;
+        memcpy(out, in, ubytes);
+        break;
+    case COMPRESSION_ADOBE_DEFLATE:
+    case COMPRESSION_DEFLATE: {
+        uLong uncompressed_size = (uLong)ubytes;
+        if (uncompress(out, &uncompressed_size, in, uLong(csize)) != Z_OK
+            || uncompressed_size != ubytes)
+            return false;
+        predictor = m_predictor;
+        break;
+    }
+    case COMPRESSION_LZW:
+        if (!lzw_decode(in, csize, out, ubytes))
+            return false;
+        predictor = m_predictor;
+        break;
+    case COMPRESSION_PACKBITS:
+        if (!packbits_decode(in, csize, out, ubytes))
+            return false;
+        break;
+    default: return false;
+    }
+
+    int elemsize = int(m_spec.format.size());
+    if (predictor == PREDICTOR_FLOATINGPOINT) {
+        // Leaves the values in native byte order, no swapping needed
+        undo_float_predictor(out, elemsize, chans, width, height);
+        return true;
+    }
+    if (m_is_byte_swapped) {
+        tmsize_t nvals = tmsize_t(ubytes / elemsize);
+        if (elemsize == 2)
+            TIFFSwabArrayOfShort((unsigned short*)out, nvals);
+        else if (elemsize == 4)
+            TIFFSwabArrayOfLong((uint32_t*)out, nvals);
+        else if (elemsize == 8)
+            TIFFSwabArrayOfDouble((double*)out, nvals);
+    }
+    if (predictor == PREDICTOR_HORIZONTAL) {
+        if (elemsize == 1)
+            undo_horizontal_predictor(out, out, chans, width, height);
+        else if (elemsize == 2)
+            undo_horizontal_predictor((unsigned short*)out,
+                                      (unsigned short*)out, chans, width,
+                                      height);
+        else if (elemsize == 4)
+            undo_horizontal_predictor((uint32_t*)out, (uint32_t*)out, chans,
+                                      width, height);
+        else if (elemsize == 8)
+            undo_horizontal_predictor((uint64_t*)out, (uint64_t*)out, chans,
+                                      width, height);
+    }
+    return true;
+}
+
+
+
 bool
 TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
                                  int yend, int z, void* data)
 {
     // If the stars all align properly, try to read strips, and use the
     // thread pool to parallelize the decompression. This can give a large
-    // speedup (5x or more!) because the zip decompression dwarfs the
-    // actual raw I/O. But libtiff is totally serialized, so we can only
-    // parallelize by reading raw (compressed) strips then making calls to
-    // zlib ourselves to decompress. Don't bother trying to handle any of
-    // the uncommon cases with strips. This covers most real-world cases.
+    // speedup (5x or more!) because the decompression dwarfs the actual
+    // raw I/O. But libtiff is totally serialized, so we can only
+    // parallelize by reading raw (compressed) strips then decoding them
+    // ourselves (see can_decode_raw_chunks() for what we handle). Don't
+    // bother trying to handle any of the uncommon cases with strips. This
+    // covers most real-world cases.
     lock_guard lock(*this);
     if (!seek_subimage(subimage, miplevel))
         return false;
@@ -1772,17 +1983,7 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
 
     // Are we reading raw (compressed) strips and doing the decompression
     // ourselves?
-    bool read_raw_strips =
-        // only deflate/zip compression
-        (m_compression
-         == COMPRESSION_ADOBE_DEFLATE /*|| m_compression == COMPRESSION_NONE*/)
-        // only horizontal predictor (or none)
-        && (m_predictor == PREDICTOR_HORIZONTAL
-            || m_predictor == PREDICTOR_NONE)
-        // contig planarconfig only (for now?)
-        && !m_separate
-        // only uint8, uint16
-        && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16);
+    bool read_raw_strips = can_decode_raw_chunks();
 
     // We know we wish to read as strips. But additionally, there are some
     // circumstances in which we want to read RAW strips, and do the
@@ -1794,9 +1995,9 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
         nstrips > 1
         // only if we are reading scanlines in order
         && ybegin == m_next_scanline
-        // only if we're threading and don't enter the thread pool recursively!
+        // only if we're threading (it's fine if we're already running
+        // inside a pool task, the work will nest)
         && pool->size() > 1
-        && !pool->is_worker()
         // and not if the feature is turned off
         && m_spec.get_int_attribute("tiff:multithread",
                                     OIIO::get_int_attribute("tiff:multithread"));
@@ -1814,46 +2015,105 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
     int stripvals = m_spec.width * stripchans
                     * m_rowsperstrip;  // values in a strip
     imagesize_t strip_bytes = stripvals * m_spec.format.size();
-    size_t cbound           = compressBound((uLong)strip_bytes);
+    size_t cbound           = raw_chunk_bound(strip_bytes);
     std::unique_ptr<char[]> compressed_scratch;
     std::unique_ptr<char[]> separate_tmp(
         m_separate ? new char[strip_bytes * nstrips * planes] : nullptr);
 
     if (read_raw_strips) {
-        // Make room for, and read the raw (still compressed) strips. As each
-        // one is read, kick off the decompress and any other extras, to execute
-        // in parallel.
+        // Make room for, and read the raw (still compressed) strips, one
+        // per plane for "separate" planarconfig. As each one is read, kick
+        // off the decoding and any other extras, to execute in parallel.
+        // Any strip we fail to decode ourselves is left for libtiff to
+        // read after the others are done.
         compressed_scratch.reset(new char[cbound * nstrips * planes]);
-        for (size_t stripidx = 0; y + m_rowsperstrip <= yend;
-             y += m_rowsperstrip, ++stripidx) {
-            char* cbuf        = compressed_scratch.get() + stripidx * cbound;
-            tstrip_t stripnum = (y - m_spec.y) / m_rowsperstrip;
-            tsize_t csize     = TIFFReadRawStrip(m_tif, stripnum, cbuf,
-                                             tmsize_t(cbound));
-            if (csize < 0) {
-                std::string err = oiio_tiff_last_error();
-                errorf("TIFFRead%sStrip failed reading line y=%d,z=%d: %s",
-                       read_raw_strips ? "Raw" : "Encoded", y, z,
-                       err.size() ? err.c_str() : "unknown error");
-                ok = false;
+        std::unique_ptr<tsize_t[]> csizes(new tsize_t[nstrips * planes]);
+        std::unique_ptr<bool[]> failed_scratch(new bool[nstrips]());
+        bool* failed      = failed_scratch.get();
+        auto out          = this;
+        auto finish_strip = [=](char* ubuf, char* dst) {
+            if (out->m_photometric == PHOTOMETRIC_MINISWHITE)
+                out->invert_photometric(stripvals * planes, ubuf);
+            if (out->m_separate)
+                out->separate_to_contig(planes,
+                                        out->m_spec.width * out->m_rowsperstrip,
+                                        (unsigned char*)ubuf,
+                                        (unsigned char*)dst);
+        };
+        size_t nraw = 0;
+        for (; y + m_rowsperstrip <= yend; y += m_rowsperstrip, ++nraw) {
+            char* cbuf     = compressed_scratch.get() + nraw * planes * cbound;
+            tsize_t* csize = csizes.get() + nraw * planes;
+            bool read_ok   = true;
+            for (int c = 0; c < planes; ++c) {
+                tstrip_t stripnum = TIFFComputeStrip(m_tif, y - m_spec.y, c);
+                csize[c] = TIFFReadRawStrip(m_tif, stripnum, cbuf + c * cbound,
+                                            tmsize_t(cbound));
+                if (csize[c] < 0) {
+                    std::string err = oiio_tiff_last_error();
+                    errorf("TIFFReadRawStrip failed reading line y=%d,z=%d: %s",
+                           y, z, err.size() ? err.c_str() : "unknown error");
+                    read_ok = false;
+                }
             }
-            auto out            = this;
-            auto uncompress_etc = [=, &ok](int /*id*/) {
-                out->uncompress_one_strip(cbuf, (unsigned long)csize, data,
-                                          strip_bytes, out->m_spec.nchannels,
-                                          out->m_spec.width,
-                                          out->m_rowsperstrip, &ok);
-                if (out->m_photometric == PHOTOMETRIC_MINISWHITE)
-                    out->invert_photometric(stripvals * stripchans, data);
+            if (!read_ok) {
+                // Nothing to decode for this strip
+                ok   = false;
+                data = (char*)data + strip_bytes * planes;
+                continue;
+            }
+            char* dst  = (char*)data;
+            char* ubuf = m_separate
+                             ? separate_tmp.get() + nraw * strip_bytes * planes
+                             : dst;
+            size_t stripidx = nraw;
+            auto decode_etc = [=](int /*id*/) {
+                for (int c = 0; c < planes; ++c)
+                    if (!out->decode_raw_chunk(cbuf + c * cbound,
+                                               size_t(csize[c]),
+                                               ubuf + c * strip_bytes,
+                                               strip_bytes, stripchans,
+                                               out->m_spec.width,
+                                               out->m_rowsperstrip)) {
+                        failed[stripidx] = true;
+                        return;
+                    }
+                finish_strip(ubuf, dst);
             };
             if (parallelize) {
                 // Push the rest of the work onto the thread pool queue
-                tasks.push(pool->push(uncompress_etc));
+                tasks.push(pool->push(decode_etc));
             } else {
-                uncompress_etc(0);
+                decode_etc(0);
             }
             data = (char*)data + strip_bytes * planes;
         }
+        tasks.wait();
+        char* dst = (char*)data - nraw * strip_bytes * planes;
+        for (size_t stripidx = 0; stripidx < nraw;
+             ++stripidx, dst += strip_bytes * planes) {
+            if (!failed[stripidx])
+                continue;
+            int stripy = ybegin + int(stripidx) * m_rowsperstrip - m_spec.y;
+            char* ubuf = m_separate ? separate_tmp.get()
+                                          + stripidx * strip_bytes * planes
+                                    : dst;
+            for (int c = 0; c < planes; ++c) {
+                if (TIFFReadEncodedStrip(m_tif,
+                                         TIFFComputeStrip(m_tif, stripy, c),
+                                         ubuf + c * strip_bytes,
+                                         tmsize_t(strip_bytes))
+                    < 0) {
+                    std::string err = oiio_tiff_last_error();
+                    errorf(
+                        "TIFFReadEncodedStrip failed reading line y=%d,z=%d: %s",
+                        stripy + m_spec.y, z,
+                        err.size() ? err.c_str() : "unknown error");
+                    ok = false;
+                }
+            }
+            finish_strip(ubuf, dst);
+        }
 
     } else {
         // One of the cases where we don't bother reading raw, we read
@@ -1901,13 +2161,12 @@ TIFFInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
     // If we have left over scanlines, read them serially
     m_next_scanline = y;
     for (; y < yend; ++y) {
-        bool ok = read_native_scanline(subimage, miplevel, y, z, data);
-        if (!ok)
+        if (!read_native_scanline(subimage, miplevel, y, z, data))
             return false;
         data = (char*)data + ystride;
     }
     tasks.wait();
-    return true;
+    return ok;
 }
 
 
@@ -2032,11 +2291,11 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
 
     // If the stars all align properly, use the thread pool to parallelize
     // the decompression. This can give a large speedup (5x or more!)
-    // because the zip decompression dwarfs the actual raw I/O. But libtiff
-    // is totally serialized, so we can only parallelize by making calls to
-    // zlib ourselves and then writing "raw" (compressed) strips. Don't
-    // bother trying to handle any of the uncommon cases with strips. This
-    // covers most real-world cases.
+    // because the decompression dwarfs the actual raw I/O. But libtiff is
+    // totally serialized, so we can only parallelize by reading "raw"
+    // (compressed) tiles and decoding them ourselves (see
+    // can_decode_raw_chunks() for what we handle). This covers most
+    // real-world cases.
     thread_pool* pool = default_thread_pool();
     OIIO_DASSERT(m_spec.tile_depth >= 1);
     size_t ntiles = size_t(
@@ -2046,23 +2305,11 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
     bool parallelize =
         // more than one tile, or no point parallelizing
         ntiles > 1
-        // and not palette or cmyk color separated conversions
-        && (m_photometric != PHOTOMETRIC_SEPARATED
-            && m_photometric != PHOTOMETRIC_PALETTE)
-        // no non-multiple-of-8 bits per sample
-        && (spec().format.size() * 8 == m_bitspersample)
-        // contig planarconfig only (for now?)
-        && !m_separate
-        // only deflate/zip compression with horizontal predictor
-        && m_compression == COMPRESSION_ADOBE_DEFLATE
-        && m_predictor == PREDICTOR_HORIZONTAL
-        // only uint8, uint16
-        && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16)
-        // No other unusual cases
-        && !m_use_rgba_interface
-        // only if we're threading and don't enter the thread pool recursively!
+        // only compression, predictors, and data types we can decode
+        && can_decode_raw_chunks()
+        // only if we're threading (it's fine if we're already running
+        // inside a pool task, the work will nest)
         && pool->size() > 1
-        && !pool->is_worker()
         // only if this ImageInput wasn't asked to be single-threaded
         && this->threads() != 1
         // and not if the feature is turned off
@@ -2077,21 +2324,48 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
                                              ybegin, yend, zbegin, zend, data);
     }
 
-    // Make room for, and read the raw (still compressed) tiles. As each one
-    // is read, kick off the decompress and any other extras, to execute in
-    // parallel.
-    stride_t pixel_bytes   = (stride_t)m_spec.pixel_bytes(true);
-    stride_t tileystride   = pixel_bytes * m_spec.tile_width;
-    stride_t tilezstride   = tileystride * m_spec.tile_height;
-    stride_t ystride       = (xend - xbegin) * pixel_bytes;
-    stride_t zstride       = (yend - ybegin) * ystride;
-    imagesize_t tile_bytes = m_spec.tile_bytes(true);
-    int tilevals           = m_spec.tile_pixels() * m_spec.nchannels;
-    size_t cbound          = compressBound((uLong)tile_bytes);
-    std::unique_ptr<char[]> compressed_scratch(new char[cbound * ntiles]);
+    // Make room for, and read the raw (still compressed) tiles, one per
+    // plane for "separate" planarconfig. As each one is read, kick off
+    // the decompress and any other extras, to execute in parallel. Any
+    // tile we fail to decode ourselves is left for libtiff to read after
+    // the others are done.
+    stride_t pixel_bytes    = (stride_t)m_spec.pixel_bytes(true);
+    stride_t tileystride    = pixel_bytes * m_spec.tile_width;
+    stride_t tilezstride    = tileystride * m_spec.tile_height;
+    stride_t ystride        = (xend - xbegin) * pixel_bytes;
+    stride_t zstride        = (yend - ybegin) * ystride;
+    imagesize_t tile_pixels = m_spec.tile_pixels();
+    imagesize_t tile_bytes  = m_spec.tile_bytes(true);
+    int tilevals            = tile_pixels * m_spec.nchannels;
+    int planes              = m_separate ? m_spec.nchannels : 1;
+    int tilechans           = m_separate ? 1 : m_spec.nchannels;
+    imagesize_t plane_bytes = tile_bytes / planes;
+    size_t cbound           = raw_chunk_bound(plane_bytes);
+    std::unique_ptr<char[]> compressed_scratch(
+        new char[cbound * ntiles * planes]);
+    std::unique_ptr<tsize_t[]> csizes(new tsize_t[ntiles * planes]);
     std::unique_ptr<char[]> scratch(new char[tile_bytes * ntiles]);
+    std::unique_ptr<bool[]> failed_scratch(new bool[ntiles]());
+    bool* failed = failed_scratch.get();
     task_set tasks(pool);
-    bool ok = true;  // failed compression will stash a false here
+
+    auto out         = this;
+    auto finish_tile = [=](char* ubuf, char* dst) {
+        if (out->m_photometric == PHOTOMETRIC_MINISWHITE)
+            out->invert_photometric(tilevals, ubuf);
+        std::unique_ptr<char[]> contig;
+        if (out->m_separate) {
+            contig.reset(new char[tile_bytes]);
+            out->separate_to_contig(planes, int(tile_pixels),
+                                    (unsigned char*)ubuf,
+                                    (unsigned char*)contig.get());
+            ubuf = contig.get();
+        }
+        copy_image(out->m_spec.nchannels, out->m_spec.tile_width,
+                   out->m_spec.tile_height, out->m_spec.tile_depth, ubuf,
+                   size_t(pixel_bytes), pixel_bytes, tileystride, tilezstride,
+                   dst, pixel_bytes, ystride, zstride);
+    };
 
     // Strutil::printf ("Parallel tile case %d %d  %d %d  %d %d\n",
     //                  xbegin, xend, ybegin, yend, zbegin, zend);
@@ -2099,41 +2373,80 @@ TIFFInput::read_native_tiles(int subimage, int miplevel, int xbegin, int xend,
     for (int z = zbegin; z < zend; z += m_spec.tile_depth) {
         for (int y = ybegin; y < yend; y += m_spec.tile_height) {
             for (int x = xbegin; x < xend; x += m_spec.tile_width, ++tileidx) {
-                char* cbuf = compressed_scratch.get() + tileidx * cbound;
-                char* ubuf = scratch.get() + tileidx * tile_bytes;
-                auto csize = TIFFReadRawTile(m_tif, tile_index(x, y, z), cbuf,
-                                             tmsize_t(cbound));
-                if (csize < 0) {
-                    std::string err = oiio_tiff_last_error();
-                    errorf(
-                        "TIFFReadRawTile failed reading tile x=%d,y=%d,z=%d: %s",
-                        x, y, z, err.size() ? err.c_str() : "unknown error");
-                    return false;
+                char* cbuf     = compressed_scratch.get()
+                             + tileidx * planes * cbound;
+                char* ubuf     = scratch.get() + tileidx * tile_bytes;
+                tsize_t* csize = csizes.get() + tileidx * planes;
+                for (int c = 0; c < planes; ++c) {
+                    ttile_t tilenum = TIFFComputeTile(m_tif, x - m_spec.x,
+                                                      y - m_spec.y,
+                                                      z - m_spec.z, c);
+                    csize[c] = TIFFReadRawTile(m_tif, tilenum,
+                                               cbuf + c * cbound,
+                                               tmsize_t(cbound));
+                    if (csize[c] < 0) {
+                        std::string err = oiio_tiff_last_error();
+                        errorf("TIFFReadRawTile failed reading tile "
+                               "x=%d,y=%d,z=%d: %s",
+                               x, y, z,
+                               err.size() ? err.c_str() : "unknown error");
+                        return false;
+                    }
                 }
+                char* dst = (char*)data + (z - zbegin) * zstride
+                            + (y - ybegin) * ystride
+                            + (x - xbegin) * pixel_bytes;
                 // Push the rest of the work onto the thread pool queue
-                auto out = this;
-                tasks.push(pool->push([=, &ok](int /*id*/) {
-                    out->uncompress_one_strip(cbuf, (unsigned long)csize, ubuf,
-                                              tile_bytes, out->m_spec.nchannels,
-                                              out->m_spec.tile_width,
-                                              out->m_spec.tile_height
-                                                  * out->m_spec.tile_depth,
-                                              &ok);
-                    if (out->m_photometric == PHOTOMETRIC_MINISWHITE)
-                        out->invert_photometric(tilevals, ubuf);
-                    copy_image(out->m_spec.nchannels, out->m_spec.tile_width,
-                               out->m_spec.tile_height, out->m_spec.tile_depth,
-                               ubuf, size_t(pixel_bytes), pixel_bytes,
-                               tileystride, tilezstride,
-                               (char*)data + (z - zbegin) * zstride
-                                   + (y - ybegin) * ystride
-                                   + (x - xbegin) * pixel_bytes,
-                               pixel_bytes, ystride, zstride);
+                tasks.push(pool->push([=](int /*id*/) {
+                    int rows = out->m_spec.tile_height * out->m_spec.tile_depth;
+                    for (int c = 0; c < planes; ++c)
+                        if (!out->decode_raw_chunk(cbuf + c * cbound,
+                                                   size_t(csize[c]),
+                                                   ubuf + c * plane_bytes,
+                                                   plane_bytes, tilechans,
+                                                   out->m_spec.tile_width,
+                                                   rows)) {
+                            failed[tileidx] = true;
+                            return;
+                        }
+                    finish_tile(ubuf, dst);
                 }));
             }
         }
     }
-    return ok;
+    tasks.wait();
+
+    // Let libtiff have a go at anything we couldn't decode
+    tileidx = 0;
+    for (int z = zbegin; z < zend; z += m_spec.tile_depth) {
+        for (int y = ybegin; y < yend; y += m_spec.tile_height) {
+            for (int x = xbegin; x < xend; x += m_spec.tile_width, ++tileidx) {
+                if (!failed[tileidx])
+                    continue;
+                char* ubuf = scratch.get() + tileidx * tile_bytes;
+                for (int c = 0; c < planes; ++c) {
+                    ttile_t tilenum = TIFFComputeTile(m_tif, x - m_spec.x,
+                                                      y - m_spec.y,
+                                                      z - m_spec.z, c);
+                    if (TIFFReadEncodedTile(m_tif, tilenum,
+                                            ubuf + c * plane_bytes,
+                                            tmsize_t(plane_bytes))
+                        < 0) {
+                        std::string err = oiio_tiff_last_error();
+                        errorf("TIFFReadEncodedTile failed reading tile "
+                               "x=%d,y=%d,z=%d: %s",
+                               x, y, z,
+                               err.size() ? err.c_str() : "unknown error");
+                        return false;
+                    }
+                }
+                finish_tile(ubuf, (char*)data + (z - zbegin) * zstride
+                                      + (y - ybegin) * ystride
+                                      + (x - xbegin) * pixel_bytes);
+            }
+        }
+    }
+    return true;
 }
 
 
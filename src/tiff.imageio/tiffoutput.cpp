@@ -1124,9 +1124,9 @@ TIFFOutput::write_scanlines(int ybegin, int yend, int z, TypeDesc format,
         && m_predictor == PREDICTOR_HORIZONTAL
         // only uint8, uint16
         && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16)
-        // only if we're threading and don't enter the thread pool recursively!
+        // only if we're threading (it's fine if we're already running
+        // inside a pool task, the work will nest)
         && pool->size() > 1
-        && !pool->is_worker()
         // only if this ImageInput wasn't asked to be single-threaded
         && this->threads() != 1
         // and not if the feature is turned off
@@ -1354,9 +1354,9 @@ TIFFOutput::write_tiles(int xbegin, int xend, int ybegin, int yend, int zbegin,
         && m_predictor == PREDICTOR_HORIZONTAL
         // only uint8, uint16
         && (m_spec.format == TypeUInt8 || m_spec.format == TypeUInt16)
-        // only if we're threading and don't enter the thread pool recursively!
+        // only if we're threading (it's fine if we're already running
+        // inside a pool task, the work will nest)
         && pool->size() > 1
-        && !pool->is_worker()
         // and not if the feature is turned off
         && m_spec.get_int_attribute("tiff:multithread",
                                     OIIO::get_int_attribute("tiff:multithread"));
@@ -24,14 +24,23 @@ public:
     virtual const char* format_name() const override { return "webp"; }
     virtual int supports(string_view feature) const override
     {
-        return (feature == "exif");
+        return (feature == "exif" || feature == "ioproxy");
     }
     virtual bool open(const std::string& name, ImageSpec& spec) override;
+    virtual bool open(const std::string& name, ImageSpec& spec,
+                      const ImageSpec& config) override;
     virtual bool seek_subimage(int subimage, int miplevel) override;
     virtual bool read_native_scanline(int subimage, int miplevel, int y, int z,
                                       void* data) override;
+    virtual bool read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                       int yend, int z, void* data) override;
     virtual bool close() override;
     virtual int current_subimage(void) const override { return m_subimage; }
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     std::string m_filename;
@@ -45,6 +54,8 @@ private:
     WebPIterator m_iter;
     int m_subimage      = -1;  // Subimage we're pointed to
     int m_subimage_read = -1;  // Subimage stored in decoded_image
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
 
     // Reposition the m_iter to the desired subimage, return true for
     // success and adjust m_subimage, false for failure.
@@ -77,18 +88,19 @@ WebpInput::open(const std::string& name, ImageSpec& spec)
 {
     m_filename = name;
 
-    // Perform preliminary test on file type.
-    if (!Filesystem::is_regular(m_filename)) {
-        errorf("Not a regular file \"%s\"", m_filename);
+    if (!m_io) {
+        // If no proxy was supplied, create a file reader
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Read);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Read) {
+        errorf("Could not open file \"%s\"", m_filename);
+        close();
         return false;
     }
 
     // Get file size and check we've got enough data to decode WebP.
-    m_image_size = Filesystem::file_size(name);
-    if (m_image_size == uint64_t(-1)) {
-        errorf("Failed to get size for \"%s\"", m_filename);
-        return false;
-    }
+    m_image_size = m_io->size();
     if (m_image_size < 12) {
         errorf("File size is less than WebP header for file \"%s\"",
                m_filename);
@@ -96,23 +108,17 @@ WebpInput::open(const std::string& name, ImageSpec& spec)
     }
     if (m_image_size > std::numeric_limits<size_t>::max()) {
         errorf("Image size (%d) is too big to read", m_image_size);
-    }
-
-    FILE* file = Filesystem::fopen(m_filename, "rb");
-    if (!file) {
-        errorf("Could not open file \"%s\"", m_filename);
+        close();
         return false;
     }
 
     // Read header and verify we've got WebP image.
     std::vector<uint8_t> image_header;
     image_header.resize(std::min(m_image_size, (uint64_t)64), 0);
-    size_t numRead = fread(&image_header[0], sizeof(uint8_t),
-                           image_header.size(), file);
+    size_t numRead = m_io->pread(&image_header[0], image_header.size(), 0);
     if (numRead != image_header.size()) {
         errorf("Read failure for header of \"%s\" (expected %d bytes, read %d)",
                m_filename, image_header.size(), numRead);
-        fclose(file);
         close();
         return false;
     }
@@ -120,17 +126,13 @@ WebpInput::open(const std::string& name, ImageSpec& spec)
     int width = 0, height = 0;
     if (!WebPGetInfo(&image_header[0], image_header.size(), &width, &height)) {
         errorf("%s is not a WebP image file", m_filename);
-        fclose(file);
         close();
         return false;
     }
 
     // Read actual data and decode.
     m_encoded_image.reset(new uint8_t[m_image_size]);
-    fseek(file, 0, SEEK_SET);
-    numRead = fread(m_encoded_image.get(), sizeof(uint8_t), m_image_size, file);
-    fclose(file);
-    file = nullptr;
+    numRead = m_io->pread(m_encoded_image.get(), m_image_size, 0);
     if (numRead != m_image_size) {
         errorf("Read failure for \"%s\" (expected %d bytes, read %d)",
                m_filename, m_image_size, numRead);
@@ -208,6 +210,18 @@ WebpInput::open(const std::string& name, ImageSpec& spec)
 
 
 
+bool
+WebpInput::open(const std::string& name, ImageSpec& spec,
+                const ImageSpec& config)
+{
+    auto ioparam = config.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    return open(name, spec);
+}
+
+
+
 bool
 WebpInput::seek_subimage(int subimage, int miplevel)
 {
@@ -354,6 +368,24 @@ WebpInput::read_native_scanline(int subimage, int miplevel, int y, int /*z*/,
 
 
 
+bool
+WebpInput::read_native_scanlines(int subimage, int miplevel, int ybegin,
+                                 int yend, int /*z*/, void* data)
+{
+    lock_guard lock(*this);
+    if (!read_subimage(subimage, true))
+        return false;
+    yend = std::min(yend, m_spec.height);
+    if (ybegin < 0 || ybegin >= yend)  // out of range scanlines
+        return false;
+    // The whole frame is already decoded, so it's one big copy
+    memcpy(data, m_decoded_image.get() + (ybegin * m_scanline_size),
+           (yend - ybegin) * m_scanline_size);
+    return true;
+}
+
+
+
 bool
 WebpInput::close()
 {
@@ -365,6 +397,8 @@ WebpInput::close()
     m_decoded_image.reset();
     m_encoded_image.reset();
     m_subimage = -1;
+    m_io       = nullptr;
+    m_io_local.reset();
     return true;
 }
 
@@ -29,12 +29,18 @@ public:
                             const void* data, stride_t xstride,
                             stride_t ystride, stride_t zstride) override;
     virtual bool close() override;
+    virtual bool set_ioproxy(Filesystem::IOProxy* ioproxy) override
+    {
+        m_io = ioproxy;
+        return true;
+    }
 
 private:
     WebPPicture m_webp_picture;
     WebPConfig m_webp_config;
     std::string m_filename;
-    FILE* m_file;
+    std::unique_ptr<Filesystem::IOProxy> m_io_local;
+    Filesystem::IOProxy* m_io = nullptr;
     int m_scanline_size;
     unsigned int m_dither;
     std::vector<uint8_t> m_uncompressed_image;
@@ -42,7 +48,9 @@ private:
     void init()
     {
         m_scanline_size = 0;
-        m_file          = NULL;
+        m_io            = nullptr;
+        m_io_local.reset();
+        m_filename.clear();
     }
 };
 
@@ -52,7 +60,8 @@ int
 WebpOutput::supports(string_view feature) const
 {
     return feature == "tiles" || feature == "alpha"
-           || feature == "random_access" || feature == "rewrite";
+           || feature == "random_access" || feature == "rewrite"
+           || feature == "ioproxy";
 }
 
 
@@ -61,13 +70,9 @@ static int
 WebpImageWriter(const uint8_t* img_data, size_t data_size,
                 const WebPPicture* const webp_img)
 {
-    FILE* out_file = (FILE*)webp_img->custom_ptr;
-    size_t wb      = fwrite(img_data, data_size, sizeof(uint8_t), out_file);
-    if (wb != sizeof(uint8_t)) {
-        //FIXME Bad write occurred
-    }
-
-    return 1;
+    auto io = (Filesystem::IOProxy*)webp_img->custom_ptr;
+    // Returning 0 makes WebPEncode fail with a bad-write error
+    return io->write(img_data, data_size) == data_size;
 }
 
 
@@ -80,9 +85,14 @@ WebpOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
         return false;
     }
 
-    // saving 'name' and 'spec' for later use
-    m_filename = name;
-    m_spec     = spec;
+    // Close any already-opened file, but hold on to a proxy that was
+    // supplied with set_ioproxy() for the new one.
+    Filesystem::IOProxy* ioproxy = m_filename.empty() ? m_io : nullptr;
+    close();
+    m_io = ioproxy;
+
+    // saving 'spec' for later use
+    m_spec = spec;
 
     if (m_spec.nchannels != 3 && m_spec.nchannels != 4) {
         errorf("%s does not support %d-channel images\n", format_name(),
@@ -90,11 +100,19 @@ WebpOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
         return false;
     }
 
-    m_file = Filesystem::fopen(m_filename, "wb");
-    if (!m_file) {
-        errorf("Could not open \"%s\"", m_filename);
+    auto ioparam = m_spec.find_attribute("oiio:ioproxy", TypeDesc::PTR);
+    if (ioparam)
+        m_io = ioparam->get<Filesystem::IOProxy*>();
+    if (!m_io) {
+        // If no proxy was supplied, create a file writer
+        m_io = new Filesystem::IOFile(name, Filesystem::IOProxy::Mode::Write);
+        m_io_local.reset(m_io);
+    }
+    if (!m_io || m_io->mode() != Filesystem::IOProxy::Mode::Write) {
+        errorf("Could not open \"%s\"", name);
         return false;
     }
+    m_filename = name;
 
     if (!WebPPictureInit(&m_webp_picture)) {
         errorf("Couldn't initialize WebPPicture\n");
@@ -105,7 +123,7 @@ WebpOutput::open(const std::string& name, const ImageSpec& spec, OpenMode mode)
     m_webp_picture.width      = m_spec.width;
     m_webp_picture.height     = m_spec.height;
     m_webp_picture.writer     = WebpImageWriter;
-    m_webp_picture.custom_ptr = (void*)m_file;
+    m_webp_picture.custom_ptr = (void*)m_io;
 
     if (!WebPConfigInit(&m_webp_config)) {
         errorf("Couldn't initialize WebPPicture\n");
@@ -193,8 +211,10 @@ WebpOutput::write_tile(int x, int y, int z, TypeDesc format, const void* data,
 bool
 WebpOutput::close()
 {
-    if (!m_file)
-        return true;  // already closed
+    if (!m_io || m_filename.empty()) {  // already closed
+        init();
+        return true;
+    }
 
     bool ok = true;
     if (m_spec.tile_width) {
@@ -206,9 +226,8 @@ WebpOutput::close()
     }
 
     WebPPictureFree(&m_webp_picture);
-    fclose(m_file);
-    m_file = NULL;
-    return true;
+    init();
+    return ok;
 }
 
 
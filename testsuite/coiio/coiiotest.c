@@ -62,6 +62,28 @@ main(void)
         }
     }
 
+    // read an unaligned sub-region with a subset of channels in one call,
+    // and check that it matches the corresponding pixels of the full read
+    OIIO_ROI roi = { 5, 37, 3, 20, 0, 1, 1, nchannels };
+    int rw = OIIO_ROI_width(&roi), rh = OIIO_ROI_height(&roi);
+    int rc        = OIIO_ROI_nchannels(&roi);
+    float* region = (float*)malloc(sizeof(float) * rw * rh * rc);
+    result = OIIO_ImageInput_read_roi(ii, 0, 0, &roi, OIIO_TypeFloat, region,
+                                      OIIO_AutoStride, OIIO_AutoStride,
+                                      OIIO_AutoStride);
+    int mismatches = result ? 0 : -1;
+    for (int y = 0; result && y < rh; ++y)
+        for (int x = 0; x < rw; ++x)
+            for (int c = 0; c < rc; ++c) {
+                float full = data[((roi.ybegin + y) * w + roi.xbegin + x)
+                                      * nchannels
+                                  + roi.chbegin + c];
+                if (region[(y * rw + x) * rc + c] != full)
+                    ++mismatches;
+            }
+    printf("read_roi mismatches: %d\n", mismatches);
+    free(region);
+
     // create a new image spec for our output image by copying the input one
     OIIO_ImageSpec* out_spec = OIIO_ImageSpec_copy(in_spec);
 
@@ -0,0 +1,28 @@
+#!/usr/bin/env python
+
+# Round trip each block compression through the DDS writer and reader. The
+# block formats are lossy, so compare to the source with a tolerance. The
+# odd size leaves partial blocks along the right and bottom edges.
+failthresh = 0.05
+hardfail = 0.1
+failpercent = 1
+
+size = "70x45"
+# Color formats hold RGBA (DXT1 only a 1 bit alpha, so keep it opaque), BC4
+# a single channel and BC5 two channels.
+sources = {
+    "opaque" : "fill:topleft=0,0.2,0.4,1:topright=1,0.6,0.2,1:bottomleft=0.2,1,0,1:bottomright=0.6,0,1,1 " + size + " 4",
+    "rgba"   : "fill:topleft=0,0.2,0.4,1:topright=1,0.6,0.2,0.75:bottomleft=0.2,1,0,0.25:bottomright=0.6,0,1,0.5 " + size + " 4",
+    "gray"   : "fill:left=0.1:right=0.9 " + size + " 1",
+    "twochan" : "fill:top=0.1,0.8:bottom=0.9,0.3 " + size + " 2",
+}
+cases = [ ("DXT1", "opaque"), ("DXT5", "rgba"),
+          ("BC4", "gray"), ("BC5", "twochan") ]
+for (comp, src) in cases :
+    command += oiiotool ("--pattern " + sources[src]
+                         + " -d uint8 -o " + src + ".tif")
+    command += oiiotool (src + ".tif --compression " + comp
+                         + " -o " + comp + ".dds")
+    command += diff_command (src + ".tif", comp + ".dds")
+
+outputs = [ "out.txt" ]
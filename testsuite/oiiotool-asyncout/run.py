@@ -0,0 +1,18 @@
+#!/usr/bin/env python
+
+# With --async-output, files are written in the background. Reading one
+# back in the same command must wait for its write to finish, however the
+# path is spelled: as written, with a leading "./", or as an absolute path.
+# Big float images make the background writes slow enough to lose a race.
+pattern = "--pattern fill:top=0,0.5,1:bottom=1,0.5,0 1024x1024 3 -d float"
+command += oiiotool (pattern + " -o ref.exr")
+cases = [ ("same", "same.exr"),
+          ("dot", "./dot.exr"),
+          ("abs", os.path.join(tmpdir, "abs.exr")) ]
+for (name, readback) in cases :
+    command += oiiotool ("--async-output " + pattern
+                         + " -o " + name + ".exr"
+                         + " " + readback + " -o " + name + "_copy.exr")
+    command += diff_command ("ref.exr", name + "_copy.exr")
+
+outputs = [ "out.txt" ]
@@ -0,0 +1,15 @@
+#!/usr/bin/env python
+
+# oiiotool --resize of a JPEG that hasn't been read yet lets libjpeg do
+# part of the reduction while decoding. Make sure the result is the size
+# that was asked for, for relative and absolute sizes, and whether or not
+# that shortcut is taken.
+command += oiiotool ("--pattern checker:width=16:height=16 640x480 3 -d uint8 -o src.jpg")
+for size in [ "50%", "25%", "20%", "200x150", "160x0", "75%" ] :
+    for jpegscale in [ 1, 0 ] :
+        command += oiiotool ("src.jpg --resize:jpegscale=" + str(jpegscale)
+                             + " " + size
+                             + " --echo \"" + size + " jpegscale=" + str(jpegscale)
+                             + ": {TOP.width}x{TOP.height}\"")
+
+outputs = [ "out.txt" ]
@@ -0,0 +1,26 @@
+#!/usr/bin/env python
+
+# With --parallel-subimages, an op on all subimages does them all at once.
+# The results must be the same as doing them one after another. The second
+# input of --add has only one subimage, so it's shared by all of them.
+command += oiiotool ("--pattern fill:top=0,0,0:bottom=1,0.5,0 64x64 3 " +
+                     "--pattern fill:left=0,1,0:right=0,0,1 64x64 3 " +
+                     "--pattern checker:width=8:height=8 64x64 3 " +
+                     "--pattern constant:color=0.1,0.2,0.3 64x64 3 " +
+                     "--siappendall -d half -o multi.exr")
+command += oiiotool ("--pattern constant:color=0.25,0.5,0.75 32x32 3 " +
+                     "-d half -o single.exr")
+for (name, flag) in [ ("serial", ""), ("parallel", "--parallel-subimages ") ] :
+    command += oiiotool (flag + "-a multi.exr --resize 32x32 --blur 3x3 " +
+                         "single.exr --add -d half -o " + name + ".exr")
+command += diff_command ("serial.exr", "parallel.exr")
+
+# Errors, here from every subimage, must be reported the same way and in
+# the same order either way.
+redirect = " >> out.txt 2>> out.err.txt "
+for flag in [ "", "--parallel-subimages " ] :
+    command += oiiotool (flag + "-a multi.exr single.exr --deepmerge " +
+                         "-o bad.exr")
+failureok = 1
+
+outputs = [ "out.txt", "out.err.txt" ]
@@ -0,0 +1,22 @@
+#!/usr/bin/env python
+
+# When built with OIIO_USE_EXR_C_API, OpenEXR files are written through
+# the OpenEXR Core library unless "openexr:core" is 0. Write the same
+# images both ways, as scanlines and as tiles (with sizes that leave
+# partial chunks and edge tiles), and make sure the pixels agree. Without
+# the Core library, both are written by the C++ library and trivially
+# agree.
+for comp in [ "none", "zip", "zips", "piz", "rle", "pxr24" ] :
+    for layout in [ "scan", "tile" ] :
+        tiling = "--tile 64 32 " if layout == "tile" else ""
+        base = comp + "_" + layout
+        for core in [ 1, 0 ] :
+            command += oiiotool ("--pattern checker:width=7:height=5 261x133 4 "
+                                 + "--pattern fill:left=0,0,0,1:right=1,0.5,0.25,1 261x133 4 --add "
+                                 + "-d half " + tiling
+                                 + "--attrib openexr:core " + str(core) + " "
+                                 + "--compression " + comp
+                                 + " -o " + base + "_core" + str(core) + ".exr")
+        command += diff_command (base + "_core1.exr", base + "_core0.exr")
+
+outputs = [ "out.txt" ]
@@ -0,0 +1,25 @@
+#!/usr/bin/env python
+
+# Images of 4 MB or more are compressed in parallel blocks unless
+# "png:parallel" is 0. Write large images both ways, and make sure both
+# read back identical to each other and to the source pixels. Ask for
+# several threads, so that the parallel path is taken even on a machine
+# with one core.
+cases = [ ("rgba16", "1501x1003 4 -d uint16"),
+          ("rgb8", "2050x1001 3 -d uint8") ]
+for (name, geom) in cases :
+    size = geom.split()[0]
+    nchans = geom.split()[1]
+    command += oiiotool ("--pattern fill:top=0,0.25,0.5,1:bottom=1,0.75,0.5,1 "
+                         + size + " " + nchans + " "
+                         + "--pattern noise:type=uniform:min=0:max=0.25:seed=3 "
+                         + size + " " + nchans + " --add "
+                         + geom.split(" ", 2)[2] + " -o " + name + "_src.tif")
+    for parallel in [ 1, 0 ] :
+        command += oiiotool ("--threads 4 " + name + "_src.tif "
+                             + "--attrib png:parallel " + str(parallel)
+                             + " -o " + name + "_par" + str(parallel) + ".png")
+    command += diff_command (name + "_par1.png", name + "_par0.png")
+    command += diff_command (name + "_par1.png", name + "_src.tif")
+
+outputs = [ "out.txt" ]
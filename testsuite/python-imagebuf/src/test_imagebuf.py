@@ -133,6 +133,23 @@ def test_multiimage () :
     out.close ()
 
 
+def test_pixels_view () :
+    print ("Testing pixels_view and wrapping a numpy array")
+    b = oiio.ImageBuf (oiio.ImageSpec (4, 2, 3, "float"))
+    v = b.pixels_view ()
+    print ("view shape", v.shape, "dtype", v.dtype)
+    v[1,2] = (0.25, 0.5, 0.75)
+    print ("pixel 2,1 after writing the view:", b.getpixel (2, 1))
+    b.setpixel (0, 0, (1.0, 0.0, 0.5))
+    print ("view of pixel 0,0 after setpixel:", tuple(float(x) for x in v[0,0]))
+    a = numpy.zeros ((2, 4, 3), dtype='f')
+    w = oiio.ImageBuf (oiio.ImageSpec (4, 2, 3, "float"), a)
+    a[1,3] = (0.5, 0.5, 0.5)
+    print ("wrapped pixel 3,1 after writing the array:", w.getpixel (3, 1))
+    w.setpixel (0, 1, (0.125, 0.25, 1.0))
+    print ("array [1,0] after setpixel:", tuple(float(x) for x in a[1,0]))
+
+
 
 ######################################################################
 # main test starts here
@@ -216,6 +233,7 @@ try:
     test_perchannel_formats ()
     test_deep ()
     test_multiimage ()
+    test_pixels_view ()
 
     print ("\nDone.")
 except Exception as detail:
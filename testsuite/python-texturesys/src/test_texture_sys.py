@@ -49,6 +49,39 @@ diff = oiio.ImageBufAlgo.compare(checker_buf, render_buf, 0, 0)
 
 print("top mip pixel differences when streaming =", diff.nfail)
 
+# The same, with one batched lookup of all the pixel centers
+ys, xs = numpy.mgrid[0:512, 0:512]
+s = ((xs + 0.5) / 512.0).ravel()
+t = ((ys + 0.5) / 512.0).ravel()
+batch_pixels = texture_sys.texture_batch(checker, texture_opt, s, t, 3)
+print("batched result shape =", batch_pixels.shape)
+render_buf.set_pixels(render_buf.roi, batch_pixels)
+diff = oiio.ImageBufAlgo.compare(checker_buf, render_buf, 0, 0)
+print("top mip pixel differences when batched =", diff.nfail)
+
+# Batched lookups of a missing texture raise, rather than returning
+# garbage, unless there is a missingcolor to return instead.
+missing = "no_such_texture.tx"
+R = numpy.array([[0.0, 0.0, 1.0]] * 4)
+try:
+    texture_sys.texture_batch(missing, texture_opt, s[:4], t[:4], 3)
+    print("texture_batch of a missing file did not raise")
+except RuntimeError:
+    print("texture_batch of a missing file raised RuntimeError")
+try:
+    texture_sys.environment_batch(missing, texture_opt, R, 3)
+    print("environment_batch of a missing file did not raise")
+except RuntimeError:
+    print("environment_batch of a missing file raised RuntimeError")
+texture_opt.missingcolor = (0.25, 0.5, 0.75)
+missing_pixels = texture_sys.texture_batch(missing, texture_opt, s[:4], t[:4], 3)
+print("texture_batch missingcolor =", missing_pixels[0].tolist(),
+      "shape", missing_pixels.shape)
+missing_pixels = texture_sys.environment_batch(missing, texture_opt, R, 3)
+print("environment_batch missingcolor =", missing_pixels[0].tolist(),
+      "shape", missing_pixels.shape)
+texture_opt.missingcolor = None
+
 print ("")
 
 print("Done.")
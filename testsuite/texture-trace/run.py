@@ -0,0 +1,19 @@
+#!/usr/bin/env python
+
+# Capture a trace of the lookups made while rendering a test image on
+# several threads, then replay it. The results of the replayed lookups
+# must not depend on how many threads replay them.
+command += testtex_command ("../common/textures/grid.tx",
+                            "--res 64 64 --nowarp --threads 4 "
+                            + "--texoptions trace_file=lookups.trc -o out.exr",
+                            silent=True)
+for nt in [ 1, 3 ] :
+    command += (oiio_app("testtex") + " --replay lookups.trc --threads "
+                + str(nt) + " > replay" + str(nt) + ".txt ;\n")
+    command += ("grep checksum replay" + str(nt) + ".txt > sum" + str(nt)
+                + ".txt ;\n")
+command += ("grep -q \"Replayed [1-9]\" replay1.txt && echo \"Replayed lookups\""
+            + redirect + ";\n")
+command += ("cmp -s sum1.txt sum3.txt && echo \"Replay checksums match\""
+            + redirect + ";\n")
+outputs = [ "out.txt" ]